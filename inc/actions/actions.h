@@ -178,6 +178,8 @@ DECLARE_SIMPLE (activate_export_as);
 COLD
 DECLARE_SIMPLE (activate_export_graph);
 
+DECLARE_SIMPLE (activate_toggle_dsp_profiling);
+
 void
 activate_properties (GSimpleAction *action,
                   GVariant      *variant,
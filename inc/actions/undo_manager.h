@@ -30,6 +30,8 @@
 
 #include "zix/sem.h"
 
+#include <glib.h>
+
 typedef struct AudioClip AudioClip;
 
 /**
@@ -50,6 +52,16 @@ typedef struct UndoManager
 
   /** Semaphore for performing actions. */
   ZixSem        action_sem;
+
+  /**
+   * Thread decoding the undo history when it is
+   * loaded lazily, or NULL.
+   *
+   * The thread returns a deserialized UndoManager
+   * whose stacks are taken over in
+   * undo_manager_ensure_loaded().
+   */
+  GThread *     loader;
 } UndoManager;
 
 static const cyaml_schema_field_t
@@ -80,6 +92,18 @@ void
 undo_manager_init_loaded (
   UndoManager * self);
 
+/**
+ * Waits for the undo history to be decoded if it
+ * is loaded lazily and populates the undo/redo
+ * stacks.
+ *
+ * Must be called before accessing the stacks
+ * directly.
+ */
+void
+undo_manager_ensure_loaded (
+  UndoManager * self);
+
 /**
  * Inits the undo manager by creating the undo/redo
  * stacks.
@@ -67,8 +67,14 @@ audio_function_type_to_string (
 /**
  * Applies the given action to the given selections.
  *
+ * The frames are processed in chunks on a thread
+ * pool, showing a cancelable progress dialog for
+ * large selections.
+ *
  * @param sel Selections to edit.
  * @param type Function type.
+ *
+ * @return Non-zero if failed or cancelled.
  */
 int
 audio_function_apply (
@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ *
+ * Compiled automation envelopes.
+ *
+ * An AutomationEnvelope is a flat, time-sorted
+ * array of segments on the timeline built from
+ * the regions of an AutomationTrack, so that the
+ * value at a position can be looked up without
+ * walking regions and automation points.
+ *
+ * The automation points of each region are
+ * compiled once, in region-local frames, and
+ * looped regions map the position into the loop
+ * when looking up, so the size of the envelope
+ * does not depend on the number of loops.
+ */
+
+#ifndef __AUDIO_AUTOMATION_ENVELOPE_H__
+#define __AUDIO_AUTOMATION_ENVELOPE_H__
+
+#include <stdbool.h>
+
+#include "audio/curve.h"
+
+typedef struct AutomationTrack AutomationTrack;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * A compiled automation point of a region.
+ *
+ * The value of the point applies from
+ * \ref AutomationEnvelopePoint.local_frames until
+ * the next point.
+ */
+typedef struct AutomationEnvelopePoint
+{
+  /** Region-local frames of the automation point
+   * (where the curve starts). */
+  long         local_frames;
+
+  /**
+   * 1 / length of the curve in frames, or 0 if
+   * the value is constant.
+   */
+  double       inv_length;
+
+  /** Lowest normalized value of the curve. */
+  float        base_val;
+
+  /** Absolute difference between the normalized
+   * values at the start and end of the curve. */
+  float        diff;
+
+  /** Whether the curve starts at the higher
+   * point. */
+  bool         start_higher;
+
+  CurveOptions curve_opts;
+} AutomationEnvelopePoint;
+
+typedef enum AutomationEnvelopeSegmentType
+{
+  /** No automation at this part of the
+   * timeline. */
+  AUTOMATION_ENVELOPE_SEGMENT_GAP,
+
+  /** Inside a region. */
+  AUTOMATION_ENVELOPE_SEGMENT_REGION,
+
+  /** After a region, holding its last value. */
+  AUTOMATION_ENVELOPE_SEGMENT_HOLD,
+} AutomationEnvelopeSegmentType;
+
+/**
+ * A part of the timeline where the value comes
+ * from the same source.
+ *
+ * The segment applies from
+ * \ref AutomationEnvelopeSegment.start_frames until
+ * the start of the next segment.
+ */
+typedef struct AutomationEnvelopeSegment
+{
+  /** Timeline frame the segment starts at. */
+  long         start_frames;
+
+  AutomationEnvelopeSegmentType type;
+
+  /** Value held, if hold. */
+  float        hold_val;
+
+  /** Timeline frames of the start of the region,
+   * if region. */
+  long         region_start_frames;
+
+  /** Region-local clip start, loop start and loop
+   * end frames, if region. */
+  long         clip_start_frames;
+  long         loop_start_frames;
+  long         loop_end_frames;
+
+  /** Index of the first point of the region in
+   * \ref AutomationEnvelope.points, if region. */
+  int          first_point;
+
+  /** Number of points of the region. */
+  int          num_points;
+} AutomationEnvelopeSegment;
+
+/**
+ * Segments for one lookup mode.
+ */
+typedef struct AutomationEnvelopeSegments
+{
+  AutomationEnvelopeSegment * segments;
+  int                         num_segments;
+  size_t                      segments_size;
+} AutomationEnvelopeSegments;
+
+/**
+ * A compiled automation envelope.
+ *
+ * Once published, it is immutable: edits create a
+ * new envelope that replaces it.
+ */
+typedef struct AutomationEnvelope
+{
+  /** Points of all the regions, shared by the
+   * segments of both lookup modes. */
+  AutomationEnvelopePoint * points;
+  int                       num_points;
+
+  /**
+   * Segments considering only regions that
+   * surround the position.
+   *
+   * See \ref
+   * automation_track_get_region_before_pos().
+   */
+  AutomationEnvelopeSegments surrounding;
+
+  /**
+   * Segments considering the region that ends
+   * last, holding its last value after it ends.
+   */
+  AutomationEnvelopeSegments latest;
+} AutomationEnvelope;
+
+/**
+ * Playback cursor for an envelope.
+ *
+ * This remembers the last segment and point found
+ * so that sequential lookups only need to move
+ * forward.
+ */
+typedef struct AutomationEnvelopeCursor
+{
+  /** Envelope the cursor was last used with. */
+  const AutomationEnvelope * env;
+
+  /** Lookup mode the cursor was last used with. */
+  bool   ends_after;
+
+  /** Index of the current segment, or -1 if
+   * before the first segment. */
+  int    seg_idx;
+
+  /** Index of the current point in the segment,
+   * or -1 if before the first point. */
+  int    point_idx;
+
+  /** Last timeline frames looked up. */
+  long   frames;
+
+  /** Last region-local frames looked up. */
+  long   local_frames;
+} AutomationEnvelopeCursor;
+
+/**
+ * Compiles the regions and automation points of
+ * the given automation track into a new envelope.
+ */
+AutomationEnvelope *
+automation_envelope_new_from_automation_track (
+  AutomationTrack * at);
+
+/**
+ * Returns the normalized value at the given
+ * timeline frames, moving the cursor forward.
+ *
+ * The cursor re-seeks (with a binary search) only
+ * when the position jumps backwards or far ahead,
+ * when a region loops, or when the envelope is
+ * replaced.
+ *
+ * This is realtime-safe.
+ *
+ * @param ends_after Whether to only consider
+ *   regions that surround the position (see
+ *   automation_track_get_ap_before_pos()).
+ * @param[out] val The normalized value.
+ *
+ * @return Whether there is a value at the given
+ *   position.
+ */
+bool
+automation_envelope_get_normalized_val (
+  const AutomationEnvelope * self,
+  AutomationEnvelopeCursor * cursor,
+  long                       frames,
+  bool                       ends_after,
+  float *                    val);
+
+/**
+ * Finds the next position after \ref frames where
+ * the value changes.
+ *
+ * This does not move any cursor so it can be used
+ * while processing without affecting playback.
+ *
+ * @param ends_after See
+ *   automation_envelope_get_normalized_val().
+ * @param[out] change_frames Timeline frames of the
+ *   next change. If the value is changing
+ *   continuously (eg, on a ramp), this is
+ *   \ref frames + 1.
+ *
+ * @return Whether there is a change after
+ *   \ref frames.
+ */
+bool
+automation_envelope_get_next_change (
+  const AutomationEnvelope * self,
+  long                       frames,
+  bool                       ends_after,
+  long *                     change_frames);
+
+void
+automation_envelope_free (
+  AutomationEnvelope * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -30,6 +30,7 @@
 
 #include <stdbool.h>
 
+#include "audio/automation_envelope.h"
 #include "audio/automation_point.h"
 #include "audio/port.h"
 #include "audio/position.h"
@@ -179,6 +180,29 @@ typedef struct AutomationTrack
   CustomButtonWidget * bot_left_buttons[8];
   int                  num_bot_left_buttons;
 
+  /**
+   * Compiled envelope used for lookups during
+   * processing.
+   *
+   * Replaced atomically when recompiled.
+   */
+  AutomationEnvelope * envelope;
+
+  /**
+   * Whether \ref AutomationTrack.envelope is out of
+   * date (regions or automation points were
+   * edited since it was compiled).
+   *
+   * While set, values are looked up from the
+   * regions directly.
+   */
+  volatile gint        envelope_dirty;
+
+  /** Playback cursor for \ref
+   * AutomationTrack.envelope (only used by the
+   * processing thread). */
+  AutomationEnvelopeCursor envelope_cursor;
+
   /** The widget. */
   //AutomationTrackWidget * widget;
 } AutomationTrack;
@@ -269,6 +293,11 @@ automation_track_find_from_port_id (
  * Finds the AutomationTrack associated with
  * `port`.
  *
+ * The owner of the port is resolved through the
+ * handle table if the port has owner handles, in
+ * which case NULL is returned if the owner was
+ * removed.
+ *
  * @param track The track that owns the port, if
  *   known.
  */
@@ -485,6 +514,95 @@ automation_track_get_val_at_pos (
   bool              normalized,
   bool              ends_after);
 
+/**
+ * Returns the normalized parameter value at the
+ * given timeline frames.
+ *
+ * This uses the compiled envelope if it is up to
+ * date, otherwise it falls back to
+ * automation_track_get_val_at_pos().
+ *
+ * @param ends_after See
+ *   automation_track_get_val_at_pos().
+ * @param[out] val The normalized value.
+ *
+ * @return Whether there is automation at the
+ *   given position.
+ */
+NONNULL
+bool
+automation_track_get_normalized_val_at_frames (
+  AutomationTrack * self,
+  long              frames,
+  bool              ends_after,
+  float *           val);
+
+/**
+ * Returns the timeline frames of the next value
+ * change after the given frames, using the
+ * compiled envelope.
+ *
+ * @see automation_envelope_get_next_change().
+ *
+ * @return Whether a change was found. This is
+ *   false if the envelope is out of date.
+ */
+NONNULL
+bool
+automation_track_get_next_change_frames (
+  AutomationTrack * self,
+  long              frames,
+  bool              ends_after,
+  long *            change_frames);
+
+/**
+ * Marks the compiled envelope as out of date and
+ * schedules recompiling it in the GTK thread.
+ *
+ * To be called when the regions or automation
+ * points of the track change.
+ *
+ * This is realtime-safe: when not called from the
+ * GTK thread, the envelope is recompiled by
+ * engine_process_events() instead.
+ */
+NONNULL
+void
+automation_track_invalidate_envelope (
+  AutomationTrack * self);
+
+/**
+ * Recompiles the out of date envelopes of all the
+ * automation tracks in the project, if any were
+ * invalidated since the last call.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+automation_track_update_pending_envelopes (void);
+
+/**
+ * Marks the compiled envelope of the automation
+ * track referenced by the given region identifier
+ * as out of date, if such a track exists.
+ */
+NONNULL
+void
+automation_track_invalidate_envelope_for_region_id (
+  const RegionIdentifier * id);
+
+/**
+ * Recompiles the envelope if it is out of date
+ * (or if \ref force is true) and publishes it.
+ *
+ * Must be called from the GTK thread.
+ */
+NONNULL
+void
+automation_track_update_envelope (
+  AutomationTrack * self,
+  bool              force);
+
 /**
  * Returns the y pixels from the value based on the
  * allocation of the automation track.
@@ -146,6 +146,17 @@ void
 automation_tracklist_update_frames (
   AutomationTracklist * self);
 
+/**
+ * Recompiles the envelopes of the automation
+ * tracks that are out of date.
+ *
+ * @param force Recompile all envelopes.
+ */
+void
+automation_tracklist_update_envelopes (
+  AutomationTracklist * self,
+  bool                  force);
+
 /**
  * Gets the currently visible AutomationTrack's
  * (regardless of whether the automation tracklist
@@ -28,6 +28,7 @@
 
 #include <stdbool.h>
 
+#include "audio/clip_chunk.h"
 #include "utils/audio.h"
 #include "utils/types.h"
 #include "utils/yaml.h"
@@ -96,6 +97,30 @@ typedef struct AudioClip
    * already written to the pool. */
   char *        file_hash;
 
+  /**
+   * Shared chunks of the frames.
+   *
+   * Clips with chunks are stored in the pool as
+   * their chunks instead of as a single file.
+   *
+   * Clips created by audio_clip_new_version() only
+   * have chunks and no frames.
+   */
+  ClipChunk **  chunks;
+  int           num_chunks;
+  size_t        chunks_size;
+
+  /**
+   * Whether the frames changed since the clip was
+   * last written to the main project's pool (not
+   * serialized).
+   *
+   * Clips that are not dirty are skipped when
+   * saving as long as their file in the pool is
+   * unchanged.
+   */
+  bool          dirty;
+
   /**
    * Frames already written to the file, per channel.
    *
@@ -133,6 +158,8 @@ audio_clip_fields_schema[] =
     AudioClip, samplerate),
   YAML_FIELD_INT (
     AudioClip, pool_id),
+  YAML_FIELD_DYN_PTR_ARRAY_VAR_COUNT_OPT (
+    AudioClip, chunks, clip_chunk_schema),
 
   CYAML_FIELD_END
 };
@@ -206,6 +233,59 @@ audio_clip_update_channel_caches (
   AudioClip * self,
   size_t      start_from);
 
+/**
+ * Splits the frames of the clip into chunks, if
+ * not already split.
+ */
+NONNULL
+void
+audio_clip_ensure_chunks (
+  AudioClip * self);
+
+/**
+ * Creates a clip that shares the current chunks of
+ * the given clip.
+ *
+ * The new clip has no frames, so this is cheap
+ * regardless of the length of the clip. It is
+ * used to keep the state of a clip before and
+ * after an edit.
+ */
+NONNULL
+AudioClip *
+audio_clip_new_version (
+  AudioClip * self);
+
+/**
+ * Replaces the frames from \ref start_frame with
+ * \ref frames.
+ *
+ * If the clip has chunks, only the chunks
+ * overlapping the range are replaced, so other
+ * versions of the clip keep sharing the rest.
+ *
+ * @param frames Frames, interleaved.
+ */
+NONNULL
+void
+audio_clip_replace_frames (
+  AudioClip *      self,
+  const sample_t * frames,
+  size_t           start_frame,
+  size_t           num_frames);
+
+/**
+ * Sets the chunks of the clip to the given chunks
+ * (eg, the chunks of a version of the clip) and
+ * updates the frames in the chunks that changed.
+ */
+NONNULL
+void
+audio_clip_set_chunks (
+  AudioClip *  self,
+  ClipChunk ** chunks,
+  int          num_chunks);
+
 /**
  * Writes the given audio clip data to a file.
  *
@@ -222,7 +302,8 @@ audio_clip_write_to_file (
   bool         parts);
 
 /**
- * Writes the clip to the pool as a wav file.
+ * Writes the clip to the pool as a wav file, or
+ * as chunks if the clip has chunks.
  *
  * @param parts If true, only write new data. @see
  *   AudioClip.frames_written.
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Reference-counted chunks of clip frames.
+ */
+
+#ifndef __AUDIO_CLIP_CHUNK_H__
+#define __AUDIO_CLIP_CHUNK_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils/types.h"
+#include "utils/yaml.h"
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * Number of frames (per channel) in each chunk.
+ *
+ * Only the last chunk of a clip may be shorter.
+ */
+#define CLIP_CHUNK_FRAMES (1 << 16)
+
+/**
+ * Name of the directory in the pool that the
+ * chunks are stored in.
+ */
+#define CLIP_CHUNK_DIR "chunks"
+
+/**
+ * Fixed-size part of the frames of an AudioClip.
+ *
+ * Chunks are immutable once created and are shared
+ * between the versions of a clip: editing a range
+ * of a clip replaces only the chunks overlapping
+ * the range.
+ *
+ * Chunks are stored in the pool as raw files named
+ * after their hash, so identical chunks are stored
+ * once.
+ */
+typedef struct ClipChunk
+{
+  /** Hash of the frames, also used as the file
+   * name in the pool. */
+  char *      hash;
+
+  /** Number of frames per channel. */
+  long        num_frames;
+
+  /** Number of channels. */
+  channels_t  channels;
+
+  /** Interleaved frames (not serialized). */
+  sample_t *  frames;
+
+  /** Reference count (not serialized). */
+  int         refcount;
+} ClipChunk;
+
+static const cyaml_schema_field_t
+clip_chunk_fields_schema[] =
+{
+  YAML_FIELD_STRING_PTR (
+    ClipChunk, hash),
+  YAML_FIELD_INT (
+    ClipChunk, num_frames),
+  YAML_FIELD_UINT (
+    ClipChunk, channels),
+
+  CYAML_FIELD_END
+};
+
+static const cyaml_schema_value_t
+clip_chunk_schema =
+{
+  YAML_VALUE_PTR (
+    ClipChunk, clip_chunk_fields_schema),
+};
+
+/**
+ * Creates a chunk by copying the given frames.
+ *
+ * The chunk has a reference count of 1.
+ *
+ * @param frames Interleaved frames.
+ * @param num_frames Number of frames per channel.
+ */
+ClipChunk *
+clip_chunk_new (
+  const sample_t * frames,
+  size_t           num_frames,
+  channels_t       channels);
+
+/**
+ * Adds a reference to the chunk and returns it.
+ */
+ClipChunk *
+clip_chunk_ref (
+  ClipChunk * self);
+
+/**
+ * Removes a reference to the chunk and frees it
+ * when no references are left.
+ */
+void
+clip_chunk_unref (
+  ClipChunk * self);
+
+/**
+ * Returns the path of the chunk with the given
+ * hash in the pool.
+ *
+ * @param is_backup Whether this is a backup
+ *   project.
+ */
+char *
+clip_chunk_get_path_in_pool_from_hash (
+  const char * hash,
+  bool         is_backup);
+
+/**
+ * Writes the chunk to the pool, unless a chunk
+ * with the same hash is already there.
+ *
+ * @param is_backup Whether writing to a backup
+ *   project.
+ *
+ * @return Non-zero if fail.
+ */
+int
+clip_chunk_write_to_pool (
+  ClipChunk * self,
+  bool        is_backup);
+
+/**
+ * Reads the frames of a deserialized chunk from
+ * the pool.
+ *
+ * The chunk gets a reference count of 1.
+ *
+ * @return Non-zero if fail.
+ */
+int
+clip_chunk_init_loaded (
+  ClipChunk * self);
+
+/**
+ * @}
+ */
+
+#endif
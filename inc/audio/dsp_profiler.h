@@ -0,0 +1,301 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Per-node DSP profiler.
+ *
+ * While enabled (see engine_set_dsp_profiling()),
+ * the processing threads record the time taken by
+ * each graph node and how long it waited in the
+ * trigger queue into preallocated per-thread ring
+ * buffers. The GTK thread periodically collects
+ * the events into rolling statistics per
+ * plugin/track and into a trace that can be
+ * written in the Chrome trace event format
+ * (viewable in Perfetto or chrome://tracing).
+ */
+
+#ifndef __AUDIO_DSP_PROFILER_H__
+#define __AUDIO_DSP_PROFILER_H__
+
+#include "zrythm-config.h"
+
+#include <stdbool.h>
+#include <time.h>
+
+#include "audio/graph.h"
+#include "utils/stoat.h"
+
+#include <glib.h>
+
+typedef struct GraphNode GraphNode;
+typedef struct ZixRingImpl ZixRing;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/** Thread slot of the engine (backend) thread. */
+#define DSP_PROFILER_ENGINE_THREAD 0
+
+/** Returns the thread slot of the given graph
+ * thread ID (the main graph thread is -1). */
+#define dsp_profiler_get_graph_thread_slot(id) \
+  ((id) + 2)
+
+#define DSP_PROFILER_MAX_THREADS \
+  (MAX_GRAPH_THREADS + 2)
+
+/** Number of events each thread can record
+ * between collections. */
+#define DSP_PROFILER_RING_EVENTS 8192
+
+/** Number of last durations to calculate the
+ * percentiles from. */
+#define DSP_PROFILER_STATS_WINDOW 512
+
+/** Max number of events to keep for the trace. */
+#define DSP_PROFILER_MAX_TRACE_EVENTS (1 << 18)
+
+/** Interval to collect the events at, in ms. */
+#define DSP_PROFILER_COLLECT_INTERVAL 50
+
+/** Node type of events for whole cycles. */
+#define DSP_PROFILER_CYCLE -1
+
+/**
+ * A timing recorded by a processing thread.
+ */
+typedef struct DspProfilerEvent
+{
+  /** GraphNodeType, or DSP_PROFILER_CYCLE. */
+  int        node_type;
+
+  /** Position of the track owning the node, or
+   * -1. */
+  int        track_pos;
+
+  /** PluginSlotType and slot, if the node belongs
+   * to a plugin. */
+  int        slot_type;
+  int        slot;
+
+  /** Thread slot. */
+  int        thread;
+
+  /** Start and end time in nanoseconds. */
+  gint64     start;
+  gint64     end;
+
+  /** Time spent in the trigger queue in
+   * nanoseconds, or -1 if unknown. */
+  gint64     wait;
+} DspProfilerEvent;
+
+/**
+ * Rolling statistics of a plugin, track or other
+ * processor.
+ */
+typedef struct DspProfilerStats
+{
+  guint64    key;
+
+  /** An event with the key, used for the name. */
+  DspProfilerEvent ev;
+
+  /** Last durations in nanoseconds (circular). */
+  gint64     durations[DSP_PROFILER_STATS_WINDOW];
+  int        num_durations;
+  int        next_duration;
+
+  /** Max time spent in the trigger queue. */
+  gint64     max_wait;
+} DspProfilerStats;
+
+/**
+ * Per-node DSP profiler.
+ */
+typedef struct DspProfiler
+{
+  /** Per-thread event rings, written by the
+   * processing threads and read by the GTK
+   * thread. */
+  ZixRing *  rings[DSP_PROFILER_MAX_THREADS];
+  int        num_rings;
+
+  /** Start of the current cycle (engine thread
+   * only). */
+  gint64     cycle_start;
+
+  /** Number of events dropped because a ring was
+   * full. */
+  volatile gint num_dropped;
+
+  /** DspProfilerStats, keyed by event key. */
+  GHashTable * stats;
+
+  /** Recorded events (circular). */
+  DspProfilerEvent * trace;
+  size_t     trace_start;
+  size_t     num_trace_events;
+
+  /** Collection source ID. */
+  guint      collect_source_id;
+} DspProfiler;
+
+/**
+ * Returns the current time in nanoseconds.
+ */
+static inline gint64
+dsp_profiler_get_time (void)
+{
+#ifdef _WOE32
+  return g_get_monotonic_time () * 1000;
+#else
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return
+    (gint64) ts.tv_sec * 1000000000 +
+    (gint64) ts.tv_nsec;
+#endif
+}
+
+/**
+ * Creates a new profiler and starts collecting
+ * events periodically in the main context.
+ *
+ * @param num_graph_threads Number of graph
+ *   processing threads, excluding the main graph
+ *   thread.
+ */
+DspProfiler *
+dsp_profiler_new (
+  int num_graph_threads);
+
+/**
+ * Records the processing of a node.
+ *
+ * To be called by the thread that processed the
+ * node.
+ *
+ * @param thread Thread slot.
+ */
+REALTIME
+void
+dsp_profiler_record_node (
+  DspProfiler * self,
+  GraphNode *   node,
+  int           thread,
+  gint64        start,
+  gint64        end);
+
+/**
+ * Records a whole cycle.
+ *
+ * To be called by the engine thread at the end of
+ * the cycle.
+ */
+REALTIME
+void
+dsp_profiler_record_cycle (
+  DspProfiler * self,
+  gint64        end);
+
+/**
+ * Moves the recorded events to the statistics and
+ * the trace.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+dsp_profiler_collect (
+  DspProfiler * self);
+
+/**
+ * Returns the duration at the given percentile
+ * of the last durations in the stats, in
+ * nanoseconds.
+ *
+ * @param percentile Percentile (0-100).
+ */
+gint64
+dsp_profiler_stats_get_percentile (
+  DspProfilerStats * stats,
+  double             percentile);
+
+/**
+ * Returns a human friendly name for the node of
+ * the event.
+ *
+ * Must be free'd.
+ */
+char *
+dsp_profiler_event_get_name (
+  const DspProfilerEvent * ev);
+
+/**
+ * Returns a newly allocated text with the
+ * percentiles of the slowest processors, sorted
+ * by their 99th percentile.
+ */
+char *
+dsp_profiler_get_summary (
+  DspProfiler * self,
+  int           max_entries);
+
+/**
+ * Writes the collected events to a JSON file in
+ * the Chrome trace event format.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+dsp_profiler_write_trace (
+  DspProfiler * self,
+  const char *  filepath);
+
+/**
+ * Frees the profiler.
+ *
+ * Must be called from the GTK thread, or after
+ * removing the collection source with
+ * dsp_profiler_stop_collecting().
+ */
+void
+dsp_profiler_free (
+  DspProfiler * self);
+
+/**
+ * Stops collecting events periodically.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+dsp_profiler_stop_collecting (
+  DspProfiler * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -78,6 +78,7 @@ typedef struct Project Project;
 typedef struct HardwareProcessor HardwareProcessor;
 typedef struct ObjectPool ObjectPool;
 typedef struct MPMCQueue MPMCQueue;
+typedef struct DspProfiler DspProfiler;
 
 /**
  * @addtogroup audio Audio
@@ -651,6 +652,21 @@ typedef struct AudioEngine
   /** Set to 1 to stop the dummy audio thread. */
   int               stop_dummy_audio_thread;
 
+  /**
+   * Whether the dummy audio thread processes
+   * blocks back to back without realtime pacing.
+   *
+   * Accessed atomically.
+   *
+   * @see engine_dummy_set_freewheel().
+   */
+  volatile gint     dummy_freewheel;
+
+  /** Number of cycles the dummy audio thread
+   * finished after their deadline (paced mode
+   * only). */
+  volatile gint     dummy_missed_deadlines;
+
   /**
    * Timeline metadata like BPM, time signature, etc.
    */
@@ -662,6 +678,35 @@ typedef struct AudioEngine
   /** Pan algorithm */
   PanAlgorithm      pan_algo;
 
+  /**
+   * Minimum size of the sub-blocks plugins are
+   * split into at automation changes and MIDI CC
+   * events, or 0 to process plugins in whole
+   * blocks.
+   *
+   * This allows sample-accurate automation
+   * without lowering the block size of the whole
+   * engine.
+   */
+  nframes_t         automation_sub_block_size;
+
+  /**
+   * Time in milliseconds after which plugins whose
+   * inputs and outputs are silent are suspended,
+   * or 0 to never suspend plugins.
+   *
+   * @see Plugin.suspended.
+   */
+  int               plugin_suspend_tail_ms;
+
+  /**
+   * Whether plugin audio ports share buffers
+   * based on their lifetimes in the graph.
+   *
+   * @see graph_buffer_planner_plan().
+   */
+  bool              share_port_buffers;
+
   /** Time taken to process in the last cycle */
   gint64            last_time_taken;
 
@@ -669,6 +714,17 @@ typedef struct AudioEngine
    * cycles. */
   gint64            max_time_taken;
 
+  /**
+   * Per-node DSP profiler, or NULL if profiling is
+   * disabled.
+   *
+   * Accessed atomically by the processing
+   * threads.
+   *
+   * @see engine_set_dsp_profiling().
+   */
+  DspProfiler *     profiler;
+
   /** Timestamp at the start of the current
    * cycle. */
   gint64            timestamp_start;
@@ -1068,6 +1124,18 @@ void
 engine_reset_bounce_mode (
   AudioEngine * self);
 
+/**
+ * Enables or disables per-node DSP profiling.
+ *
+ * Must be called from the GTK thread.
+ *
+ * @see DspProfiler.
+ */
+void
+engine_set_dsp_profiling (
+  AudioEngine * self,
+  bool          enable);
+
 /**
  * Closes any connections and free's data.
  */
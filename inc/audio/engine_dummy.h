@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019 Alexandros Theodotou <alex at zrythm dot org>
+ * Copyright (C) 2019, 2021 Alexandros Theodotou <alex at zrythm dot org>
  *
  * This file is part of Zrythm
  *
@@ -24,6 +24,12 @@
 
 typedef struct AudioEngine AudioEngine;
 
+/**
+ * Max number of missed deadlines to log in a row
+ * in paced mode.
+ */
+#define ENGINE_DUMMY_MAX_LOGGED_MISSED_DEADLINES 10
+
 /**
  * Sets up a dummy audio engine.
  */
@@ -47,6 +53,18 @@ engine_dummy_activate (
   AudioEngine * self,
   bool          activate);
 
+/**
+ * Sets whether the dummy engine processes blocks
+ * back to back (freewheel) instead of pacing them
+ * in realtime.
+ *
+ * Can be called while the engine is running.
+ */
+void
+engine_dummy_set_freewheel (
+  AudioEngine * self,
+  bool          freewheel);
+
 void
 engine_dummy_tear_down (
   AudioEngine * self);
@@ -153,6 +153,14 @@ typedef struct ExportSettings
    * for progress calculation. */
   int               num_files;
 
+  /** Number of frames exported, set after
+   * exporting audio. */
+  long              num_frames;
+
+  /** Peak amplitude of the left and right
+   * channels, set after exporting audio. */
+  float             peaks[2];
+
   GenericProgressInfo progress_info;
 } ExportSettings;
 
@@ -151,6 +151,34 @@ typedef struct Graph
   GraphNode **         setup_terminal_nodes;
   size_t               num_setup_terminal_nodes;
 
+  /** Number of static ports left out of the graph
+   * in the last setup. */
+  int                  num_pruned_ports;
+
+  /** Number of processors (tracks, faders and
+   * plugins) of idle subgraphs left out of the
+   * graph in the last setup, such as the ones of
+   * disabled tracks and of modulators that are
+   * not connected anywhere. */
+  int                  num_pruned_processors;
+
+  /** Number of ports of idle subgraphs left out
+   * of the graph in the last setup. */
+  int                  num_pruned_idle_ports;
+
+  /** Arena of the buffers shared by ports (see
+   * graph_buffer_planner_plan()), aligned. */
+  float *              shared_bufs;
+
+  /** Allocated memory for \ref shared_bufs. */
+  void *               shared_bufs_mem;
+
+  /** Number of buffers in \ref shared_bufs. */
+  int                  num_shared_bufs;
+
+  /** Number of ports using \ref shared_bufs. */
+  int                  num_shared_ports;
+
   /* ------------------------------------ */
 
   GraphThread *        threads[MAX_GRAPH_THREADS];
@@ -258,7 +286,9 @@ graph_update_latencies (
  * rechains.
  *
  * @param drop_unnecessary_ports Drops any ports
- *   that don't connect anywhere.
+ *   that don't connect anywhere, static control
+ *   ports (see Graph.num_pruned_ports) and idle
+ *   subgraphs (see Graph.num_pruned_processors).
  * @param rechain Whether to rechain or not. If
  *   we are just validating this should be 0.
  */
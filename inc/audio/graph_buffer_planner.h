@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Port buffer sharing based on the lifetimes of
+ * the buffers in the routing graph.
+ *
+ * The audio ports of the plugins in each channel
+ * are assigned to a small number of buffers from
+ * a single arena, similar to register allocation.
+ * Two ports may share a buffer only if every node
+ * that uses one of them is processed before the
+ * node that first writes the other (ie, it is an
+ * ancestor of that node in the graph), so sharing
+ * is safe with any number of processing threads.
+ *
+ * Shared buffers are cleared by the node that
+ * first writes them instead of at the start of
+ * the cycle (see GraphNode.shared_ports_to_clear).
+ *
+ * Ports whose data is read by the UI (eg, metered
+ * ports) can also share buffers: their nodes copy
+ * the data to a private buffer before filling the
+ * ring buffers (see Port.pinned_buf).
+ */
+
+#ifndef __AUDIO_GRAPH_BUFFER_PLANNER_H__
+#define __AUDIO_GRAPH_BUFFER_PLANNER_H__
+
+typedef struct Graph Graph;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/** Alignment of the shared buffers, in bytes. */
+#define GRAPH_SHARED_BUF_ALIGNMENT 64
+
+/**
+ * Max number of ancestors to visit when checking
+ * if a buffer can be reused by a port.
+ *
+ * Ancestors further away are not considered, so
+ * the plan may use more buffers than needed, but
+ * never shares buffers unsafely.
+ */
+#define GRAPH_BUFFER_PLANNER_MAX_ANCESTORS 512
+
+/**
+ * Assigns shared buffers to the ports in the
+ * current (rechained) graph, if enabled in the
+ * engine, and restores the own buffers of the
+ * ports that were sharing buffers.
+ *
+ * Must not be called while the graph is
+ * processing.
+ */
+void
+graph_buffer_planner_plan (
+  Graph * graph);
+
+/**
+ * Gives all the ports sharing buffers their own
+ * buffers again and frees the arena.
+ *
+ * Must not be called while the graph is
+ * processing.
+ */
+void
+graph_buffer_planner_unshare (
+  Graph * graph);
+
+/**
+ * @}
+ */
+
+#endif
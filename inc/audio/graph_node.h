@@ -138,6 +138,40 @@ typedef struct GraphNode
   /** Plugin, if plugin. */
   Plugin *      pl;
 
+  /**
+   * Control input ports of the plugin that have a
+   * node in the graph (ie, that can change during
+   * a cycle because of automation or CV), if
+   * plugin.
+   *
+   * These are used to split the processing of the
+   * plugin in sub-blocks.
+   *
+   * @see AudioEngine.automation_sub_block_size.
+   */
+  Port **       sub_block_ports;
+  int           num_sub_block_ports;
+
+  /**
+   * Ports with shared buffers that this node
+   * writes first in each cycle, to be cleared
+   * before processing the node.
+   *
+   * @see graph_buffer_planner_plan().
+   */
+  Port **       shared_ports_to_clear;
+  int           num_shared_ports_to_clear;
+
+  /**
+   * Time the node was pushed to the trigger queue,
+   * in nanoseconds, or 0.
+   *
+   * Only set while DSP profiling is enabled.
+   *
+   * @see DspProfiler.
+   */
+  gint64        trigger_time;
+
   /** Fader, if fader. */
   Fader *       fader;
 
@@ -28,6 +28,7 @@
 
 #include <stdbool.h>
 
+#include "audio/port_identifier.h"
 #include "utils/types.h"
 
 #include <gtk/gtk.h>
@@ -65,6 +66,15 @@ typedef struct Meter
   /** Port associated with this meter. */
   Port *          port;
 
+  /**
+   * Identifier of the port.
+   *
+   * Used to find the port again when
+   * (un)subscribing, since the port may have been
+   * freed before the meter.
+   */
+  PortIdentifier  port_id;
+
   /** True peak processor. */
   TruePeakDsp *   true_peak_processor;
   TruePeakDsp *   true_peak_max_processor;
@@ -99,6 +109,20 @@ typedef struct Meter
 
   gint64          last_midi_trigger_time;
 
+  /** Whether this meter is subscribed to the
+   * ring buffers of the port. */
+  bool            subscribed;
+
+  /**
+   * Token of the port instance this meter is
+   * subscribed to (see Port.ring_token).
+   *
+   * A port created again with the same identifier
+   * has a different token, so the subscription is
+   * never released on it.
+   */
+  guint           ring_token;
+
 } Meter;
 
 Meter *
@@ -118,6 +142,21 @@ meter_get_value (
   float *          val,
   float *          max);
 
+/**
+ * Subscribes to or unsubscribes from the ring
+ * buffers of the port.
+ *
+ * Meters that are not subscribed only show
+ * values if another reader is subscribed.
+ *
+ * If the port no longer exists, the meter is
+ * only marked as unsubscribed.
+ */
+void
+meter_set_subscribed (
+  Meter * self,
+  bool    subscribed);
+
 void
 meter_free (
   Meter * self);
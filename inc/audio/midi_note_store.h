@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ *
+ * Compact note storage for MIDI playback.
+ *
+ * A MidiNoteStore keeps only the fields needed
+ * for playback (start, end, pitch, velocity and
+ * flags) of the MidiNote's of a region in
+ * parallel arrays, so that playback does not need
+ * to walk the much larger MidiNote objects, which
+ * also carry the editing and drawing state.
+ *
+ * It also holds the note ons and note offs of the
+ * region sorted by time, so that the events of a
+ * processing cycle can be found with a binary
+ * search.
+ */
+
+#ifndef __AUDIO_MIDI_NOTE_STORE_H__
+#define __AUDIO_MIDI_NOTE_STORE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "utils/types.h"
+
+typedef struct ZRegion ZRegion;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * Flags for each note in a MidiNoteStore.
+ */
+typedef enum MidiNoteStoreFlags
+{
+  /** The note is muted. */
+  MIDI_NOTE_STORE_FLAG_MUTED = 1 << 0,
+} MidiNoteStoreFlags;
+
+/**
+ * A note on or note off in a MidiNoteStore.
+ */
+typedef struct MidiNoteStoreEvent
+{
+  /**
+   * Region-local frame the event is sent at.
+   *
+   * This is the start of the note for note ons
+   * and 1 frame before the end of the note for
+   * note offs.
+   */
+  long          frames;
+
+  midi_byte_t   pitch;
+
+  /** Velocity (only used for note ons). */
+  midi_byte_t   velocity;
+
+  /** Whether this is a note on. */
+  bool          note_on;
+} MidiNoteStoreEvent;
+
+/**
+ * Playback data of the MIDI notes of a region.
+ *
+ * Index i of each array corresponds to
+ * ZRegion.midi_notes[i] at the time the store was
+ * created.
+ *
+ * Once published, it is immutable: edits create a
+ * new store that replaces it.
+ */
+typedef struct MidiNoteStore
+{
+  /** Region-local start frames. */
+  long *        start_frames;
+
+  /** Region-local end frames. */
+  long *        end_frames;
+
+  midi_byte_t * pitches;
+  midi_byte_t * velocities;
+
+  /** Bitmask of MidiNoteStoreFlags. */
+  uint8_t *     flags;
+
+  int           num_notes;
+
+  /**
+   * Note ons and note offs of the unmuted notes,
+   * sorted by \ref MidiNoteStoreEvent.frames with
+   * note offs before note ons at the same frame.
+   */
+  MidiNoteStoreEvent * events;
+  int                  num_events;
+} MidiNoteStore;
+
+/**
+ * Creates a store from the MIDI notes of the given
+ * region.
+ */
+NONNULL
+MidiNoteStore *
+midi_note_store_new_from_region (
+  ZRegion * region);
+
+/**
+ * Returns the index of the first event at or after
+ * the given region-local frame, or
+ * \ref MidiNoteStore.num_events if there is none.
+ */
+NONNULL
+HOT
+int
+midi_note_store_find_first_event (
+  const MidiNoteStore * self,
+  long                  frames);
+
+NONNULL
+void
+midi_note_store_free (
+  MidiNoteStore * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -39,6 +39,7 @@ typedef struct ZRegion ZRegion;
 typedef struct MidiEvents MidiEvents;
 typedef struct ChordDescriptor ChordDescriptor;
 typedef struct Velocity Velocity;
+typedef struct RegionIdentifier RegionIdentifier;
 typedef ZRegion MidiRegion;
 typedef void MIDI_FILE;
 
@@ -179,6 +180,40 @@ midi_region_fill_midi_events (
   bool         note_off_at_end,
   MidiEvents * midi_events);
 
+/**
+ * Marks the note store of the region, and of the
+ * regions sharing its notes, as out of date.
+ *
+ * To be called when the MIDI notes of the region
+ * change.
+ */
+NONNULL
+void
+midi_region_invalidate_note_store (
+  ZRegion * self);
+
+/**
+ * Marks the note store of the region referenced by
+ * the given region identifier as out of date, if
+ * such a region exists.
+ */
+NONNULL
+void
+midi_region_invalidate_note_store_for_region_id (
+  const RegionIdentifier * id);
+
+/**
+ * Recreates the note store if it is out of date
+ * (or if \ref force is true) and publishes it.
+ *
+ * Must be called from the GTK thread.
+ */
+NONNULL
+void
+midi_region_update_note_store (
+  ZRegion * self,
+  bool      force);
+
 /**
  * Prints the MidiNotes in the Region.
  *
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ *
+ * Chunked offline processing of audio.
+ *
+ * An OfflineProcessor splits interleaved audio
+ * into chunks of whole frames and runs one or
+ * more passes over them on a thread pool.
+ *
+ * Each chunk has a result slot that a pass can
+ * use for a reduction (such as the peak of the
+ * chunk), which is then combined once the pass is
+ * finished and can be used by the next pass.
+ */
+
+#ifndef __AUDIO_OFFLINE_PROCESSOR_H__
+#define __AUDIO_OFFLINE_PROCESSOR_H__
+
+#include <stddef.h>
+
+#include "utils/types.h"
+
+#include <glib.h>
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * Default number of frames in each chunk.
+ */
+#define OFFLINE_PROCESSOR_CHUNK_FRAMES 65536
+
+typedef struct OfflineProcessor OfflineProcessor;
+
+/**
+ * A range of frames processed as one job.
+ */
+typedef struct OfflineProcessorChunk
+{
+  /** First frame of the chunk. */
+  size_t        start_frame;
+
+  /** Number of frames in the chunk. */
+  size_t        num_frames;
+
+  /** Result of a reduction over the chunk. */
+  float         result;
+} OfflineProcessorChunk;
+
+/**
+ * Function that processes a chunk.
+ *
+ * This is called from the worker threads and must
+ * only touch the frames of the given chunk in the
+ * destination buffer.
+ */
+typedef void (*OfflineProcessorFunc) (
+  OfflineProcessor *      self,
+  OfflineProcessorChunk * chunk);
+
+/**
+ * Chunked offline processor.
+ */
+typedef struct OfflineProcessor
+{
+  /** Interleaved source frames. */
+  const float *           src;
+
+  /** Interleaved destination frames. */
+  float *                 dest;
+
+  /** Total number of frames. */
+  size_t                  num_frames;
+
+  size_t                  channels;
+
+  OfflineProcessorChunk * chunks;
+  int                     num_chunks;
+
+  /** Total number of passes that will be run,
+   * used to calculate the progress. */
+  int                     num_passes;
+
+  /** Function of the current pass. */
+  OfflineProcessorFunc    func;
+
+  /** Data for the pass functions. */
+  void *                  user_data;
+
+  /**
+   * Progress info to update, or NULL.
+   *
+   * Setting GenericProgressInfo.cancelled from
+   * another thread stops processing after the
+   * chunks currently being processed.
+   */
+  GenericProgressInfo *   progress_info;
+
+  /** Number of chunks processed in all passes. */
+  int                     num_processed;
+
+  /** Number of chunks done in the current pass,
+   * including skipped ones. */
+  int                     num_pass_chunks_done;
+
+  /** Protects the progress and the number of
+   * chunks done in the current pass. */
+  GMutex                  progress_mutex;
+
+  /** Signaled when a chunk is done. */
+  GCond                   pass_cond;
+
+  /** Thread pool shared by all passes, or NULL
+   * to process the chunks serially. */
+  GThreadPool *           pool;
+} OfflineProcessor;
+
+/**
+ * Creates a new offline processor.
+ *
+ * The thread pool used by the passes is created
+ * here once if there is more than 1 chunk.
+ *
+ * @param src Interleaved source frames.
+ * @param dest Interleaved destination frames, which
+ *   must not overlap with the source frames.
+ * @param num_passes Number of passes that will be
+ *   run.
+ * @param progress_info Optional progress info to
+ *   update.
+ */
+OfflineProcessor *
+offline_processor_new (
+  const float *         src,
+  float *               dest,
+  size_t                num_frames,
+  size_t                channels,
+  int                   num_passes,
+  GenericProgressInfo * progress_info,
+  void *                user_data);
+
+/**
+ * Runs the given function on all chunks and waits
+ * for it to finish.
+ *
+ * The result of each chunk is reset to 0 before
+ * running the pass.
+ *
+ * @return Non-zero if processing was cancelled.
+ */
+NONNULL
+int
+offline_processor_run_pass (
+  OfflineProcessor *   self,
+  OfflineProcessorFunc func);
+
+/**
+ * Returns the max of the chunk results of the last
+ * pass.
+ */
+NONNULL
+float
+offline_processor_get_max_result (
+  OfflineProcessor * self);
+
+/**
+ * Returns the interleaved source frames of the
+ * given chunk.
+ */
+static inline const float *
+offline_processor_get_chunk_src (
+  OfflineProcessor *      self,
+  OfflineProcessorChunk * chunk)
+{
+  return
+    &self->src[chunk->start_frame * self->channels];
+}
+
+/**
+ * Returns the interleaved destination frames of
+ * the given chunk.
+ */
+static inline float *
+offline_processor_get_chunk_dest (
+  OfflineProcessor *      self,
+  OfflineProcessorChunk * chunk)
+{
+  return
+    &self->dest[chunk->start_frame * self->channels];
+}
+
+NONNULL
+void
+offline_processor_free (
+  OfflineProcessor * self);
+
+/**
+ * @}
+ */
+
+#endif
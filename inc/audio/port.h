@@ -90,6 +90,13 @@ typedef enum PanLaw PanLaw;
 #define IS_PORT_AND_NONNULL(x) \
   ((x) && IS_PORT (x))
 
+/** Whether the UI is reading the ring buffers of
+ * the port.
+ *
+ * This is realtime-safe. */
+#define port_has_ring_subscribers(x) \
+  (g_atomic_int_get (&(x)->num_ring_subscribers) > 0)
+
 #define FOREACH_SRCS(port) \
   for (int i = 0; i < port->num_srcs; i++)
 #define FOREACH_DESTS(port) \
@@ -97,6 +104,12 @@ typedef enum PanLaw PanLaw;
 
 #define TIME_TO_RESET_PEAK 4800000
 
+/**
+ * Amplitude below which a buffer is considered
+ * silent (-120 dBFS).
+ */
+#define PORT_SILENCE_THRESHOLD 0.000001f
+
 /**
  * Special ID for owner_pl, owner_ch, etc. to indicate that
  * the port is not owned.
@@ -160,6 +173,15 @@ typedef struct Port
    */
   float *             buf;
 
+  /**
+   * Whether \ref Port.buf points to a buffer
+   * shared with other ports (owned by the graph)
+   * instead of a buffer owned by this port.
+   *
+   * @see graph_buffer_planner_plan().
+   */
+  bool                buf_is_shared;
+
   /**
    * Contains raw MIDI data (MIDI ports only)
    */
@@ -423,15 +445,30 @@ typedef struct Port
   int                 deleting;
 
   /**
-   * Flag to indicate if the ring buffers below
-   * should be filled or not.
+   * Number of UI consumers (meters, live
+   * waveforms, etc.) reading the ring buffers
+   * below.
+   *
+   * The ring buffers are only allocated and
+   * filled while this is non-zero.
+   *
+   * @see port_subscribe_to_rings().
+   */
+  volatile gint       num_ring_subscribers;
+
+  /**
+   * Token identifying this port instance to the
+   * ring subscribers, assigned on the first
+   * subscription.
    *
-   * If a UI element that needs them becomes
-   * mapped (visible), this should be set to
-   * 1, and when unmapped (invisible) it should
-   * be set to 0.
+   * Subscribers compare it before unsubscribing,
+   * since a port with the same identifier (or
+   * even at the same address) may have replaced
+   * the one they subscribed to.
+   *
+   * Never 0 once assigned.
    */
-  bool                write_ring_buffers;
+  guint               ring_token;
 
   /** Whether the port has midi events not yet
    * processed by the UI. */
@@ -451,9 +488,25 @@ typedef struct Port
    * cycles' worth of buffers.
    *
    * This is also used for CV.
+   *
+   * Only allocated while there are subscribers.
    */
   ZixRing *           audio_ring;
 
+  /**
+   * Private copy of the buffer, used to fill
+   * \ref Port.audio_ring when the buffer is
+   * shared.
+   *
+   * Other ports may overwrite a shared buffer
+   * between the sub-blocks of a cycle, so the
+   * node of this port copies each sub-block here
+   * as soon as it is processed.
+   *
+   * Only allocated while there are subscribers.
+   */
+  float *             pinned_buf;
+
   /**
    * Ring buffer for saving MIDI events to be
    * used in the UI instead of directly accessing
@@ -466,6 +519,8 @@ typedef struct Port
    * Currently there is only 1 reader for each port
    * so this wont be a problem for now, but we
    * should have one ring for each reader.
+   *
+   * Only allocated while there are subscribers.
    */
   ZixRing *           midi_ring;
 
@@ -476,6 +531,16 @@ typedef struct Port
   /** Last time \ref Port.max_amp was set. */
   gint64              peak_timestamp;
 
+  /**
+   * Whether the buffer was silent (below
+   * \ref PORT_SILENCE_THRESHOLD) in the last
+   * processed range.
+   *
+   * This is only calculated for audio and CV
+   * inputs of plugins.
+   */
+  bool                is_silent;
+
   /**
    * Last known MIDI status byte received.
    *
@@ -704,6 +769,16 @@ port_init_loaded (
   Port * self,
   bool   is_project);
 
+/**
+ * Finds the Port corresponding to the identifier.
+ *
+ * If the identifier has owner handles, the owner
+ * is resolved through the handle table and NULL is
+ * returned if it was removed.
+ *
+ * @param id The PortIdentifier to use for
+ *   searching.
+ */
 NONNULL
 Port *
 port_find_from_identifier (
@@ -1071,6 +1146,34 @@ void
 port_disconnect_hw_inputs (
   Port * self);
 
+/**
+ * Registers a UI consumer of the ring buffers of
+ * the port, allocating them if this is the first
+ * one.
+ *
+ * Must be called from the GTK thread and paired
+ * with port_unsubscribe_from_rings().
+ *
+ * @return The subscription token of the port
+ *   (see Port.ring_token).
+ */
+NONNULL
+guint
+port_subscribe_to_rings (
+  Port * self);
+
+/**
+ * Unregisters a UI consumer of the ring buffers of
+ * the port, releasing them if this was the last
+ * one.
+ *
+ * Must be called from the GTK thread.
+ */
+NONNULL
+void
+port_unsubscribe_from_rings (
+  Port * self);
+
 /**
  * Deletes port, doing required cleanup and updating counters.
  */
@@ -31,6 +31,7 @@
 #include <stdbool.h>
 
 #include "plugins/plugin_identifier.h"
+#include "utils/handle_table.h"
 #include "utils/yaml.h"
 
 /**
@@ -476,6 +477,22 @@ typedef struct PortIdentifier
   int                 track_pos;
   /** Index (e.g. in plugin's output ports). */
   int                 port_index;
+
+  /**
+   * Handle to the owner track, if the port belongs
+   * to a project track (not serialized).
+   *
+   * Only set on the identifier of the port itself.
+   * Copies are positional references, like
+   * serialized identifiers.
+   */
+  ObjectHandle        track_handle;
+
+  /** Handle to the owner plugin, if the port
+   * belongs to a project plugin (not serialized).
+   *
+   * @see PortIdentifier.track_handle. */
+  ObjectHandle        plugin_handle;
 } PortIdentifier;
 
 static const cyaml_strval_t
@@ -560,6 +577,18 @@ port_identifier_get_label (
   return self->label;
 }
 
+/**
+ * Unsets the owner handles, making \ref self a
+ * positional reference.
+ */
+static inline void
+port_identifier_clear_handles (
+  PortIdentifier * self)
+{
+  self->track_handle.generation = 0;
+  self->plugin_handle.generation = 0;
+}
+
 /**
  * Port group comparator function where @ref p1 and
  * @ref p2 are pointers to Port.
@@ -572,6 +601,8 @@ port_identifier_port_group_cmp (
  * Copy the identifier content from \ref src to
  * \ref dest.
  *
+ * The owner handles are not copied.
+ *
  * @note This frees/allocates memory on \ref dest.
  */
 NONNULL
@@ -28,6 +28,8 @@
 
 #include "utils/types.h"
 
+#include <glib.h>
+
 typedef struct ObjectPool ObjectPool;
 typedef struct TrackProcessor TrackProcessor;
 typedef struct MPMCQueue MPMCQueue;
@@ -54,6 +56,16 @@ typedef struct RecordingManager
    */
   ObjectPool *       event_obj_pool;
 
+  /**
+   * Events taken out of the queue while the
+   * project was being saved, to be handled after
+   * saving.
+   *
+   * These are allocated separately so that the
+   * object pool does not run out.
+   */
+  GQueue *           deferred_events;
+
   /** Cloned selections before starting recording. */
   ArrangerSelections * selections_before_start;
 
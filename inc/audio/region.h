@@ -45,6 +45,8 @@ typedef struct _AudioClipWidget AudioClipWidget;
 typedef struct RegionLinkGroup RegionLinkGroup;
 typedef struct Stretcher Stretcher;
 typedef struct AudioClip AudioClip;
+typedef struct MidiNoteStore MidiNoteStore;
+typedef struct RegionContent RegionContent;
 
 /**
  * @addtogroup audio
@@ -126,6 +128,14 @@ typedef struct ZRegion
   int             num_midi_notes;
   size_t          midi_notes_size;
 
+  /**
+   * Number of MIDI notes to serialize.
+   *
+   * This is 0 if another region sharing the notes
+   * serializes them (see \ref ZRegion.content).
+   */
+  int             num_serialized_midi_notes;
+
   /**
    * Unended notes started in recording with
    * MIDI NOTE ON
@@ -143,6 +153,24 @@ typedef struct ZRegion
   MidiNote *      unended_notes[12000];
   int             num_unended_notes;
 
+  /**
+   * Compact copy of \ref ZRegion.midi_notes used
+   * during playback.
+   *
+   * Replaced atomically from the GTK thread (see
+   * midi_region_update_note_store()).
+   */
+  MidiNoteStore * note_store;
+
+  /**
+   * Whether \ref ZRegion.note_store is out of
+   * date.
+   *
+   * If set, playback reads the MidiNote's
+   * directly until the store is recreated.
+   */
+  volatile gint   note_store_dirty;
+
   /* ==== MIDI REGION END ==== */
 
   /* ==== AUDIO REGION ==== */
@@ -219,6 +247,10 @@ typedef struct ZRegion
   int                num_aps;
   size_t             aps_size;
 
+  /** Number of automation points to serialize
+   * (see \ref ZRegion.num_serialized_midi_notes). */
+  int                num_serialized_aps;
+
   /** Last recorded automation point. */
   AutomationPoint *  last_recorded_ap;
 
@@ -231,8 +263,19 @@ typedef struct ZRegion
   int                num_chord_objects;
   size_t             chord_objects_size;
 
+  /** Number of chord objects to serialize
+   * (see \ref ZRegion.num_serialized_midi_notes). */
+  int                num_serialized_chord_objects;
+
   /* ==== CHORD REGION END ==== */
 
+  /**
+   * Children shared with the other regions in the
+   * link group, or NULL if the region owns its
+   * children.
+   */
+  RegionContent *    content;
+
   /**
    * Set to ON during bouncing if this
    * region should be included.
@@ -307,16 +350,17 @@ static const cyaml_schema_field_t
   CYAML_FIELD_SEQUENCE_COUNT (
     "midi_notes",
     CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
-    ZRegion, midi_notes, num_midi_notes,
+    ZRegion, midi_notes, num_serialized_midi_notes,
     &midi_note_schema, 0, CYAML_UNLIMITED),
   CYAML_FIELD_SEQUENCE_COUNT (
     "aps", CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
-    ZRegion, aps, num_aps,
+    ZRegion, aps, num_serialized_aps,
     &automation_point_schema, 0, CYAML_UNLIMITED),
   CYAML_FIELD_SEQUENCE_COUNT (
     "chord_objects",
     CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
-    ZRegion, chord_objects, num_chord_objects,
+    ZRegion, chord_objects,
+    num_serialized_chord_objects,
     &chord_object_schema, 0, CYAML_UNLIMITED),
   YAML_FIELD_ENUM (
     ZRegion, musical_mode,
@@ -492,8 +536,9 @@ region_update_identifier (
   ZRegion * self);
 
 /**
- * Updates all other regions in the region link
- * group, if any.
+ * Marks the playback caches of the other regions
+ * in the region link group, if any, as out of
+ * date.
  */
 void
 region_update_link_group (
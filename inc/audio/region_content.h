@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Children shared by linked regions.
+ */
+
+#ifndef __AUDIO_REGION_CONTENT_H__
+#define __AUDIO_REGION_CONTENT_H__
+
+#include <stddef.h>
+
+typedef struct ZRegion ZRegion;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/**
+ * Content (MIDI notes, automation points or chord
+ * objects) shared by the regions of a link group.
+ *
+ * Each region keeps its own array of pointers to
+ * the children, but the children themselves exist
+ * only once. The arrays of all regions are kept
+ * identical, so a child has the same index in all
+ * of them.
+ *
+ * The children belong to the first region in
+ * \ref RegionContent.regions: their region
+ * identifier points to it and only that region
+ * serializes them.
+ *
+ * Only used for project regions. Audio regions
+ * already share their clip through the pool.
+ */
+typedef struct RegionContent
+{
+  /**
+   * Regions sharing the children.
+   *
+   * The number of regions is the reference count.
+   */
+  ZRegion ** regions;
+  int        num_regions;
+  size_t     regions_size;
+} RegionContent;
+
+/**
+ * Makes \ref self share the children of \ref src.
+ *
+ * The current children of \ref self are freed.
+ */
+void
+region_content_share (
+  ZRegion * self,
+  ZRegion * src);
+
+/**
+ * Gives \ref self its own copy of the children it
+ * shares, if any.
+ *
+ * To be called when \ref self is unlinked.
+ */
+void
+region_content_unshare (
+  ZRegion * self);
+
+/**
+ * Stops sharing the children with \ref self
+ * without copying them.
+ *
+ * The children arrays of \ref self are emptied.
+ */
+void
+region_content_leave (
+  ZRegion * self);
+
+/**
+ * To be called after the children of \ref self
+ * were added, removed or reordered.
+ *
+ * Copies the children arrays of \ref self to the
+ * regions sharing them and updates the counts
+ * used during serialization.
+ */
+void
+region_content_sync (
+  ZRegion * self);
+
+/**
+ * Sets the children counts from the serialized
+ * counts.
+ *
+ * To be called after deserializing \ref self.
+ */
+void
+region_content_init_loaded (
+  ZRegion * self);
+
+/**
+ * Returns the region to show the children of
+ * \ref self relative to.
+ *
+ * This is the region in the clip editor if it
+ * shares its children with \ref self, otherwise
+ * \ref self.
+ */
+ZRegion *
+region_content_get_region_for_editor (
+  ZRegion * self);
+
+/**
+ * @}
+ */
+
+#endif
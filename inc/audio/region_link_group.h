@@ -138,7 +138,8 @@ region_link_group_print (
   RegionLinkGroup * self);
 
 /**
- * Updates all other regions in the link group.
+ * Marks the playback caches of the regions in the
+ * link group as out of date.
  *
  * @param region The region where the change
  *   happened.
@@ -29,6 +29,7 @@
 #include "audio/fader.h"
 #include "audio/port.h"
 #include "audio/sample_playback.h"
+#include "audio/sample_stream.h"
 #include "utils/types.h"
 
 typedef enum MetronomeType MetronomeType;
@@ -48,6 +49,11 @@ typedef struct MidiEvents MidiEvents;
 #define SAMPLE_PROCESSOR \
   (AUDIO_ENGINE->sample_processor)
 
+/** Max number of file preview streams playing at
+ * once (the current one plus the ones fading
+ * out). */
+#define SAMPLE_PROCESSOR_MAX_STREAMS 4
+
 /**
  * A processor to be used in the routing graph for
  * playing samples independent of the timeline.
@@ -87,6 +93,17 @@ typedef struct SampleProcessor
 
   /** Whether to roll or not. */
   bool              roll;
+
+  /**
+   * Stream voices for previewing audio files.
+   *
+   * These are only added and removed from the UI
+   * thread (atomically) and read by the engine, so
+   * previewing audio files never pauses the
+   * engine.
+   */
+  SampleStream *
+    streams[SAMPLE_PROCESSOR_MAX_STREAMS];
 } SampleProcessor;
 
 static const cyaml_schema_field_t
@@ -181,12 +198,28 @@ sample_processor_queue_sample_from_file (
 
 /**
  * Adds a file (audio or MIDI) to the queue.
+ *
+ * Audio files are streamed from disk without
+ * pausing the engine, cross-fading with any file
+ * currently playing.
  */
 void
 sample_processor_queue_file (
   SampleProcessor *     self,
   const SupportedFile * file);
 
+/**
+ * Removes the streams that finished playing.
+ *
+ * This is called periodically from the GTK thread
+ * so that finished streams (and their decoder
+ * state) are released without waiting for the
+ * next file to be queued.
+ */
+void
+sample_processor_reap_streams (
+  SampleProcessor * self);
+
 /**
  * Stops playback of files (auditioning).
  */
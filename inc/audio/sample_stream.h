@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Audio file stream voice.
+ *
+ * A SampleStream plays back an audio file while it
+ * is being decoded: a background thread decodes
+ * and resamples the file in chunks and writes
+ * stereo frames to a lock-free ring that the
+ * engine reads from.
+ */
+
+#ifndef __AUDIO_SAMPLE_STREAM_H__
+#define __AUDIO_SAMPLE_STREAM_H__
+
+#include <stdbool.h>
+
+#include "utils/types.h"
+
+#include <glib.h>
+
+typedef struct ZixRingImpl ZixRing;
+
+/**
+ * @addtogroup audio
+ *
+ * @{
+ */
+
+/** Length of the ring in seconds. */
+#define SAMPLE_STREAM_RING_SECONDS 2
+
+/** Length of fade ins/outs in milliseconds. */
+#define SAMPLE_STREAM_FADE_MS 10
+
+/** Length of audio to decode in milliseconds
+ * before the stream starts playing. */
+#define SAMPLE_STREAM_PREFILL_MS 250
+
+/**
+ * A stream voice playing back an audio file.
+ */
+typedef struct SampleStream
+{
+  /** Absolute path of the file. */
+  char *          abs_path;
+
+  /** Sample rate to decode to. */
+  int             samplerate;
+
+  /** Interleaved stereo frames decoded so far. */
+  ZixRing *       ring;
+
+  /** Decoder thread (detached). */
+  GThread *       decoder_thread;
+
+  /** References held by the owner and the decoder
+   * thread. The last one frees the stream. */
+  volatile gint   refcount;
+
+  /** Set to tell the decoder thread to stop. */
+  volatile gint   stop_decoder;
+
+  /** Set by the decoder thread once all frames
+   * are written to the ring. */
+  volatile gint   decoder_finished;
+
+  /** Number of frames to decode before the stream
+   * is ready. */
+  nframes_t       prefill_frames;
+
+  /** Set by the decoder thread once the ring is
+   * prefilled or all frames are written. */
+  volatile gint   ready;
+
+  /** Set to fade out and stop playback. */
+  volatile gint   fade_out_requested;
+
+  /** Set by the engine once there is nothing left
+   * to play. */
+  volatile gint   finished;
+
+  /** Number of frames to fade in/out for. */
+  nframes_t       fade_frames;
+
+  /** Current gain (used by the engine). */
+  float           gain;
+
+  /** Gain change per frame (used by the
+   * engine). */
+  float           gain_step;
+} SampleStream;
+
+/**
+ * Creates a new stream for the given file and
+ * starts decoding it in the background.
+ *
+ * Playback fades in once
+ * @ref SAMPLE_STREAM_PREFILL_MS of audio is
+ * decoded.
+ *
+ * @param samplerate Sample rate to decode to.
+ */
+SampleStream *
+sample_stream_new (
+  const char * abs_path,
+  int          samplerate);
+
+/**
+ * Adds the next frames of the stream to the given
+ * buffers.
+ *
+ * Nothing is played before the stream is ready.
+ * If the decoder has not caught up afterwards, the
+ * missing frames are skipped (silence).
+ *
+ * This is realtime-safe.
+ *
+ * @param volume Volume to mix at.
+ *
+ * @return The number of frames played.
+ */
+nframes_t
+sample_stream_process (
+  SampleStream *  self,
+  float *         l,
+  float *         r,
+  const nframes_t nframes,
+  const float     volume);
+
+/**
+ * Requests the stream to fade out and finish.
+ *
+ * This can be called from any thread.
+ */
+void
+sample_stream_fade_out (
+  SampleStream * self);
+
+/**
+ * Returns whether the stream has finished playing.
+ */
+bool
+sample_stream_is_finished (
+  SampleStream * self);
+
+/**
+ * Tells the decoder thread to stop and frees the
+ * stream without waiting for it.
+ *
+ * The stream is freed by the decoder thread if it
+ * is still running.
+ *
+ * Must not be called while the engine may still be
+ * reading from the stream (use free_later()).
+ */
+void
+sample_stream_free (
+  SampleStream * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -30,6 +30,8 @@
 
 #include "utils/yaml.h"
 
+typedef struct FileIndexEntry FileIndexEntry;
+
 /**
  * @addtogroup utils
  *
@@ -189,19 +191,27 @@ supported_file_get_type (
 /**
  * Returns whether the given file should auto-play
  * (shorter than 1 min).
+ *
+ * @param entry The file's index entry (see
+ *   file_index_request()), or NULL if not indexed
+ *   yet (audio files will not auto-play).
  */
-NONNULL
 bool
 supported_file_should_autoplay (
-  const SupportedFile * self);
+  const SupportedFile *  self,
+  const FileIndexEntry * entry);
 
 /**
  * Returns a pango markup to be used in GTK labels.
+ *
+ * @param entry The file's index entry (see
+ *   file_index_request()), or NULL if not indexed
+ *   yet.
  */
-NONNULL
 char *
 supported_file_get_info_text_for_label (
-  const SupportedFile * self);
+  const SupportedFile *  self,
+  const FileIndexEntry * entry);
 
 /**
  * Frees the instance and all its members.
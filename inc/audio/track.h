@@ -485,6 +485,10 @@ typedef struct Track
    * to a clone used in actions). */
   bool                is_project;
 
+  /** Handle in the handle table, if project
+   * track. */
+  ObjectHandle        handle;
+
   /** Whether currently disconnecting. */
   bool                disconnecting;
 
@@ -131,6 +131,20 @@ void
 track_lane_init_loaded (
   TrackLane * lane);
 
+/**
+ * Recreates the note stores of the MIDI regions in
+ * the lane that are out of date (or all of them if
+ * \ref force is true).
+ *
+ * Must be called from the GTK thread.
+ *
+ * @see midi_region_update_note_store().
+ */
+void
+track_lane_update_midi_note_stores (
+  TrackLane * self,
+  bool        force);
+
 /**
  * Creates a new TrackLane at the given pos in the
  * given Track.
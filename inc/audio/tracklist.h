@@ -481,6 +481,15 @@ int
 tracklist_get_num_muted_tracks (
   const Tracklist * self);
 
+/**
+ * Returns the number of plugins currently
+ * suspended because they are idle.
+ */
+NONNULL
+int
+tracklist_get_num_suspended_plugins (
+  const Tracklist * self);
+
 NONNULL
 int
 tracklist_get_num_soloed_tracks (
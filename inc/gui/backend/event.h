@@ -25,6 +25,8 @@
 #ifndef __GUI_BACKEND_EVENT_H__
 #define __GUI_BACKEND_EVENT_H__
 
+#include <stdbool.h>
+
 /**
  * @addtogroup events
  *
@@ -38,6 +40,18 @@ typedef enum EventType
   ET_ARRANGER_OBJECT_REMOVED,
   ET_ARRANGER_OBJECT_CHANGED,
 
+  /**
+   * Many objects in an arranger were created or
+   * changed.
+   *
+   * This is pushed by the event manager instead
+   * of many ET_ARRANGER_OBJECT_CREATED and
+   * ET_ARRANGER_OBJECT_CHANGED events.
+   *
+   * Arg: ArrangerWidget.
+   */
+  ET_ARRANGER_OBJECTS_CHANGED,
+
   /* arranger_selections */
   ET_ARRANGER_SELECTIONS_CREATED,
   ET_ARRANGER_SELECTIONS_CHANGED,
@@ -262,6 +276,10 @@ typedef struct ZEvent
 
   /** Backtrace. */
   char *       backtrace;
+
+  /** Whether the event was taken from the object
+   * pool of the event manager. */
+  bool         pooled;
 } ZEvent;
 
 ZEvent *
@@ -29,12 +29,16 @@
 #ifndef __GUI_BACKEND_EVENT_MANAGER_H__
 #define __GUI_BACKEND_EVENT_MANAGER_H__
 
+#include <stdbool.h>
+
+#include "gui/backend/event.h"
 #include "utils/backtrace.h"
 #include "utils/mpmc_queue.h"
 #include "utils/object_pool.h"
 
+#include <glib.h>
+
 typedef struct Zrythm Zrythm;
-typedef struct ZEvent ZEvent;
 
 /**
  * @addtogroup events
@@ -44,11 +48,23 @@ typedef struct ZEvent ZEvent;
 
 /**
  * Event manager.
+ *
+ * Events pushed from the GTK thread are added
+ * directly to the pending events. Events pushed
+ * from other threads go through a lock-free queue
+ * and are moved to the pending events by the GTK
+ * thread.
+ *
+ * Pending events are coalesced by their type and
+ * argument, and are processed in the GTK thread
+ * under a time budget per cycle, leaving the rest
+ * for the next cycle.
  */
 typedef struct EventManager
 {
   /**
-   * Event queue, mainly for GUI events.
+   * Event queue for events pushed from threads
+   * other than the GTK thread.
    */
   MPMCQueue *        mqueue;
 
@@ -58,6 +74,15 @@ typedef struct EventManager
    */
   ObjectPool *       obj_pool;
 
+  /** Events waiting to be processed, in the order
+   * they were pushed. */
+  GQueue *           pending;
+
+  /** Set of the events in \ref
+   * EventManager.pending, hashed by their type and
+   * argument. */
+  GHashTable *       pending_set;
+
   /** ID of the event processing source func. */
   guint              process_source_id;
 
@@ -71,8 +96,26 @@ typedef struct EventManager
 /** The event queue. */
 #define EVENT_QUEUE (EVENT_MANAGER->mqueue)
 
+/**
+ * Max number of events that can be queued from
+ * threads other than the GTK thread at once.
+ */
 #define EVENT_MANAGER_MAX_EVENTS 4000
 
+/**
+ * Time to spend processing events per cycle, in
+ * microseconds.
+ */
+#define EVENT_MANAGER_CYCLE_BUDGET 8000
+
+/**
+ * Number of pending created/changed arranger object
+ * events for the same arranger after which they
+ * are merged into a single
+ * ET_ARRANGER_OBJECTS_CHANGED event.
+ */
+#define EVENT_MANAGER_MERGE_THRESHOLD 32
+
 #define event_queue_push_back_event(q,x) \
   mpmc_queue_push_back (q, (void *) x)
 
@@ -88,21 +131,6 @@ typedef struct EventManager
       (!PROJECT || !AUDIO_ENGINE || \
        !AUDIO_ENGINE->exporting)) \
     { \
-      ZEvent * _ev = \
-        (ZEvent *) \
-        object_pool_get (EVENT_MANAGER->obj_pool); \
-      _ev->file = __FILE__; \
-      _ev->func = __func__; \
-      _ev->lineno = __LINE__; \
-      _ev->type = et; \
-      _ev->arg = (void *) _arg; \
-      /* skip backtrace for now */ \
-      if (zrythm_app->gtk_thread == \
-            g_thread_self () && false) \
-        { \
-          _ev->backtrace = \
-            backtrace_get ("", 40, false); \
-        } \
       /* don't print events that are called \
        * continuously */ \
       if (et != ET_PLAYHEAD_POS_CHANGED && \
@@ -113,8 +141,9 @@ typedef struct EventManager
             "pushing UI event " #et \
             " (%s:%d)", __func__, __LINE__); \
         } \
-      event_queue_push_back_event ( \
-        EVENT_QUEUE, _ev); \
+      event_manager_push ( \
+        EVENT_MANAGER, et, (void *) (_arg), \
+        __FILE__, __func__, __LINE__); \
     }
 
 /**
@@ -125,6 +154,24 @@ typedef struct EventManager
 EventManager *
 event_manager_new (void);
 
+/**
+ * Pushes an event.
+ *
+ * If an event with the same type and argument is
+ * already pending, the new event is dropped.
+ *
+ * Use EVENTS_PUSH() instead of calling this
+ * directly.
+ */
+void
+event_manager_push (
+  EventManager * self,
+  EventType      type,
+  void *         arg,
+  const char *   file,
+  const char *   func,
+  int            lineno);
+
 /**
  * Starts accepting events.
  */
@@ -140,7 +187,8 @@ event_manager_stop_events (
   EventManager * self);
 
 /**
- * Processes the events now.
+ * Processes all pending events now, regardless
+ * of the time budget.
  *
  * Must only be called from the GTK thread.
  */
@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Metadata index for the file browser.
+ *
+ * Files are scanned on a background thread and the
+ * results are cached on disk, keyed by path and
+ * validated by modification time and size, so that
+ * browsing large sample libraries never opens
+ * files on the GTK thread.
+ */
+
+#ifndef __GUI_BACKEND_FILE_INDEX_H__
+#define __GUI_BACKEND_FILE_INDEX_H__
+
+#include <stdbool.h>
+
+#include "audio/supported_file.h"
+#include "utils/yaml.h"
+
+#include <glib.h>
+
+/**
+ * @addtogroup gui_backend
+ *
+ * @{
+ */
+
+#define FILE_INDEX_SCHEMA_VERSION 1
+
+#define FILE_INDEX_FILENAME "file-index.yaml"
+
+/** Number of peaks in the thumbnail of each audio
+ * file. */
+#define FILE_INDEX_NUM_PEAKS 64
+
+/**
+ * Cached metadata for a file.
+ */
+typedef struct FileIndexEntry
+{
+  /** Absolute path. */
+  char *         abs_path;
+
+  /** Modification time (seconds since the epoch)
+   * when the file was scanned. */
+  gint64         mtime;
+
+  /** File size in bytes when the file was
+   * scanned. */
+  gint64         size;
+
+  ZFileType      type;
+
+  /** Length in milliseconds. */
+  gint64         length;
+
+  int            sample_rate;
+  int            channels;
+  int            bit_rate;
+  int            bit_depth;
+  float          bpm;
+
+  /**
+   * Peak thumbnail as a string of hex pairs (one
+   * byte per peak, see file_index_entry_get_peak()),
+   * or NULL if not available.
+   */
+  char *         peaks;
+
+  /** Lowercase basename used for searching (not
+   * serialized). */
+  char *         search_key;
+} FileIndexEntry;
+
+/**
+ * Serializable form of the index.
+ */
+typedef struct FileIndexCache
+{
+  int               schema_version;
+  FileIndexEntry ** entries;
+  int               num_entries;
+} FileIndexCache;
+
+static const cyaml_schema_field_t
+file_index_entry_fields_schema[] =
+{
+  YAML_FIELD_STRING_PTR (
+    FileIndexEntry, abs_path),
+  YAML_FIELD_INT (FileIndexEntry, mtime),
+  YAML_FIELD_INT (FileIndexEntry, size),
+  YAML_FIELD_ENUM (
+    FileIndexEntry, type, file_type_strings),
+  YAML_FIELD_INT (FileIndexEntry, length),
+  YAML_FIELD_INT (FileIndexEntry, sample_rate),
+  YAML_FIELD_INT (FileIndexEntry, channels),
+  YAML_FIELD_INT (FileIndexEntry, bit_rate),
+  YAML_FIELD_INT (FileIndexEntry, bit_depth),
+  YAML_FIELD_FLOAT (FileIndexEntry, bpm),
+  YAML_FIELD_STRING_PTR_OPTIONAL (
+    FileIndexEntry, peaks),
+
+  CYAML_FIELD_END
+};
+
+static const cyaml_schema_value_t
+file_index_entry_schema =
+{
+  YAML_VALUE_PTR (
+    FileIndexEntry,
+    file_index_entry_fields_schema),
+};
+
+static const cyaml_schema_field_t
+file_index_cache_fields_schema[] =
+{
+  YAML_FIELD_INT (
+    FileIndexCache, schema_version),
+  YAML_FIELD_DYN_PTR_ARRAY_VAR_COUNT_OPT (
+    FileIndexCache, entries,
+    file_index_entry_schema),
+
+  CYAML_FIELD_END
+};
+
+static const cyaml_schema_value_t
+file_index_cache_schema =
+{
+  YAML_VALUE_PTR (
+    FileIndexCache,
+    file_index_cache_fields_schema),
+};
+
+/**
+ * Called on the main thread with a (temporary)
+ * copy of the entry when a requested file is
+ * indexed.
+ */
+typedef void (*FileIndexCallback) (
+  const FileIndexEntry * entry,
+  void *                 user_data);
+
+/**
+ * Background file indexer.
+ */
+typedef struct FileIndex
+{
+  /** Path to the on-disk cache, or NULL to not
+   * persist the index. */
+  char *         cache_path;
+
+  /** Entries, keyed by absolute path. */
+  GHashTable *   entries;
+
+  /** Lock for \ref entries and \ref dirty. */
+  GMutex         mutex;
+
+  /** Whether there are changes not yet written to
+   * the cache. */
+  bool           dirty;
+
+  /** Worker thread for background scans. */
+  GThreadPool *  pool;
+
+  /** Worker thread for requests with a callback,
+   * so that they are not stuck behind background
+   * scans. */
+  GThreadPool *  interactive_pool;
+
+  /** Number of queued jobs not yet finished. */
+  volatile gint  num_pending;
+
+  /** Set when freeing to stop ongoing scans. */
+  volatile gint  quit;
+} FileIndex;
+
+/**
+ * Creates a new index, loading the cache at the
+ * given path if it exists.
+ *
+ * @param cache_path Path to the on-disk cache, or
+ *   NULL to keep the index in memory only.
+ */
+FileIndex *
+file_index_new (
+  const char * cache_path);
+
+/**
+ * Returns the default path of the on-disk cache.
+ */
+char *
+file_index_get_default_cache_path (void);
+
+/**
+ * Queues the given file for indexing (if it is not
+ * already indexed and unchanged).
+ *
+ * Requests with a callback are processed before
+ * background scans.
+ *
+ * @param callback Callback to call on the main
+ *   thread when done, or NULL.
+ * @param user_data_free Function to free the user
+ *   data with on the main thread once the request
+ *   is finished (also if the file could not be
+ *   indexed), or NULL.
+ */
+void
+file_index_request (
+  FileIndex *       self,
+  const char *      abs_path,
+  FileIndexCallback callback,
+  void *            user_data,
+  GDestroyNotify    user_data_free);
+
+/**
+ * Queues all supported files under the given
+ * directory (recursively) for indexing.
+ */
+void
+file_index_queue_dir (
+  FileIndex *  self,
+  const char * abs_path);
+
+/**
+ * Returns the paths of the indexed files whose
+ * name contains the given string (ignoring case),
+ * sorted.
+ *
+ * @param max_results Max number of results, or -1
+ *   for no limit.
+ *
+ * @return A new array of strings.
+ */
+GPtrArray *
+file_index_search (
+  FileIndex *  self,
+  const char * query,
+  int          max_results);
+
+/**
+ * Returns the number of indexed files.
+ */
+int
+file_index_get_num_entries (
+  FileIndex * self);
+
+/**
+ * Blocks until all queued files are indexed.
+ *
+ * Used in tests.
+ */
+void
+file_index_wait (
+  FileIndex * self);
+
+/**
+ * Writes the index to the cache file if there are
+ * changes.
+ */
+void
+file_index_save (
+  FileIndex * self);
+
+/**
+ * Returns the peak at the given index (0 to
+ * FILE_INDEX_NUM_PEAKS - 1) in the range [0, 1].
+ */
+float
+file_index_entry_get_peak (
+  const FileIndexEntry * self,
+  int                    idx);
+
+FileIndexEntry *
+file_index_entry_clone (
+  const FileIndexEntry * src);
+
+void
+file_index_entry_free (
+  FileIndexEntry * self);
+
+/**
+ * Stops the worker and frees the index (without
+ * saving).
+ */
+void
+file_index_free (
+  FileIndex * self);
+
+/**
+ * @}
+ */
+
+#endif
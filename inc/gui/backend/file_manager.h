@@ -23,6 +23,7 @@
 #include <stdbool.h>
 
 typedef struct SupportedFile SupportedFile;
+typedef struct FileIndex FileIndex;
 
 /**
  * @addtogroup gui_backend
@@ -109,8 +110,19 @@ typedef struct FileManager
    */
   FileBrowserLocation *    selection;
 
+  /** Metadata index for the files. */
+  FileIndex *              index;
+
 } FileManager;
 
+/**
+ * Function to call when files are loaded
+ * asynchronously.
+ */
+typedef void (*FileManagerLoadedFunc) (
+  FileManager * self,
+  void *        user_data);
+
 /**
  * Creates the file manager.
  */
@@ -123,6 +135,19 @@ file_manager_new (void);
 void
 file_manager_load_files (FileManager * self);
 
+/**
+ * Loads the files under the current selection in
+ * a background thread.
+ *
+ * @param func Function to call on the main thread
+ *   once \ref FileManager.files is updated.
+ */
+void
+file_manager_load_files_async (
+  FileManager *         self,
+  FileManagerLoadedFunc func,
+  void *                user_data);
+
 /**
  * @param save_to_settings Whether to save this
  *   location to GSettings.
@@ -53,6 +53,7 @@ typedef struct _GtkEventControllerMotion
 typedef struct ArrangerObject ArrangerObject;
 typedef struct ArrangerSelections ArrangerSelections;
 typedef struct EditorSettings EditorSettings;
+typedef struct ArrangerTileCache ArrangerTileCache;
 typedef enum ArrangerObjectType ArrangerObjectType;
 
 /**
@@ -319,15 +320,11 @@ typedef struct _ArrangerWidget
    * playhead changes position. */
   int            last_playhead_px;
 
-  /** Set to 1 to redraw. */
+  /** Set to 1 to invalidate all cached tiles. */
   int            redraw;
 
-  cairo_t *      cached_cr;
-
-  cairo_surface_t * cached_surface;
-
-  /** Rectangle in the last call. */
-  GdkRectangle   last_rect;
+  /** Cached tiles of the static contents. */
+  ArrangerTileCache * tile_cache;
 
   /**
    * Whether the current selections can link
@@ -563,6 +560,9 @@ arranger_widget_redraw_playhead (
 
 /**
  * Only redraws the given rectangle.
+ *
+ * The cached tiles overlapping the rectangle are
+ * invalidated so they get re-rendered.
  */
 void
 arranger_widget_redraw_rectangle (
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Tiled render cache for arrangers.
+ *
+ * The arranger canvas is split into fixed-size
+ * square tiles that are rendered once and then
+ * reused until something invalidates them.
+ * Tiles are grouped in layers, one per zoom level,
+ * so that zooming back and forth does not
+ * re-render everything.
+ *
+ * The tiles of all caches share a single memory
+ * budget that scales with the visible area, and
+ * the least recently used tiles are evicted first
+ * regardless of their arranger or layer.
+ */
+
+#ifndef __GUI_WIDGETS_ARRANGER_TILE_CACHE_H__
+#define __GUI_WIDGETS_ARRANGER_TILE_CACHE_H__
+
+#include <stdbool.h>
+
+#include <gtk/gtk.h>
+
+/**
+ * @addtogroup widgets
+ *
+ * @{
+ */
+
+/** Width and height of each tile in px. */
+#define ARRANGER_TILE_SIZE 256
+
+/** Approximate memory used by a tile (at 4
+ * bytes/px). */
+#define ARRANGER_TILE_BYTES \
+  ((size_t) ARRANGER_TILE_SIZE * \
+   ARRANGER_TILE_SIZE * 4)
+
+/** Max number of zoom levels to keep tiles for. */
+#define ARRANGER_TILE_CACHE_MAX_LAYERS 3
+
+/**
+ * Number of screens' worth of tiles to keep.
+ *
+ * The budget shared by all caches is this many
+ * times the tiles visible in the last draw of each
+ * cache.
+ */
+#define ARRANGER_TILE_CACHE_SCREENS 3
+
+/**
+ * Function to call to render the contents of the
+ * given rectangle.
+ *
+ * Drawing must be done relative to the rectangle
+ * (ie, (rect->x, rect->y) is at (0, 0) in @ref cr),
+ * which is the same convention the arranger draw
+ * functions use.
+ */
+typedef void (*ArrangerTileDrawFunc) (
+  void *         user_data,
+  cairo_t *      cr,
+  GdkRectangle * rect);
+
+/**
+ * A cached tile.
+ */
+typedef struct ArrangerTile
+{
+  /** Tile column/row. */
+  int               col;
+  int               row;
+
+  /** Layer the tile belongs to. */
+  struct ArrangerTileLayer * layer;
+
+  /** Link in the least recently used list shared
+   * by all caches. */
+  GList             lru_link;
+
+  /** Rendered contents. */
+  cairo_surface_t * surface;
+
+  /** Whether the tile needs to be re-rendered. */
+  bool              dirty;
+
+  /** Draw count the tile was last painted at. */
+  gint64            last_used;
+} ArrangerTile;
+
+/**
+ * Tiles for a single zoom level.
+ */
+typedef struct ArrangerTileLayer
+{
+  /** Zoom level (px per tick) of this layer. */
+  double            zoom;
+
+  /** Cache the layer belongs to. */
+  struct ArrangerTileCache * cache;
+
+  /** Tiles, keyed by packed column/row. */
+  GHashTable *      tiles;
+
+  /** Draw count the layer was last used at. */
+  gint64            last_used;
+} ArrangerTileLayer;
+
+/**
+ * Tile cache for an ArrangerWidget.
+ */
+typedef struct ArrangerTileCache
+{
+  ArrangerTileLayer *
+    layers[ARRANGER_TILE_CACHE_MAX_LAYERS];
+  int               num_layers;
+
+  /** Layer for the current zoom level. */
+  ArrangerTileLayer * cur_layer;
+
+  /** X of tick 0 in px (not scaled by the zoom
+   * level). */
+  int               origin_x;
+
+  /** Number of draws so far. */
+  gint64            draw_count;
+
+  /** Tiles visible in the last draw, counted
+   * towards the shared budget. */
+  int               num_visible_tiles;
+
+  /** Tiles rendered in the last draw. */
+  int               num_tiles_rendered;
+
+  /** Tiles reused in the last draw. */
+  int               num_tiles_reused;
+} ArrangerTileCache;
+
+/**
+ * Creates a new tile cache.
+ *
+ * @param origin_x X of tick 0 in px, which does
+ *   not change with the zoom level.
+ */
+ArrangerTileCache *
+arranger_tile_cache_new (
+  int origin_x);
+
+/**
+ * Switches to the layer for the given zoom level,
+ * creating it (and evicting the least recently
+ * used layer) if needed.
+ */
+void
+arranger_tile_cache_set_zoom (
+  ArrangerTileCache * self,
+  double              zoom);
+
+/**
+ * Marks the tiles overlapping the given rectangle
+ * as dirty in all layers.
+ *
+ * The rectangle is at the current zoom level and
+ * is scaled horizontally (and padded) for the
+ * layers of other zoom levels.
+ */
+void
+arranger_tile_cache_invalidate_rect (
+  ArrangerTileCache *  self,
+  const GdkRectangle * rect);
+
+/**
+ * Drops all cached tiles.
+ */
+void
+arranger_tile_cache_invalidate_all (
+  ArrangerTileCache * self);
+
+/**
+ * Paints the given rectangle (in widget
+ * coordinates) on @ref cr, rendering only the
+ * tiles that are missing or dirty.
+ */
+void
+arranger_tile_cache_draw (
+  ArrangerTileCache *  self,
+  cairo_t *            cr,
+  const GdkRectangle * rect,
+  ArrangerTileDrawFunc draw_func,
+  void *               user_data);
+
+/**
+ * Returns the memory budget in bytes shared by
+ * the tiles of all caches.
+ */
+size_t
+arranger_tile_cache_get_budget (void);
+
+/**
+ * Returns the memory used by the tiles of all
+ * caches in bytes.
+ */
+size_t
+arranger_tile_cache_get_total_bytes (void);
+
+void
+arranger_tile_cache_free (
+  ArrangerTileCache * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -52,6 +52,10 @@ typedef struct _CpuWidget
   /** DSP load (0-100). */
   int                    dsp;
 
+  /** Number of plugins suspended because they
+   * are idle. */
+  int                    num_suspended_plugins;
+
   /** Source func IDs. */
   guint                  cpu_source_id;
   guint                  dsp_source_id;
@@ -71,6 +71,10 @@ typedef struct _LiveWaveformWidget
   /** Port, if port. */
   Port *         port;
 
+  /** Ports whose ring buffers are being read
+   * (L and R, or only L if port). */
+  Port *         subscribed_ports[2];
+
 } LiveWaveformWidget;
 
 /**
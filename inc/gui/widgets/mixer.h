@@ -32,6 +32,13 @@ G_DECLARE_FINAL_TYPE (
 
 #define MW_MIXER MW_BOT_DOCK_EDGE->mixer
 
+/**
+ * Area in pixels on each side of the visible area
+ * whose strips are also mapped, so that they are
+ * ready when scrolling.
+ */
+#define MIXER_WIDGET_VIEW_MARGIN 200
+
 typedef struct _DragDestBoxWidget DragDestBoxWidget;
 typedef struct Channel Channel;
 typedef struct _ChannelSlotWidget ChannelSlotWidget;
@@ -43,8 +50,15 @@ typedef struct _MixerWidget
   /** Drag n drop dest box. */
   DragDestBoxWidget * ddbox;
 
+  /** Scrolled window containing
+   * MixerWidget.channels_box. */
+  GtkScrolledWindow * channels_scroll;
+
   /**
    * Box containing all channels except master.
+   *
+   * Only the strips in view (plus
+   * MIXER_WIDGET_VIEW_MARGIN) are mapped.
    */
   GtkBox *            channels_box;
 
@@ -81,6 +95,13 @@ mixer_widget_setup (
  *
  * To be used sparingly.
  */
+/**
+ * Updates the strips in the mixer to match the
+ * tracklist.
+ *
+ * Only the strips that were added, removed or
+ * moved are changed in the container.
+ */
 void
 mixer_widget_hard_refresh (MixerWidget * self);
 
@@ -44,6 +44,13 @@ typedef struct _ChordTrackWidget ChordTrackWidget;
 typedef struct Track InstrumentTrack;
 typedef struct Tracklist Tracklist;
 
+/**
+ * Area in pixels above and below the visible area
+ * whose tracks are also mapped, so that they are
+ * ready when scrolling.
+ */
+#define TRACKLIST_WIDGET_VIEW_MARGIN 200
+
 /**
  * The TracklistWidget holds all the Track's
  * in the Project.
@@ -62,7 +69,12 @@ typedef struct _TracklistWidget
   /** Box to hold pinned tracks. */
   GtkBox *            pinned_box;
 
-  /** Box inside unpinned scroll. */
+  /**
+   * Box inside unpinned scroll.
+   *
+   * Only the tracks in view (plus
+   * TRACKLIST_WIDGET_VIEW_MARGIN) are mapped.
+   */
   GtkBox *            unpinned_box;
 
   /**
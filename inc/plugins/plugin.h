@@ -252,6 +252,10 @@ typedef struct Plugin
    * project. */
   bool              is_project;
 
+  /** Handle in the handle table, if project
+   * plugin. */
+  ObjectHandle      handle;
+
   /** Modulator widget, if modulator. */
   ModulatorWidget * modulator_widget;
 
@@ -275,6 +279,46 @@ typedef struct Plugin
   /** Whether the plugin is used for MIDI
    * auditioning in SampleProcessor. */
   bool              is_auditioner;
+
+  /**
+   * Number of consecutive frames without any
+   * input or output (audio, CV or MIDI).
+   */
+  nframes_t         silent_frames;
+
+  /**
+   * Whether the plugin is suspended because its
+   * inputs and outputs have been silent for
+   * longer than the tail.
+   *
+   * Suspended plugins are not run and output
+   * silence until input arrives.
+   *
+   * @see AudioEngine.plugin_suspend_tail_ms.
+   */
+  volatile bool     suspended;
+
+  /** Hash of the last saved state, used to avoid
+   * rewriting unchanged states (not
+   * serialized). */
+  char *            saved_state_hash;
+
+  /** Absolute path of the directory the last
+   * state was saved in (not serialized). */
+  char *            saved_state_dir;
+
+  /**
+   * Values of the input ports when saving the
+   * project started, indexed by
+   * PortIdentifier.port_index (not serialized).
+   *
+   * The state is saved with these instead of the
+   * values the engine keeps changing, so that all
+   * plugins are saved as of the same moment.
+   *
+   * @see plugin_snapshot_control_values().
+   */
+  float *           control_snapshot;
 } Plugin;
 
 static const cyaml_schema_field_t
@@ -521,6 +565,17 @@ plugin_set_is_project (
   Plugin * self,
   bool     is_project);
 
+/**
+ * Registers the plugin in the handle table if
+ * @p is_project, otherwise unregisters it, and
+ * sets the handle on the identifiers of its ports.
+ */
+NONNULL
+void
+plugin_update_handle (
+  Plugin * self,
+  bool     is_project);
+
 void
 plugin_append_ports (
   Plugin *  pl,
@@ -583,6 +638,81 @@ plugin_get_abs_state_dir (
   Plugin * self,
   bool     is_backup);
 
+/**
+ * Saves the state of the plugin in its state
+ * directory.
+ *
+ * The state is captured through the plugin's state
+ * interface, which may be called while the plugin
+ * is processing, so the engine does not need to be
+ * paused. Different plugins may be saved
+ * concurrently. The control values are taken from
+ * the snapshot, if any (see
+ * plugin_snapshot_control_values()).
+ *
+ * @note plugin_ensure_state_dir() must have been
+ *   called first.
+ *
+ * @return Non-zero if error.
+ */
+NONNULL
+int
+plugin_save_state (
+  Plugin * self,
+  bool     is_backup);
+
+/**
+ * Returns whether the files of the state with the
+ * given hash are already in the given directory.
+ *
+ * If the state did not change since it was last
+ * saved in another directory (eg, when saving a
+ * backup), the files are hard-linked from there
+ * instead of being written again.
+ *
+ * @param filenames NULL-terminated array of the
+ *   basenames of the state files.
+ */
+NONNULL
+bool
+plugin_reuse_saved_state (
+  Plugin *      self,
+  const char *  hash,
+  const char *  abs_state_dir,
+  const char ** filenames);
+
+/**
+ * Remembers the given state as the last saved
+ * state.
+ */
+NONNULL
+void
+plugin_set_saved_state (
+  Plugin *     self,
+  const char * hash,
+  const char * abs_state_dir);
+
+/**
+ * Copies the current values of the input ports to
+ * be used when saving the state.
+ *
+ * Must be released with
+ * plugin_clear_control_snapshot().
+ */
+NONNULL
+void
+plugin_snapshot_control_values (
+  Plugin * self);
+
+/**
+ * Releases the values copied by
+ * plugin_snapshot_control_values().
+ */
+NONNULL
+void
+plugin_clear_control_snapshot (
+  Plugin * self);
+
 /**
  * Ensures the state dir exists or creates it.
  */
@@ -78,6 +78,13 @@ typedef struct TracklistSelections
 #define PROJECT_STEMS_DIR       "stems"
 #define PROJECT_POOL_DIR        "pool"
 
+/** Default zstd level for compressing project
+ * files. */
+#define PROJECT_DEFAULT_COMPRESSION_LEVEL 1
+
+/** Max size of trained compression dictionaries. */
+#define PROJECT_COMPRESSION_DICT_SIZE (112 * 1024)
+
 typedef enum ProjectPath
 {
   PROJECT_PATH_PROJECT_FILE,
@@ -297,6 +304,17 @@ typedef struct Project
   char *            version;
 
   gint64            last_autosave_time;
+
+  /**
+   * Whether the project is currently being
+   * serialized.
+   *
+   * The engine keeps running while saving, so
+   * anything that modifies the project from
+   * engine events (like recording) must wait until
+   * this is unset.
+   */
+  volatile gint     saving;
 } Project;
 
 static const cyaml_schema_field_t
@@ -389,6 +407,10 @@ typedef struct ProjectSaveData
 
   bool      is_backup;
 
+  /** Whether to save in the binary format (see
+   * project_binary_serialize()). */
+  bool      binary;
+
   /** To be set to true when the thread finishes. */
   bool      finished;
 
@@ -508,6 +530,13 @@ project_init_selections (Project * self);
  * Compresses/decompress a project from a file/data
  * to a file/data.
  *
+ * Data is streamed through zstd so that the whole
+ * input and output are only held in memory when
+ * they are passed or requested as data.
+ * Compression uses worker threads, the compression
+ * level and the optional dictionary from the
+ * settings.
+ *
  * @param compress True to compress, false to
  *   decompress.
  * @param[out] dest Pointer to a location to allocate
@@ -536,6 +565,22 @@ _project_compress (
 #define project_decompress(a,b,c,d,e,f) \
   _project_compress (false, a, b, c, d, e, f)
 
+/**
+ * Trains a zstd dictionary from all the (YAML)
+ * project files under the given directory and
+ * writes it to the given path.
+ *
+ * The dictionary is used for compressing project
+ * files when set in the "compression-dictionary"
+ * setting.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_train_compression_dictionary (
+  const char * dir,
+  const char * dest);
+
 /**
  * Returns the YAML representation of the saved
  * project file.
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Sectioned binary project container.
+ *
+ * The container starts with a header and an index
+ * of sections, followed by the section payloads.
+ * Each section holds one part of the project
+ * (serialized with its schema and compressed with
+ * zstd) so that sections can be decoded in
+ * parallel, and the undo history can be decoded
+ * only when it is needed.
+ *
+ * All integers are little-endian:
+ *
+ * | Field            | Size                    |
+ * | ---------------- | ----------------------- |
+ * | Magic            | 4                       |
+ * | Format version   | 4                       |
+ * | Number of sections | 4                     |
+ * | Index entries    | 48 per section          |
+ * | Payloads         | see index               |
+ *
+ * Each index entry contains the section name
+ * (zero-padded to 24 bytes), the schema version
+ * (4 bytes, then 4 bytes reserved), the offset of
+ * the payload from the start of the file (8 bytes)
+ * and the payload size (8 bytes).
+ */
+
+#ifndef __PROJECT_BINARY_H__
+#define __PROJECT_BINARY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct Project Project;
+
+/**
+ * @addtogroup project
+ *
+ * @{
+ */
+
+#define PROJECT_BINARY_MAGIC "ZPJB"
+#define PROJECT_BINARY_FORMAT_VERSION 1
+
+/** Max length of a section name, including the
+ * terminating null byte. */
+#define PROJECT_BINARY_SECTION_NAME_LEN 24
+
+/**
+ * Sections in a binary project.
+ */
+typedef enum ProjectBinarySection
+{
+  /** Project info, editor settings and
+   * selections. */
+  PROJECT_BINARY_SECTION_PROJECT,
+
+  /** Audio engine, without the pool. */
+  PROJECT_BINARY_SECTION_ENGINE,
+
+  PROJECT_BINARY_SECTION_POOL,
+  PROJECT_BINARY_SECTION_TRACKLIST,
+
+  /** Undo history (optional). */
+  PROJECT_BINARY_SECTION_UNDO_HISTORY,
+
+  NUM_PROJECT_BINARY_SECTIONS,
+} ProjectBinarySection;
+
+/**
+ * Returns whether the given data is a binary
+ * project.
+ */
+bool
+project_binary_is_binary (
+  const char * data,
+  size_t       size);
+
+/**
+ * Serializes the project into a new binary
+ * container.
+ *
+ * The sections are serialized in parallel.
+ *
+ * @param[out] data Pointer to a location to
+ *   allocate memory.
+ * @param[out] size Pointer to a location to store
+ *   the size of the allocated memory.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_binary_serialize (
+  Project * project,
+  char **   data,
+  size_t *  size);
+
+/**
+ * Serializes the project into a binary container
+ * written directly to the given file.
+ *
+ * Unlike project_binary_serialize(), the
+ * container is never held in memory in one piece.
+ * The file is written to a temporary file first so
+ * that an existing file is not left half-written.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_binary_serialize_to_file (
+  Project *    project,
+  const char * path);
+
+/**
+ * Deserializes a project from a binary container.
+ *
+ * The sections are decoded in parallel.
+ *
+ * @param[out] project Pointer to a location to
+ *   store the new project.
+ * @param lazy_undo_history Whether to keep decoding
+ *   the undo history in the background and only
+ *   wait for it when it is first needed (see
+ *   undo_manager_ensure_loaded()). Otherwise,
+ *   the undo history is decoded before returning.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_binary_deserialize (
+  Project **   project,
+  const char * data,
+  size_t       size,
+  bool         lazy_undo_history);
+
+/**
+ * Deserializes a project from a binary container
+ * file.
+ *
+ * Only the index and the payloads of the known
+ * sections are read, each into its own buffer, so
+ * the file is never held in memory in one piece.
+ *
+ * @see project_binary_deserialize().
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_binary_deserialize_from_file (
+  Project **   project,
+  const char * path,
+  bool         lazy_undo_history);
+
+/**
+ * Converts a binary container into the YAML
+ * representation of the project.
+ *
+ * @param[out] yaml Pointer to a location to store
+ *   the new null-terminated YAML string.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_binary_to_yaml (
+  char **      yaml,
+  const char * data,
+  size_t       size);
+
+/**
+ * Converts a binary container file into the YAML
+ * representation of the project.
+ *
+ * @see project_binary_to_yaml().
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_binary_file_to_yaml (
+  char **      yaml,
+  const char * path);
+
+/**
+ * @}
+ */
+
+#endif
@@ -171,6 +171,64 @@ z_gtk_container_remove_children_of_type (
   GtkContainer * container,
   GType          type);
 
+/**
+ * Makes the children of the box match the given
+ * widgets, in the given order.
+ *
+ * Only the children that differ are removed,
+ * added or moved, so the widgets that stay in the
+ * box are not unrealized and realized again.
+ *
+ * @param widgets Widgets to show. Widgets inside
+ *   another container are moved to this box.
+ * @param expand Expand value to use when packing
+ *   new widgets.
+ * @param fill Fill value to use when packing new
+ *   widgets.
+ */
+void
+z_gtk_box_sync_children (
+  GtkBox *     box,
+  GtkWidget ** widgets,
+  int          num_widgets,
+  bool         expand,
+  bool         fill);
+
+/**
+ * Unmaps the children of the box (which must be
+ * inside a scrolled window) that are outside of
+ * the visible area, and maps the ones inside it,
+ * using gtk_widget_set_child_visible().
+ *
+ * The children keep their size so the scrolled
+ * area does not change.
+ *
+ * @param adj The adjustment of the scrolled window
+ *   in the orientation of the box.
+ * @param margin Extra area in pixels before and
+ *   after the visible area whose children should
+ *   also be mapped.
+ */
+void
+z_gtk_box_map_only_children_in_view (
+  GtkBox *        box,
+  GtkAdjustment * adj,
+  int             margin);
+
+/**
+ * Adds a tick callback that is only added to the
+ * frame clock while the widget is mapped.
+ *
+ * This avoids running the callbacks of widgets that
+ * are hidden or scrolled out of view (see
+ * z_gtk_box_map_only_children_in_view()).
+ */
+void
+z_gtk_widget_add_tick_callback_while_mapped (
+  GtkWidget *     widget,
+  GtkTickCallback callback,
+  gpointer        user_data);
+
 void
 z_gtk_overlay_add_if_not_exists (
   GtkOverlay * overlay,
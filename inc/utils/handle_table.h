@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Generation-checked handles to live objects.
+ */
+
+#ifndef __UTILS_HANDLE_TABLE_H__
+#define __UTILS_HANDLE_TABLE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @addtogroup utils
+ *
+ * @{
+ */
+
+#define HANDLE_TABLE (ZRYTHM->handle_table)
+
+/**
+ * Handle to an object registered in a
+ * HandleTable.
+ *
+ * A generation of 0 means the handle is not set.
+ */
+typedef struct ObjectHandle
+{
+  /** Index of the slot in the table. */
+  unsigned int slot;
+
+  /** Generation of the slot when the handle was
+   * created. */
+  unsigned int generation;
+} ObjectHandle;
+
+/**
+ * Slot in a HandleTable.
+ */
+typedef struct HandleTableSlot
+{
+  /** Object, or NULL if the slot is free. */
+  void *       obj;
+
+  /** Current generation of the slot.
+   *
+   * This is incremented every time an object is
+   * removed from the slot, so handles to the
+   * previous object no longer resolve. */
+  unsigned int generation;
+} HandleTableSlot;
+
+/**
+ * Table of slots that objects register in.
+ *
+ * Other objects keep an ObjectHandle instead of
+ * a position or a pointer, so a reference to a
+ * removed object resolves to NULL instead of to
+ * the object that took its place.
+ */
+typedef struct HandleTable
+{
+  HandleTableSlot * slots;
+  int               num_slots;
+  size_t            slots_size;
+
+  /** Indices of the free slots. */
+  unsigned int *    free_slots;
+  int               num_free_slots;
+  size_t            free_slots_size;
+} HandleTable;
+
+/**
+ * Returns whether the handle is set.
+ */
+static inline bool
+object_handle_is_set (
+  const ObjectHandle * handle)
+{
+  return handle->generation != 0;
+}
+
+/**
+ * Creates a new handle table.
+ */
+HandleTable *
+handle_table_new (void);
+
+/**
+ * Registers @p obj and returns its handle.
+ */
+ObjectHandle
+handle_table_add (
+  HandleTable * self,
+  void *        obj);
+
+/**
+ * Unregisters the object @p handle refers to.
+ *
+ * Existing copies of @p handle will no longer
+ * resolve.
+ */
+void
+handle_table_remove (
+  HandleTable *        self,
+  const ObjectHandle * handle);
+
+/**
+ * Returns the object @p handle refers to, or NULL
+ * if the handle is not set or the object was
+ * removed.
+ */
+void *
+handle_table_get (
+  const HandleTable *  self,
+  const ObjectHandle * handle);
+
+/**
+ * Frees the table.
+ *
+ * The registered objects are not freed.
+ */
+void
+handle_table_free (
+  HandleTable * self);
+
+/**
+ * @}
+ */
+
+#endif
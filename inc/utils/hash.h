@@ -26,6 +26,8 @@
 #ifndef __UTILS_HASH_H__
 #define __UTILS_HASH_H__
 
+#include <stddef.h>
+
 /**
  * @addtogroup utils
  *
@@ -43,6 +45,16 @@ hash_get_from_file (
   const char *  filepath,
   HashAlgorithm algo);
 
+/**
+ * Returns the hash of the given data as a newly
+ * allocated string.
+ */
+char *
+hash_get_from_data (
+  const void *  data,
+  size_t        size,
+  HashAlgorithm algo);
+
 /**
  * @}
  */
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Persistent cache of file hashes.
+ *
+ * Hashes are keyed by the device, inode, size and
+ * modification time of the file, so a cached hash
+ * is validated with a single stat() instead of
+ * reading the whole file.
+ */
+
+#ifndef __UTILS_HASH_CACHE_H__
+#define __UTILS_HASH_CACHE_H__
+
+#include <stdbool.h>
+
+#include "utils/hash.h"
+#include "utils/yaml.h"
+
+#include <glib.h>
+
+/**
+ * @addtogroup utils
+ *
+ * @{
+ */
+
+#define HASH_CACHE_SCHEMA_VERSION 1
+
+#define HASH_CACHE (ZRYTHM->hash_cache)
+
+/**
+ * Files modified less than this many nanoseconds
+ * before being hashed are not cached, since a
+ * later modification within the timestamp
+ * granularity of the filesystem would go
+ * unnoticed.
+ */
+#define HASH_CACHE_RACY_NS \
+  (2 * (gint64) 1000000000)
+
+/**
+ * Entries not used for this many seconds are
+ * dropped when serializing.
+ */
+#define HASH_CACHE_MAX_AGE (60 * 24 * 60 * 60)
+
+/**
+ * A cached hash.
+ */
+typedef struct HashCacheEntry
+{
+  /** Path the file had when it was hashed, for
+   * debugging. */
+  char *         path;
+
+  /** Identity of the file when it was hashed. */
+  guint64        device;
+  guint64        inode;
+  guint64        size;
+  gint64         mtime_ns;
+
+  HashAlgorithm  algo;
+  char *         hash;
+
+  /** Last time the entry was used, in seconds
+   * since the epoch. */
+  gint64         last_used;
+} HashCacheEntry;
+
+static const cyaml_schema_field_t
+hash_cache_entry_fields_schema[] =
+{
+  YAML_FIELD_STRING_PTR (
+    HashCacheEntry, path),
+  YAML_FIELD_UINT (
+    HashCacheEntry, device),
+  YAML_FIELD_UINT (
+    HashCacheEntry, inode),
+  YAML_FIELD_UINT (
+    HashCacheEntry, size),
+  YAML_FIELD_INT (
+    HashCacheEntry, mtime_ns),
+  YAML_FIELD_INT (
+    HashCacheEntry, algo),
+  YAML_FIELD_STRING_PTR (
+    HashCacheEntry, hash),
+  YAML_FIELD_INT (
+    HashCacheEntry, last_used),
+
+  CYAML_FIELD_END
+};
+
+static const cyaml_schema_value_t
+hash_cache_entry_schema =
+{
+  YAML_VALUE_PTR (
+    HashCacheEntry, hash_cache_entry_fields_schema),
+};
+
+/**
+ * Persistent cache of file hashes.
+ */
+typedef struct HashCache
+{
+  /** Version of the file. */
+  int               schema_version;
+
+  HashCacheEntry ** entries;
+  int               num_entries;
+  size_t            entries_size;
+
+  /** Entries keyed by file identity (not
+   * serialized). */
+  GHashTable *      ht;
+
+  /** Whether the cache file was read. */
+  bool              loaded;
+
+  /** Whether there are changes to serialize. */
+  bool              dirty;
+
+  GMutex            mutex;
+} HashCache;
+
+static const cyaml_schema_field_t
+hash_cache_fields_schema[] =
+{
+  YAML_FIELD_INT (
+    HashCache, schema_version),
+  YAML_FIELD_DYN_PTR_ARRAY_VAR_COUNT_OPT (
+    HashCache, entries, hash_cache_entry_schema),
+
+  CYAML_FIELD_END
+};
+
+static const cyaml_schema_value_t
+hash_cache_schema =
+{
+  YAML_VALUE_PTR (
+    HashCache, hash_cache_fields_schema),
+};
+
+/**
+ * Creates a new hash cache.
+ *
+ * The cache file is read on first use.
+ */
+HashCache *
+hash_cache_new (void);
+
+/**
+ * Returns the hash of the given file as a newly
+ * allocated string, calculating it only if the
+ * file changed since it was last cached.
+ *
+ * This can be called from any thread.
+ */
+char *
+hash_cache_get_from_file (
+  HashCache *   self,
+  const char *  filepath,
+  HashAlgorithm algo);
+
+/**
+ * Writes the cache to its file if it changed.
+ */
+void
+hash_cache_serialize_to_file (
+  HashCache * self);
+
+void
+hash_cache_free (
+  HashCache * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -260,6 +260,16 @@ yaml_deserialize (
   const char *                 yaml,
   const cyaml_schema_value_t * schema);
 
+/**
+ * Frees an object returned by yaml_deserialize()
+ * that was not modified since.
+ */
+NONNULL
+void
+yaml_free (
+  void *                       data,
+  const cyaml_schema_value_t * schema);
+
 NONNULL
 void
 yaml_print (
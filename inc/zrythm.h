@@ -37,6 +37,8 @@ typedef struct EventManager EventManager;
 typedef struct ObjectUtils ObjectUtils;
 typedef struct PluginManager PluginManager;
 typedef struct FileManager FileManager;
+typedef struct HashCache HashCache;
+typedef struct HandleTable HandleTable;
 typedef struct Settings Settings;
 typedef struct Log Log;
 typedef struct CairoCaches CairoCaches;
@@ -179,6 +181,13 @@ typedef struct Zrythm
    */
   PluginManager *     plugin_manager;
 
+  /** Cache of file hashes. */
+  HashCache *         hash_cache;
+
+  /** Handles to the tracks and plugins in the
+   * project. */
+  HandleTable *       handle_table;
+
   /**
    * Application settings
    */
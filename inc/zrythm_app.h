@@ -133,6 +133,17 @@ struct _ZrythmApp
   /** Output file passed with --output. */
   char *             output_file;
 
+  /** Trace file passed with --dsp-trace. */
+  char *             dsp_trace_file;
+
+  /** Options passed with --render-range,
+   * --render-tracks, --render-format and
+   * --render-bit-depth. */
+  char *             render_range;
+  char *             render_tracks;
+  char *             render_format;
+  int                render_bit_depth;
+
   /** Whether to pretty-print. */
   bool               pretty_print;
 
@@ -32,6 +32,8 @@
 #include "actions/range_action.h"
 #include "audio/audio_function.h"
 #include "audio/automation_function.h"
+#include "audio/dsp_profiler.h"
+#include "audio/engine.h"
 #include "audio/graph.h"
 #include "audio/graph_export.h"
 #include "audio/instrument_track.h"
@@ -93,6 +95,7 @@
 #include "gui/widgets/tracklist.h"
 #include "project.h"
 #include "settings/settings.h"
+#include "utils/datetime.h"
 #include "utils/dialogs.h"
 #include "utils/flags.h"
 #include "utils/gtk.h"
@@ -103,6 +106,7 @@
 #include "utils/stack.h"
 #include "utils/string.h"
 #include "utils/system.h"
+#include "zrythm.h"
 #include "zrythm_app.h"
 
 #include <gtk/gtk.h>
@@ -863,7 +867,7 @@ activate_export_graph (
 {
 #ifdef HAVE_CGRAPH
   Graph * graph = graph_new (ROUTER);
-  graph_setup (graph, false, false);
+  graph_setup (graph, true, false);
 
   char * exports_dir =
     project_get_path (
@@ -949,6 +953,57 @@ activate_export_graph (
 #endif
 }
 
+/**
+ * Starts per-node DSP profiling, or writes the
+ * trace to the profiling dir and stops it if
+ * already profiling.
+ */
+void
+activate_toggle_dsp_profiling (
+  GSimpleAction *action,
+  GVariant      *variant,
+  gpointer       user_data)
+{
+  DspProfiler * profiler = AUDIO_ENGINE->profiler;
+  if (!profiler)
+    {
+      engine_set_dsp_profiling (AUDIO_ENGINE, true);
+      ui_show_notification (
+        _("DSP profiling started"));
+      return;
+    }
+
+  dsp_profiler_collect (profiler);
+
+  char * dir =
+    zrythm_get_dir (ZRYTHM_DIR_USER_PROFILING);
+  io_mkdir (dir);
+  char * datetime = datetime_get_for_filename ();
+  char * filename =
+    g_strdup_printf ("dsp-trace-%s.json", datetime);
+  char * path =
+    g_build_filename (dir, filename, NULL);
+  char * err =
+    dsp_profiler_write_trace (profiler, path);
+  engine_set_dsp_profiling (AUDIO_ENGINE, false);
+  if (err)
+    {
+      ui_show_error_message (MAIN_WINDOW, err);
+      g_free (err);
+    }
+  else
+    {
+      char msg[800];
+      sprintf (
+        msg, _("DSP trace written to %s"), path);
+      ui_show_notification (msg);
+    }
+  g_free (dir);
+  g_free (datetime);
+  g_free (filename);
+  g_free (path);
+}
+
 void
 activate_properties (GSimpleAction *action,
                   GVariant      *variant,
@@ -962,6 +1017,7 @@ activate_undo (GSimpleAction *action,
                   GVariant      *variant,
                   gpointer       user_data)
 {
+  undo_manager_ensure_loaded (UNDO_MANAGER);
   if (undo_stack_is_empty (
         UNDO_MANAGER->undo_stack))
     return;
@@ -973,6 +1029,7 @@ activate_redo (GSimpleAction *action,
                   GVariant      *variant,
                   gpointer       user_data)
 {
+  undo_manager_ensure_loaded (UNDO_MANAGER);
   if (undo_stack_is_empty (
         UNDO_MANAGER->redo_stack))
     return;
@@ -752,7 +752,11 @@ update_region_link_groups (
   ArrangerObject ** objs,
   int               size)
 {
-  /* handle children of linked regions */
+  /* handle children of linked regions, updating
+   * each region once no matter how many of its
+   * children changed */
+  GHashTable * updated_regions =
+    g_hash_table_new (NULL, NULL);
   for (int i = 0; i < size; i++)
     {
       /* get the actual object from the
@@ -767,10 +771,15 @@ update_region_link_groups (
             arranger_object_get_region (obj);
           g_return_if_fail (region);
 
+          if (!g_hash_table_add (
+                 updated_regions, region))
+            continue;
+
           /* shift all linked objects */
           region_update_link_group (region);
         }
     }
+  g_hash_table_unref (updated_regions);
 }
 
 /**
@@ -1966,28 +1975,49 @@ do_or_undo_edit (
           AudioClip * src_clip =
             audio_pool_get_clip (
               AUDIO_POOL, src_audio_sel->pool_id);
+          g_return_val_if_fail (r && src_clip, -1);
 
-          /* adjust the positions */
-          Position start, end;
-          position_set_to_pos (
-            &start, &src_audio_sel->sel_start);
-          position_set_to_pos (
-            &end, &src_audio_sel->sel_end);
-          position_add_frames (
-            &start, - r->base.pos.frames);
-          position_add_frames (
-            &end, - r->base.pos.frames);
-          size_t num_frames =
-            (size_t) (end.frames - start.frames);
-          g_return_val_if_fail (
-            (long) num_frames ==
-              src_clip->num_frames, -1);
-
-          /* replace the frames in the region */
-          audio_region_replace_frames (
-            r, src_clip->frames,
-            (size_t) start.frames,
-            num_frames, F_NO_DUPLICATE_CLIP);
+          /* versions of the clip only hold chunks,
+           * so only the chunks that differ are
+           * swapped in */
+          if (src_clip->num_chunks > 0)
+            {
+              AudioClip * clip =
+                audio_region_get_clip (r);
+              g_return_val_if_fail (clip, -1);
+              audio_clip_set_chunks (
+                clip, src_clip->chunks,
+                src_clip->num_chunks);
+              r->last_clip_change =
+                g_get_monotonic_time ();
+            }
+          else
+            {
+              /* clips of older projects only hold
+               * the replaced range */
+
+              /* adjust the positions */
+              Position start, end;
+              position_set_to_pos (
+                &start, &src_audio_sel->sel_start);
+              position_set_to_pos (
+                &end, &src_audio_sel->sel_end);
+              position_add_frames (
+                &start, - r->base.pos.frames);
+              position_add_frames (
+                &end, - r->base.pos.frames);
+              size_t num_frames =
+                (size_t) (end.frames - start.frames);
+              g_return_val_if_fail (
+                (long) num_frames ==
+                  src_clip->num_frames, -1);
+
+              /* replace the frames in the region */
+              audio_region_replace_frames (
+                r, src_clip->frames,
+                (size_t) start.frames,
+                num_frames, F_NO_DUPLICATE_CLIP);
+            }
         }
       else /* not audio function */
         {
@@ -53,6 +53,7 @@ port_action_new (
   undoable_action_init (ua, UA_PORT);
 
   self->port_id = *port_id;
+  port_identifier_clear_handles (&self->port_id);
   self->type = type;
   if (is_normalized)
     {
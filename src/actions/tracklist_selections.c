@@ -1724,6 +1724,13 @@ do_or_undo_edit (
       EVENTS_PUSH (ET_TRACK_STATE_CHANGED, track);
     }
 
+  /* disabled tracks are left out of the graph */
+  if (self->edit_type ==
+        EDIT_TRACK_ACTION_TYPE_ENABLE)
+    {
+      router_recalc_graph (ROUTER, F_NOT_SOFT);
+    }
+
   return 0;
 }
 
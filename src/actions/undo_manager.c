@@ -17,9 +17,14 @@
  * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <stdlib.h>
+
 #include "actions/undoable_action.h"
 #include "actions/undo_stack.h"
 #include "actions/undo_manager.h"
+#include "audio/automation_track.h"
+#include "audio/automation_tracklist.h"
+#include "audio/track.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
 #include "gui/widgets/header.h"
@@ -28,6 +33,7 @@
 #include "project.h"
 #include "utils/objects.h"
 #include "utils/stack.h"
+#include "utils/yaml.h"
 #include "zrythm_app.h"
 
 /**
@@ -39,12 +45,54 @@ undo_manager_init_loaded (
   UndoManager * self)
 {
   g_message ("%s: loading...", __func__);
-  undo_stack_init_loaded (self->undo_stack);
-  undo_stack_init_loaded (self->redo_stack);
+  /* if the stacks are loaded lazily they are
+   * inited in undo_manager_ensure_loaded() */
+  if (!self->loader)
+    {
+      undo_stack_init_loaded (self->undo_stack);
+      undo_stack_init_loaded (self->redo_stack);
+    }
   zix_sem_init (&self->action_sem, 1);
   g_message ("%s: done", __func__);
 }
 
+/**
+ * Waits for the undo history to be decoded if it
+ * is loaded lazily and populates the undo/redo
+ * stacks.
+ *
+ * Must be called before accessing the stacks
+ * directly.
+ */
+void
+undo_manager_ensure_loaded (
+  UndoManager * self)
+{
+  if (!self->loader)
+    return;
+
+  g_message (
+    "%s: waiting for undo history...", __func__);
+  UndoManager * loaded =
+    (UndoManager *) g_thread_join (self->loader);
+  self->loader = NULL;
+
+  if (loaded)
+    {
+      self->undo_stack = loaded->undo_stack;
+      self->redo_stack = loaded->redo_stack;
+      free (loaded);
+      undo_stack_init_loaded (self->undo_stack);
+      undo_stack_init_loaded (self->redo_stack);
+    }
+  else
+    {
+      self->undo_stack = undo_stack_new ();
+      self->redo_stack = undo_stack_new ();
+    }
+  g_message ("%s: done", __func__);
+}
+
 /**
  * Inits the undo manager by creating the undo/redo
  * stacks.
@@ -142,12 +190,35 @@ do_or_undo_action (
   return 0;
 }
 
+/**
+ * Recreates the out of date note stores of MIDI
+ * regions after an action has changed the project.
+ *
+ * Only the stores marked as out of date are
+ * recreated.
+ */
+static void
+update_midi_note_stores (void)
+{
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      Track * track = TRACKLIST->tracks[i];
+      for (int j = 0; j < track->num_lanes; j++)
+        {
+          track_lane_update_midi_note_stores (
+            track->lanes[j], false);
+        }
+    }
+}
+
 /**
  * Undo last action.
  */
 void
 undo_manager_undo (UndoManager * self)
 {
+  undo_manager_ensure_loaded (self);
+
   g_warn_if_fail (
     !undo_stack_is_empty (self->undo_stack));
 
@@ -176,6 +247,12 @@ undo_manager_undo (UndoManager * self)
         self->redo_stack);
     }
 
+  /* recompile the envelopes now instead of
+   * waiting for the idle handler, so that
+   * playback uses them right away */
+  automation_track_update_pending_envelopes ();
+  update_midi_note_stores ();
+
   if (ZRYTHM_HAVE_UI)
     {
       EVENTS_PUSH (ET_UNDO_REDO_ACTION_DONE, NULL);
@@ -193,6 +270,8 @@ undo_manager_undo (UndoManager * self)
 void
 undo_manager_redo (UndoManager * self)
 {
+  undo_manager_ensure_loaded (self);
+
   g_warn_if_fail (
     !undo_stack_is_empty (self->redo_stack));
 
@@ -221,6 +300,9 @@ undo_manager_redo (UndoManager * self)
         self->undo_stack);
     }
 
+  automation_track_update_pending_envelopes ();
+  update_midi_note_stores ();
+
   if (ZRYTHM_HAVE_UI)
     {
       EVENTS_PUSH (ET_UNDO_REDO_ACTION_DONE, NULL);
@@ -245,6 +327,8 @@ undo_manager_perform (
 {
   g_return_val_if_fail (self && action, -1);
 
+  undo_manager_ensure_loaded (self);
+
   zix_sem_wait (&self->action_sem);
 
   /* if error return */
@@ -261,6 +345,9 @@ undo_manager_perform (
 
   undo_stack_clear (self->redo_stack, true);
 
+  automation_track_update_pending_envelopes ();
+  update_midi_note_stores ();
+
   if (ZRYTHM_HAVE_UI)
     {
       EVENTS_PUSH (ET_UNDO_REDO_ACTION_DONE, NULL);
@@ -283,6 +370,8 @@ undo_manager_contains_clip (
   UndoManager * self,
   AudioClip *   clip)
 {
+  undo_manager_ensure_loaded (self);
+
   bool ret =
     undo_stack_contains_clip (
       self->undo_stack, clip) ||
@@ -302,8 +391,10 @@ undo_manager_clear_stacks (
   UndoManager * self,
   bool          free)
 {
+  g_return_if_fail (self);
+  undo_manager_ensure_loaded (self);
   g_return_if_fail (
-    self && self->undo_stack && self->redo_stack);
+    self->undo_stack && self->redo_stack);
   undo_stack_clear (self->undo_stack, free);
   undo_stack_clear (self->redo_stack, free);
 }
@@ -314,6 +405,18 @@ undo_manager_free (
 {
   g_message ("%s: freeing...", __func__);
 
+  if (self->loader)
+    {
+      UndoManager * loaded =
+        (UndoManager *)
+        g_thread_join (self->loader);
+      self->loader = NULL;
+      if (loaded)
+        {
+          yaml_free (loaded, &undo_manager_schema);
+        }
+    }
+
   object_free_w_func_and_null (
     undo_stack_free, self->undo_stack);
   object_free_w_func_and_null (
@@ -20,28 +20,304 @@
 #include "audio/engine.h"
 #include "audio/audio_function.h"
 #include "audio/audio_region.h"
+#include "audio/offline_processor.h"
 #include "gui/backend/arranger_selections.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
+#include "gui/widgets/dialogs/generic_progress_dialog.h"
+#include "gui/widgets/main_window.h"
 #include "project.h"
 #include "settings/settings.h"
 #include "utils/dsp.h"
 #include "utils/flags.h"
+#include "utils/objects.h"
 #include "utils/string.h"
 #include "zrythm_app.h"
 
+#include <glib/gi18n.h>
+
+/**
+ * Minimum number of frames to show a progress
+ * dialog for.
+ */
+#define PROGRESS_DIALOG_MIN_FRAMES \
+  (4 * OFFLINE_PROCESSOR_CHUNK_FRAMES)
+
+/**
+ * Data for processing the frames of an audio
+ * function.
+ */
+typedef struct ProcessData
+{
+  AudioFunctionType   type;
+  const float *       src;
+  float *             dest;
+  size_t              num_frames;
+  size_t              channels;
+
+  /** Gain to apply when normalizing. */
+  float               gain;
+
+  GenericProgressInfo progress_info;
+
+  /** Return value of process_frames(). */
+  int                 ret;
+} ProcessData;
+
+static void
+copy_chunk (
+  OfflineProcessor *      self,
+  OfflineProcessorChunk * chunk)
+{
+  dsp_copy (
+    offline_processor_get_chunk_dest (self, chunk),
+    offline_processor_get_chunk_src (self, chunk),
+    chunk->num_frames * self->channels);
+}
+
+static void
+invert_chunk (
+  OfflineProcessor *      self,
+  OfflineProcessorChunk * chunk)
+{
+  copy_chunk (self, chunk);
+  dsp_mul_k2 (
+    offline_processor_get_chunk_dest (self, chunk),
+    -1.f, chunk->num_frames * self->channels);
+}
+
+static void
+get_abs_peak_of_chunk (
+  OfflineProcessor *      self,
+  OfflineProcessorChunk * chunk)
+{
+  dsp_abs_max (
+    (float *)
+    offline_processor_get_chunk_src (self, chunk),
+    &chunk->result,
+    chunk->num_frames * self->channels);
+}
+
+static void
+apply_gain_to_chunk (
+  OfflineProcessor *      self,
+  OfflineProcessorChunk * chunk)
+{
+  ProcessData * data =
+    (ProcessData *) self->user_data;
+  copy_chunk (self, chunk);
+  dsp_mul_k2 (
+    offline_processor_get_chunk_dest (self, chunk),
+    data->gain, chunk->num_frames * self->channels);
+}
+
+static void
+reverse_chunk (
+  OfflineProcessor *      self,
+  OfflineProcessorChunk * chunk)
+{
+  size_t channels = self->channels;
+  for (size_t i = chunk->start_frame;
+       i < chunk->start_frame + chunk->num_frames;
+       i++)
+    {
+      for (size_t j = 0; j < channels; j++)
+        {
+          self->dest[i * channels + j] =
+            self->src[
+              ((self->num_frames - i) - 1) *
+                channels + j];
+        }
+    }
+}
+
+/**
+ * Processes the frames in chunks on a thread pool.
+ *
+ * @return Non-zero if cancelled.
+ */
+static int
+process_frames (
+  ProcessData * data)
+{
+  int num_passes =
+    data->type == AUDIO_FUNCTION_NORMALIZE ? 2 : 1;
+  OfflineProcessor * processor =
+    offline_processor_new (
+      data->src, data->dest, data->num_frames,
+      data->channels, num_passes,
+      &data->progress_info, data);
+
+  int ret = 0;
+  switch (data->type)
+    {
+    case AUDIO_FUNCTION_INVERT:
+      ret =
+        offline_processor_run_pass (
+          processor, invert_chunk);
+      break;
+    case AUDIO_FUNCTION_NORMALIZE:
+      /* peak-normalize */
+      ret =
+        offline_processor_run_pass (
+          processor, get_abs_peak_of_chunk);
+      if (ret != 0)
+        break;
+      data->gain =
+        1.f /
+        offline_processor_get_max_result (
+          processor);
+      ret =
+        offline_processor_run_pass (
+          processor, apply_gain_to_chunk);
+      break;
+    case AUDIO_FUNCTION_REVERSE:
+      ret =
+        offline_processor_run_pass (
+          processor, reverse_chunk);
+      break;
+    case AUDIO_FUNCTION_INVALID:
+      /* copy only */
+      ret =
+        offline_processor_run_pass (
+          processor, copy_chunk);
+      break;
+    default:
+      g_warning ("not implemented");
+      ret =
+        offline_processor_run_pass (
+          processor, copy_chunk);
+      break;
+    }
+
+  offline_processor_free (processor);
+
+  return ret;
+}
+
+static void *
+process_frames_thread (
+  ProcessData * data)
+{
+  data->ret = process_frames (data);
+
+  return NULL;
+}
+
+/**
+ * Processes the frames in a separate thread while
+ * showing a cancelable progress dialog.
+ *
+ * @return Non-zero if cancelled.
+ */
+static int
+process_frames_with_progress_dialog (
+  ProcessData * data)
+{
+  sprintf (
+    data->progress_info.label_str,
+    _("Applying %s..."),
+    audio_function_type_to_string (data->type));
+  strcpy (
+    data->progress_info.label_done_str,
+    _("Done"));
+
+  GThread * thread =
+    g_thread_new (
+      "audio_function_thread",
+      (GThreadFunc) process_frames_thread, data);
+
+  /* create a progress dialog and block */
+  GenericProgressDialogWidget * progress_dialog =
+    generic_progress_dialog_widget_new ();
+  generic_progress_dialog_widget_setup (
+    progress_dialog, _("Audio Function Progress"),
+    &data->progress_info, true, true);
+  gtk_window_set_transient_for (
+    GTK_WINDOW (progress_dialog),
+    GTK_WINDOW (MAIN_WINDOW));
+  gtk_dialog_run (GTK_DIALOG (progress_dialog));
+  gtk_widget_destroy (GTK_WIDGET (progress_dialog));
+
+  g_thread_join (thread);
+
+  return data->ret;
+}
+
+/**
+ * Processes the given range of the clip and
+ * replaces it with the result.
+ *
+ * @return Non-zero if cancelled.
+ */
+static int
+apply_to_range (
+  AudioClip *       clip,
+  AudioFunctionType type,
+  size_t            start_frame,
+  size_t            num_frames)
+{
+  /* interleaved frames (allocated on the heap
+   * since selections can be arbitrarily large) */
+  size_t channels = clip->channels;
+  float * frames =
+    object_new_n (num_frames * channels, float);
+
+  ProcessData data;
+  memset (&data, 0, sizeof (ProcessData));
+  data.type = type;
+  data.src = &clip->frames[start_frame * channels];
+  data.dest = frames;
+  data.num_frames = num_frames;
+  data.channels = channels;
+  int ret;
+  if (ZRYTHM_HAVE_UI && !ZRYTHM_TESTING &&
+      num_frames >= PROGRESS_DIALOG_MIN_FRAMES)
+    {
+      ret =
+        process_frames_with_progress_dialog (&data);
+    }
+  else
+    {
+      ret = process_frames (&data);
+    }
+  if (ret != 0)
+    {
+      g_message (
+        "%s cancelled",
+        audio_function_type_to_string (type));
+      free (frames);
+      return -1;
+    }
+
+  /* only the chunks overlapping the range are
+   * replaced */
+  audio_clip_replace_frames (
+    clip, frames, start_frame, num_frames);
+  free (frames);
+
+  return 0;
+}
+
 /**
  * Applies the given action to the given selections.
  *
- * This will save a file in the pool and store the
- * pool ID in the selections.
+ * This will add a clip sharing the chunks of the
+ * region's clip after the change to the pool and
+ * store its pool ID in the selections.
+ *
+ * The frames are processed in chunks on a thread
+ * pool, showing a cancelable progress dialog for
+ * large selections.
  *
  * @param sel Selections to edit.
  * @param type Function type. If invalid is passed,
- *   this will simply add the audio file in the pool
+ *   this will simply add a clip to the pool
  *   for the unchanged audio material (used in
  *   audio selection actions for the selections
  *   before the change).
+ *
+ * @return Non-zero if failed or cancelled.
  */
 int
 audio_function_apply (
@@ -88,91 +364,43 @@ audio_function_apply (
   position_add_frames (
     &end, - r->base.pos.frames);
 
-  /* create a copy of the frames to be replaced */
   size_t num_frames =
     (size_t) (end.frames - start.frames);
   g_debug ("num frames %zu", num_frames);
 
-  /* interleaved frames */
-  size_t channels = orig_clip->channels;
-  float frames[num_frames * channels];
-  dsp_copy (
-    &frames[0],
-    &orig_clip->frames[start.frames * (long) channels],
-    num_frames * channels);
+  /* edits only replace the chunks they touch, so
+   * the versions of the clip kept for undo share
+   * the rest */
+  audio_clip_ensure_chunks (orig_clip);
+  g_return_val_if_fail (
+    orig_clip->num_chunks > 0, -1);
 
-  switch (type)
+  if (type != AUDIO_FUNCTION_INVALID)
     {
-    case AUDIO_FUNCTION_INVERT:
-      dsp_mul_k2 (
-        &frames[0], -1.f, num_frames * channels);
-      break;
-    case AUDIO_FUNCTION_NORMALIZE:
-      /* peak-normalize */
-      {
-        float abs_peak = 0.f;
-        dsp_abs_max (
-          &frames[0], &abs_peak,
-          num_frames * channels);
-        dsp_mul_k2 (
-          &frames[0], 1.f / abs_peak,
-          num_frames * channels);
-      }
-      break;
-    case AUDIO_FUNCTION_REVERSE:
-      for (size_t i = 0; i < num_frames; i++)
-        {
-          for (size_t j = 0; j < channels; j++)
-            {
-              frames[i * channels + j] =
-                orig_clip->frames[
-                  ((size_t) start.frames +
-                   ((num_frames - i) - 1)) *
-                    channels + j];
-            }
-        }
-      break;
-    case AUDIO_FUNCTION_INVALID:
-      /* do nothing */
-      break;
-    default:
-      g_warning ("not implemented");
-      break;
-    }
-
-#if 0
-  char * tmp =
-    g_strdup_printf (
-      "%s - %s - %s",
-      tr->name, r->name,
-      audio_function_type_to_string (type));
+      int ret =
+        apply_to_range (
+          orig_clip, type, (size_t) start.frames,
+          num_frames);
+      if (ret != 0)
+        return -1;
 
-  /* remove dots from name */
-  char * name = string_replace (tmp, ".", "_");
-  g_free (tmp);
-#endif
+      r->last_clip_change = g_get_monotonic_time ();
+    }
 
+  /* keep the current state of the clip (this only
+   * references its chunks) */
   AudioClip * clip =
-    audio_clip_new_from_float_array (
-      &frames[0], (long) num_frames,
-      channels, BIT_DEPTH_32, orig_clip->name);
+    audio_clip_new_version (orig_clip);
+  g_return_val_if_fail (clip, -1);
   audio_pool_add_clip (AUDIO_POOL, clip);
   g_message (
-    "writing %s to pool (id %d)",
+    "added %s to pool (id %d)",
     clip->name, clip->pool_id);
-  audio_clip_write_to_pool (
-    clip, false, F_NOT_BACKUP);
 
-  audio_sel->pool_id = clip->pool_id;
+  /* the clip is written to the pool when the
+   * project is saved */
 
-  if (type != AUDIO_FUNCTION_INVALID)
-    {
-      /* replace the frames in the region */
-      audio_region_replace_frames (
-        r, frames, (size_t) start.frames,
-        num_frames, F_NO_DUPLICATE_CLIP);
-      r->last_clip_change = g_get_monotonic_time ();
-    }
+  audio_sel->pool_id = clip->pool_id;
 
   if (!ZRYTHM_TESTING)
     {
@@ -243,12 +243,8 @@ audio_region_replace_frames (
       self->pool_id = clip->pool_id;
     }
 
-  dsp_copy (
-    &clip->frames[start_frame * clip->channels],
-    frames, num_frames * clip->channels);
-
-  audio_clip_write_to_pool (
-    clip, false, F_NOT_BACKUP);
+  audio_clip_replace_frames (
+    clip, frames, start_frame, num_frames);
 }
 
 static void
@@ -0,0 +1,661 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "audio/automation_envelope.h"
+#include "audio/automation_point.h"
+#include "audio/automation_track.h"
+#include "audio/region.h"
+#include "gui/backend/arranger_object.h"
+#include "utils/objects.h"
+
+#include <glib.h>
+
+/**
+ * Max number of segments or points to step
+ * through linearly before falling back to a
+ * binary search.
+ */
+#define MAX_LINEAR_STEPS 8
+
+static AutomationEnvelopeSegment *
+append_segment (
+  AutomationEnvelopeSegments * self,
+  long                         start_frames)
+{
+  if ((size_t) self->num_segments ==
+        self->segments_size)
+    {
+      size_t new_size =
+        self->segments_size == 0 ?
+          16 : self->segments_size * 2;
+      self->segments =
+        object_realloc_n (
+          self->segments, self->segments_size,
+          new_size, AutomationEnvelopeSegment);
+      self->segments_size = new_size;
+    }
+
+  AutomationEnvelopeSegment * seg =
+    &self->segments[self->num_segments++];
+  object_set_to_zero (seg);
+  seg->start_frames = start_frames;
+
+  return seg;
+}
+
+static void
+append_gap (
+  AutomationEnvelopeSegments * self,
+  long                         start_frames)
+{
+  /* merge with previous gap */
+  if (self->num_segments > 0 &&
+      self->segments[self->num_segments - 1].type ==
+        AUTOMATION_ENVELOPE_SEGMENT_GAP)
+    return;
+
+  AutomationEnvelopeSegment * seg =
+    append_segment (self, start_frames);
+  seg->type = AUTOMATION_ENVELOPE_SEGMENT_GAP;
+}
+
+/**
+ * Fills in the curve of the automation point at
+ * the given index.
+ */
+static void
+set_point_from_ap (
+  AutomationEnvelopePoint * pt,
+  ZRegion *                 r,
+  int                       ap_idx)
+{
+  AutomationPoint * ap = r->aps[ap_idx];
+  AutomationPoint * next_ap =
+    ap_idx < r->num_aps - 1 ?
+      r->aps[ap_idx + 1] : NULL;
+
+  object_set_to_zero (pt);
+  pt->local_frames =
+    ((ArrangerObject *) ap)->pos.frames;
+  pt->curve_opts = ap->curve_opts;
+  if (!next_ap)
+    {
+      pt->base_val = ap->normalized_val;
+      return;
+    }
+
+  long len =
+    ((ArrangerObject *) next_ap)->pos.frames -
+    ((ArrangerObject *) ap)->pos.frames;
+  pt->start_higher =
+    next_ap->normalized_val < ap->normalized_val;
+  pt->base_val =
+    MIN (ap->normalized_val,
+      next_ap->normalized_val);
+  pt->diff =
+    fabsf (
+      ap->normalized_val - next_ap->normalized_val);
+  pt->inv_length =
+    len > 0 ? 1.0 / (double) len : 0.0;
+}
+
+static float
+get_point_val (
+  const AutomationEnvelopePoint * pt,
+  long                            local_frames)
+{
+  if (pt->inv_length == 0.0)
+    return pt->base_val;
+
+  double ratio =
+    (double) (local_frames - pt->local_frames) *
+    pt->inv_length;
+  ratio = CLAMP (ratio, 0.0, 1.0);
+
+  return
+    pt->base_val +
+    pt->diff *
+      (float)
+      curve_get_normalized_y (
+        ratio, (CurveOptions *) &pt->curve_opts,
+        pt->start_higher);
+}
+
+/**
+ * Maps the timeline frames to region-local frames,
+ * wrapping them into the loop.
+ *
+ * Same as region_timeline_frames_to_local() with
+ * normalization.
+ */
+static inline long
+get_local_frames (
+  const AutomationEnvelopeSegment * seg,
+  long                              frames)
+{
+  long local =
+    (frames - seg->region_start_frames) +
+    seg->clip_start_frames;
+  if (local >= seg->loop_end_frames)
+    {
+      long loop_size =
+        seg->loop_end_frames -
+        seg->loop_start_frames;
+      long num_loops =
+        (local - seg->loop_end_frames) /
+          loop_size + 1;
+      local -= num_loops * loop_size;
+    }
+
+  return local;
+}
+
+/**
+ * Returns the index (in the segment) of the last
+ * point at or before the given local frames, or
+ * -1.
+ */
+static int
+seek_point (
+  const AutomationEnvelope *        self,
+  const AutomationEnvelopeSegment * seg,
+  long                              local_frames)
+{
+  const AutomationEnvelopePoint * pts =
+    &self->points[seg->first_point];
+  int lo = 0, hi = seg->num_points - 1, ret = -1;
+  while (lo <= hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+      if (pts[mid].local_frames <= local_frames)
+        {
+          ret = mid;
+          lo = mid + 1;
+        }
+      else
+        {
+          hi = mid - 1;
+        }
+    }
+
+  return ret;
+}
+
+/**
+ * Returns the index of the last segment starting
+ * at or before the given frames, or -1.
+ */
+static int
+seek_segment (
+  const AutomationEnvelopeSegments * segs,
+  long                               frames)
+{
+  int lo = 0, hi = segs->num_segments - 1, ret = -1;
+  while (lo <= hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+      if (segs->segments[mid].start_frames <= frames)
+        {
+          ret = mid;
+          lo = mid + 1;
+        }
+      else
+        {
+          hi = mid - 1;
+        }
+    }
+
+  return ret;
+}
+
+static void
+set_segment_region (
+  AutomationEnvelopeSegment * seg,
+  ZRegion *                   r,
+  int                         first_point)
+{
+  ArrangerObject * r_obj = (ArrangerObject *) r;
+  seg->type = AUTOMATION_ENVELOPE_SEGMENT_REGION;
+  seg->region_start_frames = r_obj->pos.frames;
+  seg->clip_start_frames =
+    r_obj->clip_start_pos.frames;
+  seg->loop_start_frames =
+    r_obj->loop_start_pos.frames;
+  seg->loop_end_frames = r_obj->loop_end_pos.frames;
+  seg->first_point = first_point;
+  seg->num_points = r->num_aps;
+}
+
+/**
+ * Returns whether the region can be compiled.
+ */
+static bool
+is_region_valid (
+  ZRegion * r)
+{
+  ArrangerObject * r_obj = (ArrangerObject *) r;
+  return
+    arranger_object_get_loop_length_in_frames (
+      r_obj) > 0 &&
+    r_obj->end_pos.frames >= r_obj->pos.frames;
+}
+
+static int
+cmp_long (
+  const void * a,
+  const void * b)
+{
+  long la = *(const long *) a;
+  long lb = *(const long *) b;
+  return (la > lb) - (la < lb);
+}
+
+/**
+ * Returns the index of the region that
+ * automation_track_get_region_before_pos() would
+ * return at the given frames, or -1.
+ */
+static int
+get_region_idx_at (
+  AutomationTrack * at,
+  long              frames,
+  bool              ends_after)
+{
+  if (ends_after)
+    {
+      for (int i = at->num_regions - 1; i >= 0; i--)
+        {
+          ArrangerObject * r_obj =
+            (ArrangerObject *) at->regions[i];
+          if (r_obj->pos.frames <= frames &&
+              r_obj->end_pos.frames >= frames)
+            return i;
+        }
+      return -1;
+    }
+
+  int latest_idx = -1;
+  long latest_end = LONG_MIN;
+  for (int i = at->num_regions - 1; i >= 0; i--)
+    {
+      ArrangerObject * r_obj =
+        (ArrangerObject *) at->regions[i];
+      if (r_obj->pos.frames <= frames &&
+          r_obj->end_pos.frames > latest_end)
+        {
+          latest_end = r_obj->end_pos.frames;
+          latest_idx = i;
+        }
+    }
+  return latest_idx;
+}
+
+static void
+compile_segments (
+  AutomationEnvelope *         env,
+  AutomationEnvelopeSegments * self,
+  AutomationTrack *            at,
+  const int *                  first_points,
+  const long *                 bounds,
+  int                          num_bounds,
+  bool                         ends_after)
+{
+  for (int i = 0; i < num_bounds; i++)
+    {
+      long start = bounds[i];
+      int r_idx =
+        get_region_idx_at (at, start, ends_after);
+      ZRegion * r =
+        r_idx >= 0 ? at->regions[r_idx] : NULL;
+      if (!r ||
+          arranger_object_get_muted (
+            (ArrangerObject *) r) ||
+          !is_region_valid (r))
+        {
+          append_gap (self, start);
+          continue;
+        }
+
+      /* region end is inclusive, and the bounds
+       * include the frame after each region end,
+       * so the segment never goes past it */
+      ArrangerObject * r_obj = (ArrangerObject *) r;
+      AutomationEnvelopeSegment region_seg;
+      object_set_to_zero (&region_seg);
+      set_segment_region (
+        &region_seg, r, first_points[r_idx]);
+      if (start <= r_obj->end_pos.frames)
+        {
+          AutomationEnvelopeSegment * seg =
+            append_segment (self, start);
+          *seg = region_seg;
+          seg->start_frames = start;
+          continue;
+        }
+
+      /* hold the value at the last frame of the
+       * region */
+      long local =
+        get_local_frames (
+          &region_seg, r_obj->end_pos.frames - 1);
+      int pt_idx =
+        seek_point (env, &region_seg, local);
+      if (pt_idx < 0)
+        {
+          append_gap (self, start);
+          continue;
+        }
+
+      AutomationEnvelopeSegment * seg =
+        append_segment (self, start);
+      seg->type = AUTOMATION_ENVELOPE_SEGMENT_HOLD;
+      seg->hold_val =
+        get_point_val (
+          &env->points[region_seg.first_point + pt_idx],
+          local);
+    }
+}
+
+AutomationEnvelope *
+automation_envelope_new_from_automation_track (
+  AutomationTrack * at)
+{
+  AutomationEnvelope * self =
+    object_new (AutomationEnvelope);
+
+  if (at->num_regions == 0)
+    return self;
+
+  /* compile the points of each region once, in
+   * local frames */
+  int * first_points =
+    object_new_n ((size_t) at->num_regions, int);
+  int total_points = 0;
+  for (int i = 0; i < at->num_regions; i++)
+    {
+      total_points += at->regions[i]->num_aps;
+    }
+  self->points =
+    object_new_n (
+      (size_t) MAX (total_points, 1),
+      AutomationEnvelopePoint);
+  for (int i = 0; i < at->num_regions; i++)
+    {
+      ZRegion * r = at->regions[i];
+      first_points[i] = self->num_points;
+      for (int j = 0; j < r->num_aps; j++)
+        {
+          set_point_from_ap (
+            &self->points[self->num_points++], r, j);
+        }
+    }
+
+  /* the region chosen only changes at region
+   * starts and right after region ends */
+  int num_bounds = 0;
+  long * bounds =
+    object_new_n (
+      (size_t) at->num_regions * 2, long);
+  for (int i = 0; i < at->num_regions; i++)
+    {
+      ArrangerObject * r_obj =
+        (ArrangerObject *) at->regions[i];
+      bounds[num_bounds++] = r_obj->pos.frames;
+      bounds[num_bounds++] =
+        r_obj->end_pos.frames + 1;
+    }
+  qsort (
+    bounds, (size_t) num_bounds, sizeof (long),
+    cmp_long);
+  int num_unique = 0;
+  for (int i = 0; i < num_bounds; i++)
+    {
+      if (num_unique == 0 ||
+          bounds[num_unique - 1] != bounds[i])
+        bounds[num_unique++] = bounds[i];
+    }
+
+  compile_segments (
+    self, &self->surrounding, at, first_points,
+    bounds, num_unique, true);
+  compile_segments (
+    self, &self->latest, at, first_points,
+    bounds, num_unique, false);
+
+  free (bounds);
+  free (first_points);
+
+  return self;
+}
+
+bool
+automation_envelope_get_normalized_val (
+  const AutomationEnvelope * self,
+  AutomationEnvelopeCursor * cursor,
+  long                       frames,
+  bool                       ends_after,
+  float *                    val)
+{
+  const AutomationEnvelopeSegments * segs =
+    ends_after ? &self->surrounding : &self->latest;
+  if (segs->num_segments == 0)
+    return false;
+
+  /* the index is checked too in case a new
+   * envelope was allocated at the address of a
+   * freed one */
+  bool moving_forward =
+    cursor->env == self &&
+    cursor->ends_after == ends_after &&
+    frames >= cursor->frames &&
+    cursor->seg_idx < segs->num_segments &&
+    (cursor->seg_idx < 0 ||
+     segs->segments[cursor->seg_idx].start_frames <=
+       frames);
+  int seg_idx;
+  if (moving_forward)
+    {
+      seg_idx = cursor->seg_idx;
+      int steps = 0;
+      while (seg_idx + 1 < segs->num_segments &&
+             segs->segments[seg_idx + 1].
+               start_frames <= frames)
+        {
+          if (++steps > MAX_LINEAR_STEPS)
+            {
+              seg_idx = seek_segment (segs, frames);
+              break;
+            }
+          seg_idx++;
+        }
+    }
+  else
+    {
+      /* jumped backwards (eg, loop) or the
+       * envelope changed */
+      seg_idx = seek_segment (segs, frames);
+    }
+  bool same_seg =
+    moving_forward && seg_idx == cursor->seg_idx;
+
+  cursor->env = self;
+  cursor->ends_after = ends_after;
+  cursor->seg_idx = seg_idx;
+  cursor->frames = frames;
+
+  if (seg_idx < 0)
+    return false;
+
+  const AutomationEnvelopeSegment * seg =
+    &segs->segments[seg_idx];
+  switch (seg->type)
+    {
+    case AUTOMATION_ENVELOPE_SEGMENT_GAP:
+      return false;
+    case AUTOMATION_ENVELOPE_SEGMENT_HOLD:
+      *val = seg->hold_val;
+      return true;
+    case AUTOMATION_ENVELOPE_SEGMENT_REGION:
+      break;
+    }
+
+  long local = get_local_frames (seg, frames);
+  const AutomationEnvelopePoint * pts =
+    &self->points[seg->first_point];
+  int pt_idx;
+  if (same_seg &&
+      local >= cursor->local_frames &&
+      cursor->point_idx < seg->num_points)
+    {
+      pt_idx = cursor->point_idx;
+      int steps = 0;
+      while (pt_idx + 1 < seg->num_points &&
+             pts[pt_idx + 1].local_frames <= local)
+        {
+          if (++steps > MAX_LINEAR_STEPS)
+            {
+              pt_idx = seek_point (self, seg, local);
+              break;
+            }
+          pt_idx++;
+        }
+    }
+  else
+    {
+      /* the region looped back or the segment
+       * changed */
+      pt_idx = seek_point (self, seg, local);
+    }
+  cursor->point_idx = pt_idx;
+  cursor->local_frames = local;
+
+  if (pt_idx < 0)
+    return false;
+
+  *val = get_point_val (&pts[pt_idx], local);
+
+  return true;
+}
+
+bool
+automation_envelope_get_next_change (
+  const AutomationEnvelope * self,
+  long                       frames,
+  bool                       ends_after,
+  long *                     change_frames)
+{
+  const AutomationEnvelopeSegments * segs =
+    ends_after ? &self->surrounding : &self->latest;
+  int seg_idx = seek_segment (segs, frames);
+  long next = LONG_MAX;
+  const AutomationEnvelopeSegment * next_seg =
+    seg_idx + 1 < segs->num_segments ?
+      &segs->segments[seg_idx + 1] : NULL;
+  if (next_seg)
+    {
+      next = next_seg->start_frames;
+    }
+
+  const AutomationEnvelopeSegment * seg =
+    seg_idx >= 0 ? &segs->segments[seg_idx] : NULL;
+  if (seg &&
+      seg->type == AUTOMATION_ENVELOPE_SEGMENT_REGION)
+    {
+      long local = get_local_frames (seg, frames);
+      const AutomationEnvelopePoint * pts =
+        &self->points[seg->first_point];
+      int pt_idx = seek_point (self, seg, local);
+      if (pt_idx >= 0)
+        {
+          const AutomationEnvelopePoint * pt =
+            &pts[pt_idx];
+          if (pt->inv_length > 0.0 &&
+              pt->diff > 0.f &&
+              local <
+                pt->local_frames +
+                  (long) (1.0 / pt->inv_length))
+            {
+              *change_frames = frames + 1;
+              return true;
+            }
+        }
+
+      /* points after the loop end are never
+       * reached */
+      if (pt_idx + 1 < seg->num_points &&
+          pts[pt_idx + 1].local_frames <
+            seg->loop_end_frames)
+        {
+          next =
+            MIN (
+              next,
+              frames +
+                (pts[pt_idx + 1].local_frames - local));
+        }
+
+      /* the region loops back */
+      next =
+        MIN (
+          next,
+          frames + (seg->loop_end_frames - local));
+    }
+  else if (
+    next_seg &&
+    next_seg->type ==
+      AUTOMATION_ENVELOPE_SEGMENT_REGION &&
+    next_seg->num_points > 0)
+    {
+      /* a region that starts before its first
+       * point continues the gap until that
+       * point */
+      long local =
+        get_local_frames (
+          next_seg, next_seg->start_frames);
+      const AutomationEnvelopePoint * first_pt =
+        &self->points[next_seg->first_point];
+      if (seek_point (self, next_seg, local) < 0 &&
+          first_pt->local_frames <
+            next_seg->loop_end_frames)
+        {
+          next +=
+            first_pt->local_frames - local;
+        }
+    }
+
+  if (next == LONG_MAX)
+    return false;
+
+  *change_frames = next;
+  return true;
+}
+
+void
+automation_envelope_free (
+  AutomationEnvelope * self)
+{
+  free (self->points);
+  free (self->surrounding.segments);
+  free (self->latest.segments);
+
+  object_zero_and_free (self);
+}
@@ -234,6 +234,8 @@ automation_point_set_fvalue (
   g_return_if_fail (region);
   control_port_set_val_from_normalized (
     port, self->normalized_val, 1);
+  automation_track_invalidate_envelope_for_region_id (
+    &region->id);
 
   if (pub_events)
     {
@@ -292,6 +294,8 @@ automation_point_set_curviness (
     return;
 
   self->curve_opts.curviness = curviness;
+  automation_track_invalidate_envelope_for_region_id (
+    &((ArrangerObject *) self)->region_id);
 }
 
 /**
@@ -21,8 +21,10 @@
 
 #include "audio/automation_point.h"
 #include "audio/automation_region.h"
+#include "audio/automation_track.h"
 #include "audio/position.h"
 #include "audio/region.h"
+#include "audio/region_content.h"
 #include "gui/backend/automation_selections.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
@@ -125,6 +127,10 @@ automation_region_force_sort (
       automation_point_set_region_and_index (
         self->aps[i], self, i);
     }
+  region_content_sync (self);
+
+  automation_track_invalidate_envelope_for_region_id (
+    &self->id);
 }
 
 /**
@@ -279,6 +285,8 @@ automation_region_remove_ap (
 
   array_delete (
     self->aps, self->num_aps, ap);
+  automation_track_invalidate_envelope_for_region_id (
+    &self->id);
 
   if (!freeing_region)
     {
@@ -288,6 +296,7 @@ automation_region_remove_ap (
             self->aps[i], self, i);
         }
     }
+  region_content_sync (self);
 
   if (free)
     {
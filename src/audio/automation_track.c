@@ -23,8 +23,11 @@
 #include "audio/automation_point.h"
 #include "audio/automation_region.h"
 #include "audio/control_port.h"
+#include "audio/automation_tracklist.h"
 #include "audio/instrument_track.h"
+#include "audio/region_content.h"
 #include "audio/track.h"
+#include "audio/tracklist.h"
 #include "gui/backend/event_manager.h"
 #include "gui/widgets/arranger.h"
 #include "gui/widgets/center_dock.h"
@@ -35,8 +38,10 @@
 #include "project.h"
 #include "utils/arrays.h"
 #include "utils/flags.h"
+#include "utils/handle_table.h"
 #include "utils/math.h"
 #include "utils/mem.h"
+#include "utils/object_utils.h"
 #include "utils/objects.h"
 #include "utils/string.h"
 #include "zrythm_app.h"
@@ -72,6 +77,8 @@ automation_track_init_loaded (
       arranger_object_init_loaded (
         (ArrangerObject *) region);
     }
+
+  automation_track_update_envelope (self, true);
 }
 
 AutomationTrack *
@@ -264,6 +271,8 @@ automation_track_insert_region (
   region_set_automation_track (region, self);
   region->id.idx = idx;
   region_update_identifier (region);
+
+  automation_track_invalidate_envelope (self);
 }
 
 AutomationTracklist *
@@ -386,6 +395,11 @@ automation_track_get_ap_before_pos (
  * Finds the AutomationTrack associated with
  * `port`.
  *
+ * The owner of the port is resolved through the
+ * handle table if the port has owner handles, in
+ * which case NULL is returned if the owner was
+ * removed.
+ *
  * @param track The track that owns the port, if
  *   known.
  */
@@ -395,9 +409,27 @@ automation_track_find_from_port (
   Track * track,
   bool    basic_search)
 {
+  PortIdentifier * id = &port->id;
+  if (object_handle_is_set (&id->plugin_handle) &&
+      !handle_table_get (
+        HANDLE_TABLE, &id->plugin_handle))
+    return NULL;
+
   if (!track)
     {
-      track = port_get_track (port, 1);
+      if (object_handle_is_set (
+            &id->track_handle))
+        {
+          track =
+            handle_table_get (
+              HANDLE_TABLE, &id->track_handle);
+          if (!track)
+            return NULL;
+        }
+      else
+        {
+          track = port_get_track (port, 1);
+        }
     }
   g_return_val_if_fail (track, NULL);
 
@@ -631,6 +663,8 @@ automation_track_remove_region (
       r->id.idx = i;
       region_update_identifier (r);
     }
+
+  automation_track_invalidate_envelope (self);
 }
 
 /**
@@ -833,6 +867,249 @@ automation_track_update_frames (
       arranger_object_update_frames (
         (ArrangerObject *) self->regions[i]);
     }
+
+  automation_track_invalidate_envelope (self);
+}
+
+/**
+ * Returns the normalized parameter value at the
+ * given timeline frames.
+ *
+ * This uses the compiled envelope if it is up to
+ * date, otherwise it falls back to
+ * automation_track_get_val_at_pos().
+ *
+ * @param ends_after See
+ *   automation_track_get_val_at_pos().
+ * @param[out] val The normalized value.
+ *
+ * @return Whether there is automation at the
+ *   given position.
+ */
+bool
+automation_track_get_normalized_val_at_frames (
+  AutomationTrack * self,
+  long              frames,
+  bool              ends_after,
+  float *           val)
+{
+  AutomationEnvelope * envelope =
+    (AutomationEnvelope *)
+    g_atomic_pointer_get (&self->envelope);
+  if (G_LIKELY (
+        envelope &&
+        !g_atomic_int_get (&self->envelope_dirty)))
+    {
+      return
+        automation_envelope_get_normalized_val (
+          envelope, &self->envelope_cursor, frames,
+          ends_after, val);
+    }
+
+  Position pos;
+  position_from_frames (&pos, frames);
+  AutomationPoint * ap =
+    automation_track_get_ap_before_pos (
+      self, &pos, ends_after);
+  if (!ap)
+    return false;
+
+  *val =
+    automation_track_get_val_at_pos (
+      self, &pos, true, ends_after);
+  return true;
+}
+
+/**
+ * Returns the timeline frames of the next value
+ * change after the given frames, using the
+ * compiled envelope.
+ *
+ * @see automation_envelope_get_next_change().
+ *
+ * @return Whether a change was found. This is
+ *   false if the envelope is out of date.
+ */
+bool
+automation_track_get_next_change_frames (
+  AutomationTrack * self,
+  long              frames,
+  bool              ends_after,
+  long *            change_frames)
+{
+  AutomationEnvelope * envelope =
+    (AutomationEnvelope *)
+    g_atomic_pointer_get (&self->envelope);
+  if (!envelope ||
+      g_atomic_int_get (&self->envelope_dirty))
+    return false;
+
+  return
+    automation_envelope_get_next_change (
+      envelope, frames, ends_after, change_frames);
+}
+
+/**
+ * Whether envelopes were invalidated and not
+ * recompiled yet.
+ */
+static volatile gint envelope_update_pending = 0;
+
+static int
+update_pending_envelopes_idle (
+  void * data)
+{
+  automation_track_update_pending_envelopes ();
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * Marks the compiled envelope as out of date and
+ * schedules recompiling it in the GTK thread.
+ *
+ * To be called when the regions or automation
+ * points of the track change.
+ *
+ * This is realtime-safe: when not called from the
+ * GTK thread, the envelope is recompiled by
+ * engine_process_events() instead.
+ */
+void
+automation_track_invalidate_envelope (
+  AutomationTrack * self)
+{
+  g_atomic_int_set (&self->envelope_dirty, 1);
+
+  /* one update handles all the envelopes
+   * invalidated until it runs */
+  if (!g_atomic_int_compare_and_exchange (
+         &envelope_update_pending, 0, 1))
+    return;
+
+  /* g_idle_add() may allocate, so leave it to
+   * engine_process_events() if this is not the
+   * GTK thread (eg, BPM changes from the engine) */
+  if (!zrythm_app ||
+      g_thread_self () != zrythm_app->gtk_thread)
+    return;
+
+  g_idle_add (
+    (GSourceFunc) update_pending_envelopes_idle,
+    NULL);
+}
+
+/**
+ * Recompiles the out of date envelopes of all the
+ * automation tracks in the project, if any were
+ * invalidated since the last call.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+automation_track_update_pending_envelopes (void)
+{
+  if (!g_atomic_int_compare_and_exchange (
+         &envelope_update_pending, 1, 0))
+    return;
+
+  if (!PROJECT || !TRACKLIST)
+    return;
+
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      AutomationTracklist * atl =
+        track_get_automation_tracklist (
+          TRACKLIST->tracks[i]);
+      if (!atl)
+        continue;
+
+      automation_tracklist_update_envelopes (
+        atl, false);
+    }
+}
+
+/**
+ * Marks the compiled envelope of the automation
+ * track referenced by the given region identifier
+ * as out of date, if such a track exists.
+ */
+void
+automation_track_invalidate_envelope_for_region_id (
+  const RegionIdentifier * id)
+{
+  /* objects that are not part of the project
+   * (eg, clones in the undo history) may point to
+   * tracks that don't exist, so don't warn */
+  if (id->type != REGION_TYPE_AUTOMATION ||
+      !PROJECT || !TRACKLIST ||
+      id->track_pos < 0 ||
+      id->track_pos >= TRACKLIST->num_tracks)
+    return;
+
+  Track * track = TRACKLIST->tracks[id->track_pos];
+  if (!track)
+    return;
+
+  AutomationTracklist * atl =
+    &track->automation_tracklist;
+  if (id->at_idx < 0 || id->at_idx >= atl->num_ats)
+    return;
+
+  AutomationTrack * at = atl->ats[id->at_idx];
+  automation_track_invalidate_envelope (at);
+
+  /* linked regions on other automation tracks
+   * share the automation points */
+  if (id->idx < 0 || id->idx >= at->num_regions ||
+      !at->regions[id->idx]->content)
+    return;
+
+  RegionContent * content =
+    at->regions[id->idx]->content;
+  for (int i = 0; i < content->num_regions; i++)
+    {
+      AutomationTrack * linked_at =
+        region_get_automation_track (
+          content->regions[i]);
+      if (linked_at && linked_at != at)
+        automation_track_invalidate_envelope (
+          linked_at);
+    }
+}
+
+/**
+ * Recompiles the envelope if it is out of date
+ * (or if \ref force is true) and publishes it.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+automation_track_update_envelope (
+  AutomationTrack * self,
+  bool              force)
+{
+  if (!force && self->envelope &&
+      !g_atomic_int_get (&self->envelope_dirty))
+    return;
+
+  /* clear the flag before compiling so that edits
+   * made while compiling are not lost */
+  g_atomic_int_set (&self->envelope_dirty, 0);
+  AutomationEnvelope * envelope =
+    automation_envelope_new_from_automation_track (
+      self);
+  AutomationEnvelope * prev_envelope =
+    self->envelope;
+  g_atomic_pointer_set (&self->envelope, envelope);
+
+  /* the processing thread may still be using the
+   * previous envelope */
+  if (prev_envelope)
+    {
+      free_later (
+        prev_envelope, automation_envelope_free);
+    }
 }
 
 /**
@@ -954,5 +1231,8 @@ automation_track_free (AutomationTrack * self)
     }
   object_zero_and_free (self->regions);
 
+  object_free_w_func_and_null (
+    automation_envelope_free, self->envelope);
+
   object_zero_and_free (self);
 }
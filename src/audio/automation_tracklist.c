@@ -398,6 +398,24 @@ automation_tracklist_update_frames (
     }
 }
 
+/**
+ * Recompiles the envelopes of the automation
+ * tracks that are out of date.
+ *
+ * @param force Recompile all envelopes.
+ */
+void
+automation_tracklist_update_envelopes (
+  AutomationTracklist * self,
+  bool                  force)
+{
+  for (int i = 0; i < self->num_ats; i++)
+    {
+      automation_track_update_envelope (
+        self->ats[i], force);
+    }
+}
+
 /**
  * Gets the currently visible AutomationTrack's
  * (regardless of whether the automation tracklist
@@ -23,6 +23,7 @@
 #include "audio/chord_object.h"
 #include "audio/chord_track.h"
 #include "audio/position.h"
+#include "audio/region_content.h"
 #include "gui/widgets/chord_object.h"
 #include "project.h"
 #include "utils/flags.h"
@@ -138,5 +139,7 @@ chord_object_get_region (
   ChordObject * self)
 {
   ArrangerObject * obj = (ArrangerObject *) self;
-  return region_find (&obj->region_id);
+  return
+    region_content_get_region_for_editor (
+      region_find (&obj->region_id));
 }
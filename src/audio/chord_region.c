@@ -20,6 +20,7 @@
 #include "audio/chord_region.h"
 #include "audio/chord_object.h"
 #include "audio/chord_track.h"
+#include "audio/region_content.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
 #include "project.h"
@@ -95,6 +96,7 @@ chord_region_insert_chord_object (
       chord_object_set_region_and_index (
         co, self, i);
     }
+  region_content_sync (self);
 
   if (fire_events)
     {
@@ -161,6 +163,7 @@ chord_region_remove_chord_object (
       chord_object_set_region_and_index (
         self->chord_objects[i], self, i);
     }
+  region_content_sync (self);
 
   if (free)
     {
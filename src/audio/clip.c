@@ -20,19 +20,23 @@
 #include <stdlib.h>
 
 #include "audio/clip.h"
+#include "audio/clip_chunk.h"
 #include "audio/encoder.h"
 #include "audio/engine.h"
 #include "audio/tempo_track.h"
 #include "project.h"
+#include "utils/arrays.h"
 #include "utils/audio.h"
 #include "utils/dsp.h"
 #include "utils/file.h"
 #include "utils/flags.h"
 #include "utils/hash.h"
+#include "utils/hash_cache.h"
 #include "utils/io.h"
 #include "utils/math.h"
 #include "utils/objects.h"
 #include "utils/string.h"
+#include "zrythm.h"
 #include "zrythm_app.h"
 
 #include <gtk/gtk.h>
@@ -43,6 +47,7 @@ _create ()
   AudioClip * self = object_new (AudioClip);
   self->schema_version =
     AUDIO_CLIP_SCHEMA_VERSION;
+  self->dirty = true;
 
   return self;
 }
@@ -137,6 +142,84 @@ audio_clip_init_from_file (
   audio_encoder_free (enc);
 }
 
+/**
+ * Copies the frames of the chunk at the given
+ * index to the frames and channel caches.
+ */
+static void
+copy_chunk_to_frames (
+  AudioClip * self,
+  int         idx)
+{
+  ClipChunk * chunk = self->chunks[idx];
+  size_t start_frame =
+    (size_t) idx * CLIP_CHUNK_FRAMES;
+  g_return_if_fail (
+    start_frame + (size_t) chunk->num_frames <=
+      (size_t) self->num_frames);
+
+  if (!chunk->frames)
+    {
+      g_warning (
+        "chunk %s of clip %s has no frames",
+        chunk->hash, self->name);
+      return;
+    }
+
+  dsp_copy (
+    &self->frames[start_frame * self->channels],
+    chunk->frames,
+    (size_t) chunk->num_frames * self->channels);
+  for (unsigned int i = 0; i < self->channels; i++)
+    {
+      for (size_t j = start_frame;
+           j < start_frame + (size_t) chunk->num_frames;
+           j++)
+        {
+          self->ch_frames[i][j] =
+            self->frames[j * self->channels + i];
+        }
+    }
+}
+
+/**
+ * Sets up the frames of a clip from its chunks.
+ */
+static void
+init_from_chunks (
+  AudioClip * self)
+{
+  g_return_if_fail (self->num_chunks > 0);
+
+  self->channels = self->chunks[0]->channels;
+  self->num_frames = 0;
+  for (int i = 0; i < self->num_chunks; i++)
+    {
+      self->num_frames +=
+        self->chunks[i]->num_frames;
+    }
+
+  size_t num_samples =
+    (size_t) self->num_frames * self->channels;
+  self->frames =
+    g_realloc (
+      self->frames, num_samples * sizeof (float));
+  dsp_fill (self->frames, 0.f, num_samples);
+  for (unsigned int i = 0; i < self->channels; i++)
+    {
+      self->ch_frames[i] =
+        g_realloc (
+          self->ch_frames[i],
+          sizeof (float) *
+            (size_t) self->num_frames);
+    }
+
+  for (int i = 0; i < self->num_chunks; i++)
+    {
+      copy_chunk_to_frames (self, i);
+    }
+}
+
 /**
  * Inits after loading a Project.
  */
@@ -147,6 +230,14 @@ audio_clip_init_loaded (
   g_debug (
     "%s: %p", __func__, self);
 
+  if (self->num_chunks > 0)
+    {
+      /* the chunks are loaded by the pool */
+      init_from_chunks (self);
+      self->dirty = false;
+      return;
+    }
+
   char * filepath =
     audio_clip_get_path_in_pool_from_name (
       self->name, self->use_flac, F_NOT_BACKUP);
@@ -155,6 +246,9 @@ audio_clip_init_loaded (
   audio_clip_init_from_file (self, filepath);
   self->bpm = bpm;
 
+  /* the frames are the ones in the pool */
+  self->dirty = false;
+
   g_free (filepath);
 }
 
@@ -309,7 +403,225 @@ audio_clip_get_path_in_pool (
 }
 
 /**
- * Writes the clip to the pool as a wav file.
+ * Splits the frames of the clip into chunks, if
+ * not already split.
+ */
+void
+audio_clip_ensure_chunks (
+  AudioClip * self)
+{
+  if (self->num_chunks > 0)
+    return;
+
+  g_return_if_fail (
+    self->frames && self->num_frames > 0);
+
+  size_t num_frames = (size_t) self->num_frames;
+  self->chunks_size =
+    (num_frames + CLIP_CHUNK_FRAMES - 1) /
+    CLIP_CHUNK_FRAMES;
+  self->chunks =
+    object_new_n (self->chunks_size, ClipChunk *);
+  for (size_t i = 0; i < num_frames;
+       i += CLIP_CHUNK_FRAMES)
+    {
+      size_t chunk_frames =
+        MIN (
+          (size_t) CLIP_CHUNK_FRAMES,
+          num_frames - i);
+      ClipChunk * chunk =
+        clip_chunk_new (
+          &self->frames[i * self->channels],
+          chunk_frames, self->channels);
+      array_append (
+        self->chunks, self->num_chunks, chunk);
+    }
+
+  /* the clip is now stored as chunks */
+  self->dirty = true;
+}
+
+/**
+ * Creates a clip that shares the current chunks of
+ * the given clip.
+ *
+ * The new clip has no frames, so this is cheap
+ * regardless of the length of the clip. It is
+ * used to keep the state of a clip before and
+ * after an edit.
+ */
+AudioClip *
+audio_clip_new_version (
+  AudioClip * self)
+{
+  g_return_val_if_fail (
+    self->num_chunks > 0, NULL);
+
+  AudioClip * clip = _create ();
+
+  clip->name = g_strdup (self->name);
+  clip->num_frames = self->num_frames;
+  clip->channels = self->channels;
+  clip->bpm = self->bpm;
+  clip->samplerate = self->samplerate;
+  clip->bit_depth = self->bit_depth;
+  clip->use_flac = self->use_flac;
+  clip->pool_id = -1;
+
+  clip->chunks_size = (size_t) self->num_chunks;
+  clip->chunks =
+    object_new_n (clip->chunks_size, ClipChunk *);
+  for (int i = 0; i < self->num_chunks; i++)
+    {
+      clip->chunks[i] =
+        clip_chunk_ref (self->chunks[i]);
+    }
+  clip->num_chunks = self->num_chunks;
+
+  return clip;
+}
+
+/**
+ * Replaces the frames from \ref start_frame with
+ * \ref frames.
+ *
+ * If the clip has chunks, only the chunks
+ * overlapping the range are replaced, so other
+ * versions of the clip keep sharing the rest.
+ *
+ * @param frames Frames, interleaved.
+ */
+void
+audio_clip_replace_frames (
+  AudioClip *      self,
+  const sample_t * frames,
+  size_t           start_frame,
+  size_t           num_frames)
+{
+  g_return_if_fail (
+    self->frames &&
+      start_frame + num_frames <=
+        (size_t) self->num_frames);
+
+  if (num_frames == 0)
+    return;
+
+  dsp_copy (
+    &self->frames[start_frame * self->channels],
+    frames, num_frames * self->channels);
+
+  /* only update the replaced part of the channel
+   * caches */
+  for (unsigned int i = 0; i < self->channels; i++)
+    {
+      for (size_t j = start_frame;
+           j < start_frame + num_frames; j++)
+        {
+          self->ch_frames[i][j] =
+            self->frames[j * self->channels + i];
+        }
+    }
+
+  /* replace the touched chunks with new ones made
+   * from the updated frames (the previous chunks
+   * stay alive in other versions) */
+  if (self->num_chunks > 0)
+    {
+      size_t first_chunk =
+        start_frame / CLIP_CHUNK_FRAMES;
+      size_t last_chunk =
+        (start_frame + num_frames - 1) /
+        CLIP_CHUNK_FRAMES;
+      g_return_if_fail (
+        last_chunk < (size_t) self->num_chunks);
+      for (size_t i = first_chunk; i <= last_chunk;
+           i++)
+        {
+          ClipChunk * prev_chunk = self->chunks[i];
+          self->chunks[i] =
+            clip_chunk_new (
+              &self->frames[
+                i * CLIP_CHUNK_FRAMES *
+                self->channels],
+              (size_t) prev_chunk->num_frames,
+              self->channels);
+          clip_chunk_unref (prev_chunk);
+        }
+    }
+
+  /* the clip is written to the pool when the
+   * project is saved */
+  self->dirty = true;
+}
+
+/**
+ * Sets the chunks of the clip to the given chunks
+ * (eg, the chunks of a version of the clip) and
+ * updates the frames in the chunks that changed.
+ */
+void
+audio_clip_set_chunks (
+  AudioClip *  self,
+  ClipChunk ** chunks,
+  int          num_chunks)
+{
+  g_return_if_fail (
+    num_chunks == self->num_chunks);
+
+  for (int i = 0; i < num_chunks; i++)
+    {
+      if (self->chunks[i] == chunks[i])
+        continue;
+
+      g_return_if_fail (
+        chunks[i]->num_frames ==
+          self->chunks[i]->num_frames);
+
+      ClipChunk * prev_chunk = self->chunks[i];
+      self->chunks[i] = clip_chunk_ref (chunks[i]);
+      clip_chunk_unref (prev_chunk);
+
+      /* clips without frames (eg, clips not in
+       * use) only keep the chunks */
+      if (self->frames)
+        copy_chunk_to_frames (self, i);
+
+      self->dirty = true;
+    }
+}
+
+/**
+ * Writes the chunks of the clip to the pool.
+ *
+ * Chunks that are already in the pool (from this
+ * clip or other clips) are not written again.
+ */
+static void
+write_chunks_to_pool (
+  AudioClip * self,
+  bool        is_backup)
+{
+  for (int i = 0; i < self->num_chunks; i++)
+    {
+      if (clip_chunk_write_to_pool (
+            self->chunks[i], is_backup) != 0)
+        {
+          g_warning (
+            "failed to write chunk %d of clip %s",
+            i, self->name);
+          return;
+        }
+    }
+
+  /* the main project's pool now has the current
+   * frames */
+  if (!is_backup)
+    self->dirty = false;
+}
+
+/**
+ * Writes the clip to the pool as a wav file, or
+ * as chunks if the clip has chunks.
  *
  * @param parts If true, only write new data. @see
  *   AudioClip.frames_written.
@@ -328,6 +640,13 @@ audio_clip_write_to_pool (
   g_return_if_fail (pool_clip);
   g_return_if_fail (pool_clip == self);
 
+  if (self->num_chunks > 0)
+    {
+      g_return_if_fail (!parts);
+      write_chunks_to_pool (self, is_backup);
+      return;
+    }
+
   /* generate a copy of the given filename in the
    * project dir */
   char * path_in_main_project =
@@ -341,12 +660,16 @@ audio_clip_write_to_pool (
   /* whether a new write is needed */
   bool need_new_write = true;
 
-  /* skip if file with same hash already exists */
-  if (file_exists (new_path) && !parts)
+  /* skip if file with same hash already exists
+   * (the hash of unchanged files is cached, so
+   * this only needs a stat) */
+  if (!self->dirty && !parts &&
+      file_exists (new_path))
     {
       char * existing_file_hash =
-        hash_get_from_file (
-          new_path, HASH_ALGORITHM_XXH3_64);
+        hash_cache_get_from_file (
+          HASH_CACHE, new_path,
+          HASH_ALGORITHM_XXH3_64);
       bool same_hash =
         self->file_hash &&
         string_is_equal (
@@ -365,14 +688,15 @@ audio_clip_write_to_pool (
 
   /* if writing to backup and same file exists in
    * main project dir, copy (first try reflink) */
-  if (need_new_write && self->file_hash && is_backup)
+  if (need_new_write && self->file_hash &&
+      !self->dirty && is_backup)
     {
       bool exists_in_main_project = false;
       if (file_exists (path_in_main_project))
         {
           char * existing_file_hash =
-            hash_get_from_file (
-              path_in_main_project,
+            hash_cache_get_from_file (
+              HASH_CACHE, path_in_main_project,
               HASH_ALGORITHM_XXH3_64);
           exists_in_main_project =
             string_is_equal (
@@ -437,8 +761,14 @@ audio_clip_write_to_pool (
           /* store file hash */
           g_free_and_null (self->file_hash);
           self->file_hash =
-            hash_get_from_file (
-              new_path, HASH_ALGORITHM_XXH3_64);
+            hash_cache_get_from_file (
+              HASH_CACHE, new_path,
+              HASH_ALGORITHM_XXH3_64);
+
+          /* the main project's pool now has the
+           * current frames */
+          if (!is_backup)
+            self->dirty = false;
         }
     }
 
@@ -575,12 +905,19 @@ audio_clip_remove_and_free (
   AudioClip * self,
   bool        backup)
 {
-  char * path =
-    audio_clip_get_path_in_pool (
-      self, F_NOT_BACKUP);
-  g_message ("removing clip at %s", path);
-  g_return_if_fail (path);
-  io_remove (path);
+  /* unused chunks are removed by
+   * audio_pool_remove_unused() since other clips
+   * may share them */
+  if (self->num_chunks == 0)
+    {
+      char * path =
+        audio_clip_get_path_in_pool (
+          self, F_NOT_BACKUP);
+      g_message ("removing clip at %s", path);
+      g_return_if_fail (path);
+      io_remove (path);
+      g_free (path);
+    }
 
   audio_clip_free (self);
 }
@@ -600,6 +937,11 @@ audio_clip_free (
     }
   g_free_and_null (self->name);
   g_free_and_null (self->file_hash);
+  for (int i = 0; i < self->num_chunks; i++)
+    {
+      clip_chunk_unref (self->chunks[i]);
+    }
+  object_zero_and_free (self->chunks);
 
   object_zero_and_free (self);
 }
@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "audio/clip_chunk.h"
+#include "project.h"
+#include "utils/dsp.h"
+#include "utils/file.h"
+#include "utils/hash.h"
+#include "utils/io.h"
+#include "utils/objects.h"
+
+#include <glib.h>
+
+/**
+ * Creates a chunk by copying the given frames.
+ *
+ * The chunk has a reference count of 1.
+ *
+ * @param frames Interleaved frames.
+ * @param num_frames Number of frames per channel.
+ */
+ClipChunk *
+clip_chunk_new (
+  const sample_t * frames,
+  size_t           num_frames,
+  channels_t       channels)
+{
+  g_return_val_if_fail (
+    num_frames > 0 &&
+      num_frames <= CLIP_CHUNK_FRAMES &&
+      channels > 0,
+    NULL);
+
+  ClipChunk * self = object_new (ClipChunk);
+
+  size_t num_samples = num_frames * channels;
+  self->frames =
+    object_new_n (num_samples, sample_t);
+  dsp_copy (self->frames, frames, num_samples);
+  self->num_frames = (long) num_frames;
+  self->channels = channels;
+  self->hash =
+    hash_get_from_data (
+      self->frames, num_samples * sizeof (sample_t),
+      HASH_ALGORITHM_XXH3_64);
+  self->refcount = 1;
+
+  return self;
+}
+
+/**
+ * Adds a reference to the chunk and returns it.
+ */
+ClipChunk *
+clip_chunk_ref (
+  ClipChunk * self)
+{
+  g_return_val_if_fail (self->refcount > 0, self);
+
+  self->refcount++;
+
+  return self;
+}
+
+/**
+ * Removes a reference to the chunk and frees it
+ * when no references are left.
+ */
+void
+clip_chunk_unref (
+  ClipChunk * self)
+{
+  /* chunks that were deserialized but not loaded
+   * have no references */
+  if (self->refcount > 0 &&
+      --self->refcount > 0)
+    return;
+
+  free (self->frames);
+  g_free_and_null (self->hash);
+
+  object_zero_and_free (self);
+}
+
+/**
+ * Returns the path of the chunk with the given
+ * hash in the pool.
+ *
+ * @param is_backup Whether this is a backup
+ *   project.
+ */
+char *
+clip_chunk_get_path_in_pool_from_hash (
+  const char * hash,
+  bool         is_backup)
+{
+  char * prj_pool_dir =
+    project_get_path (
+      PROJECT, PROJECT_PATH_POOL, is_backup);
+  g_return_val_if_fail (prj_pool_dir, NULL);
+  char * basename =
+    g_strdup_printf ("%s.raw", hash);
+  char * path =
+    g_build_filename (
+      prj_pool_dir, CLIP_CHUNK_DIR, basename,
+      NULL);
+  g_free (basename);
+  g_free (prj_pool_dir);
+
+  return path;
+}
+
+/**
+ * Writes the chunk to the pool, unless a chunk
+ * with the same hash is already there.
+ *
+ * @param is_backup Whether writing to a backup
+ *   project.
+ *
+ * @return Non-zero if fail.
+ */
+int
+clip_chunk_write_to_pool (
+  ClipChunk * self,
+  bool        is_backup)
+{
+  g_return_val_if_fail (self->frames, -1);
+
+  char * path =
+    clip_chunk_get_path_in_pool_from_hash (
+      self->hash, is_backup);
+  g_return_val_if_fail (path, -1);
+
+  /* chunks are named after their contents */
+  if (file_exists (path))
+    {
+      g_free (path);
+      return 0;
+    }
+
+  char * dir = g_path_get_dirname (path);
+  if (!file_exists (dir))
+    {
+      io_mkdir (dir);
+    }
+  g_free (dir);
+
+  GError * err = NULL;
+  bool ret =
+    g_file_set_contents (
+      path, (const char *) self->frames,
+      (gssize)
+      ((size_t) self->num_frames * self->channels *
+         sizeof (sample_t)),
+      &err);
+  if (!ret)
+    {
+      g_warning (
+        "failed to write chunk %s: %s",
+        path, err->message);
+      g_error_free (err);
+    }
+  g_free (path);
+
+  return ret ? 0 : -1;
+}
+
+/**
+ * Reads the frames of a deserialized chunk from
+ * the pool.
+ *
+ * The chunk gets a reference count of 1.
+ *
+ * @return Non-zero if fail.
+ */
+int
+clip_chunk_init_loaded (
+  ClipChunk * self)
+{
+  g_return_val_if_fail (
+    self->hash && self->num_frames > 0 &&
+      self->channels > 0,
+    -1);
+
+  self->refcount = 1;
+
+  char * path =
+    clip_chunk_get_path_in_pool_from_hash (
+      self->hash, F_NOT_BACKUP);
+  g_return_val_if_fail (path, -1);
+
+  char * contents = NULL;
+  gsize size = 0;
+  GError * err = NULL;
+  bool ret =
+    g_file_get_contents (
+      path, &contents, &size, &err);
+  if (!ret)
+    {
+      g_warning (
+        "failed to read chunk %s: %s",
+        path, err->message);
+      g_error_free (err);
+      g_free (path);
+      return -1;
+    }
+
+  size_t num_samples =
+    (size_t) self->num_frames * self->channels;
+  size_t expected_size =
+    num_samples * sizeof (sample_t);
+  if (size != expected_size)
+    {
+      g_warning (
+        "chunk %s has size %zu, expected %zu",
+        path, (size_t) size, expected_size);
+      g_free (contents);
+      g_free (path);
+      return -1;
+    }
+  g_free (path);
+
+  self->frames =
+    object_new_n (num_samples, sample_t);
+  dsp_copy (
+    self->frames, (const sample_t *) contents,
+    num_samples);
+  g_free (contents);
+
+  return 0;
+}
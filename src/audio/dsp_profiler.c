@@ -0,0 +1,746 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/dsp_profiler.h"
+#include "audio/engine.h"
+#include "audio/fader.h"
+#include "audio/graph_node.h"
+#include "audio/modulator_macro_processor.h"
+#include "audio/port.h"
+#include "audio/track.h"
+#include "audio/tracklist.h"
+#include "plugins/plugin.h"
+#include "project.h"
+#include "utils/objects.h"
+
+#include "ext/zix/zix/ring.h"
+
+#include <glib.h>
+#include <glib/gi18n.h>
+
+/**
+ * Returns the key to group the statistics of the
+ * event by.
+ */
+static guint64
+get_event_key (
+  const DspProfilerEvent * ev)
+{
+  return
+    ((guint64) (ev->node_type + 1) << 48) |
+    ((guint64) ((ev->track_pos + 1) & 0xFFFF) << 32) |
+    ((guint64) ((ev->slot_type + 1) & 0xFFFF) << 16) |
+    (guint64) ((ev->slot + 1) & 0xFFFF);
+}
+
+static gboolean
+collect_source_func (
+  DspProfiler * self)
+{
+  dsp_profiler_collect (self);
+
+  return G_SOURCE_CONTINUE;
+}
+
+/**
+ * Creates a new profiler and starts collecting
+ * events periodically in the main context.
+ *
+ * @param num_graph_threads Number of graph
+ *   processing threads, excluding the main graph
+ *   thread.
+ */
+DspProfiler *
+dsp_profiler_new (
+  int num_graph_threads)
+{
+  DspProfiler * self = object_new (DspProfiler);
+
+  self->num_rings =
+    MIN (
+      dsp_profiler_get_graph_thread_slot (
+        num_graph_threads),
+      DSP_PROFILER_MAX_THREADS);
+  for (int i = 0; i < self->num_rings; i++)
+    {
+      self->rings[i] =
+        zix_ring_new (
+          DSP_PROFILER_RING_EVENTS *
+            sizeof (DspProfilerEvent));
+      zix_ring_mlock (self->rings[i]);
+    }
+
+  self->stats =
+    g_hash_table_new_full (
+      g_int64_hash, g_int64_equal, NULL, free);
+  self->trace =
+    object_new_n (
+      DSP_PROFILER_MAX_TRACE_EVENTS,
+      DspProfilerEvent);
+
+  self->collect_source_id =
+    g_timeout_add (
+      DSP_PROFILER_COLLECT_INTERVAL,
+      (GSourceFunc) collect_source_func, self);
+
+  return self;
+}
+
+REALTIME
+static inline void
+write_event (
+  DspProfiler *            self,
+  const DspProfilerEvent * ev)
+{
+  if (ev->thread >= self->num_rings ||
+      zix_ring_write (
+        self->rings[ev->thread], ev,
+        sizeof (DspProfilerEvent)) !=
+          sizeof (DspProfilerEvent))
+    {
+      g_atomic_int_inc (&self->num_dropped);
+    }
+}
+
+/**
+ * Records the processing of a node.
+ *
+ * To be called by the thread that processed the
+ * node.
+ *
+ * @param thread Thread slot.
+ */
+REALTIME
+void
+dsp_profiler_record_node (
+  DspProfiler * self,
+  GraphNode *   node,
+  int           thread,
+  gint64        start,
+  gint64        end)
+{
+  DspProfilerEvent ev = {
+    .node_type = (int) node->type,
+    .track_pos = -1,
+    .slot_type = -1,
+    .slot = -1,
+    .thread = thread,
+    .start = start,
+    .end = end,
+    .wait =
+      node->trigger_time > 0 ?
+        start - node->trigger_time : -1,
+  };
+  node->trigger_time = 0;
+
+  switch (node->type)
+    {
+    case ROUTE_NODE_TYPE_PLUGIN:
+      ev.track_pos = node->pl->id.track_pos;
+      ev.slot_type = (int) node->pl->id.slot_type;
+      ev.slot = node->pl->id.slot;
+      break;
+    case ROUTE_NODE_TYPE_PORT:
+      ev.track_pos = node->port->id.track_pos;
+      if (node->port->id.owner_type ==
+            PORT_OWNER_TYPE_PLUGIN)
+        {
+          ev.slot_type =
+            (int) node->port->id.plugin_id.slot_type;
+          ev.slot = node->port->id.plugin_id.slot;
+        }
+      break;
+    case ROUTE_NODE_TYPE_FADER:
+      ev.track_pos = node->fader->track_pos;
+      break;
+    case ROUTE_NODE_TYPE_PREFADER:
+      ev.track_pos = node->prefader->track_pos;
+      break;
+    case ROUTE_NODE_TYPE_TRACK:
+      ev.track_pos = node->track->pos;
+      break;
+    case ROUTE_NODE_TYPE_MODULATOR_MACRO_PROCESOR:
+      ev.track_pos =
+        node->modulator_macro_processor->
+          cv_in->id.track_pos;
+      break;
+    default:
+      break;
+    }
+
+  write_event (self, &ev);
+}
+
+/**
+ * Records a whole cycle.
+ *
+ * To be called by the engine thread at the end of
+ * the cycle.
+ */
+REALTIME
+void
+dsp_profiler_record_cycle (
+  DspProfiler * self,
+  gint64        end)
+{
+  if (self->cycle_start == 0)
+    return;
+
+  DspProfilerEvent ev = {
+    .node_type = DSP_PROFILER_CYCLE,
+    .track_pos = -1,
+    .slot_type = -1,
+    .slot = -1,
+    .thread = DSP_PROFILER_ENGINE_THREAD,
+    .start = self->cycle_start,
+    .end = end,
+    .wait = -1,
+  };
+  write_event (self, &ev);
+}
+
+static void
+add_to_stats (
+  DspProfiler *            self,
+  const DspProfilerEvent * ev)
+{
+  guint64 key = get_event_key (ev);
+  DspProfilerStats * stats =
+    g_hash_table_lookup (self->stats, &key);
+  if (!stats)
+    {
+      stats = object_new (DspProfilerStats);
+      stats->key = key;
+      stats->ev = *ev;
+      g_hash_table_insert (
+        self->stats, &stats->key, stats);
+    }
+
+  stats->durations[stats->next_duration] =
+    ev->end - ev->start;
+  stats->next_duration =
+    (stats->next_duration + 1) %
+      DSP_PROFILER_STATS_WINDOW;
+  if (stats->num_durations <
+        DSP_PROFILER_STATS_WINDOW)
+    stats->num_durations++;
+  stats->max_wait = MAX (stats->max_wait, ev->wait);
+}
+
+static void
+add_to_trace (
+  DspProfiler *            self,
+  const DspProfilerEvent * ev)
+{
+  size_t idx =
+    (self->trace_start + self->num_trace_events) %
+      DSP_PROFILER_MAX_TRACE_EVENTS;
+  self->trace[idx] = *ev;
+  if (self->num_trace_events <
+        DSP_PROFILER_MAX_TRACE_EVENTS)
+    {
+      self->num_trace_events++;
+    }
+  else
+    {
+      /* overwrite the oldest event */
+      self->trace_start =
+        (self->trace_start + 1) %
+          DSP_PROFILER_MAX_TRACE_EVENTS;
+    }
+}
+
+/**
+ * Moves the recorded events to the statistics and
+ * the trace.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+dsp_profiler_collect (
+  DspProfiler * self)
+{
+  DspProfilerEvent ev;
+  for (int i = 0; i < self->num_rings; i++)
+    {
+      ZixRing * ring = self->rings[i];
+      while (zix_ring_read_space (ring) >=
+               sizeof (DspProfilerEvent))
+        {
+          zix_ring_read (
+            ring, &ev, sizeof (DspProfilerEvent));
+          add_to_stats (self, &ev);
+          add_to_trace (self, &ev);
+        }
+    }
+
+  int num_dropped =
+    g_atomic_int_and (&self->num_dropped, 0);
+  if (num_dropped > 0)
+    {
+      g_message (
+        "%s: %d events were dropped", __func__,
+        num_dropped);
+    }
+}
+
+static int
+cmp_gint64 (
+  const void * a,
+  const void * b)
+{
+  gint64 val1 = *(const gint64 *) a;
+  gint64 val2 = *(const gint64 *) b;
+  return (val1 > val2) - (val1 < val2);
+}
+
+/**
+ * Returns the duration at the given percentile
+ * of the last durations in the stats, in
+ * nanoseconds.
+ *
+ * @param percentile Percentile (0-100).
+ */
+gint64
+dsp_profiler_stats_get_percentile (
+  DspProfilerStats * stats,
+  double             percentile)
+{
+  if (stats->num_durations == 0)
+    return 0;
+
+  gint64 sorted[DSP_PROFILER_STATS_WINDOW];
+  memcpy (
+    sorted, stats->durations,
+    (size_t) stats->num_durations *
+      sizeof (gint64));
+  qsort (
+    sorted, (size_t) stats->num_durations,
+    sizeof (gint64), cmp_gint64);
+
+  int idx =
+    (int)
+    ((percentile / 100.0) *
+       (stats->num_durations - 1) + 0.5);
+  idx = CLAMP (idx, 0, stats->num_durations - 1);
+
+  return sorted[idx];
+}
+
+/**
+ * Returns a human friendly name for the node of
+ * the event.
+ *
+ * Must be free'd.
+ */
+char *
+dsp_profiler_event_get_name (
+  const DspProfilerEvent * ev)
+{
+  if (ev->node_type == DSP_PROFILER_CYCLE)
+    return g_strdup ("Cycle");
+
+  Track * track = NULL;
+  if (TRACKLIST && ev->track_pos >= 0 &&
+      ev->track_pos < TRACKLIST->num_tracks)
+    {
+      track = TRACKLIST->tracks[ev->track_pos];
+    }
+  const char * track_name =
+    track ? track->name : "?";
+  const char * pl_name = NULL;
+  if (track && ev->slot_type >= 0)
+    {
+      Plugin * pl =
+        track_get_plugin_at_slot (
+          track, (PluginSlotType) ev->slot_type,
+          ev->slot);
+      if (pl)
+        pl_name = pl->setting->descr->name;
+    }
+
+  switch ((GraphNodeType) ev->node_type)
+    {
+    case ROUTE_NODE_TYPE_PLUGIN:
+      return
+        g_strdup_printf (
+          "%s/%s (Plugin)", track_name,
+          pl_name ? pl_name : "?");
+    case ROUTE_NODE_TYPE_PORT:
+      if (pl_name)
+        {
+          return
+            g_strdup_printf (
+              "%s/%s Ports", track_name, pl_name);
+        }
+      else if (ev->track_pos >= 0)
+        {
+          return
+            g_strdup_printf (
+              "%s Ports", track_name);
+        }
+      return g_strdup ("Ports");
+    case ROUTE_NODE_TYPE_FADER:
+      return
+        g_strdup_printf (
+          "%s Fader", track_name);
+    case ROUTE_NODE_TYPE_MODULATOR_MACRO_PROCESOR:
+      return
+        g_strdup_printf (
+          "%s Modulator Macro Processor",
+          track_name);
+    case ROUTE_NODE_TYPE_TRACK:
+      return g_strdup (track_name);
+    case ROUTE_NODE_TYPE_PREFADER:
+      return
+        g_strdup_printf (
+          "%s Pre-Fader", track_name);
+    case ROUTE_NODE_TYPE_MONITOR_FADER:
+      return g_strdup ("Monitor Fader");
+    case ROUTE_NODE_TYPE_SAMPLE_PROCESSOR:
+      return g_strdup ("Sample Processor");
+    case ROUTE_NODE_TYPE_INITIAL_PROCESSOR:
+      return g_strdup ("Initial Processor");
+    case ROUTE_NODE_TYPE_HW_PROCESSOR:
+      return g_strdup ("HW Processor");
+    }
+  g_return_val_if_reached (NULL);
+}
+
+typedef struct SummaryEntry
+{
+  DspProfilerStats * stats;
+  gint64             p50;
+  gint64             p99;
+  gint64             max;
+} SummaryEntry;
+
+static int
+cmp_summary_entry (
+  const void * a,
+  const void * b)
+{
+  const SummaryEntry * entry1 =
+    (const SummaryEntry *) a;
+  const SummaryEntry * entry2 =
+    (const SummaryEntry *) b;
+  return
+    (entry2->p99 > entry1->p99) -
+    (entry2->p99 < entry1->p99);
+}
+
+/**
+ * Returns a newly allocated text with the
+ * percentiles of the slowest processors, sorted
+ * by their 99th percentile.
+ */
+char *
+dsp_profiler_get_summary (
+  DspProfiler * self,
+  int           max_entries)
+{
+  guint num_stats =
+    g_hash_table_size (self->stats);
+  SummaryEntry * entries =
+    object_new_n (MAX (num_stats, 1), SummaryEntry);
+  GHashTableIter iter;
+  gpointer value;
+  guint num_entries = 0;
+  g_hash_table_iter_init (&iter, self->stats);
+  while (g_hash_table_iter_next (
+           &iter, NULL, &value))
+    {
+      DspProfilerStats * stats =
+        (DspProfilerStats *) value;
+
+      /* the cycle is shown by the DSP load */
+      if (stats->ev.node_type == DSP_PROFILER_CYCLE)
+        continue;
+
+      SummaryEntry * entry = &entries[num_entries++];
+      entry->stats = stats;
+      entry->p50 =
+        dsp_profiler_stats_get_percentile (
+          stats, 50.0);
+      entry->p99 =
+        dsp_profiler_stats_get_percentile (
+          stats, 99.0);
+      entry->max =
+        dsp_profiler_stats_get_percentile (
+          stats, 100.0);
+    }
+  qsort (
+    entries, num_entries, sizeof (SummaryEntry),
+    cmp_summary_entry);
+
+  GString * gstr = g_string_new (NULL);
+  for (guint i = 0;
+       i < num_entries && (int) i < max_entries;
+       i++)
+    {
+      SummaryEntry * entry = &entries[i];
+      char * name =
+        dsp_profiler_event_get_name (
+          &entry->stats->ev);
+      g_string_append_printf (
+        gstr,
+        _("%s: p50 %.1f µs, p99 %.1f µs, "
+        "max %.1f µs"),
+        name, (double) entry->p50 / 1000.0,
+        (double) entry->p99 / 1000.0,
+        (double) entry->max / 1000.0);
+      if (i + 1 < num_entries &&
+          (int) i + 1 < max_entries)
+        {
+          g_string_append_c (gstr, '\n');
+        }
+      g_free (name);
+    }
+  free (entries);
+
+  return g_string_free (gstr, false);
+}
+
+static void
+append_json_string (
+  GString *    gstr,
+  const char * str)
+{
+  g_string_append_c (gstr, '"');
+  for (const char * c = str; *c; c++)
+    {
+      switch (*c)
+        {
+        case '"':
+          g_string_append (gstr, "\\\"");
+          break;
+        case '\\':
+          g_string_append (gstr, "\\\\");
+          break;
+        default:
+          if ((unsigned char) *c < 0x20)
+            {
+              g_string_append_printf (
+                gstr, "\\u%04x", (unsigned) *c);
+            }
+          else
+            {
+              g_string_append_c (gstr, *c);
+            }
+          break;
+        }
+    }
+  g_string_append_c (gstr, '"');
+}
+
+static void
+append_thread_name (
+  GString * gstr,
+  int       thread)
+{
+  char name[60];
+  if (thread == DSP_PROFILER_ENGINE_THREAD)
+    strcpy (name, "Engine");
+  else if (thread ==
+             dsp_profiler_get_graph_thread_slot (-1))
+    strcpy (name, "Graph main");
+  else
+    sprintf (
+      name, "Graph worker %d",
+      thread - dsp_profiler_get_graph_thread_slot (0));
+
+  g_string_append_printf (
+    gstr,
+    "{\"name\":\"thread_name\",\"ph\":\"M\","
+    "\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+    thread);
+  append_json_string (gstr, name);
+  g_string_append (gstr, "}},\n");
+}
+
+/**
+ * Writes the collected events to a JSON file in
+ * the Chrome trace event format.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+dsp_profiler_write_trace (
+  DspProfiler * self,
+  const char *  filepath)
+{
+  if (self->num_trace_events == 0)
+    {
+      return
+        g_strdup (_("No DSP events were recorded"));
+    }
+
+  /* events are not ordered by start time (they are
+   * collected from several threads), so find the
+   * earliest one first */
+  gint64 first_time =
+    self->trace[self->trace_start].start;
+  for (size_t i = 1; i < self->num_trace_events; i++)
+    {
+      DspProfilerEvent * ev =
+        &self->trace[
+          (self->trace_start + i) %
+            DSP_PROFILER_MAX_TRACE_EVENTS];
+      first_time = MIN (first_time, ev->start);
+    }
+
+  gint64 block_duration = 0;
+  if (AUDIO_ENGINE && AUDIO_ENGINE->sample_rate > 0)
+    {
+      block_duration =
+        ((gint64) AUDIO_ENGINE->block_length *
+          1000000000) /
+        (gint64) AUDIO_ENGINE->sample_rate;
+    }
+
+  /* names are looked up once per processor */
+  GHashTable * names =
+    g_hash_table_new_full (
+      g_int64_hash, g_int64_equal, free, g_free);
+
+  GString * gstr =
+    g_string_new ("{\"traceEvents\":[\n");
+  for (int i = 0; i < self->num_rings; i++)
+    {
+      append_thread_name (gstr, i);
+    }
+  for (size_t i = 0; i < self->num_trace_events; i++)
+    {
+      DspProfilerEvent * ev =
+        &self->trace[
+          (self->trace_start + i) %
+            DSP_PROFILER_MAX_TRACE_EVENTS];
+
+      guint64 key = get_event_key (ev);
+      const char * name =
+        g_hash_table_lookup (names, &key);
+      if (!name)
+        {
+          guint64 * key_copy = object_new (guint64);
+          *key_copy = key;
+          char * new_name =
+            dsp_profiler_event_get_name (ev);
+          g_hash_table_insert (
+            names, key_copy, new_name);
+          name = new_name;
+        }
+
+      g_string_append (gstr, "{\"name\":");
+      append_json_string (gstr, name);
+      g_string_append_printf (
+        gstr,
+        ",\"cat\":\"%s\",\"ph\":\"X\","
+        "\"ts\":%.3f,\"dur\":%.3f,"
+        "\"pid\":1,\"tid\":%d",
+        ev->node_type == DSP_PROFILER_CYCLE ?
+          "cycle" : "node",
+        (double) (ev->start - first_time) / 1000.0,
+        (double) (ev->end - ev->start) / 1000.0,
+        ev->thread);
+      if (ev->wait >= 0)
+        {
+          g_string_append_printf (
+            gstr,
+            ",\"args\":{\"queue_wait_us\":%.3f}",
+            (double) ev->wait / 1000.0);
+        }
+      else if (ev->node_type == DSP_PROFILER_CYCLE &&
+               block_duration > 0)
+        {
+          g_string_append_printf (
+            gstr,
+            ",\"args\":{\"over_budget\":%s}",
+            ev->end - ev->start > block_duration ?
+              "true" : "false");
+        }
+      g_string_append (
+        gstr,
+        i + 1 < self->num_trace_events ?
+          "},\n" : "}\n");
+    }
+  g_string_append (
+    gstr, "],\"displayTimeUnit\":\"ns\"}\n");
+  g_hash_table_unref (names);
+
+  GError * err = NULL;
+  g_file_set_contents (
+    filepath, gstr->str, (gssize) gstr->len, &err);
+  g_string_free (gstr, true);
+  if (err)
+    {
+      char * msg =
+        g_strdup_printf (
+          _("Failed to write DSP trace to %s: %s"),
+          filepath, err->message);
+      g_error_free (err);
+      return msg;
+    }
+
+  return NULL;
+}
+
+/**
+ * Stops collecting events periodically.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+dsp_profiler_stop_collecting (
+  DspProfiler * self)
+{
+  if (self->collect_source_id)
+    {
+      g_source_remove_and_zero (
+        self->collect_source_id);
+    }
+}
+
+/**
+ * Frees the profiler.
+ *
+ * Must be called from the GTK thread, or after
+ * removing the collection source with
+ * dsp_profiler_stop_collecting().
+ */
+void
+dsp_profiler_free (
+  DspProfiler * self)
+{
+  dsp_profiler_stop_collecting (self);
+
+  for (int i = 0; i < self->num_rings; i++)
+    {
+      object_free_w_func_and_null (
+        zix_ring_free, self->rings[i]);
+    }
+  object_free_w_func_and_null (
+    g_hash_table_unref, self->stats);
+  object_zero_and_free (self->trace);
+
+  object_zero_and_free (self);
+}
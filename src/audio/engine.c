@@ -49,6 +49,7 @@
 #include "audio/automation_tracklist.h"
 #include "audio/channel.h"
 #include "audio/control_port.h"
+#include "audio/dsp_profiler.h"
 #include "audio/engine.h"
 #include "audio/engine_alsa.h"
 #include "audio/engine_dummy.h"
@@ -60,6 +61,7 @@
 #include "audio/engine_sdl.h"
 #include "audio/engine_windows_mme.h"
 #include "audio/graph.h"
+#include "audio/graph_buffer_planner.h"
 #include "audio/graph_node.h"
 #include "audio/hardware_processor.h"
 #include "audio/metronome.h"
@@ -83,6 +85,7 @@
 #include "utils/flags.h"
 #include "utils/mpmc_queue.h"
 #include "utils/object_pool.h"
+#include "utils/object_utils.h"
 #include "utils/objects.h"
 #include "utils/string.h"
 #include "utils/ui.h"
@@ -251,6 +254,18 @@ engine_process_events (
       return G_SOURCE_CONTINUE;
     }
 
+  /* release finished file previews */
+  if (self->sample_processor)
+    {
+      sample_processor_reap_streams (
+        self->sample_processor);
+    }
+
+  /* recompile the automation envelopes
+   * invalidated outside the GTK thread (eg, by
+   * BPM changes) */
+  automation_track_update_pending_envelopes ();
+
   self->last_events_process_started =
     g_get_monotonic_time ();
 
@@ -814,6 +829,30 @@ init_common (
       g_settings_get_enum (
         S_P_DSP_PAN,
         "pan-algorithm");
+  /* tests enable this by setting the size
+   * directly */
+  self->automation_sub_block_size =
+    ZRYTHM_TESTING ||
+    !g_settings_get_boolean (
+      S_P_GENERAL_ENGINE,
+      "sample-accurate-automation") ?
+      0 :
+      (nframes_t)
+      g_settings_get_int (
+        S_P_GENERAL_ENGINE,
+        "automation-sub-block-size");
+  self->plugin_suspend_tail_ms =
+    ZRYTHM_TESTING ?
+      0 :
+      g_settings_get_int (
+        S_P_GENERAL_ENGINE,
+        "plugin-suspend-tail");
+  self->share_port_buffers =
+    ZRYTHM_TESTING ?
+      false :
+      g_settings_get_boolean (
+        S_P_GENERAL_ENGINE,
+        "share-port-buffers");
 
   /* set a temporary buffer sizes */
   if (self->block_length == 0)
@@ -1147,6 +1186,14 @@ engine_realloc_port_buffers (
     "reallocating buffers...",
     AUDIO_ENGINE->block_length);
 
+  /* the shared buffers are planned again for the
+   * new size below */
+  Graph * graph = ROUTER ? ROUTER->graph : NULL;
+  if (graph)
+    {
+      graph_buffer_planner_unshare (graph);
+    }
+
   /** reallocate port buffers to new size */
   Channel * ch;
   Plugin * pl;
@@ -1167,6 +1214,12 @@ engine_realloc_port_buffers (
           nframes * sizeof (float));
       port->buf = g_realloc (port->buf, new_sz);
       memset (port->buf, 0, new_sz);
+      if (port->pinned_buf)
+        {
+          port->pinned_buf =
+            g_realloc (port->pinned_buf, new_sz);
+          memset (port->pinned_buf, 0, new_sz);
+        }
     }
   free (ports);
   for (int i = 0; i < TRACKLIST->num_tracks; i++)
@@ -1198,6 +1251,11 @@ engine_realloc_port_buffers (
     }
   AUDIO_ENGINE->nframes = nframes;
 
+  if (graph)
+    {
+      graph_buffer_planner_plan (graph);
+    }
+
   g_message ("done");
 }
 
@@ -1275,6 +1333,14 @@ engine_process_prepare (
   self->last_time_taken = g_get_monotonic_time ();
   self->nframes = nframes;
 
+  DspProfiler * profiler =
+    g_atomic_pointer_get (&self->profiler);
+  if (profiler)
+    {
+      profiler->cycle_start =
+        dsp_profiler_get_time ();
+    }
+
   if (self->transport->play_state ==
         PLAYSTATE_PAUSE_REQUESTED)
     {
@@ -1735,6 +1801,14 @@ engine_post_process (
     AUDIO_ENGINE->max_time_taken =
       AUDIO_ENGINE->last_time_taken;
 
+  DspProfiler * profiler =
+    g_atomic_pointer_get (&self->profiler);
+  if (profiler)
+    {
+      dsp_profiler_record_cycle (
+        profiler, dsp_profiler_get_time ());
+    }
+
   zix_sem_post (&self->port_operation_lock);
 }
 
@@ -1922,6 +1996,47 @@ engine_reset_bounce_mode (
     TRACKLIST, false);
 }
 
+/**
+ * Enables or disables per-node DSP profiling.
+ *
+ * Must be called from the GTK thread.
+ *
+ * @see DspProfiler.
+ */
+void
+engine_set_dsp_profiling (
+  AudioEngine * self,
+  bool          enable)
+{
+  DspProfiler * profiler =
+    g_atomic_pointer_get (&self->profiler);
+  if (enable == (profiler != NULL))
+    return;
+
+  if (enable)
+    {
+      int num_threads =
+        self->router && self->router->graph ?
+          self->router->graph->num_threads : 0;
+      profiler = dsp_profiler_new (num_threads);
+      g_atomic_pointer_set (
+        &self->profiler, profiler);
+      g_message (
+        "%s: enabled DSP profiling", __func__);
+    }
+  else
+    {
+      g_atomic_pointer_set (&self->profiler, NULL);
+      dsp_profiler_stop_collecting (profiler);
+
+      /* the processing threads may still be
+       * recording */
+      free_later (profiler, dsp_profiler_free);
+      g_message (
+        "%s: disabled DSP profiling", __func__);
+    }
+}
+
 /**
  * Stops events from getting fired.
  */
@@ -1960,6 +2075,9 @@ engine_free (
   object_free_w_func_and_null (
     router_free, self->router);
 
+  object_free_w_func_and_null (
+    dsp_profiler_free, self->profiler);
+
   switch (self->audio_backend)
     {
 #ifdef HAVE_JACK
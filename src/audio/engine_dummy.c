@@ -17,36 +17,127 @@
  * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "zrythm-config.h"
+
+#include <errno.h>
+#include <time.h>
+
 #include "audio/engine.h"
 #include "audio/engine_dummy.h"
 #include "audio/router.h"
 #include "audio/port.h"
 #include "audio/tempo_track.h"
 #include "project.h"
+#include "utils/env.h"
 #include "zrythm_app.h"
 
 #include <gtk/gtk.h>
 
+/**
+ * Returns the monotonic time in nanoseconds.
+ */
+static gint64
+get_time_ns (void)
+{
+#ifdef _WOE32
+  return g_get_monotonic_time () * 1000;
+#else
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return
+    (gint64) ts.tv_sec * 1000000000 +
+    (gint64) ts.tv_nsec;
+#endif
+}
+
+/**
+ * Sleeps until the given monotonic time in
+ * nanoseconds.
+ */
+static void
+sleep_until (
+  gint64 deadline)
+{
+#ifdef HAVE_CLOCK_NANOSLEEP
+  struct timespec ts = {
+    .tv_sec = (time_t) (deadline / 1000000000),
+    .tv_nsec = (long) (deadline % 1000000000),
+  };
+  while (clock_nanosleep (
+           CLOCK_MONOTONIC, TIMER_ABSTIME, &ts,
+           NULL) == EINTR)
+    {
+    }
+#else
+  gint64 remaining = deadline - get_time_ns ();
+  if (remaining > 0)
+    {
+      g_usleep ((gulong) (remaining / 1000));
+    }
+#endif
+}
+
+/**
+ * Processes blocks either back to back
+ * (freewheel) or paced against absolute
+ * deadlines, so that the timing does not drift
+ * with the time taken by each cycle.
+ */
 static gpointer
 process_cb (gpointer data)
 {
   AudioEngine * self = (AudioEngine *) data;
 
-  double secs_per_block =
-    (double) self->block_length / self->sample_rate;
-  gulong sleep_time =
-    (gulong) (secs_per_block * 1000.0 * 1000);
-
   g_message (
     "Running dummy audio engine for first time");
 
-  while (1)
+  gint64 deadline = get_time_ns ();
+  int num_missed_in_row = 0;
+  while (!self->stop_dummy_audio_thread)
     {
-      if (self->stop_dummy_audio_thread)
-        break;
+      gint64 block_ns =
+        ((gint64) self->block_length *
+           1000000000) /
+        (gint64) self->sample_rate;
+
+      if (g_atomic_int_get (&self->dummy_freewheel)
+          && engine_get_run (self))
+        {
+          engine_process (self, self->block_length);
+
+          /* resume pacing from now when leaving
+           * freewheel mode */
+          deadline = get_time_ns ();
+          continue;
+        }
 
       engine_process (self, self->block_length);
-      g_usleep (sleep_time);
+
+      deadline += block_ns;
+      gint64 now = get_time_ns ();
+      if (now > deadline)
+        {
+          g_atomic_int_inc (
+            &self->dummy_missed_deadlines);
+          if (num_missed_in_row <
+                ENGINE_DUMMY_MAX_LOGGED_MISSED_DEADLINES)
+            {
+              g_message (
+                "%s: missed deadline by %"
+                G_GINT64_FORMAT " us", __func__,
+                (now - deadline) / 1000);
+            }
+          num_missed_in_row++;
+
+          /* start over instead of trying to catch
+           * up */
+          deadline = now;
+        }
+      else
+        {
+          num_missed_in_row = 0;
+          sleep_until (deadline);
+        }
     }
 
   return NULL;
@@ -83,9 +174,15 @@ engine_dummy_setup (
     tempo_track_get_beats_per_bar (P_TEMPO_TRACK);
   g_warn_if_fail (beats_per_bar >= 1);
 
+  g_atomic_int_set (
+    &self->dummy_freewheel,
+    env_get_int ("ZRYTHM_DUMMY_FREEWHEEL", 0) != 0);
+
   g_message (
-    "Dummy Engine set up [samplerate: %u]",
-    self->sample_rate);
+    "Dummy Engine set up [samplerate: %u, "
+    "freewheel: %d]",
+    self->sample_rate,
+    g_atomic_int_get (&self->dummy_freewheel));
 
   return 0;
 }
@@ -137,6 +234,24 @@ engine_dummy_activate (
   return 0;
 }
 
+/**
+ * Sets whether the dummy engine processes blocks
+ * back to back (freewheel) instead of pacing them
+ * in realtime.
+ *
+ * Can be called while the engine is running.
+ */
+void
+engine_dummy_set_freewheel (
+  AudioEngine * self,
+  bool          freewheel)
+{
+  g_message (
+    "%s: %s", __func__, freewheel ? "on" : "off");
+  g_atomic_int_set (
+    &self->dummy_freewheel, freewheel);
+}
+
 void
 engine_dummy_tear_down (
   AudioEngine * self)
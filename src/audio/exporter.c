@@ -37,6 +37,7 @@
 #include "gui/widgets/main_window.h"
 #include "project.h"
 #include "settings/settings.h"
+#include "utils/dsp.h"
 #include "utils/flags.h"
 #include "utils/io.h"
 #include "utils/math.h"
@@ -372,6 +373,9 @@ export_audio (
   /*sf_count_t last_playhead_frames = start_pos.frames;*/
   float out_ptr[
     AUDIO_ENGINE->block_length * EXPORT_CHANNELS];
+  info->num_frames = 0;
+  info->peaks[0] = 0.f;
+  info->peaks[1] = 0.f;
   do
     {
       /* calculate number of frames to process
@@ -407,6 +411,21 @@ export_audio (
               stereo_out->r->buf[i];
         }
 
+      /* update the peaks */
+      StereoPorts * stereo_out =
+        P_MASTER_TRACK->channel->stereo_out;
+      float cycle_peaks[2] = { 0.f, 0.f };
+      dsp_abs_max (
+        stereo_out->l->buf, &cycle_peaks[0],
+        nframes);
+      dsp_abs_max (
+        stereo_out->r->buf, &cycle_peaks[1],
+        nframes);
+      info->peaks[0] =
+        MAX (info->peaks[0], cycle_peaks[0]);
+      info->peaks[1] =
+        MAX (info->peaks[1], cycle_peaks[1]);
+
       /* seek to the write position in the file */
       if (covered_frames != 0)
         {
@@ -439,6 +458,7 @@ export_audio (
       g_warn_if_fail (written_frames == nframes);
 
       covered_frames += nframes;
+      info->num_frames = (long) covered_frames;
       covered_ticks +=
         AUDIO_ENGINE->ticks_per_frame * nframes;
 #if 0
@@ -37,9 +37,11 @@
 
 
 #include "audio/control_room.h"
+#include "audio/dsp_profiler.h"
 #include "audio/engine.h"
 #include "audio/fader.h"
 #include "audio/graph.h"
+#include "audio/graph_buffer_planner.h"
 #include "audio/graph_node.h"
 #include "audio/graph_thread.h"
 #include "audio/hardware_processor.h"
@@ -111,11 +113,17 @@ graph_on_reached_terminal_node (
         (unsigned int) self->n_terminal_nodes);
 
       /* and start the initial nodes */
+      gint64 trigger_time =
+        g_atomic_pointer_get (
+          &AUDIO_ENGINE->profiler) ?
+            dsp_profiler_get_time () : 0;
       for (size_t i = 0;
            i < self->n_init_triggers; ++i)
         {
           g_atomic_int_inc (
             &self->trigger_queue_size);
+          self->init_trigger_list[i]->trigger_time =
+            trigger_time;
           mpmc_queue_push_back_node (
             self->trigger_queue,
             self->init_trigger_list[i]);
@@ -261,6 +269,13 @@ connect_plugin (
   GraphNode * pl_node =
     graph_find_node_from_plugin (self, pl);
   g_return_if_fail (pl_node);
+  if (!pl_node->sub_block_ports)
+    {
+      pl_node->sub_block_ports =
+        object_new_n (
+          (size_t) MAX (pl->num_in_ports, 1),
+          Port *);
+    }
   for (int i = 0; i < pl->num_in_ports; i++)
     {
       Port * port = pl->in_ports[i];
@@ -276,6 +291,12 @@ connect_plugin (
         }
       g_return_if_fail (port_node);
       graph_node_connect (port_node, pl_node);
+
+      if (port->id.type == TYPE_CONTROL)
+        {
+          pl_node->sub_block_ports[
+            pl_node->num_sub_block_ports++] = port;
+        }
     }
   for (int i = 0; i < pl->num_out_ports; i++)
     {
@@ -338,11 +359,106 @@ graph_destroy (
   graph_free (self);
 }
 
+/**
+ * Returns whether the port is static, ie, whether
+ * processing it does nothing so it can be left out
+ * of the graph.
+ *
+ * Control inputs only need to be processed to read
+ * automation or to apply CV from other ports
+ * (modulators). Changes from the UI or from MIDI
+ * mappings are written directly to the port.
+ *
+ * Ports that become dynamic (eg, when the first
+ * automation region is added or when a connection
+ * is made) are added back the next time the graph
+ * is recalculated.
+ */
+static bool
+is_port_static (
+  Port * port)
+{
+  if (port->id.type != TYPE_CONTROL ||
+      port->id.flow != FLOW_INPUT ||
+      port->num_srcs > 0 ||
+      port->num_dests > 0)
+    return false;
+
+  /* these are always connected to their
+   * track */
+  if (port->id.flags & PORT_FLAG_TP_MONO ||
+      port->id.flags & PORT_FLAG_TP_INPUT_GAIN)
+    return false;
+
+  if (port->id.flags & PORT_FLAG_AUTOMATABLE)
+    {
+      AutomationTrack * at = port->at;
+      g_return_val_if_fail (at, true);
+      return at->num_regions == 0;
+    }
+
+  return true;
+}
+
+/**
+ * Returns whether the track is idle, ie, whether
+ * it cannot produce any output, so its whole
+ * subgraph (track processor, plugins, faders and
+ * their ports) can be left out of the graph.
+ *
+ * Disabled tracks are idle since the track
+ * processor already outputs silence for them.
+ */
+static bool
+is_track_idle (
+  Track * tr)
+{
+  return
+    track_type_has_channel (tr->type) &&
+    tr->type != TRACK_TYPE_MASTER &&
+    !track_is_enabled (tr);
+}
+
+/**
+ * Returns whether the modulator is idle, ie,
+ * whether none of its outputs are connected
+ * anywhere.
+ */
+static bool
+is_modulator_idle (
+  Plugin * pl)
+{
+  for (int i = 0; i < pl->num_out_ports; i++)
+    {
+      if (pl->out_ports[i]->num_dests > 0)
+        return false;
+    }
+
+  return true;
+}
+
+/**
+ * Adds the given ports to the set of ports of
+ * idle subgraphs.
+ */
+static void
+add_idle_ports (
+  GHashTable * idle_ports,
+  Port **      ports,
+  int          num_ports)
+{
+  for (int i = 0; i < num_ports; i++)
+    {
+      g_hash_table_add (idle_ports, ports[i]);
+    }
+}
+
 /**
  * Add the port to the nodes.
  *
  * @param drop_if_unnecessary Drops the port
- *   if it doesn't connect anywhere.
+ *   if it doesn't connect anywhere or if it is
+ *   static.
  *
  * @return The graph node, if created.
  */
@@ -354,25 +470,11 @@ add_port (
 {
   PortOwnerType owner = port->id.owner_type;
 
-  if (drop_if_unnecessary)
+  if (drop_if_unnecessary &&
+      is_port_static (port))
     {
-      /* skip unnecessary control ports */
-      if (port->id.type == TYPE_CONTROL &&
-          port->id.flags & PORT_FLAG_AUTOMATABLE)
-        {
-          AutomationTrack * found_at = port->at;
-          if (!found_at)
-            {
-              /*automation_track_find_from_port (*/
-                /*port, NULL, true);*/
-            }
-          g_return_val_if_fail (found_at, NULL);
-          if (found_at->num_regions == 0 &&
-              port->num_srcs == 0)
-            {
-              return NULL;
-            }
-        }
+      self->num_pruned_ports++;
+      return NULL;
     }
 
   /* drop ports without sources and dests */
@@ -404,18 +506,28 @@ add_port (
 
 /**
  * Connect the port as a node.
+ *
+ * @param idle_ports Ports of idle subgraphs, which
+ *   have no nodes, so connections from/to them are
+ *   skipped.
  */
 static void
 connect_port (
-  Graph * self,
-  Port * port)
+  Graph *      self,
+  Port *       port,
+  GHashTable * idle_ports)
 {
+  if (g_hash_table_contains (idle_ports, port))
+    return;
+
   GraphNode * node =
     graph_find_node_from_port (self, port);
   GraphNode * node2;
   for (int j = 0; j < port->num_srcs; j++)
     {
       Port * src = port->srcs[j];
+      if (g_hash_table_contains (idle_ports, src))
+        continue;
       node2 = graph_find_node_from_port (self, src);
       g_warn_if_fail (node);
       g_warn_if_fail (node2);
@@ -424,6 +536,8 @@ connect_port (
   for (int j = 0; j < port->num_dests; j++)
     {
       Port * dest = port->dests[j];
+      if (g_hash_table_contains (idle_ports, dest))
+        continue;
       node2 = graph_find_node_from_port (self, dest);
       g_warn_if_fail (node);
       g_warn_if_fail (node2);
@@ -518,7 +632,9 @@ graph_update_latencies (
  * rechains.
  *
  * @param drop_unnecessary_ports Drops any ports
- *   that don't connect anywhere.
+ *   that don't connect anywhere, static control
+ *   ports (see Graph.num_pruned_ports) and idle
+ *   subgraphs (see Graph.num_pruned_processors).
  * @param rechain Whether to rechain or not. If
  *   we are just validating this should be 0.
  */
@@ -530,6 +646,18 @@ graph_setup (
 {
   GraphNode * node, * node2;
 
+  self->num_pruned_ports = 0;
+  self->num_pruned_processors = 0;
+  self->num_pruned_idle_ports = 0;
+
+  /* ports of idle subgraphs */
+  GHashTable * idle_ports =
+    g_hash_table_new (NULL, NULL);
+  size_t idle_max_size = 20;
+  Port ** idle_port_arr =
+    object_new_n (idle_max_size, Port *);
+  int num_idle_port_arr = 0;
+
   /* ========================
    * first add all the nodes
    * ======================== */
@@ -566,6 +694,38 @@ graph_setup (
           return;
         }
 
+      /* leave out the whole subgraph of idle
+       * tracks */
+      if (drop_unnecessary_ports &&
+          is_track_idle (tr))
+        {
+          num_idle_port_arr = 0;
+          track_append_all_ports (
+            tr, &idle_port_arr, &num_idle_port_arr,
+            true, &idle_max_size, true);
+          add_idle_ports (
+            idle_ports, idle_port_arr,
+            num_idle_port_arr);
+
+          /* track, prefader, fader and plugins */
+          self->num_pruned_processors += 3;
+          for (int j = 0; j < STRIP_SIZE * 2 + 1;
+               j++)
+            {
+              if (j < STRIP_SIZE)
+                pl = tr->channel->midi_fx[j];
+              else if (j == STRIP_SIZE)
+                pl = tr->channel->instrument;
+              else
+                pl =
+                  tr->channel->inserts[
+                    j - (STRIP_SIZE + 1)];
+              if (pl && !pl->deleting)
+                self->num_pruned_processors++;
+            }
+          continue;
+        }
+
       /* add the track */
       graph_create_node (
         self, ROUTE_NODE_TYPE_TRACK, tr);
@@ -577,6 +737,22 @@ graph_setup (
           if (!pl || pl->deleting)
             continue;
 
+          /* leave out modulators that don't
+           * modulate anything */
+          if (drop_unnecessary_ports &&
+              is_modulator_idle (pl))
+            {
+              num_idle_port_arr = 0;
+              plugin_append_ports (
+                pl, &idle_port_arr, &idle_max_size,
+                true, &num_idle_port_arr);
+              add_idle_ports (
+                idle_ports, idle_port_arr,
+                num_idle_port_arr);
+              self->num_pruned_processors++;
+              continue;
+            }
+
           add_plugin (self, pl);
           plugin_update_latency (pl);
         }
@@ -650,6 +826,12 @@ graph_setup (
             continue;
         }
 
+      if (g_hash_table_contains (idle_ports, port))
+        {
+          self->num_pruned_idle_ports++;
+          continue;
+        }
+
       GraphNode * port_node =
         add_port (
           self, port, drop_unnecessary_ports);
@@ -772,6 +954,10 @@ graph_setup (
     {
       tr = TRACKLIST->tracks[i];
 
+      if (drop_unnecessary_ports &&
+          is_track_idle (tr))
+        continue;
+
       /* connect the track */
       node =
         graph_find_node_from_track (self, tr, true);
@@ -930,7 +1116,9 @@ graph_setup (
             {
               pl = tr->modulators[j];
 
-              if (pl && !pl->deleting)
+              if (pl && !pl->deleting &&
+                  !(drop_unnecessary_ports &&
+                    is_modulator_idle (pl)))
                 {
                   connect_plugin (
                     self, pl,
@@ -948,7 +1136,7 @@ graph_setup (
                           self, pl_port);
                       if (drop_unnecessary_ports &&
                           !port_node &&
-                          port->id.type ==
+                          pl_port->id.type ==
                             TYPE_CONTROL)
                         {
                           continue;
@@ -1155,7 +1343,7 @@ graph_setup (
             continue;
         }
 
-      connect_port (self, port);
+      connect_port (self, port, idle_ports);
     }
 
   /* ========================
@@ -1203,6 +1391,15 @@ graph_setup (
 
   graph_update_latencies (self, true);
 
+  g_debug (
+    "graph setup: %zu nodes, %d static ports "
+    "pruned, %d idle processors pruned with %d "
+    "ports",
+    self->num_setup_graph_nodes,
+    self->num_pruned_ports,
+    self->num_pruned_processors,
+    self->num_pruned_idle_ports);
+
   /* ========================
    * set up caches to tracks, channels, plugins,
    * automation tracks, etc.
@@ -1219,7 +1416,26 @@ graph_setup (
   free (ports);
 
   if (rechain)
-    graph_rechain (self);
+    {
+      graph_rechain (self);
+      graph_buffer_planner_plan (self);
+
+      /* idle ports are no longer processed, so
+       * clear any data left from when they were
+       * (eg, a plugin output used as a
+       * sidechain by another track) */
+      GHashTableIter iter;
+      gpointer key;
+      g_hash_table_iter_init (&iter, idle_ports);
+      while (g_hash_table_iter_next (
+               &iter, &key, NULL))
+        {
+          port_clear_buffer ((Port *) key);
+        }
+    }
+
+  g_hash_table_unref (idle_ports);
+  free (idle_port_arr);
 }
 
 /**
@@ -1678,6 +1894,10 @@ graph_free (
   object_zero_and_free (
     self->terminal_nodes);
 
+  /* the ports are being freed too, so they are
+   * not given their buffers back */
+  free (self->shared_bufs_mem);
+
   zix_sem_destroy (&self->callback_start);
   zix_sem_destroy (&self->callback_done);
   zix_sem_destroy (&self->trigger);
@@ -0,0 +1,430 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "audio/channel.h"
+#include "audio/engine.h"
+#include "audio/graph.h"
+#include "audio/graph_buffer_planner.h"
+#include "audio/graph_node.h"
+#include "audio/port.h"
+#include "audio/track.h"
+#include "audio/tracklist.h"
+#include "plugins/plugin.h"
+#include "project.h"
+#include "utils/object_utils.h"
+#include "utils/objects.h"
+
+#include <glib.h>
+
+/**
+ * A buffer in the arena and the nodes that use
+ * the port that was last assigned to it.
+ */
+typedef struct BufferSlot
+{
+  /** Ports assigned to this buffer. */
+  GPtrArray * ports;
+
+  /** Nodes using the last port assigned. */
+  GPtrArray * uses;
+} BufferSlot;
+
+static void
+buffer_slot_free (
+  BufferSlot * self)
+{
+  g_ptr_array_unref (self->ports);
+  g_ptr_array_unref (self->uses);
+  free (self);
+}
+
+/**
+ * Returns whether the port can use a shared
+ * buffer.
+ */
+static bool
+is_port_shareable (
+  Port * port)
+{
+  return
+    port->id.type == TYPE_AUDIO &&
+    port->id.owner_type == PORT_OWNER_TYPE_PLUGIN &&
+    port->buf &&
+    !port->exposed_to_backend &&
+    port->min_buf_size <=
+      (size_t) AUDIO_ENGINE->block_length;
+}
+
+/**
+ * Returns the ancestors of the given node (not
+ * including the node itself), up to
+ * GRAPH_BUFFER_PLANNER_MAX_ANCESTORS of them.
+ */
+static GHashTable *
+get_ancestors (
+  GraphNode * node)
+{
+  GHashTable * ancestors =
+    g_hash_table_new (NULL, NULL);
+  GQueue queue = G_QUEUE_INIT;
+  g_queue_push_tail (&queue, node);
+  while (!g_queue_is_empty (&queue) &&
+         g_hash_table_size (ancestors) <
+           GRAPH_BUFFER_PLANNER_MAX_ANCESTORS)
+    {
+      GraphNode * cur = g_queue_pop_head (&queue);
+      for (int i = 0; i < cur->init_refcount; i++)
+        {
+          GraphNode * parent = cur->parentnodes[i];
+          if (g_hash_table_add (ancestors, parent))
+            {
+              g_queue_push_tail (&queue, parent);
+            }
+        }
+    }
+  g_queue_clear (&queue);
+
+  return ancestors;
+}
+
+/**
+ * Finds a slot among the slots of the current
+ * channel that is no longer used when the given
+ * node starts processing.
+ */
+static BufferSlot *
+find_free_slot (
+  GPtrArray * slots,
+  guint       first_slot,
+  GraphNode * def_node)
+{
+  GHashTable * ancestors =
+    get_ancestors (def_node);
+  BufferSlot * found = NULL;
+  for (guint i = first_slot;
+       i < slots->len && !found; i++)
+    {
+      BufferSlot * slot =
+        g_ptr_array_index (slots, i);
+      bool all_done = true;
+      for (guint j = 0; j < slot->uses->len; j++)
+        {
+          if (!g_hash_table_contains (
+                 ancestors,
+                 g_ptr_array_index (slot->uses, j)))
+            {
+              all_done = false;
+              break;
+            }
+        }
+      if (all_done)
+        found = slot;
+    }
+  g_hash_table_unref (ancestors);
+
+  return found;
+}
+
+/**
+ * Assigns the given plugin port to a buffer slot.
+ *
+ * @param pl_node The node of the plugin owning
+ *   the port.
+ */
+static void
+assign_port (
+  GPtrArray *  slots,
+  guint        first_slot,
+  GHashTable * port_nodes,
+  GraphNode *  pl_node,
+  Port *       port)
+{
+  GraphNode * port_node =
+    g_hash_table_lookup (port_nodes, port);
+  if (!port_node)
+    return;
+
+  /* inputs are written when their sources are
+   * summed and outputs when the plugin runs */
+  GraphNode * def_node =
+    port->id.flow == FLOW_OUTPUT ?
+      pl_node : port_node;
+
+  GPtrArray * uses = g_ptr_array_new ();
+  g_ptr_array_add (uses, port_node);
+  if (def_node != port_node)
+    g_ptr_array_add (uses, def_node);
+  for (int i = 0; i < port_node->n_childnodes; i++)
+    {
+      g_ptr_array_add (
+        uses, port_node->childnodes[i]);
+    }
+
+  BufferSlot * slot =
+    find_free_slot (slots, first_slot, def_node);
+  if (slot)
+    {
+      g_ptr_array_unref (slot->uses);
+    }
+  else
+    {
+      slot = object_new (BufferSlot);
+      slot->ports = g_ptr_array_new ();
+      g_ptr_array_add (slots, slot);
+    }
+  g_ptr_array_add (slot->ports, port);
+  slot->uses = uses;
+}
+
+/**
+ * Adds the port to the ports to clear by the node
+ * that first writes it.
+ */
+static void
+add_port_to_clear (
+  GHashTable * port_nodes,
+  GHashTable * plugin_nodes,
+  Port *       port)
+{
+  GraphNode * node =
+    port->id.flow == FLOW_OUTPUT ?
+      g_hash_table_lookup (
+        plugin_nodes, port_get_plugin (port, true)) :
+      g_hash_table_lookup (port_nodes, port);
+  g_return_if_fail (node);
+
+  node->shared_ports_to_clear =
+    g_realloc (
+      node->shared_ports_to_clear,
+      (size_t) (node->num_shared_ports_to_clear + 1) *
+        sizeof (Port *));
+  node->shared_ports_to_clear[
+    node->num_shared_ports_to_clear++] = port;
+}
+
+/**
+ * Gives all the ports sharing buffers their own
+ * buffers again and frees the arena.
+ *
+ * Must not be called while the graph is
+ * processing.
+ */
+void
+graph_buffer_planner_unshare (
+  Graph * self)
+{
+  for (int i = 0; i < self->n_graph_nodes; i++)
+    {
+      GraphNode * node = self->graph_nodes[i];
+      g_free_and_null (node->shared_ports_to_clear);
+      node->num_shared_ports_to_clear = 0;
+    }
+
+  if (!self->shared_bufs_mem)
+    return;
+
+  size_t max_size = 20;
+  Port ** ports =
+    object_new_n (max_size, Port *);
+  int num_ports = 0;
+  port_get_all (
+    &ports, &max_size, true, &num_ports);
+  for (int i = 0; i < num_ports; i++)
+    {
+      Port * port = ports[i];
+      if (!port->buf_is_shared)
+        continue;
+
+      size_t size =
+        MAX (
+          AUDIO_ENGINE->block_length,
+          port->min_buf_size);
+      port->buf = object_new_n (MAX (size, 1), float);
+      port->buf_is_shared = false;
+    }
+  free (ports);
+
+  /* the UI may still be reading from the old
+   * buffers */
+  free_later (self->shared_bufs_mem, free);
+  self->shared_bufs_mem = NULL;
+  self->shared_bufs = NULL;
+  self->num_shared_bufs = 0;
+  self->num_shared_ports = 0;
+}
+
+/**
+ * Assigns shared buffers to the ports in the
+ * current (rechained) graph, if enabled in the
+ * engine, and restores the own buffers of the
+ * ports that were sharing buffers.
+ *
+ * Must not be called while the graph is
+ * processing.
+ */
+void
+graph_buffer_planner_plan (
+  Graph * self)
+{
+  graph_buffer_planner_unshare (self);
+
+  if (!AUDIO_ENGINE->share_port_buffers ||
+      AUDIO_ENGINE->block_length == 0)
+    return;
+
+  gint64 start_time = g_get_monotonic_time ();
+
+  /* index the nodes */
+  GHashTable * port_nodes =
+    g_hash_table_new (NULL, NULL);
+  GHashTable * plugin_nodes =
+    g_hash_table_new (NULL, NULL);
+  for (int i = 0; i < self->n_graph_nodes; i++)
+    {
+      GraphNode * node = self->graph_nodes[i];
+      if (node->type == ROUTE_NODE_TYPE_PORT)
+        {
+          g_hash_table_insert (
+            port_nodes, node->port, node);
+        }
+      else if (node->type == ROUTE_NODE_TYPE_PLUGIN)
+        {
+          g_hash_table_insert (
+            plugin_nodes, node->pl, node);
+        }
+    }
+
+  /* plan each channel separately, following the
+   * order of the plugins in the channel so that
+   * the buffers are reused down the chain */
+  GPtrArray * slots =
+    g_ptr_array_new_with_free_func (
+      (GDestroyNotify) buffer_slot_free);
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      Track * tr = TRACKLIST->tracks[i];
+      if (!tr->channel)
+        continue;
+
+      guint first_slot = slots->len;
+      Channel * ch = tr->channel;
+      for (int j = 0; j < STRIP_SIZE * 2 + 1; j++)
+        {
+          Plugin * pl;
+          if (j < STRIP_SIZE)
+            pl = ch->midi_fx[j];
+          else if (j == STRIP_SIZE)
+            pl = ch->instrument;
+          else
+            pl = ch->inserts[j - (STRIP_SIZE + 1)];
+          if (!pl || pl->deleting)
+            continue;
+
+          GraphNode * pl_node =
+            g_hash_table_lookup (plugin_nodes, pl);
+          if (!pl_node)
+            continue;
+
+          for (int k = 0; k < pl->num_in_ports; k++)
+            {
+              Port * port = pl->in_ports[k];
+              if (is_port_shareable (port))
+                {
+                  assign_port (
+                    slots, first_slot, port_nodes,
+                    pl_node, port);
+                }
+            }
+          for (int k = 0; k < pl->num_out_ports; k++)
+            {
+              Port * port = pl->out_ports[k];
+              if (is_port_shareable (port))
+                {
+                  assign_port (
+                    slots, first_slot, port_nodes,
+                    pl_node, port);
+                }
+            }
+        }
+    }
+
+  /* allocate the arena, with each buffer
+   * aligned */
+  const size_t floats_per_align =
+    GRAPH_SHARED_BUF_ALIGNMENT / sizeof (float);
+  const size_t stride =
+    ((AUDIO_ENGINE->block_length +
+        floats_per_align - 1) /
+       floats_per_align) * floats_per_align;
+  if (slots->len > 0)
+    {
+      self->shared_bufs_mem =
+        calloc (
+          stride * slots->len * sizeof (float) +
+            GRAPH_SHARED_BUF_ALIGNMENT,
+          1);
+      uintptr_t addr =
+        (uintptr_t) self->shared_bufs_mem;
+      addr =
+        (addr + GRAPH_SHARED_BUF_ALIGNMENT - 1) &
+        ~((uintptr_t) GRAPH_SHARED_BUF_ALIGNMENT - 1);
+      self->shared_bufs = (float *) addr;
+    }
+
+  /* point the ports to the arena */
+  for (guint i = 0; i < slots->len; i++)
+    {
+      BufferSlot * slot =
+        g_ptr_array_index (slots, i);
+      float * buf = &self->shared_bufs[i * stride];
+      for (guint j = 0; j < slot->ports->len; j++)
+        {
+          Port * port =
+            g_ptr_array_index (slot->ports, j);
+          object_zero_and_free (port->buf);
+          port->buf = buf;
+          port->buf_is_shared = true;
+          add_port_to_clear (
+            port_nodes, plugin_nodes, port);
+          self->num_shared_ports++;
+        }
+    }
+  self->num_shared_bufs = (int) slots->len;
+
+  g_ptr_array_unref (slots);
+  g_hash_table_unref (port_nodes);
+  g_hash_table_unref (plugin_nodes);
+
+  size_t block_size =
+    AUDIO_ENGINE->block_length * sizeof (float);
+  g_debug (
+    "%s: %d port buffers (%zu KiB) now share %d "
+    "buffers (%zu KiB), planned in %"
+    G_GINT64_FORMAT " us",
+    __func__, self->num_shared_ports,
+    ((size_t) self->num_shared_ports *
+       block_size) / 1024,
+    self->num_shared_bufs,
+    ((size_t) self->num_shared_bufs * stride *
+       sizeof (float)) / 1024,
+    g_get_monotonic_time () - start_time);
+}
@@ -358,6 +358,20 @@ export_as_graphviz_type (
       (char *) "routing_graph", Agstrictdirected,
       NULL);
 
+  /* show how many ports were left out */
+  char graph_label[600];
+  sprintf (
+    graph_label,
+    "%zu nodes (%d static ports pruned, %d idle "
+    "processors pruned with %d ports)",
+    graph->num_setup_graph_nodes,
+    graph->num_pruned_ports,
+    graph->num_pruned_processors,
+    graph->num_pruned_idle_ports);
+  agsafeset (
+    agraph, (char *) "label", graph_label,
+    (char *) "");
+
   /* fill anodes with subgraphs */
   ANode * anodes =
     object_new_n (
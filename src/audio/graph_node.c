@@ -38,11 +38,14 @@
 #include <inttypes.h>
 #include <stdlib.h>
 
+#include "audio/automation_track.h"
+#include "audio/dsp_profiler.h"
 #include "audio/engine.h"
 #include "audio/fader.h"
 #include "audio/graph.h"
 #include "audio/graph_node.h"
 #include "audio/master_track.h"
+#include "audio/midi.h"
 #include "audio/midi_event.h"
 #include "audio/port.h"
 #include "audio/router.h"
@@ -55,6 +58,7 @@
 #include "plugins/plugin.h"
 #include "project.h"
 #include "utils/arrays.h"
+#include "utils/dsp.h"
 #include "utils/mpmc_queue.h"
 #include "utils/objects.h"
 
@@ -237,6 +241,129 @@ on_node_finish (
     }
 }
 
+/**
+ * Returns the number of frames to process the
+ * plugin for before the next parameter change,
+ * starting at the given position.
+ */
+static nframes_t
+get_sub_block_length (
+  GraphNode *     node,
+  long            g_start_frames,
+  const nframes_t local_offset,
+  const nframes_t nframes)
+{
+  const nframes_t min_size =
+    AUDIO_ENGINE->automation_sub_block_size;
+  if (nframes <= min_size)
+    return nframes;
+
+  nframes_t len = nframes;
+  for (int i = 0; i < node->num_sub_block_ports;
+       i++)
+    {
+      Port * port = node->sub_block_ports[i];
+
+      /* CV changes continuously */
+      if (port->num_srcs > 0)
+        {
+          return min_size;
+        }
+
+      /* automation only changes while rolling */
+      AutomationTrack * at = port->at;
+      long change_frames;
+      if (TRANSPORT_IS_ROLLING && at &&
+          automation_track_should_read_automation (
+            at, AUDIO_ENGINE->timestamp_start) &&
+          automation_track_get_next_change_frames (
+            at, g_start_frames, false,
+            &change_frames) &&
+          change_frames - g_start_frames <
+            (long) len)
+        {
+          len =
+            (nframes_t)
+            (change_frames - g_start_frames);
+          if (len <= min_size)
+            return min_size;
+        }
+    }
+
+  /* split at MIDI CC events */
+  Plugin * pl = node->pl;
+  for (int i = 0; i < pl->num_in_ports; i++)
+    {
+      Port * port = pl->in_ports[i];
+      if (port->id.type != TYPE_EVENT ||
+          !port->midi_events)
+        continue;
+
+      MidiEvents * events = port->midi_events;
+      for (int j = 0; j < events->num_events; j++)
+        {
+          MidiEvent * ev = &events->events[j];
+          if ((ev->raw_buffer[0] & 0xf0) !=
+                MIDI_CH1_CTRL_CHANGE ||
+              ev->time <= local_offset ||
+              ev->time >= local_offset + len)
+            continue;
+
+          len = ev->time - local_offset;
+        }
+    }
+
+  return MAX (len, min_size);
+}
+
+/**
+ * Processes the plugin in sub-blocks that end at
+ * automation changes and MIDI CC events, updating
+ * its automated control ports at the start of
+ * each sub-block.
+ */
+static void
+process_plugin_in_sub_blocks (
+  GraphNode *     node,
+  long            g_start_frames,
+  const nframes_t local_offset,
+  const nframes_t nframes)
+{
+  nframes_t processed = 0;
+  while (processed < nframes)
+    {
+      long sub_g_start_frames =
+        g_start_frames + (long) processed;
+      nframes_t sub_local_offset =
+        local_offset + processed;
+      nframes_t remaining = nframes - processed;
+
+      /* the port nodes already set the values for
+       * the start of the block */
+      if (processed > 0)
+        {
+          for (int i = 0;
+               i < node->num_sub_block_ports; i++)
+            {
+              port_process (
+                node->sub_block_ports[i],
+                sub_g_start_frames,
+                sub_local_offset, remaining,
+                false);
+            }
+        }
+
+      nframes_t len =
+        get_sub_block_length (
+          node, sub_g_start_frames,
+          sub_local_offset, remaining);
+      plugin_process (
+        node->pl, sub_g_start_frames,
+        sub_local_offset, len);
+      processed += len;
+    }
+}
+
 HOT
 static void
 process_node (
@@ -248,9 +375,19 @@ process_node (
   switch (node->type)
     {
     case ROUTE_NODE_TYPE_PLUGIN:
-      plugin_process (
-        node->pl, g_start_frames, local_offset,
-        nframes);
+      if (AUDIO_ENGINE->automation_sub_block_size >
+            0)
+        {
+          process_plugin_in_sub_blocks (
+            node, g_start_frames, local_offset,
+            nframes);
+        }
+      else
+        {
+          plugin_process (
+            node->pl, g_start_frames, local_offset,
+            nframes);
+        }
       break;
     case ROUTE_NODE_TYPE_FADER:
       fader_process (
@@ -352,6 +489,17 @@ graph_node_process (
   nframes_t local_offset =
     node->graph->router->local_offset;
 
+  /* shared buffers contain the data of other
+   * ports until this node writes them */
+  for (int i = 0;
+       i < node->num_shared_ports_to_clear; i++)
+    {
+      dsp_fill (
+        &node->shared_ports_to_clear[i]->buf[
+          local_offset],
+        DENORMAL_PREVENTION_VAL, nframes);
+    }
+
   /* skip BPM during cycle (already processed in
    * router_start_cycle()) */
   if (G_UNLIKELY (
@@ -483,6 +631,12 @@ graph_node_trigger (
        * now. */
       g_atomic_int_inc (
         &self->graph->trigger_queue_size);
+      if (g_atomic_pointer_get (
+            &AUDIO_ENGINE->profiler))
+        {
+          self->trigger_time =
+            dsp_profiler_get_time ();
+        }
       /*g_message ("triggering node, pushing back");*/
       mpmc_queue_push_back_node (
         self->graph->trigger_queue, self);
@@ -672,6 +826,8 @@ graph_node_free (
 {
   free (self->childnodes);
   free (self->parentnodes);
+  free (self->sub_block_ports);
+  g_free (self->shared_ports_to_clear);
 
   object_zero_and_free (self);
 }
@@ -37,6 +37,7 @@
 
 #include "zrythm-config.h"
 
+#include "audio/dsp_profiler.h"
 #include "audio/engine.h"
 #include "audio/graph.h"
 #include "audio/graph_node.h"
@@ -190,8 +191,25 @@ worker_thread (void * arg)
 #ifdef DEBUG_THREADS
       g_message ("[%d]: running node", thread->id);
 #endif
-      graph_node_process (
-        to_run, graph->router->nsamples);
+      DspProfiler * profiler =
+        g_atomic_pointer_get (
+          &AUDIO_ENGINE->profiler);
+      if (profiler)
+        {
+          gint64 start = dsp_profiler_get_time ();
+          graph_node_process (
+            to_run, graph->router->nsamples);
+          dsp_profiler_record_node (
+            profiler, to_run,
+            dsp_profiler_get_graph_thread_slot (
+              thread->id),
+            start, dsp_profiler_get_time ());
+        }
+      else
+        {
+          graph_node_process (
+            to_run, graph->router->nsamples);
+        }
 
     }
 
@@ -238,10 +256,16 @@ main_thread (void * arg)
   /* bootstrap trigger-list.
    * (later this is done by
    * Graph_reached_terminal_node)*/
+  gint64 trigger_time =
+    g_atomic_pointer_get (
+      &AUDIO_ENGINE->profiler) ?
+        dsp_profiler_get_time () : 0;
   for (size_t i = 0;
        i < self->n_init_triggers; ++i)
     {
       g_atomic_int_inc (&self->trigger_queue_size);
+      self->init_trigger_list[i]->trigger_time =
+        trigger_time;
       /*g_message ("[main] pushing back node %d during bootstrap", i);*/
       mpmc_queue_push_back_node (
         self->trigger_queue,
@@ -54,9 +54,9 @@ meter_get_value (
   if (port->id.type == TYPE_AUDIO ||
       port->id.type == TYPE_CV)
     {
-      g_return_if_fail (port->audio_ring);
       int num_cycles = 4;
       size_t read_space_avail =
+        port->audio_ring == NULL ? 0 :
         zix_ring_read_space (port->audio_ring);
       size_t size =
         sizeof (float) *
@@ -93,6 +93,12 @@ meter_get_value (
           return;
         }
 
+      /* the port buffer is being written by the
+       * engine, so only use the copy from the
+       * ring */
+      const size_t num_frames =
+        (size_t) num_cycles *
+          AUDIO_ENGINE->block_length;
       switch (self->algorithm)
         {
         case METER_ALGORITHM_RMS:
@@ -100,15 +106,12 @@ meter_get_value (
           g_warn_if_reached ();
           amp =
             math_calculate_rms_amp (
-              &buf[start_index],
-              (size_t) num_cycles *
-                AUDIO_ENGINE->block_length);
+              &buf[start_index], num_frames);
           break;
         case METER_ALGORITHM_TRUE_PEAK:
           true_peak_dsp_process (
             self->true_peak_processor,
-            &port->buf[0],
-            (int) AUDIO_ENGINE->block_length);
+            &buf[start_index], (int) num_frames);
           amp =
             true_peak_dsp_read_f (
               self->true_peak_processor);
@@ -116,16 +119,14 @@ meter_get_value (
         case METER_ALGORITHM_K:
           kmeter_dsp_process (
             self->kmeter_processor,
-            &port->buf[0],
-            (int) AUDIO_ENGINE->block_length);
+            &buf[start_index], (int) num_frames);
           kmeter_dsp_read (
             self->kmeter_processor, &amp, &max_amp);
           break;
         case METER_ALGORITHM_DIGITAL_PEAK:
           peak_dsp_process (
             self->peak_processor,
-            &port->buf[0],
-            (int) AUDIO_ENGINE->block_length);
+            &buf[start_index], (int) num_frames);
           peak_dsp_read (
             self->peak_processor, &amp, &max_amp);
           break;
@@ -136,7 +137,7 @@ meter_get_value (
   else if (port->id.type == TYPE_EVENT)
     {
       bool on = false;
-      if (port->write_ring_buffers)
+      if (port->midi_ring)
         {
           MidiEvent event;
           while (
@@ -229,6 +230,17 @@ meter_new_for_port (
   Meter * self = object_new (Meter);
 
   self->port = port;
+  port_identifier_copy (&self->port_id, &port->id);
+
+  /* the audio ring of the port is only filled
+   * while meters are reading it */
+  if (port->id.type == TYPE_AUDIO ||
+      port->id.type == TYPE_CV)
+    {
+      self->ring_token =
+        port_subscribe_to_rings (port);
+      self->subscribed = true;
+    }
 
   /* master */
   if (port->id.type == TYPE_AUDIO ||
@@ -269,10 +281,61 @@ meter_new_for_port (
   return self;
 }
 
+/**
+ * Subscribes to or unsubscribes from the ring
+ * buffers of the port.
+ *
+ * Meters that are not subscribed only show
+ * values if another reader is subscribed.
+ *
+ * If the port no longer exists, the meter is
+ * only marked as unsubscribed.
+ */
+void
+meter_set_subscribed (
+  Meter * self,
+  bool    subscribed)
+{
+  if (self->subscribed == subscribed ||
+      (self->port_id.type != TYPE_AUDIO &&
+       self->port_id.type != TYPE_CV))
+    return;
+
+  /* the port may have been freed (and its rings
+   * with it), so look it up before using the
+   * cached pointer */
+  Port * port =
+    port_find_from_identifier (&self->port_id);
+  if (!subscribed)
+    {
+      self->subscribed = false;
+
+      /* a port created again with the same
+       * identifier never got this subscription */
+      if (port &&
+          port->ring_token == self->ring_token &&
+          port_has_ring_subscribers (port))
+        port_unsubscribe_from_rings (port);
+      self->ring_token = 0;
+      return;
+    }
+
+  self->port = port;
+
+  if (!port)
+    return;
+
+  self->ring_token =
+    port_subscribe_to_rings (port);
+  self->subscribed = true;
+}
+
 void
 meter_free (
   Meter * self)
 {
+  meter_set_subscribed (self, false);
+
 #define FREE_DSP(x,name) \
   if (self->x) \
     { \
@@ -286,5 +349,7 @@ meter_free (
 
 #undef FREE_DSP
 
+  port_identifier_free_members (&self->port_id);
+
   free (self);
 }
@@ -656,6 +656,22 @@ midi_events_sort (
       events = self->events;
       num_events = (size_t) self->num_events;
     }
+
+  /* regions filled from their note stores usually
+   * produce sorted events already */
+  bool sorted = true;
+  for (size_t i = 1; i < num_events; i++)
+    {
+      if (midi_event_cmpfunc (
+            &events[i - 1], &events[i]) > 0)
+        {
+          sorted = false;
+          break;
+        }
+    }
+  if (sorted)
+    return;
+
   qsort (events, num_events, sizeof (MidiEvent),
          midi_event_cmpfunc);
 }
@@ -21,7 +21,9 @@
 
 #include "audio/midi_event.h"
 #include "audio/midi_note.h"
+#include "audio/midi_region.h"
 #include "audio/position.h"
+#include "audio/region_content.h"
 #include "audio/track.h"
 #include "audio/velocity.h"
 #include "gui/backend/midi_arranger_selections.h"
@@ -319,6 +321,8 @@ midi_note_set_val (
     }
 
   midi_note->val = val;
+  midi_region_invalidate_note_store_for_region_id (
+    &midi_note->base.region_id);
 }
 
 /**
@@ -341,7 +345,9 @@ midi_note_get_region (
   MidiNote * self)
 {
   ArrangerObject * obj = (ArrangerObject *) self;
-  return region_find (&obj->region_id);
+  return
+    region_content_get_region_for_editor (
+      region_find (&obj->region_id));
 }
 
 /**
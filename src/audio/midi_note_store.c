@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "audio/midi_note.h"
+#include "audio/midi_note_store.h"
+#include "audio/region.h"
+#include "audio/velocity.h"
+#include "gui/backend/arranger_object.h"
+#include "utils/objects.h"
+
+#include <glib.h>
+
+static int
+cmp_events (
+  const void * _a,
+  const void * _b)
+{
+  const MidiNoteStoreEvent * a =
+    (const MidiNoteStoreEvent *) _a;
+  const MidiNoteStoreEvent * b =
+    (const MidiNoteStoreEvent *) _b;
+  if (a->frames != b->frames)
+    return a->frames < b->frames ? -1 : 1;
+
+  /* note offs first */
+  return (int) a->note_on - (int) b->note_on;
+}
+
+/**
+ * Adds the note ons and note offs of the unmuted
+ * notes and sorts them.
+ */
+static void
+create_events (
+  MidiNoteStore * self)
+{
+  self->events =
+    object_new_n (
+      (size_t) self->num_notes * 2,
+      MidiNoteStoreEvent);
+  for (int i = 0; i < self->num_notes; i++)
+    {
+      if (self->flags[i] &
+            MIDI_NOTE_STORE_FLAG_MUTED)
+        continue;
+
+      /* notes starting before the region are
+       * never started */
+      if (self->start_frames[i] >= 0)
+        {
+          MidiNoteStoreEvent * ev =
+            &self->events[self->num_events++];
+          ev->frames = self->start_frames[i];
+          ev->pitch = self->pitches[i];
+          ev->velocity = self->velocities[i];
+          ev->note_on = true;
+        }
+
+      /* the note actually ends 1 frame before the
+       * end point */
+      MidiNoteStoreEvent * ev =
+        &self->events[self->num_events++];
+      ev->frames = self->end_frames[i] - 1;
+      ev->pitch = self->pitches[i];
+      ev->note_on = false;
+    }
+
+  qsort (
+    self->events, (size_t) self->num_events,
+    sizeof (MidiNoteStoreEvent), cmp_events);
+}
+
+/**
+ * Creates a store from the MIDI notes of the given
+ * region.
+ */
+MidiNoteStore *
+midi_note_store_new_from_region (
+  ZRegion * region)
+{
+  MidiNoteStore * self =
+    object_new (MidiNoteStore);
+
+  int num_notes = region->num_midi_notes;
+  self->num_notes = num_notes;
+  if (num_notes == 0)
+    return self;
+
+  /* allocate all arrays in a single block, largest
+   * elements first to keep them aligned */
+  size_t n = (size_t) num_notes;
+  char * block =
+    malloc (
+      n * (2 * sizeof (long) +
+        2 * sizeof (midi_byte_t) +
+        sizeof (uint8_t)));
+  g_return_val_if_fail (block, self);
+  self->start_frames = (long *) block;
+  self->end_frames = self->start_frames + n;
+  self->pitches =
+    (midi_byte_t *) (self->end_frames + n);
+  self->velocities = self->pitches + n;
+  self->flags = self->velocities + n;
+
+  for (int i = 0; i < num_notes; i++)
+    {
+      MidiNote * mn = region->midi_notes[i];
+      ArrangerObject * mn_obj =
+        (ArrangerObject *) mn;
+      self->start_frames[i] = mn_obj->pos.frames;
+      self->end_frames[i] = mn_obj->end_pos.frames;
+      self->pitches[i] = mn->val;
+      self->velocities[i] = mn->vel->vel;
+      self->flags[i] =
+        arranger_object_get_muted (mn_obj) ?
+          MIDI_NOTE_STORE_FLAG_MUTED : 0;
+    }
+
+  create_events (self);
+
+  return self;
+}
+
+/**
+ * Returns the index of the first event at or after
+ * the given region-local frame, or
+ * \ref MidiNoteStore.num_events if there is none.
+ */
+int
+midi_note_store_find_first_event (
+  const MidiNoteStore * self,
+  long                  frames)
+{
+  int lo = 0;
+  int hi = self->num_events;
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+      if (self->events[mid].frames < frames)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+void
+midi_note_store_free (
+  MidiNoteStore * self)
+{
+  /* the other arrays share the block */
+  free (self->start_frames);
+  free (self->events);
+
+  object_zero_and_free (self);
+}
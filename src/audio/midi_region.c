@@ -42,8 +42,10 @@
 #include "audio/midi_event.h"
 #include "audio/midi_file.h"
 #include "audio/midi_note.h"
+#include "audio/midi_note_store.h"
 #include "audio/midi_region.h"
 #include "audio/region.h"
+#include "audio/region_content.h"
 #include "audio/tempo_track.h"
 #include "audio/track.h"
 #include "gui/backend/event.h"
@@ -193,6 +195,8 @@ midi_region_insert_midi_note (
   self->midi_notes[idx] = midi_note;
   midi_note_set_region_and_index (
     midi_note, self, idx);
+  region_content_sync (self);
+  midi_region_invalidate_note_store (self);
 
   if (pub_events)
     {
@@ -371,6 +375,8 @@ midi_region_remove_midi_note (
       midi_note_set_region_and_index (
         region->midi_notes[i], region, i);
     }
+  region_content_sync (region);
+  midi_region_invalidate_note_store (region);
 
   if (free)
     free_later (midi_note, arranger_object_free);
@@ -1047,6 +1053,63 @@ send_notes_off_at (
 
 }
 
+/**
+ * Fills MIDI events from the sorted events in the
+ * note store.
+ *
+ * This is equivalent to the MidiNote walk in
+ * midi_region_fill_midi_events(), but only visits
+ * the events inside the range and adds them in
+ * order.
+ */
+REALTIME
+static void
+fill_midi_events_from_store (
+  ZRegion *             self,
+  const MidiNoteStore * store,
+  long                  r_local_pos,
+  nframes_t             local_start_frame,
+  nframes_t             nframes,
+  MidiEvents *          midi_events)
+{
+  midi_byte_t channel =
+    midi_region_get_midi_ch (self);
+  long r_local_end = r_local_pos + (long) nframes;
+
+  /* note offs of notes ending at the start of the
+   * range are sent 1 frame before it */
+  for (int i =
+         midi_note_store_find_first_event (
+           store, r_local_pos - 1);
+       i < store->num_events &&
+         store->events[i].frames < r_local_end;
+       i++)
+    {
+      const MidiNoteStoreEvent * ev =
+        &store->events[i];
+      long offset =
+        (long) local_start_frame +
+        (ev->frames - r_local_pos);
+      if (ev->note_on)
+        {
+          if (ev->frames < r_local_pos)
+            continue;
+
+          midi_events_add_note_on (
+            midi_events, channel, ev->pitch,
+            ev->velocity, (midi_time_t) offset,
+            F_QUEUED);
+        }
+      else
+        {
+          midi_events_add_note_off (
+            midi_events, channel, ev->pitch,
+            (midi_time_t) MAX (offset, 0),
+            F_QUEUED);
+        }
+    }
+}
+
 /**
  * Fills MIDI event queue from the region.
  *
@@ -1083,6 +1146,35 @@ midi_region_fill_midi_events (
     (ArrangerObject *) self;
   Track * track = arranger_object_get_track (r_obj);
 
+  long r_local_pos =
+    region_timeline_frames_to_local (
+      self, g_start_frames, F_NORMALIZE);
+
+  MidiNoteStore * store =
+    (MidiNoteStore *)
+    g_atomic_pointer_get (&self->note_store);
+  if (track->type != TRACK_TYPE_CHORD &&
+      store &&
+      !g_atomic_int_get (&self->note_store_dirty))
+    {
+      fill_midi_events_from_store (
+        self, store, r_local_pos,
+        local_start_frame, nframes, midi_events);
+
+      /* send all MIDI notes off if needed (last,
+       * so that the events stay sorted) */
+      if (note_off_at_end)
+        {
+          send_notes_off_at (
+            self, midi_events,
+            (midi_time_t)
+              /* -1 to send event 1 sample
+               * before the end point */
+              ((local_start_frame + nframes) - 1));
+        }
+      return;
+    }
+
   /* send all MIDI notes off if needed */
   if (note_off_at_end)
     {
@@ -1094,10 +1186,6 @@ midi_region_fill_midi_events (
           ((local_start_frame + nframes) - 1));
     }
 
-  long r_local_pos =
-    region_timeline_frames_to_local (
-      self, g_start_frames, F_NORMALIZE);
-
 #if 0
   if (g_start_frames == 0)
     {
@@ -1232,6 +1320,100 @@ midi_region_fill_midi_events (
     } /* foreach midi note */
 }
 
+/**
+ * Marks the note store of the region, and of the
+ * regions sharing its notes, as out of date.
+ *
+ * To be called when the MIDI notes of the region
+ * change.
+ */
+void
+midi_region_invalidate_note_store (
+  ZRegion * self)
+{
+  /* linked regions share the notes */
+  if (self->content)
+    {
+      for (int i = 0;
+           i < self->content->num_regions; i++)
+        {
+          g_atomic_int_set (
+            &self->content->regions[i]->
+              note_store_dirty, 1);
+        }
+      return;
+    }
+
+  g_atomic_int_set (&self->note_store_dirty, 1);
+}
+
+/**
+ * Marks the note store of the region referenced by
+ * the given region identifier as out of date, if
+ * such a region exists.
+ */
+void
+midi_region_invalidate_note_store_for_region_id (
+  const RegionIdentifier * id)
+{
+  /* objects that are not part of the project
+   * (eg, clones in the undo history) may point to
+   * regions that don't exist, so don't warn */
+  if (id->type != REGION_TYPE_MIDI ||
+      !PROJECT || !TRACKLIST ||
+      id->track_pos < 0 ||
+      id->track_pos >= TRACKLIST->num_tracks)
+    return;
+
+  Track * track = TRACKLIST->tracks[id->track_pos];
+  if (!track ||
+      id->lane_pos < 0 ||
+      id->lane_pos >= track->num_lanes)
+    return;
+
+  TrackLane * lane = track->lanes[id->lane_pos];
+  if (!lane || id->idx < 0 ||
+      id->idx >= lane->num_regions)
+    return;
+
+  midi_region_invalidate_note_store (
+    lane->regions[id->idx]);
+}
+
+/**
+ * Recreates the note store if it is out of date
+ * (or if \ref force is true) and publishes it.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+midi_region_update_note_store (
+  ZRegion * self,
+  bool      force)
+{
+  g_return_if_fail (
+    self->id.type == REGION_TYPE_MIDI);
+
+  if (!force && self->note_store &&
+      !g_atomic_int_get (&self->note_store_dirty))
+    return;
+
+  /* clear the flag before creating the store so
+   * that edits made meanwhile are not lost */
+  g_atomic_int_set (&self->note_store_dirty, 0);
+  MidiNoteStore * store =
+    midi_note_store_new_from_region (self);
+  MidiNoteStore * prev_store = self->note_store;
+  g_atomic_pointer_set (&self->note_store, store);
+
+  /* the processing thread may still be using the
+   * previous store */
+  if (prev_store)
+    {
+      free_later (prev_store, midi_note_store_free);
+    }
+}
+
 /**
  * Fills in the array with all the velocities in
  * the project that are within or outside the
@@ -1300,4 +1482,7 @@ midi_region_free_members (ZRegion * self)
       arranger_object_free (
         (ArrangerObject *) self->midi_notes[i]);
     }
+
+  object_free_w_func_and_null (
+    midi_note_store_free, self->note_store);
 }
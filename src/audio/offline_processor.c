@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "audio/offline_processor.h"
+#include "utils/objects.h"
+
+#include <glib.h>
+
+static bool
+is_cancelled (
+  OfflineProcessor * self)
+{
+  return
+    self->progress_info &&
+    self->progress_info->cancelled;
+}
+
+/**
+ * Thread pool job that processes a chunk.
+ */
+static void
+process_chunk (
+  OfflineProcessorChunk * chunk,
+  OfflineProcessor *      self)
+{
+  bool processed = false;
+  if (!is_cancelled (self))
+    {
+      self->func (self, chunk);
+      processed = true;
+    }
+
+  g_mutex_lock (&self->progress_mutex);
+  if (processed && self->progress_info)
+    {
+      self->num_processed++;
+      self->progress_info->progress =
+        (double) self->num_processed /
+        (double)
+        (self->num_chunks * self->num_passes);
+    }
+  self->num_pass_chunks_done++;
+  g_cond_signal (&self->pass_cond);
+  g_mutex_unlock (&self->progress_mutex);
+}
+
+/**
+ * Creates a new offline processor.
+ *
+ * The thread pool used by the passes is created
+ * here once if there is more than 1 chunk.
+ *
+ * @param src Interleaved source frames.
+ * @param dest Interleaved destination frames, which
+ *   must not overlap with the source frames.
+ * @param num_passes Number of passes that will be
+ *   run.
+ * @param progress_info Optional progress info to
+ *   update.
+ */
+OfflineProcessor *
+offline_processor_new (
+  const float *         src,
+  float *               dest,
+  size_t                num_frames,
+  size_t                channels,
+  int                   num_passes,
+  GenericProgressInfo * progress_info,
+  void *                user_data)
+{
+  OfflineProcessor * self =
+    object_new (OfflineProcessor);
+
+  self->src = src;
+  self->dest = dest;
+  self->num_frames = num_frames;
+  self->channels = channels;
+  self->num_passes = MAX (num_passes, 1);
+  self->progress_info = progress_info;
+  self->user_data = user_data;
+  g_mutex_init (&self->progress_mutex);
+  g_cond_init (&self->pass_cond);
+
+  self->num_chunks =
+    (int)
+    ((num_frames + OFFLINE_PROCESSOR_CHUNK_FRAMES - 1)
+     / OFFLINE_PROCESSOR_CHUNK_FRAMES);
+  self->chunks =
+    object_new_n (
+      (size_t) MAX (self->num_chunks, 1),
+      OfflineProcessorChunk);
+  for (int i = 0; i < self->num_chunks; i++)
+    {
+      OfflineProcessorChunk * chunk =
+        &self->chunks[i];
+      chunk->start_frame =
+        (size_t) i * OFFLINE_PROCESSOR_CHUNK_FRAMES;
+      chunk->num_frames =
+        MIN (
+          OFFLINE_PROCESSOR_CHUNK_FRAMES,
+          num_frames - chunk->start_frame);
+    }
+
+  if (self->num_chunks > 1)
+    {
+      GError * err = NULL;
+      self->pool =
+        g_thread_pool_new (
+          (GFunc) process_chunk, self,
+          MIN (
+            (int) g_get_num_processors (),
+            self->num_chunks),
+          false, &err);
+      if (!self->pool)
+        {
+          g_warning (
+            "failed to create thread pool: %s",
+            err->message);
+          g_error_free (err);
+        }
+    }
+
+  return self;
+}
+
+/**
+ * Runs the given function on all chunks and waits
+ * for it to finish.
+ *
+ * The result of each chunk is reset to 0 before
+ * running the pass.
+ *
+ * @return Non-zero if processing was cancelled.
+ */
+int
+offline_processor_run_pass (
+  OfflineProcessor *   self,
+  OfflineProcessorFunc func)
+{
+  self->func = func;
+  self->num_pass_chunks_done = 0;
+  for (int i = 0; i < self->num_chunks; i++)
+    {
+      self->chunks[i].result = 0.f;
+    }
+
+  for (int i = 0; i < self->num_chunks; i++)
+    {
+      GError * err = NULL;
+      if (self->pool &&
+          g_thread_pool_push (
+            self->pool, &self->chunks[i], &err))
+        continue;
+
+      if (err)
+        {
+          g_warning (
+            "failed to push chunk: %s",
+            err->message);
+          g_error_free (err);
+        }
+      process_chunk (&self->chunks[i], self);
+    }
+
+  /* wait for all chunks to be processed */
+  g_mutex_lock (&self->progress_mutex);
+  while (self->num_pass_chunks_done <
+           self->num_chunks)
+    {
+      g_cond_wait (
+        &self->pass_cond, &self->progress_mutex);
+    }
+  g_mutex_unlock (&self->progress_mutex);
+
+  return is_cancelled (self) ? -1 : 0;
+}
+
+/**
+ * Returns the max of the chunk results of the last
+ * pass.
+ */
+float
+offline_processor_get_max_result (
+  OfflineProcessor * self)
+{
+  float max = 0.f;
+  for (int i = 0; i < self->num_chunks; i++)
+    {
+      max = MAX (max, self->chunks[i].result);
+    }
+
+  return max;
+}
+
+void
+offline_processor_free (
+  OfflineProcessor * self)
+{
+  if (self->pool)
+    {
+      g_thread_pool_free (self->pool, false, true);
+    }
+  object_zero_and_free (self->chunks);
+  g_mutex_clear (&self->progress_mutex);
+  g_cond_clear (&self->pass_cond);
+
+  object_zero_and_free (self);
+}
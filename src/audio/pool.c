@@ -21,6 +21,7 @@
 
 #include "actions/undo_manager.h"
 #include "audio/clip.h"
+#include "audio/clip_chunk.h"
 #include "audio/pool.h"
 #include "audio/track.h"
 #include "audio/tracklist.h"
@@ -28,13 +29,71 @@
 #include "utils/arrays.h"
 #include "utils/file.h"
 #include "utils/flags.h"
+#include "utils/hash_cache.h"
 #include "utils/io.h"
 #include "utils/mem.h"
 #include "utils/objects.h"
 #include "utils/string.h"
+#include "zrythm.h"
 
 #include <gtk/gtk.h>
 
+/**
+ * Loads the chunks of the clips.
+ *
+ * Chunks with the same hash are deserialized as
+ * separate instances, so they are merged here to
+ * be shared again.
+ */
+static void
+init_loaded_chunks (
+  AudioPool * self)
+{
+  /* hash -> ClipChunk */
+  GHashTable * chunks =
+    g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (int i = 0; i < self->num_clips; i++)
+    {
+      AudioClip * clip = self->clips[i];
+      if (!clip)
+        continue;
+
+      clip->chunks_size = (size_t) clip->num_chunks;
+      for (int j = 0; j < clip->num_chunks; j++)
+        {
+          ClipChunk * chunk = clip->chunks[j];
+          ClipChunk * existing =
+            g_hash_table_lookup (
+              chunks, chunk->hash);
+          if (existing &&
+              existing->num_frames ==
+                chunk->num_frames &&
+              existing->channels == chunk->channels)
+            {
+              clip->chunks[j] =
+                clip_chunk_ref (existing);
+              clip_chunk_unref (chunk);
+              continue;
+            }
+
+          if (clip_chunk_init_loaded (chunk) != 0)
+            {
+              g_warning (
+                "failed to load chunk %d of clip %s",
+                j, clip->name);
+            }
+          if (!existing)
+            {
+              g_hash_table_insert (
+                chunks, chunk->hash, chunk);
+            }
+        }
+    }
+
+  g_hash_table_destroy (chunks);
+}
+
 /**
  * Inits after loading a project.
  */
@@ -44,6 +103,8 @@ audio_pool_init_loaded (
 {
   self->clips_size = (size_t) self->num_clips;
 
+  init_loaded_chunks (self);
+
   for (int i = 0; i < self->num_clips; i++)
     {
       AudioClip * clip = self->clips[i];
@@ -361,6 +422,26 @@ audio_pool_remove_unused (
         }
     }
 
+  /* collect the chunks of the remaining clips */
+  GHashTable * chunk_paths =
+    g_hash_table_new_full (
+      g_str_hash, g_str_equal, g_free, NULL);
+  for (int i = 0; i < self->num_clips; i++)
+    {
+      AudioClip * clip = self->clips[i];
+      if (!clip)
+        continue;
+
+      for (int j = 0; j < clip->num_chunks; j++)
+        {
+          char * chunk_path =
+            clip_chunk_get_path_in_pool_from_hash (
+              clip->chunks[j]->hash, backup);
+          g_hash_table_add (
+            chunk_paths, chunk_path);
+        }
+    }
+
   /* remove untracked files from pool directory */
   char * prj_pool_dir =
     project_get_path (
@@ -374,11 +455,17 @@ audio_pool_remove_unused (
         {
           const char * path = files[i];
 
-          bool found = false;
-          for (int j = 0; j < self->num_clips; j++)
+          bool found =
+            g_hash_table_contains (
+              chunk_paths, path);
+          for (int j = 0;
+               !found && j < self->num_clips; j++)
             {
               AudioClip * clip = self->clips[j];
-              if (!clip)
+
+              /* chunked clips have no file of their
+               * own */
+              if (!clip || clip->num_chunks > 0)
                 continue;
 
               char * clip_path =
@@ -404,6 +491,7 @@ audio_pool_remove_unused (
       g_strfreev (files);
     }
   g_free (prj_pool_dir);
+  g_hash_table_destroy (chunk_paths);
 
   g_message ("%s: done", __func__);
 }
@@ -429,6 +517,22 @@ audio_pool_reload_clip_frame_bufs (
       bool in_use =
         audio_clip_is_in_use (clip, false);
 
+      /* chunked clips keep their chunks loaded, so
+       * only the frames are loaded/unloaded */
+      if (clip->num_chunks > 0)
+        {
+          if (in_use && !clip->frames)
+            {
+              audio_clip_init_loaded (clip);
+            }
+          else if (!in_use && clip->frames)
+            {
+              free (clip->frames);
+              clip->frames = NULL;
+            }
+          continue;
+        }
+
       if (in_use && clip->num_frames == 0)
         {
           /* load from the file */
@@ -475,6 +579,8 @@ audio_pool_write_to_disk (
             clip, false, is_backup);
         }
     }
+
+  hash_cache_serialize_to_file (HASH_CACHE);
 }
 
 void
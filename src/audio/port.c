@@ -50,6 +50,7 @@
 #include "utils/dsp.h"
 #include "utils/error.h"
 #include "utils/flags.h"
+#include "utils/handle_table.h"
 #include "utils/math.h"
 #include "utils/mem.h"
 #include "utils/object_utils.h"
@@ -243,12 +244,6 @@ port_init_loaded (
         {
           self->midi_events = midi_events_new ();
         }
-      if (!self->midi_ring)
-        {
-          self->midi_ring =
-            zix_ring_new (
-              sizeof (MidiEvent) * (size_t) 11);
-        }
 #ifdef _WOE32
       if (AUDIO_ENGINE->midi_backend ==
             MIDI_BACKEND_WINDOWS_MME)
@@ -258,15 +253,6 @@ port_init_loaded (
         }
 #endif
       break;
-    case TYPE_AUDIO:
-      /* fall through */
-    case TYPE_CV:
-      if (!self->audio_ring)
-        {
-          self->audio_ring =
-            zix_ring_new (
-              sizeof (float) * AUDIO_RING_SIZE);
-        }
     default:
       break;
     }
@@ -283,9 +269,40 @@ port_init_loaded (
     }
 }
 
+/**
+ * Returns the track owning the port with the
+ * given identifier.
+ *
+ * The track is resolved through the handle table
+ * if the identifier has a track handle, in which
+ * case NULL is returned if the track was removed.
+ * Otherwise, the track position is used.
+ */
+static Track *
+get_track (
+  PortIdentifier * id)
+{
+  if (object_handle_is_set (&id->track_handle))
+    {
+      return
+        handle_table_get (
+          HANDLE_TABLE, &id->track_handle);
+    }
+
+  g_return_val_if_fail (
+    id->track_pos >= 0 &&
+      id->track_pos < TRACKLIST->num_tracks,
+    NULL);
+  return TRACKLIST->tracks[id->track_pos];
+}
+
 /**
  * Finds the Port corresponding to the identifier.
  *
+ * If the identifier has owner handles, the owner
+ * is resolved through the handle table and NULL is
+ * returned if it was removed.
+ *
  * @param id The PortIdentifier to use for
  *   searching.
  */
@@ -335,30 +352,41 @@ port_find_from_identifier (
         }
       break;
     case PORT_OWNER_TYPE_PLUGIN:
-      tr = TRACKLIST->tracks[id->track_pos];
-      g_warn_if_fail (IS_TRACK_AND_NONNULL (tr));
-      switch (id->plugin_id.slot_type)
+      if (object_handle_is_set (&id->plugin_handle))
         {
-        case PLUGIN_SLOT_MIDI_FX:
           pl =
-            tr->channel->midi_fx[
-              id->plugin_id.slot];
-          break;
-        case PLUGIN_SLOT_INSTRUMENT:
-          pl = tr->channel->instrument;
-          break;
-        case PLUGIN_SLOT_INSERT:
-          pl =
-            tr->channel->inserts[
-              id->plugin_id.slot];
-          break;
-        case PLUGIN_SLOT_MODULATOR:
-          pl =
-            tr->modulators[id->plugin_id.slot];
-          break;
-        default:
-          g_return_val_if_reached (NULL);
-          break;
+            handle_table_get (
+              HANDLE_TABLE, &id->plugin_handle);
+          if (!pl)
+            return NULL;
+        }
+      else
+        {
+          tr = TRACKLIST->tracks[id->track_pos];
+          g_warn_if_fail (IS_TRACK_AND_NONNULL (tr));
+          switch (id->plugin_id.slot_type)
+            {
+            case PLUGIN_SLOT_MIDI_FX:
+              pl =
+                tr->channel->midi_fx[
+                  id->plugin_id.slot];
+              break;
+            case PLUGIN_SLOT_INSTRUMENT:
+              pl = tr->channel->instrument;
+              break;
+            case PLUGIN_SLOT_INSERT:
+              pl =
+                tr->channel->inserts[
+                  id->plugin_id.slot];
+              break;
+            case PLUGIN_SLOT_MODULATOR:
+              pl =
+                tr->modulators[id->plugin_id.slot];
+              break;
+            default:
+              g_return_val_if_reached (NULL);
+              break;
+            }
         }
       g_warn_if_fail (IS_PLUGIN (pl));
       switch (id->flow)
@@ -377,8 +405,9 @@ port_find_from_identifier (
         }
       break;
     case PORT_OWNER_TYPE_TRACK_PROCESSOR:
-      tr = TRACKLIST->tracks[id->track_pos];
-      g_warn_if_fail (tr);
+      tr = get_track (id);
+      if (!tr)
+        return NULL;
       switch (id->type)
         {
         case TYPE_EVENT:
@@ -470,8 +499,9 @@ port_find_from_identifier (
         }
       break;
     case PORT_OWNER_TYPE_TRACK:
-      tr = TRACKLIST->tracks[id->track_pos];
-      g_warn_if_fail (tr);
+      tr = get_track (id);
+      if (!tr)
+        return NULL;
       if (flags & PORT_FLAG_BPM)
         {
           return tr->bpm_port;
@@ -534,8 +564,9 @@ port_find_from_identifier (
       break;
     case PORT_OWNER_TYPE_FADER:
       g_warn_if_fail (id->track_pos >= 0);
-      tr = TRACKLIST->tracks[id->track_pos];
-      g_warn_if_fail (tr);
+      tr = get_track (id);
+      if (!tr)
+        return NULL;
       ch = tr->channel;
       g_warn_if_fail (ch);
       switch (id->type)
@@ -612,8 +643,9 @@ port_find_from_identifier (
       break;
     case PORT_OWNER_TYPE_PREFADER:
       g_warn_if_fail (id->track_pos > -1);
-      tr = TRACKLIST->tracks[id->track_pos];
-      g_warn_if_fail (tr);
+      tr = get_track (id);
+      if (!tr)
+        return NULL;
       ch = tr->channel;
       g_warn_if_fail (ch);
       switch (id->type)
@@ -690,8 +722,9 @@ port_find_from_identifier (
       break;
     case PORT_OWNER_TYPE_CHANNEL_SEND:
       g_warn_if_fail (id->track_pos > -1);
-      tr = TRACKLIST->tracks[id->track_pos];
-      g_warn_if_fail (tr);
+      tr = get_track (id);
+      if (!tr)
+        return NULL;
       ch = tr->channel;
       g_warn_if_fail (ch);
       if (id->flags2 &
@@ -888,9 +921,6 @@ port_new_with_type (
     case TYPE_EVENT:
       self->maxf = 1.f;
       self->midi_events = midi_events_new ();
-      self->midi_ring =
-        zix_ring_new (
-          sizeof (MidiEvent) * (size_t) 11);
 #ifdef _WOE32
       if (AUDIO_ENGINE->midi_backend ==
             MIDI_BACKEND_WINDOWS_MME)
@@ -909,17 +939,11 @@ port_new_with_type (
       self->minf = 0.f;
       self->maxf = 2.f;
       self->zerof = 0.f;
-      self->audio_ring =
-        zix_ring_new (
-          sizeof (float) * AUDIO_RING_SIZE);
       break;
     case TYPE_CV:
       self->minf = -1.f;
       self->maxf = 1.f;
       self->zerof = 0.f;
-      self->audio_ring =
-        zix_ring_new (
-          sizeof (float) * AUDIO_RING_SIZE);
     default:
       break;
     }
@@ -1564,6 +1588,7 @@ port_set_owner_plugin (
   plugin_identifier_copy (
     &port->id.plugin_id, &pl->id);
   port->id.track_pos = pl->id.track_pos;
+  port->id.plugin_handle = pl->handle;
   port->id.owner_type =
     PORT_OWNER_TYPE_PLUGIN;
 
@@ -1596,6 +1621,7 @@ port_set_owner_track (
   Track *   track)
 {
   port->id.track_pos = track->pos;
+  port->id.track_handle = track->handle;
   port->id.owner_type =
     PORT_OWNER_TYPE_TRACK;
 }
@@ -2113,6 +2139,35 @@ port_verify_src_and_dests (
     }
 }
 
+/**
+ * Returns whether \ref Port.at is set and is
+ * still part of the automation tracklist of the
+ * given track (or of the owner track if NULL).
+ */
+static bool
+cached_automation_track_is_valid (
+  Port *  self,
+  Track * track)
+{
+  AutomationTrack * at = self->at;
+  if (!at)
+    return false;
+
+  if (!track)
+    {
+      track = port_get_track (self, false);
+      if (!track)
+        return false;
+    }
+
+  AutomationTracklist * atl =
+    track_get_automation_tracklist (track);
+  return
+    atl && at->index >= 0 &&
+    at->index < atl->num_ats &&
+    atl->ats[at->index] == at;
+}
+
 /**
  * To be called when the port's identifier changes
  * to update corresponding identifiers.
@@ -2165,10 +2220,17 @@ port_update_identifier (
           self->id.track_pos > -1 &&
           self->id.flags & PORT_FLAG_AUTOMATABLE)
         {
-          /* update automation track's port id */
-          self->at =
-            automation_track_find_from_port (
-              self, track, true);
+          /* update automation track's port id
+           * (the automation track only needs to be
+           * searched for if the cached one is not
+           * part of the track anymore) */
+          if (!cached_automation_track_is_valid (
+                 self, track))
+            {
+              self->at =
+                automation_track_find_from_port (
+                  self, track, true);
+            }
           AutomationTrack * at = self->at;
           g_return_if_fail (at);
           port_identifier_copy (
@@ -3589,18 +3651,22 @@ port_process (
       if (local_offset + nframes ==
             AUDIO_ENGINE->block_length)
         {
-          if (port->write_ring_buffers)
+          ZixRing * ring =
+            port_has_ring_subscribers (port) ?
+              (ZixRing *)
+              g_atomic_pointer_get (
+                &port->midi_ring) :
+              NULL;
+          if (ring)
             {
               for (int i = port->midi_events->num_events - 1;
                    i >= 0; i--)
                 {
-                  if (zix_ring_write_space (
-                        port->midi_ring) <
+                  if (zix_ring_write_space (ring) <
                         sizeof (MidiEvent))
                     {
                       zix_ring_skip (
-                        port->midi_ring,
-                        sizeof (MidiEvent));
+                        ring, sizeof (MidiEvent));
                     }
 
                   MidiEvent * ev =
@@ -3608,8 +3674,7 @@ port_process (
                   ev->systime =
                     g_get_monotonic_time ();
                   zix_ring_write (
-                    port->midi_ring, ev,
-                    sizeof (MidiEvent));
+                    ring, ev, sizeof (MidiEvent));
                 }
             }
           else
@@ -3718,6 +3783,20 @@ port_process (
             minf, maxf, nframes);
         }
 
+      /* detect silence so that idle plugins can be
+       * suspended */
+      if (port->id.owner_type ==
+            PORT_OWNER_TYPE_PLUGIN &&
+          port->id.flow == FLOW_INPUT)
+        {
+          float peak = 0.f;
+          dsp_abs_max (
+            &port->buf[local_offset], &peak,
+            nframes);
+          port->is_silent =
+            peak < PORT_SILENCE_THRESHOLD;
+        }
+
       if (port->id.flow == FLOW_OUTPUT)
         {
           switch (AUDIO_ENGINE->audio_backend)
@@ -3733,27 +3812,50 @@ port_process (
             }
         }
 
-      if (local_offset + nframes ==
+      /* only fill the ring buffer if the UI is
+       * reading it */
+      ZixRing * ring =
+        port_has_ring_subscribers (port) ?
+          (ZixRing *)
+          g_atomic_pointer_get (&port->audio_ring) :
+          NULL;
+
+      /* pin the data of this sub-block before
+       * another port sharing the buffer overwrites
+       * it */
+      const float * ring_src = port->buf;
+      float * pinned_buf =
+        ring && port->buf_is_shared ?
+          (float *)
+          g_atomic_pointer_get (&port->pinned_buf) :
+          NULL;
+      if (pinned_buf)
+        {
+          dsp_copy (
+            &pinned_buf[local_offset],
+            &port->buf[local_offset], nframes);
+          ring_src = pinned_buf;
+        }
+
+      if (ring &&
+          local_offset + nframes ==
             AUDIO_ENGINE->block_length)
         {
           size_t size =
             sizeof (float) *
             (size_t) AUDIO_ENGINE->block_length;
           size_t write_space_avail =
-            zix_ring_write_space (
-              port->audio_ring);
+            zix_ring_write_space (ring);
 
           /* move the read head 8 blocks to make
            * space if no space avail to write */
           if (write_space_avail / size < 1)
             {
-              zix_ring_skip (
-                port->audio_ring, size * 8);
+              zix_ring_skip (ring, size * 8);
             }
 
           zix_ring_write (
-            port->audio_ring, &port->buf[0],
-            size);
+            ring, &ring_src[0], size);
         }
 
       /* if track output (to be shown on mixer) */
@@ -3956,12 +4058,6 @@ port_process (
             automation_track_should_read_automation (
               at, AUDIO_ENGINE->timestamp_start))
           {
-            /* FIXME optimize, calculate this
-             * once at the start of each cycle */
-            Position pos;
-            position_from_frames (
-              &pos, g_start_frames);
-
             /* if playhead pos changed manually
              * recently or transport is rolling,
              * we will force the last known
@@ -3976,16 +4072,12 @@ port_process (
             /* if there was an automation event
              * at the playhead position, set val
              * and flag */
-            AutomationPoint * ap =
-              automation_track_get_ap_before_pos (
-                at, &pos,
-                !can_read_previous_automation);
-            if (ap)
+            float val;
+            if (automation_track_get_normalized_val_at_frames (
+                  at, g_start_frames,
+                  !can_read_previous_automation,
+                  &val))
               {
-                float val =
-                  automation_track_get_val_at_pos (
-                    at, &pos, true,
-                    !can_read_previous_automation);
                 control_port_set_val_from_normalized (
                   port, val, true);
                 port->value_changed_from_reading =
@@ -4036,7 +4128,7 @@ port_process (
                   CLAMP (
                     val_to_use +
                       depth_range *
-                        src_port->buf[0] *
+                        src_port->buf[local_offset] *
                         src_port->multipliers[
                           port_get_dest_index (
                             src_port, port)],
@@ -4315,6 +4407,12 @@ port_clear_buffer (Port * port)
   if ((pi->type == TYPE_AUDIO ||
        pi->type == TYPE_CV) && port->buf)
     {
+      /* shared buffers are cleared by the node
+       * that first writes them in the cycle */
+      if (port->buf_is_shared)
+        return;
+
+
       dsp_fill (
         port->buf, DENORMAL_PREVENTION_VAL,
         AUDIO_ENGINE->block_length);
@@ -4358,7 +4456,15 @@ port_get_track (
   g_return_val_if_fail (IS_PORT (self), NULL);
 
   Track * track = NULL;
-  if (self->id.track_pos != -1)
+  if (object_handle_is_set (
+        &self->id.track_handle))
+    {
+      /* NULL if the track was removed */
+      track =
+        handle_table_get (
+          HANDLE_TABLE, &self->id.track_handle);
+    }
+  else if (self->id.track_pos != -1)
     {
       g_return_val_if_fail (
         ZRYTHM && TRACKLIST, NULL);
@@ -4383,6 +4489,15 @@ port_get_plugin (
 {
   g_return_val_if_fail (IS_PORT (self), NULL);
 
+  if (object_handle_is_set (
+        &self->id.plugin_handle))
+    {
+      /* NULL if the plugin was removed */
+      return
+        handle_table_get (
+          HANDLE_TABLE, &self->id.plugin_handle);
+    }
+
   Track * track = port_get_track (self, 0);
   if (!track && self->tmp_plugin)
     {
@@ -4560,6 +4675,113 @@ port_get_enabled (
   return src->dest_enabled[dest_idx];
 }
 
+/**
+ * Registers a UI consumer of the ring buffers of
+ * the port, allocating them if this is the first
+ * one.
+ *
+ * Must be called from the GTK thread and paired
+ * with port_unsubscribe_from_rings().
+ *
+ * @return The subscription token of the port
+ *   (see Port.ring_token).
+ */
+guint
+port_subscribe_to_rings (
+  Port * self)
+{
+  g_return_val_if_fail (IS_PORT (self), 0);
+
+  /* tokens are only handed out from the GTK
+   * thread */
+  static guint next_ring_token = 1;
+  if (self->ring_token == 0)
+    {
+      self->ring_token = next_ring_token++;
+      if (next_ring_token == 0)
+        next_ring_token = 1;
+    }
+
+  /* publish the rings before the count so that
+   * the engine never sees a subscriber without a
+   * ring */
+  switch (self->id.type)
+    {
+    case TYPE_EVENT:
+      if (!self->midi_ring)
+        {
+          g_atomic_pointer_set (
+            &self->midi_ring,
+            zix_ring_new (
+              sizeof (MidiEvent) * (size_t) 11));
+        }
+      break;
+    case TYPE_AUDIO:
+    case TYPE_CV:
+      if (!self->audio_ring)
+        {
+          g_atomic_pointer_set (
+            &self->audio_ring,
+            zix_ring_new (
+              sizeof (float) * AUDIO_RING_SIZE));
+        }
+      /* the buffer may start being shared at
+       * any graph recalculation, so always
+       * allocate the private copy */
+      if (!self->pinned_buf)
+        {
+          g_atomic_pointer_set (
+            &self->pinned_buf,
+            object_new_n (
+              MAX (AUDIO_ENGINE->block_length, 1),
+              float));
+        }
+      break;
+    default:
+      break;
+    }
+
+  g_atomic_int_inc (&self->num_ring_subscribers);
+
+  return self->ring_token;
+}
+
+/**
+ * Unregisters a UI consumer of the ring buffers of
+ * the port, releasing them if this was the last
+ * one.
+ *
+ * Must be called from the GTK thread.
+ */
+void
+port_unsubscribe_from_rings (
+  Port * self)
+{
+  g_return_if_fail (
+    IS_PORT (self) &&
+    g_atomic_int_get (
+      &self->num_ring_subscribers) > 0);
+
+  if (!g_atomic_int_dec_and_test (
+         &self->num_ring_subscribers))
+    return;
+
+  /* the engine may still be writing to the rings
+   * in the current cycle, so free them later */
+  ZixRing * audio_ring = self->audio_ring;
+  ZixRing * midi_ring = self->midi_ring;
+  float * pinned_buf = self->pinned_buf;
+  g_atomic_pointer_set (&self->audio_ring, NULL);
+  g_atomic_pointer_set (&self->midi_ring, NULL);
+  g_atomic_pointer_set (&self->pinned_buf, NULL);
+  if (audio_ring)
+    free_later (audio_ring, zix_ring_free);
+  if (midi_ring)
+    free_later (midi_ring, zix_ring_free);
+  if (pinned_buf)
+    free_later (pinned_buf, free);
+}
+
 /**
  * Deletes port, doing required cleanup and
  * updating counters.
@@ -4584,11 +4806,13 @@ port_free (Port * self)
     !self->dests ||
     self->dests[0] == 0);
 
-  object_zero_and_free (self->buf);
+  if (!self->buf_is_shared)
+    object_zero_and_free (self->buf);
   object_free_w_func_and_null (
     zix_ring_free, self->audio_ring);
   object_free_w_func_and_null (
     zix_ring_free, self->midi_ring);
+  object_zero_and_free (self->pinned_buf);
 
   object_free_w_func_and_null (
     midi_events_free, self->midi_events);
@@ -67,6 +67,8 @@ port_identifier_port_group_cmp (
  * Copy the identifier content from \ref src to
  * \ref dest.
  *
+ * The owner handles are not copied.
+ *
  * @note This frees/allocates memory on \ref dest.
  */
 void
@@ -17,6 +17,8 @@
  * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include "actions/arranger_selections.h"
 #include "audio/audio_region.h"
 #include "audio/automation_region.h"
@@ -1475,6 +1477,158 @@ handle_start_recording (
   self->num_active_recordings++;
 }
 
+/**
+ * Handles the given event.
+ *
+ * @return Whether successful.
+ */
+static bool
+handle_event (
+  RecordingManager * self,
+  RecordingEvent *   ev)
+{
+  /*g_message ("event type %d", ev->type);*/
+
+  switch (ev->type)
+    {
+    case RECORDING_EVENT_TYPE_MIDI:
+      /*g_message ("-------- RECORD MIDI");*/
+      handle_midi_event (self, ev);
+      break;
+    case RECORDING_EVENT_TYPE_AUDIO:
+      /*g_message ("-------- RECORD AUDIO");*/
+      handle_audio_event (self, ev);
+      break;
+    case RECORDING_EVENT_TYPE_AUTOMATION:
+      /*g_message ("-------- RECORD AUTOMATION");*/
+      handle_automation_event (self, ev);
+      break;
+    case RECORDING_EVENT_TYPE_PAUSE_TRACK_RECORDING:
+      g_message ("-------- PAUSE TRACK RECORDING");
+      handle_pause_event (self, ev);
+      break;
+    case RECORDING_EVENT_TYPE_PAUSE_AUTOMATION_RECORDING:
+      g_message ("-------- PAUSE AUTOMATION RECORDING");
+      handle_pause_event (self, ev);
+      break;
+    case RECORDING_EVENT_TYPE_STOP_TRACK_RECORDING:
+      g_message (
+        "-------- STOP TRACK RECORDING (%s)",
+        ev->track_name);
+      {
+        Track * track =
+          track_get_from_name (ev->track_name);
+        g_return_val_if_fail (
+          track, false);
+        handle_stop_recording (self, false);
+        track->recording_region = NULL;
+        track->recording_start_sent = false;
+        track->recording_stop_sent = false;
+      }
+      g_message (
+        "num active recordings: %d",
+        self->num_active_recordings);
+      break;
+    case RECORDING_EVENT_TYPE_STOP_AUTOMATION_RECORDING:
+      g_message ("-------- STOP AUTOMATION RECORDING");
+      {
+        AutomationTrack * at =
+          automation_track_find_from_port_id (
+            &ev->port_id, false);
+        g_return_val_if_fail (
+          at, false);
+        if (at->recording_started)
+          {
+            handle_stop_recording (self, true);
+          }
+        at->recording_started = false;
+        at->recording_start_sent = false;
+        at->recording_region = NULL;
+      }
+      g_message (
+        "num active recordings: %d",
+        self->num_active_recordings);
+      break;
+    case RECORDING_EVENT_TYPE_START_TRACK_RECORDING:
+      g_message (
+        "-------- START TRACK RECORDING (%s)",
+        ev->track_name);
+      handle_start_recording (self, ev, false);
+      g_message (
+        "num active recordings: %d",
+        self->num_active_recordings);
+      break;
+    case RECORDING_EVENT_TYPE_START_AUTOMATION_RECORDING:
+      g_message (
+        "-------- START AUTOMATION RECORDING");
+      {
+        AutomationTrack * at =
+          automation_track_find_from_port_id (
+            &ev->port_id, false);
+        g_return_val_if_fail (
+          at, false);
+        if (!at->recording_started)
+          {
+            handle_start_recording (
+              self, ev, true);
+          }
+        at->recording_started = true;
+      }
+      g_message (
+        "num active recordings: %d",
+        self->num_active_recordings);
+      break;
+    default:
+      g_warning (
+        "recording event %d not implemented yet",
+        ev->type);
+      break;
+    }
+
+  return true;
+}
+
+/**
+ * Moves the queued events out of the object pool
+ * into RecordingManager.deferred_events, so that
+ * the engine can keep queueing events while they
+ * cannot be handled.
+ */
+static void
+defer_queued_events (
+  RecordingManager * self)
+{
+  RecordingEvent * ev;
+  while (recording_event_queue_dequeue_event (
+           self->event_queue, &ev))
+    {
+      RecordingEvent * copy =
+        recording_event_new ();
+      *copy = *ev;
+      memset (
+        &copy->port_id, 0, sizeof (PortIdentifier));
+      port_identifier_copy (
+        &copy->port_id, &ev->port_id);
+      g_queue_push_tail (
+        self->deferred_events, copy);
+
+      object_pool_return (
+        self->event_obj_pool, ev);
+    }
+}
+
+/**
+ * Frees an event from
+ * RecordingManager.deferred_events.
+ */
+static void
+free_deferred_event (
+  RecordingEvent * ev)
+{
+  port_identifier_free_members (&ev->port_id);
+  recording_event_free (ev);
+}
+
 /**
  * GSourceFunc to be added using idle add.
  *
@@ -1490,7 +1644,30 @@ recording_manager_process_events (
 {
   /*gint64 curr_time = g_get_monotonic_time ();*/
   /*g_message ("starting processing");*/
+
+  /* the engine keeps running while the project is
+   * being serialized - keep draining the queue but
+   * only handle the events once the project can be
+   * modified again */
+  if (g_atomic_int_get (&PROJECT->saving))
+    {
+      defer_queued_events (self);
+      return G_SOURCE_CONTINUE;
+    }
+
+  /* handle the deferred events first to keep the
+   * order */
   RecordingEvent * ev;
+  while ((ev =
+            g_queue_pop_head (self->deferred_events)))
+    {
+      bool success =
+        self->freeing || handle_event (self, ev);
+      free_deferred_event (ev);
+      if (!success)
+        return G_SOURCE_REMOVE;
+    }
+
   while (recording_event_queue_dequeue_event (
            self->event_queue, &ev))
     {
@@ -1505,102 +1682,9 @@ recording_manager_process_events (
           goto return_to_pool;
         }
 
-      /*g_message ("event type %d", ev->type);*/
-
-      switch (ev->type)
+      if (!handle_event (self, ev))
         {
-        case RECORDING_EVENT_TYPE_MIDI:
-          /*g_message ("-------- RECORD MIDI");*/
-          handle_midi_event (self, ev);
-          break;
-        case RECORDING_EVENT_TYPE_AUDIO:
-          /*g_message ("-------- RECORD AUDIO");*/
-          handle_audio_event (self, ev);
-          break;
-        case RECORDING_EVENT_TYPE_AUTOMATION:
-          /*g_message ("-------- RECORD AUTOMATION");*/
-          handle_automation_event (self, ev);
-          break;
-        case RECORDING_EVENT_TYPE_PAUSE_TRACK_RECORDING:
-          g_message ("-------- PAUSE TRACK RECORDING");
-          handle_pause_event (self, ev);
-          break;
-        case RECORDING_EVENT_TYPE_PAUSE_AUTOMATION_RECORDING:
-          g_message ("-------- PAUSE AUTOMATION RECORDING");
-          handle_pause_event (self, ev);
-          break;
-        case RECORDING_EVENT_TYPE_STOP_TRACK_RECORDING:
-          g_message (
-            "-------- STOP TRACK RECORDING (%s)",
-            ev->track_name);
-          {
-            Track * track =
-              track_get_from_name (ev->track_name);
-            g_return_val_if_fail (
-              track, G_SOURCE_REMOVE);
-            handle_stop_recording (self, false);
-            track->recording_region = NULL;
-            track->recording_start_sent = false;
-            track->recording_stop_sent = false;
-          }
-          g_message (
-            "num active recordings: %d",
-            self->num_active_recordings);
-          break;
-        case RECORDING_EVENT_TYPE_STOP_AUTOMATION_RECORDING:
-          g_message ("-------- STOP AUTOMATION RECORDING");
-          {
-            AutomationTrack * at =
-              automation_track_find_from_port_id (
-                &ev->port_id, false);
-            g_return_val_if_fail (
-              at, G_SOURCE_REMOVE);
-            if (at->recording_started)
-              {
-                handle_stop_recording (self, true);
-              }
-            at->recording_started = false;
-            at->recording_start_sent = false;
-            at->recording_region = NULL;
-          }
-          g_message (
-            "num active recordings: %d",
-            self->num_active_recordings);
-          break;
-        case RECORDING_EVENT_TYPE_START_TRACK_RECORDING:
-          g_message (
-            "-------- START TRACK RECORDING (%s)",
-            ev->track_name);
-          handle_start_recording (self, ev, false);
-          g_message (
-            "num active recordings: %d",
-            self->num_active_recordings);
-          break;
-        case RECORDING_EVENT_TYPE_START_AUTOMATION_RECORDING:
-          g_message (
-            "-------- START AUTOMATION RECORDING");
-          {
-            AutomationTrack * at =
-              automation_track_find_from_port_id (
-                &ev->port_id, false);
-            g_return_val_if_fail (
-              at, G_SOURCE_REMOVE);
-            if (!at->recording_started)
-              {
-                handle_start_recording (
-                  self, ev, true);
-              }
-            at->recording_started = true;
-          }
-          g_message (
-            "num active recordings: %d",
-            self->num_active_recordings);
-          break;
-        default:
-          g_warning (
-            "recording event %d not implemented yet",
-            ev->type);
-          break;
+          return G_SOURCE_REMOVE;
         }
 
       /*UP_RETURNED (ev);*/
@@ -1633,6 +1717,7 @@ recording_manager_new (void)
   self->event_queue = mpmc_queue_new ();
   mpmc_queue_reserve (
     self->event_queue, max_events);
+  self->deferred_events = g_queue_new ();
 
   self->source_id =
     g_timeout_add (
@@ -1662,6 +1747,10 @@ recording_manager_free (
     mpmc_queue_free, self->event_queue);
   object_free_w_func_and_null (
     object_pool_free, self->event_obj_pool);
+  g_queue_free_full (
+    self->deferred_events,
+    (GDestroyNotify) free_deferred_event);
+  self->deferred_events = NULL;
 
   free_temp_selections (self);
 
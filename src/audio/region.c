@@ -19,6 +19,7 @@
 
 #include "audio/audio_region.h"
 #include "audio/automation_region.h"
+#include "audio/automation_track.h"
 #include "audio/chord_region.h"
 #include "audio/chord_track.h"
 #include "audio/channel.h"
@@ -29,6 +30,7 @@
 #include "audio/pool.h"
 #include "audio/recording_manager.h"
 #include "audio/region.h"
+#include "audio/region_content.h"
 #include "audio/region_link_group_manager.h"
 #include "audio/stretcher.h"
 #include "audio/track.h"
@@ -638,6 +640,12 @@ region_set_link_group (
       region_link_group_remove_region (
         link_group,
         region, true, update_identifier);
+
+      /* copy the shared children, unless the region
+       * joins another group and shares its
+       * children instead */
+      if (group_idx < 0)
+        region_content_unshare (region);
     }
   if (group_idx >= 0)
     {
@@ -700,6 +708,7 @@ region_unlink (
           region->id.link_group);
       region_link_group_remove_region (
         group, region, true, true);
+      region_content_unshare (region);
     }
   else
     {
@@ -808,6 +817,12 @@ region_update_identifier (
   region_set_link_group (
     self, self->id.link_group, false);
 
+  /* children shared with linked regions belong to
+   * the first region sharing them */
+  ZRegion * owner =
+    self->content ?
+      self->content->regions[0] : self;
+
   switch (self->id.type)
     {
     case REGION_TYPE_AUDIO:
@@ -817,7 +832,7 @@ region_update_identifier (
         {
           MidiNote * mn = self->midi_notes[i];
           midi_note_set_region_and_index (
-            mn, self, i);
+            mn, owner, i);
         }
       break;
     case REGION_TYPE_AUTOMATION:
@@ -825,7 +840,7 @@ region_update_identifier (
         {
           AutomationPoint * ap = self->aps[i];
           automation_point_set_region_and_index (
-            ap, self, i);
+            ap, owner, i);
         }
       break;
     case REGION_TYPE_CHORD:
@@ -834,7 +849,7 @@ region_update_identifier (
         {
           ChordObject * co = self->chord_objects[i];
           chord_object_set_region_and_index (
-            co, self, i);
+            co, owner, i);
         }
       break;
     default:
@@ -843,8 +858,9 @@ region_update_identifier (
 }
 
 /**
- * Updates all other regions in the region link
- * group, if any.
+ * Marks the playback caches of the other regions
+ * in the region link group, if any, as out of
+ * date.
  */
 void
 region_update_link_group (
@@ -978,6 +994,7 @@ region_copy_children (
                 src_ap->fvalue,
                 src_ap->normalized_val,
                 &src_ap_obj->pos);
+            dest_ap->curve_opts = src_ap->curve_opts;
             automation_region_add_ap (
               dest, dest_ap, F_NO_PUBLISH_EVENTS);
           }
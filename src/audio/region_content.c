@@ -0,0 +1,327 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/automation_point.h"
+#include "audio/automation_track.h"
+#include "audio/chord_object.h"
+#include "audio/midi_note.h"
+#include "audio/midi_region.h"
+#include "audio/region.h"
+#include "audio/region_content.h"
+#include "gui/backend/clip_editor.h"
+#include "project.h"
+#include "utils/arrays.h"
+#include "utils/mem.h"
+#include "utils/objects.h"
+
+#define COPY_CHILDREN(arr,type) \
+  if (dest->arr##_size < (size_t) src->num_##arr) \
+    { \
+      dest->arr = \
+        object_realloc_n ( \
+          dest->arr, dest->arr##_size, \
+          (size_t) src->num_##arr, type); \
+      dest->arr##_size = (size_t) src->num_##arr; \
+    } \
+  if (src->num_##arr > 0) \
+    { \
+      memcpy ( \
+        dest->arr, src->arr, \
+        (size_t) src->num_##arr * sizeof (type)); \
+    } \
+  dest->num_##arr = src->num_##arr
+
+/**
+ * Copies the children pointers of \ref src to
+ * \ref dest.
+ */
+static void
+copy_children (
+  ZRegion *       dest,
+  const ZRegion * src)
+{
+  switch (src->id.type)
+    {
+    case REGION_TYPE_MIDI:
+      COPY_CHILDREN (midi_notes, MidiNote *);
+      break;
+    case REGION_TYPE_AUTOMATION:
+      COPY_CHILDREN (aps, AutomationPoint *);
+      break;
+    case REGION_TYPE_CHORD:
+      COPY_CHILDREN (chord_objects, ChordObject *);
+      break;
+    default:
+      break;
+    }
+}
+
+#undef COPY_CHILDREN
+
+/**
+ * Points the region identifier of the children of
+ * \ref self to \ref self.
+ */
+static void
+set_children_region (
+  ZRegion * self)
+{
+  for (int i = 0; i < self->num_midi_notes; i++)
+    {
+      midi_note_set_region_and_index (
+        self->midi_notes[i], self, i);
+    }
+  for (int i = 0; i < self->num_aps; i++)
+    {
+      automation_point_set_region_and_index (
+        self->aps[i], self, i);
+    }
+  for (int i = 0; i < self->num_chord_objects; i++)
+    {
+      chord_object_set_region_and_index (
+        self->chord_objects[i], self, i);
+    }
+}
+
+static void
+set_serialized_counts (
+  ZRegion * self,
+  bool      serialize)
+{
+  self->num_serialized_midi_notes =
+    serialize ? self->num_midi_notes : 0;
+  self->num_serialized_aps =
+    serialize ? self->num_aps : 0;
+  self->num_serialized_chord_objects =
+    serialize ? self->num_chord_objects : 0;
+}
+
+static void
+invalidate_caches (
+  ZRegion * self)
+{
+  switch (self->id.type)
+    {
+    case REGION_TYPE_MIDI:
+      midi_region_invalidate_note_store (self);
+      break;
+    case REGION_TYPE_AUTOMATION:
+      automation_track_invalidate_envelope_for_region_id (
+        &self->id);
+      break;
+    default:
+      break;
+    }
+}
+
+static void
+add_region (
+  RegionContent * self,
+  ZRegion *       region)
+{
+  array_double_size_if_full (
+    self->regions, self->num_regions,
+    self->regions_size, ZRegion *);
+  array_append (
+    self->regions, self->num_regions, region);
+  region->content = self;
+}
+
+/**
+ * Makes \ref self share the children of \ref src.
+ *
+ * The current children of \ref self are freed.
+ */
+void
+region_content_share (
+  ZRegion * self,
+  ZRegion * src)
+{
+  g_return_if_fail (
+    IS_REGION (self) && IS_REGION (src) &&
+    self != src &&
+    self->id.type == src->id.type);
+
+  if (self->id.type == REGION_TYPE_AUDIO ||
+      (self->content &&
+       self->content == src->content))
+    return;
+
+  if (self->content)
+    region_content_leave (self);
+  else
+    region_remove_all_children (self);
+
+  RegionContent * content = src->content;
+  if (!content)
+    {
+      content = object_new (RegionContent);
+      add_region (content, src);
+    }
+  add_region (content, self);
+
+  region_content_sync (src);
+}
+
+/**
+ * Gives \ref self its own copy of the children it
+ * shares, if any.
+ *
+ * To be called when \ref self is unlinked.
+ */
+void
+region_content_unshare (
+  ZRegion * self)
+{
+  RegionContent * content = self->content;
+  if (!content)
+    return;
+
+  ZRegion * src =
+    content->regions[0] == self ?
+      content->regions[1] : content->regions[0];
+  region_content_leave (self);
+  region_copy_children (self, src);
+}
+
+/**
+ * Stops sharing the children with \ref self
+ * without copying them.
+ *
+ * The children arrays of \ref self are emptied.
+ */
+void
+region_content_leave (
+  ZRegion * self)
+{
+  RegionContent * content = self->content;
+  if (!content)
+    return;
+
+  bool was_owner = content->regions[0] == self;
+  array_delete (
+    content->regions, content->num_regions, self);
+  self->content = NULL;
+  self->num_midi_notes = 0;
+  self->num_aps = 0;
+  self->num_chord_objects = 0;
+  set_serialized_counts (self, true);
+
+  ZRegion * owner = content->regions[0];
+  if (content->num_regions == 1)
+    {
+      owner->content = NULL;
+      free (content->regions);
+      object_zero_and_free (content);
+    }
+
+  /* the children now belong to the first region
+   * left */
+  if (was_owner)
+    {
+      set_children_region (owner);
+      set_serialized_counts (owner, true);
+    }
+}
+
+/**
+ * To be called after the children of \ref self
+ * were added, removed or reordered.
+ *
+ * Copies the children arrays of \ref self to the
+ * regions sharing them and updates the counts
+ * used during serialization.
+ */
+void
+region_content_sync (
+  ZRegion * self)
+{
+  RegionContent * content = self->content;
+  if (!content)
+    {
+      set_serialized_counts (self, true);
+      return;
+    }
+
+  ZRegion * owner = content->regions[0];
+  for (int i = 0; i < content->num_regions; i++)
+    {
+      ZRegion * region = content->regions[i];
+      if (region != self)
+        copy_children (region, self);
+      set_serialized_counts (
+        region, region == owner);
+    }
+
+  /* editing functions point the children to the
+   * edited region */
+  set_children_region (owner);
+
+  invalidate_caches (self);
+}
+
+/**
+ * Sets the children counts from the serialized
+ * counts.
+ *
+ * To be called after deserializing \ref self.
+ */
+void
+region_content_init_loaded (
+  ZRegion * self)
+{
+  /* the counts of regions already sharing their
+   * children are up to date */
+  if (self->content)
+    return;
+
+  self->num_midi_notes =
+    self->num_serialized_midi_notes;
+  self->num_aps = self->num_serialized_aps;
+  self->num_chord_objects =
+    self->num_serialized_chord_objects;
+}
+
+/**
+ * Returns the region to show the children of
+ * \ref self relative to.
+ *
+ * This is the region in the clip editor if it
+ * shares its children with \ref self, otherwise
+ * \ref self.
+ */
+ZRegion *
+region_content_get_region_for_editor (
+  ZRegion * self)
+{
+  if (!self || !self->content ||
+      !CLIP_EDITOR->has_region)
+    return self;
+
+  ZRegion * ce_region =
+    clip_editor_get_region (CLIP_EDITOR);
+  if (ce_region &&
+      ce_region->content == self->content)
+    return ce_region;
+
+  return self;
+}
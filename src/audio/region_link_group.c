@@ -17,7 +17,10 @@
  * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "audio/automation_track.h"
+#include "audio/midi_region.h"
 #include "audio/region.h"
+#include "audio/region_content.h"
 #include "audio/region_link_group.h"
 #include "audio/region_link_group_manager.h"
 #include "project.h"
@@ -31,6 +34,35 @@ region_link_group_init_loaded (
 {
   self->magic = REGION_LINK_GROUP_MAGIC;
   self->ids_size = (size_t) self->num_ids;
+
+  if (self->num_ids == 0 ||
+      self->ids[0].type == REGION_TYPE_AUDIO)
+    return;
+
+  /* only one region serializes the shared
+   * children (older projects have a copy in each
+   * region), so share the children of the first
+   * region that has any */
+  ZRegion * src = NULL;
+  for (int i = 0; i < self->num_ids; i++)
+    {
+      ZRegion * region = region_find (&self->ids[i]);
+      g_return_if_fail (
+        IS_REGION_AND_NONNULL (region));
+      if (!src ||
+          (src->num_midi_notes == 0 &&
+           src->num_aps == 0 &&
+           src->num_chord_objects == 0))
+        {
+          src = region;
+        }
+    }
+  for (int i = 0; i < self->num_ids; i++)
+    {
+      ZRegion * region = region_find (&self->ids[i]);
+      if (region != src)
+        region_content_share (region, src);
+    }
 }
 
 void
@@ -73,6 +105,17 @@ region_link_group_add_region (
   g_return_if_fail (region->id.idx >= 0);
   g_return_if_fail (IS_REGION_LINK_GROUP (self));
 
+  /* share the children of the regions already in
+   * the group */
+  if (self->num_ids > 0 && !region->content &&
+      region->id.type != REGION_TYPE_AUDIO)
+    {
+      ZRegion * first = region_find (&self->ids[0]);
+      g_return_if_fail (IS_REGION_AND_NONNULL (first));
+      if (first != region)
+        region_content_share (region, first);
+    }
+
   array_double_size_if_full (
     self->ids, self->num_ids, self->ids_size,
     RegionIdentifier);
@@ -154,7 +197,12 @@ region_link_group_remove_region (
 }
 
 /**
- * Updates all other regions in the link group.
+ * Marks the playback caches of the regions in the
+ * link group as out of date.
+ *
+ * The regions share their children (see
+ * RegionContent), so the children themselves need
+ * no updating.
  *
  * @param region The region where the change
  *   happened.
@@ -164,24 +212,18 @@ region_link_group_update (
   RegionLinkGroup * self,
   ZRegion *         main_region)
 {
-  for (int i = 0; i < self->num_ids; i++)
+  switch (main_region->id.type)
     {
-      ZRegion * region =
-        region_find (&self->ids[i]);
-      g_return_if_fail (
-        IS_REGION_AND_NONNULL (region));
-
-      if (region_identifier_is_equal (
-           &self->ids[i], &main_region->id))
-        continue;
-
-      g_message ("[%s] updating %d (%d %s)",
-        __func__, i,
-        region->id.idx, region->name);
-
-      /* delete and readd all children */
-      region_remove_all_children (region);
-      region_copy_children (region, main_region);
+    case REGION_TYPE_MIDI:
+      midi_region_invalidate_note_store (
+        main_region);
+      break;
+    case REGION_TYPE_AUTOMATION:
+      automation_track_invalidate_envelope_for_region_id (
+        &main_region->id);
+      break;
+    default:
+      break;
     }
 }
 
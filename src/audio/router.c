@@ -38,6 +38,7 @@
 #include "zrythm-config.h"
 
 #include "audio/audio_track.h"
+#include "audio/dsp_profiler.h"
 #include "audio/engine.h"
 #include "audio/engine_alsa.h"
 #ifdef HAVE_JACK
@@ -47,6 +48,7 @@
 #include "audio/engine_pa.h"
 #endif
 #include "audio/graph.h"
+#include "audio/graph_node.h"
 #include "audio/graph_thread.h"
 #include "audio/master_track.h"
 #include "audio/midi.h"
@@ -87,6 +89,32 @@ router_get_max_route_playback_latency (
   return router->max_route_playback_latency;
 }
 
+/**
+ * Processes a node in the engine thread, before
+ * the graph threads start.
+ */
+REALTIME
+static void
+process_node_in_engine_thread (
+  GraphNode * node,
+  nframes_t   nsamples)
+{
+  DspProfiler * profiler =
+    g_atomic_pointer_get (&AUDIO_ENGINE->profiler);
+  if (profiler)
+    {
+      gint64 start = dsp_profiler_get_time ();
+      graph_node_process (node, nsamples);
+      dsp_profiler_record_node (
+        profiler, node, DSP_PROFILER_ENGINE_THREAD,
+        start, dsp_profiler_get_time ());
+    }
+  else
+    {
+      graph_node_process (node, nsamples);
+    }
+}
+
 /**
  * Starts a new cycle.
  *
@@ -122,17 +150,17 @@ router_start_cycle (
   /* process tempo track ports first */
   if (self->graph->bpm_node)
     {
-      graph_node_process (
+      process_node_in_engine_thread (
         self->graph->bpm_node, nsamples);
     }
   if (self->graph->beats_per_bar_node)
     {
-      graph_node_process (
+      process_node_in_engine_thread (
         self->graph->beats_per_bar_node, nsamples);
     }
   if (self->graph->beat_unit_node)
     {
-      graph_node_process (
+      process_node_in_engine_thread (
         self->graph->beat_unit_node, nsamples);
     }
 
@@ -17,7 +17,6 @@
  * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-#include "audio/audio_region.h"
 #include "audio/engine.h"
 #include "audio/group_target_track.h"
 #include "audio/metronome.h"
@@ -35,6 +34,7 @@
 #include "utils/dsp.h"
 #include "utils/flags.h"
 #include "utils/io.h"
+#include "utils/object_utils.h"
 #include "utils/objects.h"
 
 #include <glib/gi18n.h>
@@ -299,6 +299,21 @@ sample_processor_process (
         }
     }
 
+  /* process the file preview streams */
+  for (int i = 0; i < SAMPLE_PROCESSOR_MAX_STREAMS;
+       i++)
+    {
+      SampleStream * stream =
+        (SampleStream *)
+        g_atomic_pointer_get (&self->streams[i]);
+      if (!stream)
+        continue;
+
+      sample_stream_process (
+        stream, &l[cycle_offset], &r[cycle_offset],
+        nframes, self->fader->amp->control);
+    }
+
   if (self->roll)
     {
       midi_events_clear (
@@ -515,14 +530,112 @@ sample_processor_queue_sample_from_file (
   /* TODO */
 }
 
+/**
+ * Removes the streams that finished playing.
+ *
+ * This is called periodically from the GTK thread
+ * so that finished streams (and their decoder
+ * state) are released without waiting for the
+ * next file to be queued.
+ */
+void
+sample_processor_reap_streams (
+  SampleProcessor * self)
+{
+  for (int i = 0; i < SAMPLE_PROCESSOR_MAX_STREAMS;
+       i++)
+    {
+      SampleStream * stream = self->streams[i];
+      if (!stream ||
+          !sample_stream_is_finished (stream))
+        continue;
+
+      g_atomic_pointer_set (&self->streams[i], NULL);
+      free_later (stream, sample_stream_free);
+    }
+}
+
+/**
+ * Fades out all the streams.
+ */
+static void
+fade_out_streams (
+  SampleProcessor * self)
+{
+  for (int i = 0; i < SAMPLE_PROCESSOR_MAX_STREAMS;
+       i++)
+    {
+      SampleStream * stream = self->streams[i];
+      if (stream)
+        sample_stream_fade_out (stream);
+    }
+}
+
+/**
+ * Starts streaming the given audio file, fading
+ * out any other streams.
+ */
+static void
+queue_stream (
+  SampleProcessor * self,
+  const char *      abs_path)
+{
+  sample_processor_reap_streams (self);
+  fade_out_streams (self);
+
+  SampleStream * stream =
+    sample_stream_new (
+      abs_path, (int) AUDIO_ENGINE->sample_rate);
+  g_return_if_fail (stream);
+
+  /* use a free slot, or replace the first stream
+   * (already fading out) if there is none */
+  int slot = 0;
+  for (int i = 0; i < SAMPLE_PROCESSOR_MAX_STREAMS;
+       i++)
+    {
+      if (!self->streams[i])
+        {
+          slot = i;
+          break;
+        }
+    }
+  SampleStream * prev_stream = self->streams[slot];
+  g_atomic_pointer_set (
+    &self->streams[slot], stream);
+  if (prev_stream)
+    {
+      free_later (prev_stream, sample_stream_free);
+    }
+}
+
 /**
  * Adds a file (audio or MIDI) to the queue.
+ *
+ * Audio files are streamed from disk without
+ * pausing the engine, cross-fading with any file
+ * currently playing.
  */
 void
 sample_processor_queue_file (
   SampleProcessor *     self,
   const SupportedFile * file)
 {
+  if (supported_file_type_is_audio (file->type))
+    {
+      /* stop any MIDI file playback */
+      if (self->roll)
+        {
+          sample_processor_stop_file_playback (
+            self);
+        }
+
+      queue_stream (self, file->abs_path);
+      return;
+    }
+
+  fade_out_streams (self);
+
   EngineState state;
   engine_wait_for_pause (
     AUDIO_ENGINE, &state, false);
@@ -568,37 +681,8 @@ sample_processor_queue_file (
     self->tracklist, track, track->pos,
     F_NO_PUBLISH_EVENTS, F_NO_RECALC_GRAPH);
 
-  if (supported_file_type_is_audio (file->type))
-    {
-      track =
-        track_new (
-          TRACK_TYPE_AUDIO,
-          self->tracklist->num_tracks,
-          "Sample processor audio",
-          F_WITH_LANE, F_AUDITIONER);
-      track->is_auditioner = true;
-      tracklist_insert_track (
-        self->tracklist, track, track->pos,
-        F_NO_PUBLISH_EVENTS, F_NO_RECALC_GRAPH);
-
-      /* create an audio region & add to
-       * track */
-      ZRegion * ar =
-        audio_region_new (
-          -1, file->abs_path, false,
-          NULL, 0, NULL, 0, 0,
-          &start_pos, 0, 0, 0);
-      track_add_region (
-        track, ar, NULL, 0, F_GEN_NAME,
-        F_NO_PUBLISH_EVENTS);
-
-      ArrangerObject * obj =  (ArrangerObject *) ar;
-      position_set_to_pos (
-        &self->file_end_pos, &obj->end_pos);
-    }
-  else if (supported_file_type_is_midi (
-             file->type) &&
-           self->instrument_setting)
+  if (supported_file_type_is_midi (file->type) &&
+      self->instrument_setting)
     {
       /* create an instrument track */
       Track * instrument_track =
@@ -710,6 +794,14 @@ void
 sample_processor_stop_file_playback (
   SampleProcessor *     self)
 {
+  fade_out_streams (self);
+  sample_processor_reap_streams (self);
+
+  /* only pause the engine if auditioning a MIDI
+   * file */
+  if (!self->roll)
+    return;
+
   EngineState state;
   engine_wait_for_pause (
     AUDIO_ENGINE, &state, false);
@@ -733,6 +825,13 @@ sample_processor_free (
 {
   sample_processor_disconnect (self);
 
+  for (int i = 0; i < SAMPLE_PROCESSOR_MAX_STREAMS;
+       i++)
+    {
+      object_free_w_func_and_null (
+        sample_stream_free, self->streams[i]);
+    }
+
   object_free_w_func_and_null (
     tracklist_free, self->tracklist);
   object_free_w_func_and_null (
@@ -0,0 +1,507 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/encoder.h"
+#include "audio/sample_stream.h"
+#include "utils/objects.h"
+
+#include "zix/ring.h"
+
+#include <samplerate.h>
+#include <sndfile.h>
+
+/** Frames to decode at a time. */
+#define DECODE_CHUNK_FRAMES 1024
+
+/** Frames to read from the ring at a time. */
+#define READ_CHUNK_FRAMES 256
+
+/** Size of an interleaved stereo frame. */
+#define STEREO_FRAME_SIZE (2 * sizeof (float))
+
+/**
+ * Marks the stream as ready once enough frames are
+ * decoded.
+ */
+static void
+update_ready (
+  SampleStream * self)
+{
+  if (g_atomic_int_get (&self->ready))
+    return;
+
+  if (zix_ring_read_space (self->ring) >=
+        self->prefill_frames * STEREO_FRAME_SIZE)
+    {
+      g_atomic_int_set (&self->ready, 1);
+    }
+}
+
+/**
+ * Writes the given interleaved stereo frames to the
+ * ring, waiting for space if needed.
+ *
+ * @return False if the decoder was asked to stop.
+ */
+static bool
+write_to_ring (
+  SampleStream * self,
+  const float *  frames,
+  long           num_frames)
+{
+  const char * src = (const char *) frames;
+  uint32_t size =
+    (uint32_t) num_frames * STEREO_FRAME_SIZE;
+  while (size > 0)
+    {
+      /* also stop once playback finished, so the
+       * decoder does not wait for space that will
+       * never be read */
+      if (g_atomic_int_get (&self->stop_decoder) ||
+          g_atomic_int_get (&self->finished))
+        return false;
+
+      /* only write whole frames */
+      uint32_t space =
+        zix_ring_write_space (self->ring);
+      space -= space % STEREO_FRAME_SIZE;
+      if (space == 0)
+        {
+          g_usleep (1000);
+          continue;
+        }
+
+      uint32_t to_write = MIN (space, size);
+      zix_ring_write (self->ring, src, to_write);
+      src += to_write;
+      size -= to_write;
+      update_ready (self);
+    }
+
+  return true;
+}
+
+/**
+ * Converts interleaved frames with the given
+ * number of channels to stereo.
+ */
+static void
+to_stereo (
+  const float * in_frames,
+  int           channels,
+  float *       out_frames,
+  long          num_frames)
+{
+  for (long i = 0; i < num_frames; i++)
+    {
+      const float * in = &in_frames[i * channels];
+      out_frames[i * 2] = in[0];
+      out_frames[i * 2 + 1] =
+        channels > 1 ? in[1] : in[0];
+    }
+}
+
+/**
+ * Decodes the file in chunks with libsndfile,
+ * resampling with libsamplerate if needed.
+ *
+ * @return False if the file could not be opened.
+ */
+static bool
+decode_with_sndfile (
+  SampleStream * self)
+{
+  SF_INFO info;
+  memset (&info, 0, sizeof (SF_INFO));
+  SNDFILE * sndfile =
+    sf_open (self->abs_path, SFM_READ, &info);
+  if (!sndfile)
+    return false;
+
+  int channels = info.channels;
+  double ratio =
+    (double) self->samplerate /
+    (double) info.samplerate;
+  long out_size =
+    (long) ceil (DECODE_CHUNK_FRAMES * ratio) + 16;
+  float * in_frames =
+    calloc (
+      (size_t) (DECODE_CHUNK_FRAMES * channels),
+      sizeof (float));
+  float * stereo_frames =
+    calloc (
+      DECODE_CHUNK_FRAMES * 2, sizeof (float));
+  float * out_frames =
+    calloc ((size_t) out_size * 2, sizeof (float));
+
+  SRC_STATE * src_state = NULL;
+  if (info.samplerate != self->samplerate)
+    {
+      int err = 0;
+      src_state =
+        src_new (SRC_SINC_FASTEST, 2, &err);
+      if (!src_state)
+        {
+          g_warning (
+            "failed to create resampler: %s",
+            src_strerror (err));
+        }
+    }
+
+  bool eof = false;
+  bool stopped = false;
+  while (!eof && !stopped)
+    {
+      sf_count_t num_read =
+        sf_readf_float (
+          sndfile, in_frames, DECODE_CHUNK_FRAMES);
+      eof = num_read < DECODE_CHUNK_FRAMES;
+      to_stereo (
+        in_frames, channels, stereo_frames,
+        num_read);
+
+      if (!src_state)
+        {
+          stopped =
+            !write_to_ring (
+              self, stereo_frames, num_read);
+          continue;
+        }
+
+      SRC_DATA data = {
+        .data_in = stereo_frames,
+        .input_frames = num_read,
+        .data_out = out_frames,
+        .output_frames = out_size,
+        .src_ratio = ratio,
+        .end_of_input = eof,
+      };
+      while (!stopped)
+        {
+          int err = src_process (src_state, &data);
+          if (err)
+            {
+              g_warning (
+                "failed to resample %s: %s",
+                self->abs_path, src_strerror (err));
+              eof = true;
+              break;
+            }
+          stopped =
+            !write_to_ring (
+              self, out_frames,
+              data.output_frames_gen);
+
+          data.data_in +=
+            data.input_frames_used * 2;
+          data.input_frames -=
+            data.input_frames_used;
+
+          /* at the end of the input, keep going
+           * until the resampler is drained */
+          if (data.output_frames_gen == 0 &&
+              (data.input_frames == 0 ||
+               data.input_frames_used == 0))
+            break;
+          if (data.input_frames == 0 &&
+              !data.end_of_input)
+            break;
+        }
+    }
+
+  if (src_state)
+    src_delete (src_state);
+  free (in_frames);
+  free (stereo_frames);
+  free (out_frames);
+  sf_close (sndfile);
+
+  return true;
+}
+
+/**
+ * Decodes the whole file with libaudec (for
+ * formats libsndfile does not support) and writes
+ * it to the ring.
+ */
+static void
+decode_with_audec (
+  SampleStream * self)
+{
+  AudioEncoder * enc =
+    audio_encoder_new_from_file (self->abs_path);
+  if (!enc)
+    return;
+
+  audio_encoder_decode (
+    enc, self->samplerate, false);
+  if (enc->num_out_frames > 0)
+    {
+      float stereo_frames[DECODE_CHUNK_FRAMES * 2];
+      int channels = (int) enc->channels;
+      for (long i = 0; i < enc->num_out_frames;
+           i += DECODE_CHUNK_FRAMES)
+        {
+          long num_frames =
+            MIN (
+              DECODE_CHUNK_FRAMES,
+              enc->num_out_frames - i);
+          to_stereo (
+            &enc->out_frames[i * channels],
+            channels, stereo_frames, num_frames);
+          if (!write_to_ring (
+                 self, stereo_frames, num_frames))
+            break;
+        }
+    }
+
+  audio_encoder_free (enc);
+}
+
+static void
+unref_stream (
+  SampleStream * self)
+{
+  if (!g_atomic_int_dec_and_test (&self->refcount))
+    return;
+
+  object_free_w_func_and_null (
+    zix_ring_free, self->ring);
+  g_free_and_null (self->abs_path);
+
+  object_zero_and_free (self);
+}
+
+static void *
+decoder_thread_func (
+  void * data)
+{
+  SampleStream * self = (SampleStream *) data;
+
+  if (!decode_with_sndfile (self))
+    {
+      decode_with_audec (self);
+    }
+
+  g_atomic_int_set (&self->decoder_finished, 1);
+  g_atomic_int_set (&self->ready, 1);
+
+  unref_stream (self);
+
+  return NULL;
+}
+
+/**
+ * Creates a new stream for the given file and
+ * starts decoding it in the background.
+ *
+ * Playback fades in once
+ * @ref SAMPLE_STREAM_PREFILL_MS of audio is
+ * decoded.
+ *
+ * @param samplerate Sample rate to decode to.
+ */
+SampleStream *
+sample_stream_new (
+  const char * abs_path,
+  int          samplerate)
+{
+  g_return_val_if_fail (
+    abs_path && samplerate > 0, NULL);
+
+  SampleStream * self = object_new (SampleStream);
+
+  self->abs_path = g_strdup (abs_path);
+  self->samplerate = samplerate;
+  self->ring =
+    zix_ring_new (
+      (uint32_t)
+      (samplerate * SAMPLE_STREAM_RING_SECONDS *
+         STEREO_FRAME_SIZE));
+  zix_ring_mlock (self->ring);
+
+  self->fade_frames =
+    MAX (
+      (nframes_t)
+      ((samplerate * SAMPLE_STREAM_FADE_MS) / 1000),
+      1);
+  self->gain = 0.f;
+  self->gain_step = 1.f / (float) self->fade_frames;
+  self->prefill_frames =
+    (nframes_t)
+    ((samplerate * SAMPLE_STREAM_PREFILL_MS) / 1000);
+
+  /* 1 for the owner and 1 for the decoder */
+  self->refcount = 2;
+  self->decoder_thread =
+    g_thread_new (
+      "sample_stream_decoder",
+      (GThreadFunc) decoder_thread_func, self);
+
+  return self;
+}
+
+/**
+ * Adds the next frames of the stream to the given
+ * buffers.
+ *
+ * Nothing is played before the stream is ready.
+ * If the decoder has not caught up afterwards, the
+ * missing frames are skipped (silence).
+ *
+ * This is realtime-safe.
+ *
+ * @param volume Volume to mix at.
+ *
+ * @return The number of frames played.
+ */
+nframes_t
+sample_stream_process (
+  SampleStream *  self,
+  float *         l,
+  float *         r,
+  const nframes_t nframes,
+  const float     volume)
+{
+  if (g_atomic_int_get (&self->finished))
+    return 0;
+
+  if (!g_atomic_int_get (&self->ready))
+    {
+      /* nothing was played yet, so there is
+       * nothing to fade out */
+      if (g_atomic_int_get (
+            &self->fade_out_requested))
+        {
+          g_atomic_int_set (&self->finished, 1);
+        }
+      return 0;
+    }
+
+  if (g_atomic_int_get (&self->fade_out_requested)
+      && self->gain_step >= 0.f)
+    {
+      self->gain_step =
+        - 1.f / (float) self->fade_frames;
+    }
+
+  /* check if the decoder finished before checking
+   * the available frames so that no frames written
+   * in between are missed */
+  bool decoder_finished =
+    g_atomic_int_get (&self->decoder_finished);
+  nframes_t avail =
+    zix_ring_read_space (self->ring) /
+    STEREO_FRAME_SIZE;
+  nframes_t to_play = MIN (avail, nframes);
+
+  float frames[READ_CHUNK_FRAMES * 2];
+  nframes_t played = 0;
+  while (played < to_play)
+    {
+      nframes_t chunk =
+        MIN (to_play - played, READ_CHUNK_FRAMES);
+      zix_ring_read (
+        self->ring, frames,
+        (uint32_t) (chunk * STEREO_FRAME_SIZE));
+      for (nframes_t j = 0; j < chunk; j++)
+        {
+          self->gain += self->gain_step;
+          if (self->gain >= 1.f)
+            {
+              self->gain = 1.f;
+              if (self->gain_step > 0.f)
+                self->gain_step = 0.f;
+            }
+          else if (self->gain <= 0.f)
+            {
+              self->gain = 0.f;
+            }
+
+          float mult = self->gain * volume;
+          l[played + j] += frames[j * 2] * mult;
+          r[played + j] += frames[j * 2 + 1] * mult;
+        }
+      played += chunk;
+    }
+
+  bool faded_out =
+    self->gain_step < 0.f &&
+    (self->gain <= 0.f || to_play == 0);
+  bool drained = decoder_finished && avail <= nframes;
+  if (faded_out || drained)
+    {
+      g_atomic_int_set (&self->finished, 1);
+    }
+
+  return played;
+}
+
+/**
+ * Requests the stream to fade out and finish.
+ *
+ * This can be called from any thread.
+ */
+void
+sample_stream_fade_out (
+  SampleStream * self)
+{
+  g_atomic_int_set (&self->fade_out_requested, 1);
+}
+
+/**
+ * Returns whether the stream has finished playing.
+ */
+bool
+sample_stream_is_finished (
+  SampleStream * self)
+{
+  return g_atomic_int_get (&self->finished);
+}
+
+/**
+ * Tells the decoder thread to stop and frees the
+ * stream without waiting for it.
+ *
+ * The stream is freed by the decoder thread if it
+ * is still running.
+ *
+ * Must not be called while the engine may still be
+ * reading from the stream (use free_later()).
+ */
+void
+sample_stream_free (
+  SampleStream * self)
+{
+  /* decoding a file that libsndfile does not
+   * support can take a while, so don't block the
+   * caller (usually the UI thread) on it */
+  g_atomic_int_set (&self->stop_decoder, 1);
+  if (self->decoder_thread)
+    {
+      g_thread_unref (self->decoder_thread);
+      self->decoder_thread = NULL;
+    }
+
+  unref_stream (self);
+}
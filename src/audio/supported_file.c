@@ -19,8 +19,8 @@
 
 #include <stdlib.h>
 
-#include "audio/encoder.h"
 #include "audio/supported_file.h"
+#include "gui/backend/file_index.h"
 #include "utils/io.h"
 #include "utils/objects.h"
 #include "utils/string.h"
@@ -255,13 +255,16 @@ supported_file_type_get_ext (
 /**
  * Returns whether the given file should auto-play
  * (shorter than 1 min).
+ *
+ * @param entry The file's index entry (see
+ *   file_index_request()), or NULL if not indexed
+ *   yet (audio files will not auto-play).
  */
 bool
 supported_file_should_autoplay (
-  const SupportedFile * self)
+  const SupportedFile *  self,
+  const FileIndexEntry * entry)
 {
-  bool autoplay = true;
-
   /* no autoplay if not audio/MIDI */
   if (!supported_file_type_is_audio (self->type) &&
       !supported_file_type_is_midi (self->type))
@@ -269,28 +272,27 @@ supported_file_should_autoplay (
 
   if (supported_file_type_is_audio (self->type))
     {
-      AudioEncoder * enc =
-        audio_encoder_new_from_file (
-          self->abs_path);
-      if (!enc)
+      if (!entry)
         return false;
 
-      if ((enc->nfo.length / 1000) > 60)
-        {
-          autoplay = false;
-        }
-      audio_encoder_free (enc);
+      if ((entry->length / 1000) > 60)
+        return false;
     }
 
-  return autoplay;
+  return true;
 }
 
 /**
  * Returns a pango markup to be used in GTK labels.
+ *
+ * @param entry The file's index entry (see
+ *   file_index_request()), or NULL if not indexed
+ *   yet.
  */
 char *
 supported_file_get_info_text_for_label (
-  const SupportedFile * self)
+  const SupportedFile *  self,
+  const FileIndexEntry * entry)
 {
   char * file_type_label =
     supported_file_type_get_description (
@@ -299,32 +301,36 @@ supported_file_get_info_text_for_label (
   if (supported_file_type_is_audio (
         self->type))
     {
-      AudioEncoder * enc =
-        audio_encoder_new_from_file (
-          self->abs_path);
-      if (!enc)
+      if (!entry)
         {
-          g_free (file_type_label);
-          return
+          label =
+            g_markup_printf_escaped (
+              "<b>%s</b>\n%s",
+              self->label, _("Loading..."));
+        }
+      else if (entry->sample_rate <= 0)
+        {
+          label =
             g_strdup (_("Failed opening file"));
         }
-
-      label =
-        g_markup_printf_escaped (
-          "<b>%s</b>\n"
-          "Format: TODO\n"
-          "Sample rate: %d\n"
-          "Length: %lds | BPM: %.1f\n"
-          "Channels: %d | Bitrate: %d\n"
-          "Bit depth: %d",
-          self->label,
-          enc->nfo.sample_rate,
-          enc->nfo.length / 1000,
-          (double) enc->nfo.bpm,
-          enc->nfo.channels,
-          enc->nfo.bit_rate,
-          enc->nfo.bit_depth);
-      audio_encoder_free (enc);
+      else
+        {
+          label =
+            g_markup_printf_escaped (
+              "<b>%s</b>\n"
+              "Format: TODO\n"
+              "Sample rate: %d\n"
+              "Length: %lds | BPM: %.1f\n"
+              "Channels: %d | Bitrate: %d\n"
+              "Bit depth: %d",
+              self->label,
+              entry->sample_rate,
+              (long) (entry->length / 1000),
+              (double) entry->bpm,
+              entry->channels,
+              entry->bit_rate,
+              entry->bit_depth);
+        }
     }
   else
     label =
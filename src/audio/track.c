@@ -59,6 +59,7 @@
 #include "project.h"
 #include "utils/arrays.h"
 #include "utils/flags.h"
+#include "utils/handle_table.h"
 #include "utils/io.h"
 #include "utils/mem.h"
 #include "utils/object_utils.h"
@@ -3358,6 +3359,33 @@ track_set_icon (
     }
 }
 
+/**
+ * Registers the track in the handle table if
+ * @p is_project, otherwise unregisters it.
+ */
+static void
+update_handle (
+  Track * self,
+  bool    is_project)
+{
+  if (!ZRYTHM || !HANDLE_TABLE ||
+      is_project ==
+        object_handle_is_set (&self->handle))
+    return;
+
+  if (is_project)
+    {
+      self->handle =
+        handle_table_add (HANDLE_TABLE, self);
+    }
+  else
+    {
+      handle_table_remove (
+        HANDLE_TABLE, &self->handle);
+      self->handle.generation = 0;
+    }
+}
+
 /**
  * Recursively marks the track and children as
  * project objects or not.
@@ -3371,6 +3399,8 @@ track_set_is_project (
     "Setting track %s is_project to %d...",
     self->name, is_project);
 
+  update_handle (self, is_project);
+
   track_processor_set_is_project (
     self->processor, is_project);
   if (self->channel)
@@ -3396,6 +3426,14 @@ track_set_is_project (
         /*"%s: setting %s (%p) to %d",*/
         /*__func__, port->id.label, port, is_project);*/
       port_set_is_project (port, is_project);
+
+      /* plugin ports are resolved through the
+       * plugin handle */
+      if (port->id.owner_type !=
+            PORT_OWNER_TYPE_PLUGIN)
+        {
+          port->id.track_handle = self->handle;
+        }
     }
   free (ports);
 
@@ -3413,6 +3451,7 @@ track_set_is_project (
             {
               plugin_activate (pl, is_project);
             }
+          plugin_update_handle (pl, is_project);
         }
     }
 
@@ -3773,6 +3812,8 @@ track_free (Track * self)
   g_debug ("freeing track '%s' (pos %d)...",
     self->name, self->pos);
 
+  update_handle (self, false);
+
   /* remove regions */
   for (int i = 0; i < self->num_lanes; i++)
     {
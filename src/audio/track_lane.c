@@ -55,6 +55,33 @@ track_lane_init_loaded (
       region_set_lane (region, lane);
       arranger_object_init_loaded (r_obj);
     }
+
+  track_lane_update_midi_note_stores (lane, true);
+}
+
+/**
+ * Recreates the note stores of the MIDI regions in
+ * the lane that are out of date (or all of them if
+ * \ref force is true).
+ *
+ * Must be called from the GTK thread.
+ *
+ * @see midi_region_update_note_store().
+ */
+void
+track_lane_update_midi_note_stores (
+  TrackLane * self,
+  bool        force)
+{
+  for (int i = 0; i < self->num_regions; i++)
+    {
+      ZRegion * region = self->regions[i];
+      if (region->id.type != REGION_TYPE_MIDI)
+        continue;
+
+      midi_region_update_note_store (
+        region, force);
+    }
 }
 
 /**
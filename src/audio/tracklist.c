@@ -234,41 +234,60 @@ tracklist_print_tracks (
   g_message ("------ end ------");
 }
 
+/**
+ * Moves the track at \p src to \p dest and shifts
+ * the tracks in between by one position.
+ *
+ * Each affected track is renumbered once (the
+ * moved track twice), instead of moving the track
+ * one position at a time.
+ */
 static void
-swap_tracks (
+move_track_in_array (
   Tracklist * self,
   int         src,
   int         dest)
 {
+  if (src == dest)
+    return;
+
   self->swapping_tracks = true;
 
-  Track * src_track = self->tracks[src];
-  Track * dest_track = self->tracks[dest];
-  g_debug ("swapping tracks %s [%d] and %s [%d]...",
-    src_track ? src_track->name : "(null)", src,
-    dest_track ? dest_track->name : "(null)",
-    dest);
+  Track * track = self->tracks[src];
+  g_debug (
+    "moving track %s [%d] to %d...",
+    track ? track->name : "(null)", src, dest);
 
-  /* move src somewhere temporarily */
+  /* move the track somewhere temporarily so that
+   * no 2 tracks share a position while the others
+   * are renumbered */
+  int tmp_pos = self->num_tracks + 1;
   self->tracks[src] = NULL;
-  self->tracks[self->num_tracks + 1] = src_track;
-  if (src_track)
-    track_set_pos (src_track, self->num_tracks + 1);
-
-  /* move dest to src */
-  self->tracks[src] = dest_track;
-  self->tracks[dest] = NULL;
-  if (dest_track)
-    track_set_pos (dest_track, src);
-
-  /* move src from temp pos to dest */
-  self->tracks[dest] = src_track;
-  self->tracks[self->num_tracks + 1] = NULL;
-  if (src_track)
-    track_set_pos (src_track, dest);
+  self->tracks[tmp_pos] = track;
+  if (track)
+    track_set_pos (track, tmp_pos);
+
+  /* shift the tracks in between towards src,
+   * starting from the one next to the free slot */
+  int step = src > dest ? -1 : 1;
+  for (int i = src; i != dest; i += step)
+    {
+      Track * cur_track = self->tracks[i + step];
+      self->tracks[i] = cur_track;
+      self->tracks[i + step] = NULL;
+      if (cur_track)
+        track_set_pos (cur_track, i);
+    }
+
+  /* move the track from the temporary position to
+   * dest */
+  self->tracks[dest] = track;
+  self->tracks[tmp_pos] = NULL;
+  if (track)
+    track_set_pos (track, dest);
 
   self->swapping_tracks = false;
-  g_debug ("tracks swapped");
+  g_debug ("track moved");
 }
 
 /**
@@ -305,16 +324,9 @@ tracklist_insert_track (
   array_append (
     self->tracks, self->num_tracks, track);
 
-  /* if inserting it, swap until it reaches its
-   * position */
-  if (pos != self->num_tracks - 1)
-    {
-      for (int i = self->num_tracks - 1; i > pos;
-           i--)
-        {
-          swap_tracks (self, i, i - 1);
-        }
-    }
+  /* if inserting it, move it to its position */
+  move_track_in_array (
+    self, self->num_tracks - 1, pos);
 
   if (!self->is_auditioner)
     {
@@ -967,28 +979,15 @@ tracklist_move_track (
         }
     }
 
-  if (move_higher)
-    {
-      /* move all other tracks 1 track further */
-      for (int i = track->pos; i > pos; i--)
-        {
-          swap_tracks (self, i, i - 1);
-        }
-    }
-  else
+  /* when moving lower, the other tracks are moved
+   * 1 track earlier so the track would end up after
+   * the track currently at pos */
+  int dest = pos;
+  if (!move_higher && always_before_pos && pos > 0)
     {
-      /* move all other tracks 1 track earlier */
-      for (int i = track->pos; i < pos; i++)
-        {
-          swap_tracks (self, i, i + 1);
-        }
-
-      if (always_before_pos && pos > 0)
-        {
-          /* swap with previous track */
-          swap_tracks (self, pos, pos - 1);
-        }
+      dest = pos - 1;
     }
+  move_track_in_array (self, track->pos, dest);
 
   if (!self->is_auditioner)
     {
@@ -1089,6 +1088,34 @@ tracklist_get_num_muted_tracks (
   return count;
 }
 
+/**
+ * Returns the number of plugins currently
+ * suspended because they are idle.
+ */
+int
+tracklist_get_num_suspended_plugins (
+  const Tracklist * self)
+{
+  int count = 0;
+  Plugin * pls[STRIP_SIZE * 2 + 1];
+  for (int i = 0; i < self->num_tracks; i++)
+    {
+      Track * track = self->tracks[i];
+      if (!track->channel)
+        continue;
+
+      int num_pls =
+        channel_get_plugins (track->channel, pls);
+      for (int j = 0; j < num_pls; j++)
+        {
+          if (pls[j]->suspended)
+            count++;
+        }
+    }
+
+  return count;
+}
+
 int
 tracklist_get_num_soloed_tracks (
   const Tracklist * self)
@@ -117,6 +117,12 @@ velocity_shift (
   self->vel =
     (midi_byte_t)
     ((int) self->vel + delta);
+
+  if (self->midi_note)
+    {
+      midi_region_invalidate_note_store_for_region_id (
+        &self->midi_note->base.region_id);
+    }
 }
 
 /**
@@ -20,10 +20,12 @@
 #include "audio/audio_region.h"
 #include "audio/automation_point.h"
 #include "audio/automation_region.h"
+#include "audio/automation_track.h"
 #include "audio/chord_region.h"
 #include "audio/chord_track.h"
 #include "audio/marker_track.h"
 #include "audio/midi_region.h"
+#include "audio/region_content.h"
 #include "audio/stretcher.h"
 #include "gui/backend/arranger_object.h"
 #include "gui/backend/automation_selections.h"
@@ -248,6 +250,44 @@ set_to_midi_note_object (
   dest->val = src->val;
 }
 
+/**
+ * Marks the envelope of the automation track the
+ * object belongs to (if any) as out of date.
+ */
+static void
+invalidate_automation_envelope (
+  ArrangerObject * self)
+{
+  switch (self->type)
+    {
+    case TYPE (REGION):
+      automation_track_invalidate_envelope_for_region_id (
+        &((ZRegion *) self)->id);
+      break;
+    case TYPE (AUTOMATION_POINT):
+      automation_track_invalidate_envelope_for_region_id (
+        &self->region_id);
+      break;
+    default:
+      break;
+    }
+}
+
+/**
+ * Marks the note store of the MIDI region the
+ * object belongs to (if any) as out of date.
+ */
+static void
+invalidate_midi_note_store (
+  ArrangerObject * self)
+{
+  if (self->type == TYPE (MIDI_NOTE))
+    {
+      midi_region_invalidate_note_store_for_region_id (
+        &self->region_id);
+    }
+}
+
 /**
  * Sets the mute status of the object.
  */
@@ -258,6 +298,8 @@ arranger_object_set_muted (
   bool             fire_events)
 {
   self->muted = muted;
+  invalidate_automation_envelope (self);
+  invalidate_midi_note_store (self);
 
   if (fire_events)
     {
@@ -327,6 +369,9 @@ arranger_object_set_to_object (
     default:
       break;
     }
+
+  invalidate_automation_envelope (dest);
+  invalidate_midi_note_store (dest);
 }
 
 /**
@@ -378,7 +423,10 @@ arranger_object_get_region (
 
   ZRegion * region = region_find (id);
 
-  return region;
+  /* children shared by linked regions are shown
+   * relative to the region in the editor */
+  return
+    region_content_get_region_for_editor (region);
 }
 
 /**
@@ -675,6 +723,9 @@ arranger_object_set_position (
   pos_ptr = get_position_ptr (self, pos_type);
   g_return_if_fail (pos_ptr);
   position_set_to_pos (pos_ptr, pos);
+
+  invalidate_automation_envelope (self);
+  invalidate_midi_note_store (self);
 }
 
 /**
@@ -960,6 +1011,8 @@ init_loaded_region (
 {
   self->magic = REGION_MAGIC;
 
+  region_content_init_loaded (self);
+
   int i;
   switch (self->id.type)
     {
@@ -1132,6 +1185,8 @@ arranger_object_update_frames (
       position_update_frames_from_ticks (
         &self->fade_out_pos);
     }
+  invalidate_automation_envelope (self);
+  invalidate_midi_note_store (self);
 
   ZRegion * r;
   switch (self->type)
@@ -1469,6 +1524,7 @@ arranger_object_post_deserialize (
       {
         ZRegion * r = (ZRegion *) self;
         r->magic = REGION_MAGIC;
+        region_content_init_loaded (r);
       }
       break;
     case TYPE (SCALE_OBJECT):
@@ -2130,9 +2186,14 @@ clone_region (
               (ArrangerObject *) orig_mn;
             MidiNote * mn;
 
-            region_identifier_copy (
-              &orig_mn_obj->region_id,
-              &mr_orig->id);
+            /* shared notes must keep pointing
+             * to the region they belong to */
+            if (!mr_orig->content)
+              {
+                region_identifier_copy (
+                  &orig_mn_obj->region_id,
+                  &mr_orig->id);
+              }
             mn =
               (MidiNote *)
               arranger_object_clone (
@@ -3356,6 +3417,10 @@ free_region (
 
   g_message ("freeing region %s...", self->name);
 
+  /* leave the children to the linked regions
+   * still using them */
+  region_content_leave (self);
+
 #define FREE_R(type,sc) \
   case REGION_TYPE_##type: \
     sc##_region_free_members (self); \
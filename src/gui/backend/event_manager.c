@@ -998,6 +998,39 @@ on_arranger_object_created (
     }
 }
 
+/**
+ * Redraws everything that may show the objects
+ * of the given arranger, once for all objects.
+ */
+static void
+on_arranger_objects_changed (
+  ArrangerWidget * arranger)
+{
+  arranger_widget_redraw_whole (arranger);
+
+  if (arranger == MW_TIMELINE ||
+      arranger == MW_PINNED_TIMELINE)
+    {
+      ruler_widget_redraw_whole (
+        EDITOR_RULER);
+      timeline_toolbar_widget_refresh (
+        MW_TIMELINE_TOOLBAR);
+      return;
+    }
+
+  /* redraw the parent regions */
+  arranger_widget_redraw_whole (MW_TIMELINE);
+  arranger_widget_redraw_whole (
+    MW_PINNED_TIMELINE);
+
+  if (arranger == MW_MIDI_ARRANGER)
+    {
+      arranger_widget_redraw_whole (
+        (ArrangerWidget *)
+        MW_MIDI_MODIFIER_ARRANGER);
+    }
+}
+
 static void
 on_arranger_object_removed (
   ArrangerObjectType type)
@@ -1136,40 +1169,213 @@ on_plugin_visibility_changed (Plugin * pl)
   /*return FALSE;*/
 /*}*/
 
-static inline void
-clean_duplicates_and_copy (
+static guint
+event_hash (
+  gconstpointer data)
+{
+  const ZEvent * ev = (const ZEvent *) data;
+  return
+    g_direct_hash (ev->arg) ^
+    ((guint) ev->type * 2654435761u);
+}
+
+static gboolean
+event_equal (
+  gconstpointer a,
+  gconstpointer b)
+{
+  const ZEvent * ev1 = (const ZEvent *) a;
+  const ZEvent * ev2 = (const ZEvent *) b;
+  return
+    ev1->type == ev2->type &&
+    ev1->arg == ev2->arg;
+}
+
+/**
+ * Returns the event to the pool, or frees it if
+ * it was not taken from the pool.
+ */
+static void
+release_event (
+  EventManager * self,
+  ZEvent *       ev)
+{
+  if (ev->pooled)
+    {
+      object_pool_return (self->obj_pool, ev);
+    }
+  else
+    {
+      event_free (ev);
+    }
+}
+
+/**
+ * Adds the event to the pending events, unless
+ * an identical event is already pending.
+ */
+static void
+add_pending (
   EventManager * self,
-  ZEvent **      events,
-  int *          num_events)
+  ZEvent *       ev)
 {
-  MPMCQueue * q = self->mqueue;
-  ZEvent * event;
-  *num_events = 0;
-  int i, already_exists = 0;;
+  if (g_hash_table_contains (
+        self->pending_set, ev))
+    {
+      release_event (self, ev);
+      return;
+    }
+
+  g_hash_table_add (self->pending_set, ev);
+  g_queue_push_tail (self->pending, ev);
+}
 
-  /* only add events once to new array while
-   * popping */
+/**
+ * Moves the events pushed from other threads to
+ * the pending events.
+ */
+static void
+drain_queue (
+  EventManager * self)
+{
+  ZEvent * ev;
   while (event_queue_dequeue_event (
-           q, &event))
+           self->mqueue, &ev))
+    {
+      add_pending (self, ev);
+    }
+}
+
+/**
+ * Removes the pending events for which \p func
+ * returns true.
+ */
+static void
+remove_pending_events (
+  EventManager * self,
+  bool (*func) (ZEvent * ev, void * data),
+  void *         data)
+{
+  GList * link = self->pending->head;
+  while (link)
+    {
+      GList * next = link->next;
+      ZEvent * ev = (ZEvent *) link->data;
+      if (func (ev, data))
+        {
+          g_hash_table_remove (
+            self->pending_set, ev);
+          g_queue_delete_link (
+            self->pending, link);
+          release_event (self, ev);
+        }
+      link = next;
+    }
+}
+
+static inline bool
+is_arranger_object_event (
+  ZEvent * ev)
+{
+  return
+    ev->type == ET_ARRANGER_OBJECT_CREATED ||
+    ev->type == ET_ARRANGER_OBJECT_CHANGED;
+}
+
+static bool
+is_arranger_object_event_for_arranger (
+  ZEvent * ev,
+  void *   data)
+{
+  GHashTable * arrangers = (GHashTable *) data;
+  if (!is_arranger_object_event (ev))
+    return false;
+
+  ArrangerWidget * arranger =
+    arranger_object_get_arranger (
+      (ArrangerObject *) ev->arg);
+  return
+    arranger &&
+    g_hash_table_contains (arrangers, arranger);
+}
+
+/**
+ * Replaces the created/changed events of arranger
+ * objects with a single ET_ARRANGER_OBJECTS_CHANGED
+ * event for each arranger that has more than
+ * EVENT_MANAGER_MERGE_THRESHOLD of them pending.
+ */
+static void
+merge_arranger_object_events (
+  EventManager * self)
+{
+  if (g_queue_get_length (self->pending) <=
+        EVENT_MANAGER_MERGE_THRESHOLD)
+    return;
+
+  /* count the events per arranger */
+  GHashTable * counts =
+    g_hash_table_new (NULL, NULL);
+  for (GList * link = self->pending->head;
+       link; link = link->next)
     {
-      already_exists = 0;
+      ZEvent * ev = (ZEvent *) link->data;
+      if (!is_arranger_object_event (ev))
+        continue;
 
-      for (i = 0; i < *num_events; i++)
-        if (event->type == events[i]->type &&
-            event->arg == events[i]->arg)
-          already_exists = 1;
+      ArrangerWidget * arranger =
+        arranger_object_get_arranger (
+          (ArrangerObject *) ev->arg);
+      if (!arranger)
+        continue;
 
-      if (already_exists)
+      int count =
+        GPOINTER_TO_INT (
+          g_hash_table_lookup (
+            counts, arranger));
+      g_hash_table_insert (
+        counts, arranger,
+        GINT_TO_POINTER (count + 1));
+    }
+
+  GHashTable * arrangers_to_merge =
+    g_hash_table_new (NULL, NULL);
+  GHashTableIter iter;
+  gpointer key, value;
+  g_hash_table_iter_init (&iter, counts);
+  while (g_hash_table_iter_next (
+           &iter, &key, &value))
+    {
+      if (GPOINTER_TO_INT (value) >
+            EVENT_MANAGER_MERGE_THRESHOLD)
         {
-          object_pool_return (
-            self->obj_pool, event);
+          g_hash_table_add (
+            arrangers_to_merge, key);
         }
-      else
+    }
+  g_hash_table_unref (counts);
+
+  if (g_hash_table_size (arrangers_to_merge) > 0)
+    {
+      remove_pending_events (
+        self, is_arranger_object_event_for_arranger,
+        arrangers_to_merge);
+
+      g_hash_table_iter_init (
+        &iter, arrangers_to_merge);
+      while (g_hash_table_iter_next (
+               &iter, &key, NULL))
         {
-          array_append (
-            events, (*num_events), event);
+          ZEvent * ev = event_new ();
+          ev->file = __FILE__;
+          ev->func = __func__;
+          ev->lineno = __LINE__;
+          ev->type = ET_ARRANGER_OBJECTS_CHANGED;
+          ev->arg = key;
+          add_pending (self, ev);
         }
     }
+  g_hash_table_unref (arrangers_to_merge);
 }
 
 static int
@@ -1187,35 +1393,34 @@ soft_recalc_graph_when_paused (
 }
 
 /**
- * GSourceFunc to be added using idle add.
+ * Processes the pending events.
  *
- * This will loop indefinintely.
+ * @param use_budget Whether to stop after
+ *   EVENT_MANAGER_CYCLE_BUDGET and leave the
+ *   remaining events for the next cycle.
  */
-static int
-process_events (void * data)
+static void
+process_pending_events (
+  EventManager * self,
+  bool           use_budget)
 {
-  EventManager * self = (EventManager *) data;
+  gint64 start_time = g_get_monotonic_time ();
 
-  ZEvent * events[100];
-  ZEvent * ev;
-  int num_events = 0, i;
-  clean_duplicates_and_copy (
-    self, events, &num_events);
+  drain_queue (self);
+  merge_arranger_object_events (self);
 
-  /*g_message ("starting processing");*/
-  for (i = 0; i < num_events; i++)
+  ZEvent * ev;
+  int i = 0;
+  while ((ev = g_queue_pop_head (self->pending)))
     {
-      if (i > 30)
-        {
-          g_message (
-            "more than 30 UI events processed!");
-        }
+      /* events pushed while processing this one
+       * are new events */
+      g_hash_table_remove (self->pending_set, ev);
 
-      ev = events[i];
       if (ev->type < 0)
         {
           g_warn_if_reached ();
-          continue;
+          goto return_to_pool;
         }
 
       if (!ZRYTHM_HAVE_UI)
@@ -1264,6 +1469,10 @@ process_events (void * data)
           on_arranger_object_changed (
             (ArrangerObject *) ev->arg);
           break;
+        case ET_ARRANGER_OBJECTS_CHANGED:
+          on_arranger_objects_changed (
+            Z_ARRANGER_WIDGET (ev->arg));
+          break;
         case ET_ARRANGER_OBJECT_REMOVED:
           on_arranger_object_removed (
             (ArrangerObjectType) ev->arg);
@@ -1993,21 +2202,104 @@ process_events (void * data)
         }
 
 return_to_pool:
-      object_pool_return (
-        self->obj_pool, ev);
+      release_event (self, ev);
+      i++;
+
+      if (use_budget &&
+          g_get_monotonic_time () - start_time >
+            EVENT_MANAGER_CYCLE_BUDGET)
+        {
+          break;
+        }
     }
-  /*g_message ("processed %d events", i);*/
 
-  if (num_events > 6)
-    g_message ("More than 6 events processed. "
-               "Optimization needed.");
+  if (!g_queue_is_empty (self->pending))
+    {
+      g_debug (
+        "%s: processed %d events, %u left for the "
+        "next cycle",
+        __func__, i,
+        g_queue_get_length (self->pending));
+    }
 
-  /*g_usleep (8000);*/
   /*project_validate (PROJECT);*/
+}
+
+/**
+ * GSourceFunc to be added using idle add.
+ *
+ * This will loop indefinintely.
+ */
+static int
+process_events (void * data)
+{
+  EventManager * self = (EventManager *) data;
+
+  process_pending_events (self, true);
 
   return G_SOURCE_CONTINUE;
 }
 
+/**
+ * Pushes an event.
+ *
+ * If an event with the same type and argument is
+ * already pending, the new event is dropped.
+ *
+ * Use EVENTS_PUSH() instead of calling this
+ * directly.
+ */
+void
+event_manager_push (
+  EventManager * self,
+  EventType      type,
+  void *         arg,
+  const char *   file,
+  const char *   func,
+  int            lineno)
+{
+  ZEvent * ev;
+  if (g_thread_self () == zrythm_app->gtk_thread)
+    {
+      /* no need to allocate if already
+       * pending */
+      ZEvent key = { .type = type, .arg = arg };
+      if (g_hash_table_contains (
+            self->pending_set, &key))
+        return;
+
+      ev = event_new ();
+    }
+  else
+    {
+      /* may be called from the real time
+       * thread */
+      ev =
+        (ZEvent *)
+        object_pool_get (self->obj_pool);
+      if (!ev)
+        return;
+
+      ev->pooled = true;
+    }
+
+  ev->file = file;
+  ev->func = func;
+  ev->lineno = lineno;
+  ev->type = type;
+  ev->arg = arg;
+
+  if (ev->pooled)
+    {
+      event_queue_push_back_event (
+        self->mqueue, ev);
+    }
+  else
+    {
+      add_pending (self, ev);
+    }
+}
+
 /**
  * Starts accepting events.
  */
@@ -2053,6 +2345,9 @@ event_manager_new (void)
     self->mqueue,
     (size_t)
     EVENT_MANAGER_MAX_EVENTS * sizeof (ZEvent *));
+  self->pending = g_queue_new ();
+  self->pending_set =
+    g_hash_table_new (event_hash, event_equal);
 
   return self;
 }
@@ -2073,7 +2368,7 @@ event_manager_stop_events (
 
   /* process any remaining events - clear the
    * queue. */
-  process_events (self);
+  process_pending_events (self, false);
 }
 
 /**
@@ -2090,36 +2385,31 @@ event_manager_process_now (
   g_message ("processing events now...");
 
   /* process events now */
-  process_events (self);
+  process_pending_events (self, false);
 
   g_message ("done");
 }
 
+static bool
+event_has_arg (
+  ZEvent * ev,
+  void *   data)
+{
+  return ev->arg == data;
+}
+
 /**
  * Removes events where the arg matches the
  * given object.
- *
- * FIXME doesn't work - infinite loop.
  */
 void
 event_manager_remove_events_for_obj (
   EventManager * self,
   void *         obj)
 {
-  MPMCQueue * q = self->mqueue;
-  ZEvent * event;
-  while (event_queue_dequeue_event (q, &event))
-    {
-      if (event->arg == obj)
-        {
-          object_pool_return (
-            self->obj_pool, event);
-        }
-      else
-        {
-          event_queue_push_back_event (q, event);
-        }
-    }
+  drain_queue (self);
+  remove_pending_events (
+    self, event_has_arg, obj);
 }
 
 void
@@ -2130,6 +2420,10 @@ event_manager_free (
 
   event_manager_stop_events (self);
 
+  object_free_w_func_and_null (
+    g_queue_free, self->pending);
+  object_free_w_func_and_null (
+    g_hash_table_unref, self->pending_set);
   object_free_w_func_and_null (
     object_pool_free, self->obj_pool);
   object_free_w_func_and_null (
@@ -0,0 +1,779 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gui/backend/file_index.h"
+#include "utils/file.h"
+#include "utils/objects.h"
+#include "zrythm.h"
+
+#include <glib/gstdio.h>
+
+#include <audec/audec.h>
+#include <sndfile.h>
+
+/** Frames to read at a time when computing
+ * peaks. */
+#define PEAKS_CHUNK_FRAMES 4096
+
+typedef enum FileIndexJobType
+{
+  FILE_INDEX_JOB_SCAN_FILE,
+  FILE_INDEX_JOB_SCAN_DIR,
+} FileIndexJobType;
+
+typedef struct FileIndexJob
+{
+  FileIndexJobType  type;
+  char *            abs_path;
+  FileIndexCallback callback;
+  void *            user_data;
+  GDestroyNotify    user_data_free;
+} FileIndexJob;
+
+/**
+ * A result to deliver on the main thread.
+ */
+typedef struct FileIndexResult
+{
+  /** Entry, or NULL if the file could not be
+   * indexed. */
+  FileIndexEntry *  entry;
+  FileIndexCallback callback;
+  void *            user_data;
+  GDestroyNotify    user_data_free;
+} FileIndexResult;
+
+static void
+set_search_key (
+  FileIndexEntry * self)
+{
+  g_free_and_null (self->search_key);
+  char * basename =
+    g_path_get_basename (self->abs_path);
+  self->search_key = g_ascii_strdown (basename, -1);
+  g_free (basename);
+}
+
+FileIndexEntry *
+file_index_entry_clone (
+  const FileIndexEntry * src)
+{
+  FileIndexEntry * self = object_new (FileIndexEntry);
+
+  *self = *src;
+  self->abs_path = g_strdup (src->abs_path);
+  self->peaks = g_strdup (src->peaks);
+  self->search_key = g_strdup (src->search_key);
+
+  return self;
+}
+
+/**
+ * Returns the peak at the given index (0 to
+ * FILE_INDEX_NUM_PEAKS - 1) in the range [0, 1].
+ */
+float
+file_index_entry_get_peak (
+  const FileIndexEntry * self,
+  int                    idx)
+{
+  g_return_val_if_fail (
+    idx >= 0 && idx < FILE_INDEX_NUM_PEAKS, 0.f);
+
+  if (!self->peaks ||
+      strlen (self->peaks) !=
+        FILE_INDEX_NUM_PEAKS * 2)
+    return 0.f;
+
+  int hi =
+    g_ascii_xdigit_value (self->peaks[idx * 2]);
+  int lo =
+    g_ascii_xdigit_value (self->peaks[idx * 2 + 1]);
+  if (hi < 0 || lo < 0)
+    return 0.f;
+
+  return (float) (hi * 16 + lo) / 255.f;
+}
+
+void
+file_index_entry_free (
+  FileIndexEntry * self)
+{
+  g_free_and_null (self->abs_path);
+  g_free_and_null (self->peaks);
+  g_free_and_null (self->search_key);
+
+  object_zero_and_free (self);
+}
+
+/**
+ * Computes the peak thumbnail with libsndfile.
+ *
+ * @return A new string, or NULL if the file cannot
+ *   be opened with libsndfile.
+ */
+static char *
+compute_peaks (
+  FileIndex *  self,
+  const char * abs_path)
+{
+  SF_INFO info;
+  memset (&info, 0, sizeof (SF_INFO));
+  SNDFILE * sndfile =
+    sf_open (abs_path, SFM_READ, &info);
+  if (!sndfile)
+    return NULL;
+
+  if (info.frames <= 0 || info.channels <= 0)
+    {
+      sf_close (sndfile);
+      return NULL;
+    }
+
+  float peaks[FILE_INDEX_NUM_PEAKS];
+  memset (peaks, 0, sizeof (peaks));
+  float * frames =
+    calloc (
+      (size_t) (PEAKS_CHUNK_FRAMES * info.channels),
+      sizeof (float));
+  sf_count_t frame_idx = 0;
+  sf_count_t num_read;
+  while ((num_read =
+            sf_readf_float (
+              sndfile, frames,
+              PEAKS_CHUNK_FRAMES)) > 0)
+    {
+      if (g_atomic_int_get (&self->quit))
+        break;
+
+      for (sf_count_t i = 0; i < num_read; i++)
+        {
+          int peak_idx =
+            (int)
+            (((frame_idx + i) *
+                FILE_INDEX_NUM_PEAKS) /
+               info.frames);
+          peak_idx =
+            MIN (peak_idx, FILE_INDEX_NUM_PEAKS - 1);
+          for (int j = 0; j < info.channels; j++)
+            {
+              float val =
+                fabsf (frames[i * info.channels + j]);
+              if (val > peaks[peak_idx])
+                peaks[peak_idx] = val;
+            }
+        }
+      frame_idx += num_read;
+    }
+  free (frames);
+  sf_close (sndfile);
+
+  char * str =
+    g_malloc (FILE_INDEX_NUM_PEAKS * 2 + 1);
+  for (int i = 0; i < FILE_INDEX_NUM_PEAKS; i++)
+    {
+      int val =
+        (int)
+        roundf (CLAMP (peaks[i], 0.f, 1.f) * 255.f);
+      sprintf (&str[i * 2], "%02x", val);
+    }
+
+  return str;
+}
+
+/**
+ * Opens the file and creates a new entry with its
+ * metadata.
+ */
+static FileIndexEntry *
+scan_file (
+  FileIndex *      self,
+  const char *     abs_path,
+  const GStatBuf * stat_buf)
+{
+  FileIndexEntry * entry =
+    object_new (FileIndexEntry);
+  entry->abs_path = g_strdup (abs_path);
+  entry->mtime = (gint64) stat_buf->st_mtime;
+  entry->size = (gint64) stat_buf->st_size;
+  char * basename = g_path_get_basename (abs_path);
+  entry->type = supported_file_get_type (basename);
+  g_free (basename);
+  set_search_key (entry);
+
+  if (!supported_file_type_is_audio (entry->type))
+    return entry;
+
+  AudecInfo nfo;
+  memset (&nfo, 0, sizeof (AudecInfo));
+  AudecHandle * handle = audec_open (abs_path, &nfo);
+  if (handle)
+    {
+      entry->length = (gint64) nfo.length;
+      entry->sample_rate = (int) nfo.sample_rate;
+      entry->channels = (int) nfo.channels;
+      entry->bit_rate = (int) nfo.bit_rate;
+      entry->bit_depth = (int) nfo.bit_depth;
+      entry->bpm = (float) nfo.bpm;
+      audec_close (handle);
+    }
+  else
+    {
+      g_message ("failed to open %s", abs_path);
+    }
+
+  entry->peaks = compute_peaks (self, abs_path);
+
+  return entry;
+}
+
+/**
+ * Returns a copy of the up-to-date entry for the
+ * given file, scanning the file if needed.
+ *
+ * @return A new entry, or NULL if the file does not
+ *   exist.
+ */
+static FileIndexEntry *
+get_or_scan_file (
+  FileIndex *  self,
+  const char * abs_path)
+{
+  GStatBuf stat_buf;
+  if (g_stat (abs_path, &stat_buf) != 0)
+    return NULL;
+
+  g_mutex_lock (&self->mutex);
+  FileIndexEntry * entry =
+    g_hash_table_lookup (self->entries, abs_path);
+  if (entry &&
+      entry->mtime == (gint64) stat_buf.st_mtime &&
+      entry->size == (gint64) stat_buf.st_size)
+    {
+      FileIndexEntry * clone =
+        file_index_entry_clone (entry);
+      g_mutex_unlock (&self->mutex);
+      return clone;
+    }
+  g_mutex_unlock (&self->mutex);
+
+  entry = scan_file (self, abs_path, &stat_buf);
+
+  g_mutex_lock (&self->mutex);
+  g_hash_table_replace (
+    self->entries, entry->abs_path, entry);
+  self->dirty = true;
+  FileIndexEntry * clone =
+    file_index_entry_clone (entry);
+  g_mutex_unlock (&self->mutex);
+
+  return clone;
+}
+
+static void
+scan_dir (
+  FileIndex *  self,
+  const char * abs_path)
+{
+  GDir * dir = g_dir_open (abs_path, 0, NULL);
+  if (!dir)
+    return;
+
+  const char * filename;
+  while ((filename = g_dir_read_name (dir)))
+    {
+      if (g_atomic_int_get (&self->quit))
+        break;
+
+      /* skip hidden files */
+      if (filename[0] == '.')
+        continue;
+
+      char * path =
+        g_build_filename (abs_path, filename, NULL);
+      if (g_file_test (path, G_FILE_TEST_IS_DIR))
+        {
+          if (!g_file_test (
+                 path, G_FILE_TEST_IS_SYMLINK))
+            scan_dir (self, path);
+        }
+      else if (supported_file_type_is_supported (
+                 supported_file_get_type (filename)))
+        {
+          FileIndexEntry * entry =
+            get_or_scan_file (self, path);
+          if (entry)
+            file_index_entry_free (entry);
+        }
+      g_free (path);
+    }
+  g_dir_close (dir);
+}
+
+static int
+deliver_result (
+  FileIndexResult * result)
+{
+  if (result->entry)
+    {
+      result->callback (
+        result->entry, result->user_data);
+      file_index_entry_free (result->entry);
+    }
+  if (result->user_data_free)
+    {
+      result->user_data_free (result->user_data);
+    }
+  free (result);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+job_free (
+  FileIndexJob * job)
+{
+  g_free_and_null (job->abs_path);
+  object_zero_and_free (job);
+}
+
+/**
+ * Delivers the result of the job on the main
+ * thread (also when there is no entry, so that the
+ * user data is released there).
+ *
+ * @param entry Entry to pass to the callback, or
+ *   NULL to only release the user data.
+ */
+static void
+queue_result (
+  FileIndexJob *   job,
+  FileIndexEntry * entry)
+{
+  if (!job->callback)
+    {
+      if (entry)
+        file_index_entry_free (entry);
+      return;
+    }
+
+  FileIndexResult * result =
+    object_new (FileIndexResult);
+  result->entry = entry;
+  result->callback = job->callback;
+  result->user_data = job->user_data;
+  result->user_data_free = job->user_data_free;
+  g_idle_add (
+    (GSourceFunc) deliver_result, result);
+}
+
+static void
+process_job (
+  FileIndexJob * job,
+  FileIndex *    self)
+{
+  if (g_atomic_int_get (&self->quit))
+    {
+      queue_result (job, NULL);
+      goto done;
+    }
+
+  switch (job->type)
+    {
+    case FILE_INDEX_JOB_SCAN_FILE:
+      queue_result (
+        job,
+        get_or_scan_file (self, job->abs_path));
+      break;
+    case FILE_INDEX_JOB_SCAN_DIR:
+      scan_dir (self, job->abs_path);
+      file_index_save (self);
+      break;
+    }
+
+done:
+  job_free (job);
+  g_atomic_int_dec_and_test (&self->num_pending);
+}
+
+/**
+ * Queues the job.
+ *
+ * Jobs with a callback are requested by the user
+ * and go to a separate worker so that they are not
+ * stuck behind background scans.
+ */
+static void
+push_job (
+  FileIndex *    self,
+  FileIndexJob * job)
+{
+  g_atomic_int_inc (&self->num_pending);
+  GError * err = NULL;
+  g_thread_pool_push (
+    job->callback ?
+      self->interactive_pool : self->pool,
+    job, &err);
+  if (err)
+    {
+      g_warning (
+        "failed to queue file index job: %s",
+        err->message);
+      g_error_free (err);
+      queue_result (job, NULL);
+      job_free (job);
+      g_atomic_int_dec_and_test (&self->num_pending);
+    }
+}
+
+/**
+ * Loads the cache file into the entries.
+ */
+static void
+load_cache (
+  FileIndex * self)
+{
+  if (!self->cache_path ||
+      !file_exists (self->cache_path))
+    return;
+
+  char * yaml = NULL;
+  GError * err = NULL;
+  g_file_get_contents (
+    self->cache_path, &yaml, NULL, &err);
+  if (err)
+    {
+      g_warning (
+        "failed to read file index %s: %s",
+        self->cache_path, err->message);
+      g_error_free (err);
+      return;
+    }
+
+  FileIndexCache * cache =
+    (FileIndexCache *)
+    yaml_deserialize (yaml, &file_index_cache_schema);
+  g_free (yaml);
+  if (!cache ||
+      cache->schema_version !=
+        FILE_INDEX_SCHEMA_VERSION)
+    {
+      g_message (
+        "discarding file index at %s",
+        self->cache_path);
+      if (cache)
+        {
+          for (int i = 0; i < cache->num_entries; i++)
+            {
+              file_index_entry_free (
+                cache->entries[i]);
+            }
+          free (cache->entries);
+          free (cache);
+        }
+      return;
+    }
+
+  /* move the entries to the hash table */
+  for (int i = 0; i < cache->num_entries; i++)
+    {
+      FileIndexEntry * entry = cache->entries[i];
+      set_search_key (entry);
+      g_hash_table_replace (
+        self->entries, entry->abs_path, entry);
+    }
+  free (cache->entries);
+  free (cache);
+
+  g_message (
+    "loaded %u entries from file index",
+    g_hash_table_size (self->entries));
+}
+
+/**
+ * Creates a new index, loading the cache at the
+ * given path if it exists.
+ *
+ * @param cache_path Path to the on-disk cache, or
+ *   NULL to keep the index in memory only.
+ */
+FileIndex *
+file_index_new (
+  const char * cache_path)
+{
+  FileIndex * self = object_new (FileIndex);
+
+  self->cache_path = g_strdup (cache_path);
+  self->entries =
+    g_hash_table_new_full (
+      g_str_hash, g_str_equal, NULL,
+      (GDestroyNotify) file_index_entry_free);
+  g_mutex_init (&self->mutex);
+
+  load_cache (self);
+
+  self->pool =
+    g_thread_pool_new (
+      (GFunc) process_job, self, 1, false, NULL);
+  self->interactive_pool =
+    g_thread_pool_new (
+      (GFunc) process_job, self, 1, false, NULL);
+
+  return self;
+}
+
+/**
+ * Returns the default path of the on-disk cache.
+ */
+char *
+file_index_get_default_cache_path (void)
+{
+  char * zrythm_dir =
+    zrythm_get_dir (ZRYTHM_DIR_USER_TOP);
+  g_return_val_if_fail (zrythm_dir, NULL);
+
+  char * path =
+    g_build_filename (
+      zrythm_dir, FILE_INDEX_FILENAME, NULL);
+  g_free (zrythm_dir);
+
+  return path;
+}
+
+/**
+ * Queues the given file for indexing (if it is not
+ * already indexed and unchanged).
+ *
+ * Requests with a callback are processed before
+ * background scans.
+ *
+ * @param callback Callback to call on the main
+ *   thread when done, or NULL.
+ * @param user_data_free Function to free the user
+ *   data with on the main thread once the request
+ *   is finished (also if the file could not be
+ *   indexed), or NULL.
+ */
+void
+file_index_request (
+  FileIndex *       self,
+  const char *      abs_path,
+  FileIndexCallback callback,
+  void *            user_data,
+  GDestroyNotify    user_data_free)
+{
+  FileIndexJob * job = object_new (FileIndexJob);
+  job->type = FILE_INDEX_JOB_SCAN_FILE;
+  job->abs_path = g_strdup (abs_path);
+  job->callback = callback;
+  job->user_data = user_data;
+  job->user_data_free = user_data_free;
+
+  push_job (self, job);
+}
+
+/**
+ * Queues all supported files under the given
+ * directory (recursively) for indexing.
+ */
+void
+file_index_queue_dir (
+  FileIndex *  self,
+  const char * abs_path)
+{
+  FileIndexJob * job = object_new (FileIndexJob);
+  job->type = FILE_INDEX_JOB_SCAN_DIR;
+  job->abs_path = g_strdup (abs_path);
+
+  push_job (self, job);
+}
+
+/**
+ * Returns the paths of the indexed files whose
+ * name contains the given string (ignoring case),
+ * sorted.
+ *
+ * @param max_results Max number of results, or -1
+ *   for no limit.
+ *
+ * @return A new array of strings.
+ */
+GPtrArray *
+file_index_search (
+  FileIndex *  self,
+  const char * query,
+  int          max_results)
+{
+  GPtrArray * results =
+    g_ptr_array_new_with_free_func (g_free);
+  char * query_down = g_ascii_strdown (query, -1);
+
+  g_mutex_lock (&self->mutex);
+  GHashTableIter iter;
+  gpointer value;
+  g_hash_table_iter_init (&iter, self->entries);
+  while (g_hash_table_iter_next (
+           &iter, NULL, &value))
+    {
+      FileIndexEntry * entry =
+        (FileIndexEntry *) value;
+      if (strstr (entry->search_key, query_down))
+        {
+          g_ptr_array_add (
+            results, g_strdup (entry->abs_path));
+        }
+    }
+  g_mutex_unlock (&self->mutex);
+  g_free (query_down);
+
+  g_ptr_array_sort (
+    results, (GCompareFunc) g_ascii_strcasecmp);
+  if (max_results >= 0 &&
+      results->len > (guint) max_results)
+    {
+      g_ptr_array_remove_range (
+        results, (guint) max_results,
+        results->len - (guint) max_results);
+    }
+
+  return results;
+}
+
+/**
+ * Returns the number of indexed files.
+ */
+int
+file_index_get_num_entries (
+  FileIndex * self)
+{
+  g_mutex_lock (&self->mutex);
+  int num_entries =
+    (int) g_hash_table_size (self->entries);
+  g_mutex_unlock (&self->mutex);
+
+  return num_entries;
+}
+
+/**
+ * Blocks until all queued files are indexed.
+ *
+ * Used in tests.
+ */
+void
+file_index_wait (
+  FileIndex * self)
+{
+  while (g_atomic_int_get (&self->num_pending) > 0)
+    {
+      g_usleep (1000);
+    }
+}
+
+/**
+ * Writes the index to the cache file if there are
+ * changes.
+ */
+void
+file_index_save (
+  FileIndex * self)
+{
+  if (!self->cache_path)
+    return;
+
+  g_mutex_lock (&self->mutex);
+  if (!self->dirty)
+    {
+      g_mutex_unlock (&self->mutex);
+      return;
+    }
+
+  FileIndexCache cache = {
+    .schema_version = FILE_INDEX_SCHEMA_VERSION,
+  };
+  cache.num_entries =
+    (int) g_hash_table_size (self->entries);
+  cache.entries =
+    calloc (
+      (size_t) MAX (cache.num_entries, 1),
+      sizeof (FileIndexEntry *));
+  GHashTableIter iter;
+  gpointer value;
+  int i = 0;
+  g_hash_table_iter_init (&iter, self->entries);
+  while (g_hash_table_iter_next (
+           &iter, NULL, &value))
+    {
+      cache.entries[i++] = (FileIndexEntry *) value;
+    }
+  char * yaml =
+    yaml_serialize (
+      &cache, &file_index_cache_schema);
+  free (cache.entries);
+  self->dirty = false;
+  g_mutex_unlock (&self->mutex);
+
+  g_return_if_fail (yaml);
+  GError * err = NULL;
+  g_file_set_contents (
+    self->cache_path, yaml, -1, &err);
+  if (err)
+    {
+      g_warning (
+        "failed to write file index to %s: %s",
+        self->cache_path, err->message);
+      g_error_free (err);
+    }
+  g_free (yaml);
+}
+
+/**
+ * Stops the worker and frees the index (without
+ * saving).
+ */
+void
+file_index_free (
+  FileIndex * self)
+{
+  g_atomic_int_set (&self->quit, 1);
+
+  /* remaining jobs are skipped because of the quit
+   * flag but still need to be freed */
+  if (self->interactive_pool)
+    {
+      g_thread_pool_free (
+        self->interactive_pool, false, true);
+      self->interactive_pool = NULL;
+    }
+  if (self->pool)
+    {
+      g_thread_pool_free (self->pool, false, true);
+      self->pool = NULL;
+    }
+
+  object_free_w_func_and_null (
+    g_hash_table_destroy, self->entries);
+  g_mutex_clear (&self->mutex);
+  g_free_and_null (self->cache_path);
+
+  object_zero_and_free (self);
+}
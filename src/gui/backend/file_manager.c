@@ -21,6 +21,7 @@
 #include <string.h>
 
 #include "audio/supported_file.h"
+#include "gui/backend/file_index.h"
 #include "gui/backend/file_manager.h"
 #include "settings/settings.h"
 #include "utils/arrays.h"
@@ -46,6 +47,15 @@ file_manager_new (void)
   self->files =
     g_ptr_array_new_full (
       400, (GDestroyNotify) supported_file_free);
+
+  char * index_path = NULL;
+  if (!ZRYTHM_TESTING)
+    {
+      index_path =
+        file_index_get_default_cache_path ();
+    }
+  self->index = file_index_new (index_path);
+  g_free (index_path);
   self->locations =
     g_ptr_array_new_with_free_func (
       (GDestroyNotify) file_browser_location_free);
@@ -90,6 +100,11 @@ file_manager_new (void)
           fl->special_location =
             FILE_MANAGER_NONE;
           g_ptr_array_add (self->locations, fl);
+
+          /* index bookmarked locations in the
+           * background */
+          file_index_queue_dir (
+            self->index, fl->path);
         }
       g_strfreev (bookmarks);
 
@@ -125,40 +140,41 @@ alphaBetize (const void * _a,
   return -strcmp(a->label, b->label); /* aka: return strcmp(b, a); */
 }
 
-static void
-load_files_from_location (
-  FileManager *         self,
-  FileBrowserLocation * location)
+/**
+ * Returns a new array with the files under the
+ * given path.
+ */
+static GPtrArray *
+list_files (
+  const char * path)
 {
   const gchar * file;
   SupportedFile * fd;
 
-  g_ptr_array_remove_range (
-    self->files, 0, self->files->len);
+  GPtrArray * files =
+    g_ptr_array_new_full (
+      400, (GDestroyNotify) supported_file_free);
 
-  GDir * dir =
-    g_dir_open (location->path, 0, NULL);
+  GDir * dir = g_dir_open (path, 0, NULL);
   if (!dir)
     {
-      g_warning ("Could not open dir %s",
-                 location->path);
-      return;
+      g_warning ("Could not open dir %s", path);
+      return files;
     }
 
   /* create special parent dir entry */
   fd = object_new (SupportedFile);
   /*g_message ("pre path %s",*/
-             /*location->path);*/
-  fd->abs_path =
-    io_path_get_parent_dir (location->path);
+             /*path);*/
+  fd->abs_path = io_path_get_parent_dir (path);
   /*g_message ("after path %s",*/
              /*fd->abs_path);*/
   fd->type = FILE_TYPE_PARENT_DIR;
   fd->hidden = 0;
   fd->label = g_strdup ("..");
-  if (strlen (location->path) > 1)
+  if (strlen (path) > 1)
     {
-      g_ptr_array_add (self->files, fd);
+      g_ptr_array_add (files, fd);
     }
   else
     {
@@ -175,8 +191,7 @@ load_files_from_location (
       char * absolute_path =
         g_strdup_printf (
           "%s%s%s",
-          strlen (location->path) == 1 ?
-            "" : location->path,
+          strlen (path) == 1 ? "" : path,
           G_DIR_SEPARATOR_S, file);
       fd->abs_path = absolute_path;
       fd->label = g_strdup (file);
@@ -193,6 +208,7 @@ load_files_from_location (
           g_warning (
             "failed to query file info for %s",
             absolute_path);
+          g_error_free (err);
         }
       else
         {
@@ -217,7 +233,7 @@ load_files_from_location (
       if (file[0] == '.')
         fd->hidden = true;
 
-      g_ptr_array_add (self->files, fd);
+      g_ptr_array_add (files, fd);
       /*g_message ("File found: %s (%d - %d)",*/
                  /*fd->abs_path,*/
                  /*fd->type,*/
@@ -226,8 +242,37 @@ load_files_from_location (
   g_dir_close (dir);
 
   g_ptr_array_sort (
-    self->files, (GCompareFunc) alphaBetize);
-  g_message ("Total files: %d", self->files->len);
+    files, (GCompareFunc) alphaBetize);
+  g_message ("Total files: %d", files->len);
+
+  return files;
+}
+
+/**
+ * Replaces the current files with the given ones
+ * and queues the audio files for indexing so that
+ * their metadata is ready when selected.
+ */
+static void
+set_files (
+  FileManager * self,
+  GPtrArray *   files)
+{
+  g_ptr_array_unref (self->files);
+  self->files = files;
+
+  for (guint i = 0; i < files->len; i++)
+    {
+      SupportedFile * fd =
+        (SupportedFile *)
+        g_ptr_array_index (files, i);
+      if (supported_file_type_is_audio (fd->type))
+        {
+          file_index_request (
+            self->index, fd->abs_path, NULL, NULL,
+            NULL);
+        }
+    }
 }
 
 /**
@@ -238,9 +283,8 @@ file_manager_load_files (FileManager * self)
 {
   if (self->selection)
     {
-      load_files_from_location (
-        self,
-        (FileBrowserLocation *) self->selection);
+      set_files (
+        self, list_files (self->selection->path));
     }
   else
     {
@@ -249,6 +293,81 @@ file_manager_load_files (FileManager * self)
     }
 }
 
+typedef struct LoadFilesData
+{
+  FileManager *         file_manager;
+  char *                path;
+  GPtrArray *           files;
+  FileManagerLoadedFunc func;
+  void *                user_data;
+} LoadFilesData;
+
+static int
+on_files_loaded (
+  LoadFilesData * data)
+{
+  FileManager * self = data->file_manager;
+
+  /* ignore if the selection changed in the
+   * meantime (another load is on its way) */
+  if (self->selection &&
+      string_is_equal (
+        self->selection->path, data->path))
+    {
+      set_files (self, data->files);
+      data->func (self, data->user_data);
+    }
+  else
+    {
+      g_ptr_array_unref (data->files);
+    }
+
+  g_free (data->path);
+  free (data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void *
+load_files_thread (
+  LoadFilesData * data)
+{
+  data->files = list_files (data->path);
+  g_idle_add (
+    (GSourceFunc) on_files_loaded, data);
+
+  return NULL;
+}
+
+/**
+ * Loads the files under the current selection in
+ * a background thread.
+ *
+ * @param func Function to call on the main thread
+ *   once 
+ef FileManager.files is updated.
+ */
+void
+file_manager_load_files_async (
+  FileManager *         self,
+  FileManagerLoadedFunc func,
+  void *                user_data)
+{
+  g_return_if_fail (self->selection);
+
+  LoadFilesData * data = object_new (LoadFilesData);
+  data->file_manager = self;
+  data->path = g_strdup (self->selection->path);
+  data->func = func;
+  data->user_data = user_data;
+
+  GThread * thread =
+    g_thread_new (
+      "file_manager_load_files",
+      (GThreadFunc) load_files_thread, data);
+  g_thread_unref (thread);
+}
+
 /**
  * @param save_to_settings Whether to save this
  *   location to GSettings.
@@ -330,6 +449,8 @@ file_manager_add_location_and_save (
   g_ptr_array_add (self->locations, loc);
 
   save_locations (self);
+
+  file_index_queue_dir (self->index, loc->path);
 }
 
 /**
@@ -388,6 +509,13 @@ file_manager_free (
   g_ptr_array_free (self->files, true);
   g_ptr_array_free (self->locations, true);
 
+  if (self->index)
+    {
+      file_index_save (self->index);
+      object_free_w_func_and_null (
+        file_index_free, self->index);
+    }
+
   object_zero_and_free (self);
 }
 
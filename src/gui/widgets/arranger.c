@@ -35,6 +35,7 @@
 #include "gui/backend/event_manager.h"
 #include "gui/widgets/arranger.h"
 #include "gui/widgets/arranger_draw.h"
+#include "gui/widgets/arranger_tile_cache.h"
 #include "gui/widgets/arranger_playhead.h"
 #include "gui/widgets/audio_arranger.h"
 #include "gui/widgets/audio_editor_space.h"
@@ -4969,12 +4970,17 @@ arranger_widget_redraw_playhead (
 
 /**
  * Only redraws the given rectangle.
+ *
+ * The cached tiles overlapping the rectangle are
+ * invalidated so they get re-rendered.
  */
 void
 arranger_widget_redraw_rectangle (
   ArrangerWidget * self,
   GdkRectangle *   rect)
 {
+  arranger_tile_cache_invalidate_rect (
+    self->tile_cache, rect);
   gtk_widget_queue_draw_area (
     GTK_WIDGET (self), rect->x, rect->y,
     rect->width, rect->height);
@@ -6251,10 +6257,26 @@ arranger_widget_setup (
   g_debug ("done");
 }
 
+static void
+arranger_widget_finalize (
+  ArrangerWidget * self)
+{
+  object_free_w_func_and_null (
+    arranger_tile_cache_free, self->tile_cache);
+
+  G_OBJECT_CLASS (
+    arranger_widget_parent_class)->
+      finalize (G_OBJECT (self));
+}
+
 static void
 arranger_widget_class_init (
   ArrangerWidgetClass * _klass)
 {
+  GObjectClass * oklass =
+    G_OBJECT_CLASS (_klass);
+  oklass->finalize =
+    (GObjectFinalizeFunc) arranger_widget_finalize;
 }
 
 static void
@@ -6262,6 +6284,8 @@ arranger_widget_init (
   ArrangerWidget *self)
 {
   self->first_draw = true;
+  self->tile_cache =
+    arranger_tile_cache_new (SPACE_BEFORE_START);
 
   /* make widget able to notify */
   gtk_widget_add_events (
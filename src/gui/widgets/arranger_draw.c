@@ -23,6 +23,7 @@
 #include "gui/backend/arranger_object.h"
 #include "gui/widgets/arranger_draw.h"
 #include "gui/widgets/arranger_object.h"
+#include "gui/widgets/arranger_tile_cache.h"
 #include "gui/widgets/bot_bar.h"
 #include "gui/widgets/bot_dock_edge.h"
 #include "gui/widgets/center_dock.h"
@@ -263,7 +264,7 @@ draw_timeline_bg (
           line_y < rect->y + rect->height)
         {
           cairo_set_source_rgb (
-            self->cached_cr, 0.3, 0.3, 0.3);
+            cr, 0.3, 0.3, 0.3);
           cairo_rectangle (
             cr, 0, (line_y - rect->y) - 1,
             rect->width, 2);
@@ -851,6 +852,209 @@ draw_range (
     }
 }
 
+/**
+ * Draws the contents that don't change on every
+ * frame (backgrounds, grid lines and objects).
+ *
+ * Used as the ArrangerTileDrawFunc when rendering
+ * tiles.
+ *
+ * @param rect Rectangle to draw, in arranger
+ *   coordinates.
+ */
+static void
+draw_cached_contents (
+  ArrangerWidget * self,
+  cairo_t *        cr,
+  GdkRectangle *   rect)
+{
+  RulerWidget * ruler =
+    self->type == TYPE (TIMELINE) ?
+    MW_RULER : EDITOR_RULER;
+  GtkStyleContext * context =
+    gtk_widget_get_style_context (
+      GTK_WIDGET (self));
+
+  gtk_render_background (
+    context, cr, 0, 0,
+    rect->width, rect->height);
+
+  /* draw loop background */
+  if (TRANSPORT->loop)
+    {
+      double start_px = 0, end_px = 0;
+      if (self->type == TYPE (TIMELINE))
+        {
+          start_px =
+            ui_pos_to_px_timeline (
+              &TRANSPORT->loop_start_pos, 1);
+          end_px =
+            ui_pos_to_px_timeline (
+              &TRANSPORT->loop_end_pos, 1);
+        }
+      else
+        {
+          start_px =
+            ui_pos_to_px_editor (
+              &TRANSPORT->loop_start_pos, 1);
+          end_px =
+            ui_pos_to_px_editor (
+              &TRANSPORT->loop_end_pos, 1);
+        }
+      cairo_set_source_rgba (
+        cr, 0, 0.9, 0.7, 0.08);
+      cairo_set_line_width (
+        cr, 2);
+
+      /* if transport loop start is within the
+       * screen */
+      if (start_px > rect->x &&
+          start_px <= rect->x + rect->width)
+        {
+          /* draw the loop start line */
+          double x =
+            (start_px - rect->x) + 1.0;
+          cairo_rectangle (
+            cr,
+            (int) x, 0, 2, rect->height);
+          cairo_fill (cr);
+        }
+      /* if transport loop end is within the
+       * screen */
+      if (end_px > rect->x &&
+          end_px < rect->x + rect->width)
+        {
+          double x =
+            (end_px - rect->x) - 1.0;
+          cairo_rectangle (
+            cr,
+            (int) x, 0, 2, rect->height);
+          cairo_fill (cr);
+        }
+
+      /* draw transport loop area */
+      cairo_set_source_rgba (
+        cr, 0, 0.9, 0.7, 0.02);
+      double loop_start_local_x =
+        MAX (0, start_px - rect->x);
+      cairo_rectangle (
+        cr,
+        (int) loop_start_local_x, 0,
+        (int) (end_px - MAX (rect->x, start_px)),
+        rect->height);
+      cairo_fill (cr);
+    }
+
+  /* --- handle vertical drawing --- */
+
+  draw_vertical_lines (
+    self, ruler, cr, rect);
+
+  /* draw range */
+  int range_first_px, range_second_px;
+  bool have_range = false;
+  if (self->type == TYPE (AUDIO) &&
+      AUDIO_SELECTIONS->has_selection)
+    {
+      Position * range_first_pos,
+               * range_second_pos;
+      if (position_is_before_or_equal (
+            &TRANSPORT->range_1,
+            &TRANSPORT->range_2))
+        {
+          range_first_pos =
+            &AUDIO_SELECTIONS->sel_start;
+          range_second_pos =
+            &AUDIO_SELECTIONS->sel_end;
+        }
+      else
+        {
+          range_first_pos =
+            &AUDIO_SELECTIONS->sel_end;
+          range_second_pos =
+            &AUDIO_SELECTIONS->sel_start;
+        }
+
+      range_first_px =
+        ui_pos_to_px_editor (
+          range_first_pos, 1);
+      range_second_px =
+        ui_pos_to_px_editor (
+          range_second_pos, 1);
+      have_range = true;
+    }
+  else if (self->type == TYPE (TIMELINE) &&
+      TRANSPORT->has_range)
+    {
+      /* in order they appear */
+      Position * range_first_pos,
+               * range_second_pos;
+      if (position_is_before_or_equal (
+            &TRANSPORT->range_1,
+            &TRANSPORT->range_2))
+        {
+          range_first_pos = &TRANSPORT->range_1;
+          range_second_pos =
+            &TRANSPORT->range_2;
+        }
+      else
+        {
+          range_first_pos = &TRANSPORT->range_2;
+          range_second_pos =
+            &TRANSPORT->range_1;
+        }
+
+      range_first_px =
+        ui_pos_to_px_timeline (
+          range_first_pos, 1);
+      range_second_px =
+        ui_pos_to_px_timeline (
+          range_second_pos, 1);
+      have_range = true;
+    }
+
+  if (have_range)
+    {
+      draw_range (
+        self, range_first_px, range_second_px,
+        rect, cr);
+    }
+
+  if (self->type == TYPE (TIMELINE))
+    {
+      draw_timeline_bg (
+        self, cr, rect);
+    }
+  else if (self->type == TYPE (MIDI))
+    {
+      draw_midi_bg (
+        self, cr, rect);
+    }
+  else if (self->type == TYPE (AUDIO))
+    {
+      draw_audio_bg (
+        self, cr, rect);
+    }
+
+  /* draw each arranger object */
+  ArrangerObject * objs[2000];
+  int num_objs;
+  arranger_widget_get_hit_objects_in_rect (
+    self, ARRANGER_OBJECT_TYPE_ALL, rect,
+    objs, &num_objs);
+
+  /*g_message (*/
+    /*"objects found: %d (is pinned %d)",*/
+    /*num_objs, self->is_pinned);*/
+  /* note: these are only project objects */
+  for (int j = 0; j < num_objs; j++)
+    {
+      draw_arranger_object (
+        self, objs[j], cr,
+        rect);
+    }
+}
+
 gboolean
 arranger_draw_cb (
   GtkWidget *      widget,
@@ -904,228 +1108,45 @@ arranger_draw_cb (
   gdk_cairo_get_clip_rectangle (
     cr, &rect);
 
-  if (self->redraw ||
-      !gdk_rectangle_equal (
-         &rect, &self->last_rect))
+  /* skip drawing if rectangle too large */
+  if (rect.width > 10000 ||
+      rect.height > 10000)
     {
-      /* skip drawing if rectangle too large */
-      if (rect.width > 10000 ||
-          rect.height > 10000)
-        {
-          g_warning (
-            "skipping draw - rectangle too large");
-          return false;
-        }
-
-      /*g_message (*/
-        /*"redrawing arranger in rect: "*/
-        /*"(%d, %d) width: %d height %d)",*/
-        /*rect.x, rect.y, rect.width, rect.height);*/
-      self->last_rect = rect;
-
-      GtkStyleContext *context =
-        gtk_widget_get_style_context (widget);
-
-      z_cairo_reset_caches (
-        &self->cached_cr,
-        &self->cached_surface, rect.width,
-        rect.height, cr);
-
-      gtk_render_background (
-        context, self->cached_cr, 0, 0,
-        rect.width, rect.height);
-
-      /* draw loop background */
-      if (TRANSPORT->loop)
-        {
-          double start_px = 0, end_px = 0;
-          if (self->type == TYPE (TIMELINE))
-            {
-              start_px =
-                ui_pos_to_px_timeline (
-                  &TRANSPORT->loop_start_pos, 1);
-              end_px =
-                ui_pos_to_px_timeline (
-                  &TRANSPORT->loop_end_pos, 1);
-            }
-          else
-            {
-              start_px =
-                ui_pos_to_px_editor (
-                  &TRANSPORT->loop_start_pos, 1);
-              end_px =
-                ui_pos_to_px_editor (
-                  &TRANSPORT->loop_end_pos, 1);
-            }
-          cairo_set_source_rgba (
-            self->cached_cr, 0, 0.9, 0.7, 0.08);
-          cairo_set_line_width (
-            self->cached_cr, 2);
-
-          /* if transport loop start is within the
-           * screen */
-          if (start_px > rect.x &&
-              start_px <= rect.x + rect.width)
-            {
-              /* draw the loop start line */
-              double x =
-                (start_px - rect.x) + 1.0;
-              cairo_rectangle (
-                self->cached_cr,
-                (int) x, 0, 2, rect.height);
-              cairo_fill (self->cached_cr);
-            }
-          /* if transport loop end is within the
-           * screen */
-          if (end_px > rect.x &&
-              end_px < rect.x + rect.width)
-            {
-              double x =
-                (end_px - rect.x) - 1.0;
-              cairo_rectangle (
-                self->cached_cr,
-                (int) x, 0, 2, rect.height);
-              cairo_fill (self->cached_cr);
-            }
-
-          /* draw transport loop area */
-          cairo_set_source_rgba (
-            self->cached_cr, 0, 0.9, 0.7, 0.02);
-          double loop_start_local_x =
-            MAX (0, start_px - rect.x);
-          cairo_rectangle (
-            self->cached_cr,
-            (int) loop_start_local_x, 0,
-            (int) (end_px - MAX (rect.x, start_px)),
-            rect.height);
-          cairo_fill (self->cached_cr);
-        }
-
-      /* --- handle vertical drawing --- */
-
-      draw_vertical_lines (
-        self, ruler, self->cached_cr, &rect);
-
-      /* draw range */
-      int range_first_px, range_second_px;
-      bool have_range = false;
-      if (self->type == TYPE (AUDIO) &&
-          AUDIO_SELECTIONS->has_selection)
-        {
-          Position * range_first_pos,
-                   * range_second_pos;
-          if (position_is_before_or_equal (
-                &TRANSPORT->range_1,
-                &TRANSPORT->range_2))
-            {
-              range_first_pos =
-                &AUDIO_SELECTIONS->sel_start;
-              range_second_pos =
-                &AUDIO_SELECTIONS->sel_end;
-            }
-          else
-            {
-              range_first_pos =
-                &AUDIO_SELECTIONS->sel_end;
-              range_second_pos =
-                &AUDIO_SELECTIONS->sel_start;
-            }
-
-          range_first_px =
-            ui_pos_to_px_editor (
-              range_first_pos, 1);
-          range_second_px =
-            ui_pos_to_px_editor (
-              range_second_pos, 1);
-          have_range = true;
-        }
-      else if (self->type == TYPE (TIMELINE) &&
-          TRANSPORT->has_range)
-        {
-          /* in order they appear */
-          Position * range_first_pos,
-                   * range_second_pos;
-          if (position_is_before_or_equal (
-                &TRANSPORT->range_1,
-                &TRANSPORT->range_2))
-            {
-              range_first_pos = &TRANSPORT->range_1;
-              range_second_pos =
-                &TRANSPORT->range_2;
-            }
-          else
-            {
-              range_first_pos = &TRANSPORT->range_2;
-              range_second_pos =
-                &TRANSPORT->range_1;
-            }
-
-          range_first_px =
-            ui_pos_to_px_timeline (
-              range_first_pos, 1);
-          range_second_px =
-            ui_pos_to_px_timeline (
-              range_second_pos, 1);
-          have_range = true;
-        }
-
-      if (have_range)
-        {
-          draw_range (
-            self, range_first_px, range_second_px,
-            &rect, self->cached_cr);
-        }
+      g_warning (
+        "skipping draw - rectangle too large");
+      return false;
+    }
 
-      if (self->type == TYPE (TIMELINE))
-        {
-          draw_timeline_bg (
-            self, self->cached_cr, &rect);
-        }
-      else if (self->type == TYPE (MIDI))
-        {
-          draw_midi_bg (
-            self, self->cached_cr, &rect);
-        }
-      else if (self->type == TYPE (AUDIO))
-        {
-          draw_audio_bg (
-            self, self->cached_cr, &rect);
-        }
+  if (self->redraw)
+    {
+      arranger_tile_cache_invalidate_all (
+        self->tile_cache);
+      self->redraw = 0;
+    }
 
-      /* draw each arranger object */
-      ArrangerObject * objs[2000];
-      int num_objs;
-      arranger_widget_get_hit_objects_in_rect (
-        self, ARRANGER_OBJECT_TYPE_ALL, &rect,
-        objs, &num_objs);
-
-      /*g_message (*/
-        /*"objects found: %d (is pinned %d)",*/
-        /*num_objs, self->is_pinned);*/
-      /* note: these are only project objects */
-      for (int j = 0; j < num_objs; j++)
-        {
-          draw_arranger_object (
-            self, objs[j], self->cached_cr,
-            &rect);
-        }
+  /* render missing/invalidated tiles and paint
+   * them */
+  arranger_tile_cache_set_zoom (
+    self->tile_cache, ruler->px_per_tick);
+  arranger_tile_cache_draw (
+    self->tile_cache, cr, &rect,
+    (ArrangerTileDrawFunc) draw_cached_contents,
+    self);
 
-      /* draw dnd highlight */
-      draw_highlight (
-        self, self->cached_cr, &rect);
+  /* draw the parts that change on every frame on
+   * top */
+  cairo_save (cr);
+  cairo_translate (cr, rect.x, rect.y);
 
-      /* draw selections */
-      draw_selections (
-        self, self->cached_cr, &rect);
+  /* draw dnd highlight */
+  draw_highlight (self, cr, &rect);
 
-      draw_playhead (self, self->cached_cr, &rect);
+  /* draw selections */
+  draw_selections (self, cr, &rect);
 
-      self->redraw--;
-    }
+  draw_playhead (self, cr, &rect);
 
-  cairo_set_source_surface (
-    cr, self->cached_surface, rect.x, rect.y);
-  cairo_paint (cr);
+  cairo_restore (cr);
 
   return FALSE;
 }
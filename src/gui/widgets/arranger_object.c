@@ -57,9 +57,60 @@
 #define TYPE(x) \
   ARRANGER_OBJECT_TYPE_##x
 
+/**
+ * Queues a redraw of the visible part of the given
+ * full rectangle of the object.
+ */
+static void
+queue_redraw_full_rect (
+  ArrangerObject * self,
+  ArrangerWidget * arranger,
+  GdkRectangle *   arranger_rect,
+  GdkRectangle *   full_rect_in)
+{
+  GdkRectangle full_rect = *full_rect_in;
+
+  /* add some padding to the full rect for any
+   * effects or things like automation points */
+  static const int padding = 6;
+  if (self->type == TYPE (AUTOMATION_POINT))
+    {
+      full_rect.x = MAX (full_rect.x - padding, 0);
+      full_rect.y = MAX (full_rect.y - padding, 0);
+      full_rect.width += padding * 2;
+      full_rect.height += padding * 2;
+    }
+
+  GdkRectangle draw_rect;
+  int draw_rect_visible =
+    arranger_object_get_draw_rectangle (
+      self, arranger_rect, &full_rect,
+      &draw_rect);
+
+  /* if draw rect is not visible ignore */
+  if (!draw_rect_visible)
+    {
+#if 0
+      arranger_object_print (self);
+      g_message (
+        "%s: draw rect not visible, ignoring",
+        __func__);
+#endif
+      return;
+    }
+
+  arranger_widget_redraw_rectangle (
+    arranger, &draw_rect);
+}
+
 /**
  * Queues a redraw in the area covered by this
  * object.
+ *
+ * If the object moved since it was last drawn,
+ * both the previous and the current area are
+ * redrawn so that only the affected arranger tiles
+ * get invalidated.
  */
 void
 arranger_object_queue_redraw (
@@ -87,46 +138,28 @@ arranger_object_queue_redraw (
       return;
     }
 
-  /* set rectangle if not initialized yet */
-  if (self->full_rect.width == 0 &&
-      self->full_rect.height == 0)
-    arranger_object_set_full_rectangle (
-      self, arranger);
-
-  GdkRectangle full_rect = self->full_rect;
-
-  /* add some padding to the full rect for any
-   * effects or things like automation points */
-  static const int padding = 6;
-  if (self->type == TYPE (AUTOMATION_POINT))
+  /* redraw the area the object was last drawn
+   * at */
+  GdkRectangle prev_full_rect = self->full_rect;
+  if (prev_full_rect.width != 0 ||
+      prev_full_rect.height != 0)
     {
-      full_rect.x = MAX (full_rect.x - padding, 0);
-      full_rect.y = MAX (full_rect.y - padding, 0);
-      full_rect.width += padding * 2;
-      full_rect.height += padding * 2;
+      queue_redraw_full_rect (
+        self, arranger, &arranger_rect,
+        &prev_full_rect);
     }
 
-  GdkRectangle draw_rect;
-  int draw_rect_visible =
-    arranger_object_get_draw_rectangle (
-      self, &arranger_rect, &full_rect,
-      &draw_rect);
-
-  /* if draw rect is not visible ignore */
-  if (!draw_rect_visible)
+  /* redraw the area the object is at now */
+  arranger_object_set_full_rectangle (
+    self, arranger);
+  if (!gdk_rectangle_equal (
+         &prev_full_rect, &self->full_rect))
     {
-#if 0
-      arranger_object_print (self);
-      g_message (
-        "%s: draw rect not visible, ignoring",
-        __func__);
-#endif
-      return;
+      queue_redraw_full_rect (
+        self, arranger, &arranger_rect,
+        &self->full_rect);
     }
 
-  arranger_widget_redraw_rectangle (
-    arranger, &draw_rect);
-
   /* if region and lanes are visible, redraw
    * lane too */
   if (self->type == TYPE (REGION))
@@ -137,8 +170,10 @@ arranger_object_queue_redraw (
           arranger_object_can_have_lanes (self))
         {
           ZRegion * r = (ZRegion *) self;
+          GdkRectangle full_rect;
           region_get_lane_full_rect (
             r, &full_rect);
+          GdkRectangle draw_rect;
           arranger_object_get_draw_rectangle (
             self, &arranger_rect, &full_rect,
             &draw_rect);
@@ -0,0 +1,469 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+
+#include "gui/widgets/arranger_tile_cache.h"
+#include "utils/math.h"
+#include "utils/objects.h"
+
+#define TILE_KEY(col,row) \
+  ((gint64) (((guint64) (guint32) (col) << 32) | \
+   (guint64) (guint32) (row)))
+
+/* these are only accessed from the GTK thread */
+
+/** Rendered tiles of all caches, least recently
+ * used first. */
+static GQueue tile_lru = G_QUEUE_INIT;
+
+/** Memory used by the tiles in @ref tile_lru. */
+static size_t total_bytes = 0;
+
+/** All caches, to compute the budget. */
+static GSList * caches = NULL;
+
+static void
+tile_free (
+  ArrangerTile * tile)
+{
+  if (tile->surface)
+    {
+      cairo_surface_destroy (tile->surface);
+      g_queue_unlink (&tile_lru, &tile->lru_link);
+      total_bytes -= ARRANGER_TILE_BYTES;
+    }
+
+  object_zero_and_free (tile);
+}
+
+static ArrangerTileLayer *
+layer_new (
+  ArrangerTileCache * cache,
+  double              zoom)
+{
+  ArrangerTileLayer * self =
+    object_new (ArrangerTileLayer);
+
+  self->cache = cache;
+  self->zoom = zoom;
+  self->tiles =
+    g_hash_table_new_full (
+      g_int64_hash, g_int64_equal, g_free,
+      (GDestroyNotify) tile_free);
+
+  return self;
+}
+
+static void
+layer_free (
+  ArrangerTileLayer * self)
+{
+  g_hash_table_destroy (self->tiles);
+
+  object_zero_and_free (self);
+}
+
+static ArrangerTile *
+layer_get_or_add_tile (
+  ArrangerTileLayer * self,
+  int                 col,
+  int                 row)
+{
+  gint64 key = TILE_KEY (col, row);
+  ArrangerTile * tile =
+    g_hash_table_lookup (self->tiles, &key);
+  if (tile)
+    return tile;
+
+  tile = object_new (ArrangerTile);
+  tile->col = col;
+  tile->row = row;
+  tile->layer = self;
+  tile->lru_link.data = tile;
+  tile->dirty = true;
+  gint64 * key_ptr = g_new (gint64, 1);
+  *key_ptr = key;
+  g_hash_table_insert (self->tiles, key_ptr, tile);
+
+  return tile;
+}
+
+/**
+ * Removes the layer from its cache and frees it.
+ */
+static void
+cache_remove_layer (
+  ArrangerTileCache * self,
+  ArrangerTileLayer * layer)
+{
+  for (int i = 0; i < self->num_layers; i++)
+    {
+      if (self->layers[i] != layer)
+        continue;
+
+      self->layers[i] =
+        self->layers[--self->num_layers];
+      break;
+    }
+  if (self->cur_layer == layer)
+    self->cur_layer = NULL;
+
+  layer_free (layer);
+}
+
+size_t
+arranger_tile_cache_get_budget (void)
+{
+  size_t num_tiles = 0;
+  for (GSList * l = caches; l; l = l->next)
+    {
+      ArrangerTileCache * cache = l->data;
+      num_tiles += (size_t) cache->num_visible_tiles;
+    }
+
+  return
+    num_tiles * ARRANGER_TILE_CACHE_SCREENS *
+    ARRANGER_TILE_BYTES;
+}
+
+size_t
+arranger_tile_cache_get_total_bytes (void)
+{
+  return total_bytes;
+}
+
+/**
+ * Evicts the least recently used tiles of all
+ * caches until they fit in the budget.
+ *
+ * Tiles painted in the last draw of their cache
+ * are kept, and layers left empty are removed
+ * (except the current one).
+ */
+static void
+evict_tiles (void)
+{
+  size_t budget = arranger_tile_cache_get_budget ();
+  GList * link = tile_lru.head;
+  while (link && total_bytes > budget)
+    {
+      GList * next = link->next;
+      ArrangerTile * tile = link->data;
+      ArrangerTileLayer * layer = tile->layer;
+      ArrangerTileCache * cache = layer->cache;
+      if (layer == cache->cur_layer &&
+          tile->last_used >= cache->draw_count)
+        {
+          link = next;
+          continue;
+        }
+
+      gint64 key = TILE_KEY (tile->col, tile->row);
+      g_hash_table_remove (layer->tiles, &key);
+      if (layer != cache->cur_layer &&
+          g_hash_table_size (layer->tiles) == 0)
+        {
+          cache_remove_layer (cache, layer);
+        }
+      link = next;
+    }
+}
+
+ArrangerTileCache *
+arranger_tile_cache_new (
+  int origin_x)
+{
+  ArrangerTileCache * self =
+    object_new (ArrangerTileCache);
+
+  self->origin_x = origin_x;
+  caches = g_slist_prepend (caches, self);
+
+  return self;
+}
+
+void
+arranger_tile_cache_set_zoom (
+  ArrangerTileCache * self,
+  double              zoom)
+{
+  if (self->cur_layer &&
+      math_doubles_equal (
+        self->cur_layer->zoom, zoom))
+    return;
+
+  /* find existing layer */
+  for (int i = 0; i < self->num_layers; i++)
+    {
+      ArrangerTileLayer * layer = self->layers[i];
+      if (math_doubles_equal (layer->zoom, zoom))
+        {
+          self->cur_layer = layer;
+          return;
+        }
+    }
+
+  /* evict the least recently used layer if
+   * full */
+  if (self->num_layers ==
+        ARRANGER_TILE_CACHE_MAX_LAYERS)
+    {
+      int lru_idx = 0;
+      for (int i = 1; i < self->num_layers; i++)
+        {
+          if (self->layers[i]->last_used <
+                self->layers[lru_idx]->last_used)
+            lru_idx = i;
+        }
+      layer_free (self->layers[lru_idx]);
+      self->layers[lru_idx] =
+        self->layers[--self->num_layers];
+    }
+
+  ArrangerTileLayer * layer =
+    layer_new (self, zoom);
+  layer->last_used = self->draw_count;
+  self->layers[self->num_layers++] = layer;
+  self->cur_layer = layer;
+}
+
+static void
+layer_invalidate_rect (
+  ArrangerTileLayer *  self,
+  const GdkRectangle * rect)
+{
+  int start_col =
+    (int) floor (
+      (double) rect->x / ARRANGER_TILE_SIZE);
+  int end_col =
+    (int) floor (
+      (double) (rect->x + rect->width - 1) /
+      ARRANGER_TILE_SIZE);
+  int start_row =
+    (int) floor (
+      (double) rect->y / ARRANGER_TILE_SIZE);
+  int end_row =
+    (int) floor (
+      (double) (rect->y + rect->height - 1) /
+      ARRANGER_TILE_SIZE);
+
+  for (int col = start_col; col <= end_col; col++)
+    {
+      for (int row = start_row; row <= end_row;
+           row++)
+        {
+          gint64 key = TILE_KEY (col, row);
+          ArrangerTile * tile =
+            g_hash_table_lookup (
+              self->tiles, &key);
+          if (tile)
+            tile->dirty = true;
+        }
+    }
+}
+
+void
+arranger_tile_cache_invalidate_rect (
+  ArrangerTileCache *  self,
+  const GdkRectangle * rect)
+{
+  if (!self->cur_layer || rect->width <= 0 ||
+      rect->height <= 0)
+    return;
+
+  for (int i = 0; i < self->num_layers; i++)
+    {
+      ArrangerTileLayer * layer = self->layers[i];
+      if (layer == self->cur_layer)
+        {
+          layer_invalidate_rect (layer, rect);
+          continue;
+        }
+
+      /* scale to the zoom level of the layer and
+       * pad by the width of the rect to cover the
+       * parts of objects that don't scale with the
+       * zoom level (such as labels) */
+      double ratio =
+        layer->zoom / self->cur_layer->zoom;
+      double start_x =
+        (rect->x - self->origin_x) * ratio +
+        self->origin_x;
+      double end_x =
+        ((rect->x + rect->width) - self->origin_x) *
+          ratio + self->origin_x;
+      GdkRectangle layer_rect = *rect;
+      layer_rect.x =
+        (int) floor (start_x) - rect->width;
+      layer_rect.width =
+        ((int) ceil (end_x) + rect->width) -
+        layer_rect.x;
+      layer_invalidate_rect (layer, &layer_rect);
+    }
+}
+
+void
+arranger_tile_cache_invalidate_all (
+  ArrangerTileCache * self)
+{
+  for (int i = 0; i < self->num_layers; i++)
+    {
+      g_hash_table_remove_all (
+        self->layers[i]->tiles);
+    }
+}
+
+static void
+render_tile (
+  ArrangerTile *       tile,
+  cairo_t *            cr,
+  ArrangerTileDrawFunc draw_func,
+  void *               user_data)
+{
+  if (!tile->surface)
+    {
+      tile->surface =
+        cairo_surface_create_similar (
+          cairo_get_target (cr),
+          CAIRO_CONTENT_COLOR_ALPHA,
+          ARRANGER_TILE_SIZE, ARRANGER_TILE_SIZE);
+      g_queue_push_tail_link (
+        &tile_lru, &tile->lru_link);
+      total_bytes += ARRANGER_TILE_BYTES;
+    }
+
+  cairo_t * tile_cr = cairo_create (tile->surface);
+  cairo_set_operator (tile_cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint (tile_cr);
+  cairo_set_operator (tile_cr, CAIRO_OPERATOR_OVER);
+
+  GdkRectangle tile_rect = {
+    .x = tile->col * ARRANGER_TILE_SIZE,
+    .y = tile->row * ARRANGER_TILE_SIZE,
+    .width = ARRANGER_TILE_SIZE,
+    .height = ARRANGER_TILE_SIZE,
+  };
+  draw_func (user_data, tile_cr, &tile_rect);
+  cairo_destroy (tile_cr);
+
+  tile->dirty = false;
+}
+
+void
+arranger_tile_cache_draw (
+  ArrangerTileCache *  self,
+  cairo_t *            cr,
+  const GdkRectangle * rect,
+  ArrangerTileDrawFunc draw_func,
+  void *               user_data)
+{
+  g_return_if_fail (self->cur_layer);
+
+  ArrangerTileLayer * layer = self->cur_layer;
+  self->draw_count++;
+  layer->last_used = self->draw_count;
+  self->num_tiles_rendered = 0;
+  self->num_tiles_reused = 0;
+
+  int start_col =
+    (int) floor (
+      (double) rect->x / ARRANGER_TILE_SIZE);
+  int end_col =
+    (int) floor (
+      (double) (rect->x + rect->width - 1) /
+      ARRANGER_TILE_SIZE);
+  int start_row =
+    (int) floor (
+      (double) rect->y / ARRANGER_TILE_SIZE);
+  int end_row =
+    (int) floor (
+      (double) (rect->y + rect->height - 1) /
+      ARRANGER_TILE_SIZE);
+  self->num_visible_tiles =
+    (end_col - start_col + 1) *
+    (end_row - start_row + 1);
+
+  for (int col = start_col; col <= end_col; col++)
+    {
+      for (int row = start_row; row <= end_row;
+           row++)
+        {
+          ArrangerTile * tile =
+            layer_get_or_add_tile (layer, col, row);
+          if (tile->surface)
+            {
+              /* move to the most recently used
+               * end (new tiles are added there
+               * when rendered) */
+              g_queue_unlink (
+                &tile_lru, &tile->lru_link);
+              g_queue_push_tail_link (
+                &tile_lru, &tile->lru_link);
+            }
+          if (tile->dirty)
+            {
+              render_tile (
+                tile, cr, draw_func, user_data);
+              self->num_tiles_rendered++;
+            }
+          else
+            {
+              self->num_tiles_reused++;
+            }
+          tile->last_used = self->draw_count;
+
+          /* paint the part of the tile inside the
+           * rect */
+          GdkRectangle tile_rect = {
+            .x = col * ARRANGER_TILE_SIZE,
+            .y = row * ARRANGER_TILE_SIZE,
+            .width = ARRANGER_TILE_SIZE,
+            .height = ARRANGER_TILE_SIZE,
+          };
+          GdkRectangle isect;
+          if (!gdk_rectangle_intersect (
+                 &tile_rect, rect, &isect))
+            continue;
+
+          cairo_set_source_surface (
+            cr, tile->surface, tile_rect.x,
+            tile_rect.y);
+          cairo_rectangle (
+            cr, isect.x, isect.y, isect.width,
+            isect.height);
+          cairo_fill (cr);
+        }
+    }
+
+  evict_tiles ();
+}
+
+void
+arranger_tile_cache_free (
+  ArrangerTileCache * self)
+{
+  for (int i = 0; i < self->num_layers; i++)
+    {
+      layer_free (self->layers[i]);
+    }
+  caches = g_slist_remove (caches, self);
+
+  object_zero_and_free (self);
+}
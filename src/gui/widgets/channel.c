@@ -882,11 +882,11 @@ channel_widget_new (Channel * channel)
 
   channel_widget_refresh (self);
 
-  gtk_widget_add_tick_callback (
+  z_gtk_widget_add_tick_callback_while_mapped (
     GTK_WIDGET (self),
     (GtkTickCallback)
       channel_widget_update_meter_reading,
-    self, NULL);
+    self);
 
   g_signal_connect (
     self, "destroy",
@@ -24,7 +24,9 @@
 
 #include <stdio.h>
 
+#include "audio/dsp_profiler.h"
 #include "audio/engine.h"
+#include "audio/tracklist.h"
 #include "gui/widgets/bot_bar.h"
 #include "gui/widgets/cpu.h"
 #include "project.h"
@@ -175,6 +177,10 @@ refresh_dsp_load (
 
   AUDIO_ENGINE->max_time_taken = 0;
 
+  self->num_suspended_plugins =
+    tracklist_get_num_suspended_plugins (
+      TRACKLIST);
+
   return G_SOURCE_CONTINUE;
 }
 
@@ -248,13 +254,33 @@ refresh_cpu_load (
 
 #endif
 
-  char ttip[100];
+  char ttip[200];
   sprintf (
     ttip,
-    "CPU: %d%%\nDSP: %d%%",
-    self->cpu, self->dsp);
-  gtk_widget_set_tooltip_text (
-    (GtkWidget *) self, ttip);
+    "CPU: %d%%\nDSP: %d%%\n"
+    "Suspended plugins: %d",
+    self->cpu, self->dsp,
+    self->num_suspended_plugins);
+  DspProfiler * profiler =
+    AUDIO_ENGINE ? AUDIO_ENGINE->profiler : NULL;
+  if (profiler)
+    {
+      /* show the slowest processors */
+      char * summary =
+        dsp_profiler_get_summary (profiler, 5);
+      char * full_ttip =
+        g_strdup_printf (
+          "%s\n\n%s", ttip, summary);
+      gtk_widget_set_tooltip_text (
+        (GtkWidget *) self, full_ttip);
+      g_free (summary);
+      g_free (full_ttip);
+    }
+  else
+    {
+      gtk_widget_set_tooltip_text (
+        (GtkWidget *) self, ttip);
+    }
   gtk_widget_queue_draw ((GtkWidget *) self);
 
   return G_SOURCE_CONTINUE;
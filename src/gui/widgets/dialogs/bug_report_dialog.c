@@ -50,7 +50,8 @@ bug_report_dialog_new (
   char * log =
     log_get_last_n_lines (LOG, 60);
   char * undo_stack =
-    PROJECT && UNDO_MANAGER ?
+    PROJECT && UNDO_MANAGER &&
+    !UNDO_MANAGER->loader ?
       undo_stack_get_as_string (
         UNDO_MANAGER->undo_stack, 12) :
       g_strdup ("<undo stack uninitialized>");
@@ -21,6 +21,7 @@
 
 #include "actions/tracklist_selections.h"
 #include "audio/supported_file.h"
+#include "gui/backend/file_index.h"
 #include "gui/backend/file_manager.h"
 #include "gui/widgets/arranger.h"
 #include "gui/widgets/bot_dock_edge.h"
@@ -41,6 +42,7 @@
 #include "utils/io.h"
 #include "utils/objects.h"
 #include "utils/resources.h"
+#include "utils/string.h"
 #include "zrythm.h"
 #include "zrythm_app.h"
 
@@ -124,6 +126,41 @@ on_file_chooser_file_activated (
   supported_file_free (file);
 }
 
+/**
+ * Called when the metadata of the selected file is
+ * available.
+ */
+static void
+on_file_indexed (
+  const FileIndexEntry * entry,
+  FileBrowserWidget *    self)
+{
+  /* ignore if the widget was destroyed */
+  if (!gtk_widget_get_realized (GTK_WIDGET (self)))
+    return;
+
+  /* ignore if the selection changed */
+  SupportedFile * file = self->selected_file;
+  if (!file ||
+      !string_is_equal (
+         file->abs_path, entry->abs_path))
+    return;
+
+  char * label =
+    supported_file_get_info_text_for_label (
+      file, entry);
+  update_file_info_label (self, label);
+  g_free (label);
+
+  if (g_settings_get_boolean (
+        S_UI_FILE_BROWSER, "autoplay") &&
+      supported_file_should_autoplay (file, entry))
+    {
+      sample_processor_queue_file (
+        SAMPLE_PROCESSOR, file);
+    }
+}
+
 /**
  * Called when the file selection changes.
  */
@@ -151,20 +188,32 @@ on_file_chooser_selection_changed (
     supported_file_new_from_path (abs_path);
 
   char * label =
-    supported_file_get_info_text_for_label (file);
+    supported_file_get_info_text_for_label (
+      file, NULL);
   update_file_info_label (self, label);
+  g_free (label);
 
   g_free (abs_path);
 
-  if (g_settings_get_boolean (
-        S_UI_FILE_BROWSER, "autoplay") &&
-      supported_file_should_autoplay (file))
+  self->selected_file = file;
+
+  if (supported_file_type_is_audio (file->type))
+    {
+      /* update the label and autoplay once the
+       * metadata is available */
+      file_index_request (
+        FILE_MANAGER->index, file->abs_path,
+        (FileIndexCallback) on_file_indexed,
+        g_object_ref (self), g_object_unref);
+    }
+  else if (g_settings_get_boolean (
+             S_UI_FILE_BROWSER, "autoplay") &&
+           supported_file_should_autoplay (
+             file, NULL))
     {
       sample_processor_queue_file (
         SAMPLE_PROCESSOR, file);
     }
-
-  self->selected_file = file;
 }
 
 static SupportedFile *
@@ -84,6 +84,16 @@ refresh_undo_or_redo_button (
 
   ButtonWithMenuWidget * btn_w_menu =
     redo ? self->redo : self->undo;
+
+  /* the buttons are refreshed again once the undo
+   * history is loaded */
+  if (UNDO_MANAGER->loader)
+    {
+      gtk_widget_set_sensitive (
+        GTK_WIDGET (btn_w_menu), false);
+      return;
+    }
+
   UndoStack * stack =
     redo ?
       UNDO_MANAGER->redo_stack :
@@ -95,6 +95,63 @@ draw_lines (
   cairo_stroke (cr);
 }
 
+/**
+ * Releases the subscriptions to the ring buffers
+ * of the ports.
+ */
+static void
+unsubscribe_from_ports (
+  LiveWaveformWidget * self)
+{
+  for (int i = 0; i < 2; i++)
+    {
+      Port * port = self->subscribed_ports[i];
+      if (IS_PORT_AND_NONNULL (port) &&
+          port_has_ring_subscribers (port))
+        {
+          port_unsubscribe_from_rings (port);
+        }
+      self->subscribed_ports[i] = NULL;
+    }
+}
+
+/**
+ * Subscribes to the ring buffers of the given
+ * ports, releasing previous subscriptions if the
+ * ports changed (eg, after loading a project).
+ *
+ * @return Whether the rings were already being
+ *   filled (otherwise there is nothing to draw
+ *   yet).
+ */
+static bool
+subscribe_to_ports (
+  LiveWaveformWidget * self,
+  Port *               l,
+  Port *               r)
+{
+  /* a port that was freed and reallocated at the
+   * same address has no subscribers */
+  if (self->subscribed_ports[0] == l &&
+      self->subscribed_ports[1] == r &&
+      port_has_ring_subscribers (l) &&
+      (!r || port_has_ring_subscribers (r)))
+    {
+      return true;
+    }
+
+  unsubscribe_from_ports (self);
+  port_subscribe_to_rings (l);
+  self->subscribed_ports[0] = l;
+  if (r)
+    {
+      port_subscribe_to_rings (r);
+      self->subscribed_ports[1] = r;
+    }
+
+  return false;
+}
+
 /**
  * Draws the color picker.
  */
@@ -142,21 +199,19 @@ live_waveform_draw_cb (
       g_return_val_if_fail (
         IS_TRACK_AND_NONNULL (P_MASTER_TRACK),
         false);
-      if (!P_MASTER_TRACK->channel->stereo_out->l->
-            write_ring_buffers)
+      if (!subscribe_to_ports (
+             self,
+             P_MASTER_TRACK->channel->stereo_out->l,
+             P_MASTER_TRACK->channel->stereo_out->r))
         {
-          P_MASTER_TRACK->channel->stereo_out->l->
-            write_ring_buffers = true;
-          P_MASTER_TRACK->channel->stereo_out->r->
-            write_ring_buffers = true;
           return FALSE;
         }
       port = P_MASTER_TRACK->channel->stereo_out->l;
       break;
     case LIVE_WAVEFORM_PORT:
-      if (!self->port->write_ring_buffers)
+      if (!subscribe_to_ports (
+             self, self->port, NULL))
         {
-          self->port->write_ring_buffers = true;
           return FALSE;
         }
       port = self->port;
@@ -200,6 +255,8 @@ live_waveform_draw_cb (
       /* get the R buffer */
       port =
         P_MASTER_TRACK->channel->stereo_out->r;
+      g_return_val_if_fail (
+        port->audio_ring, FALSE);
       read_space_avail =
         zix_ring_read_space (port->audio_ring);
       blocks_to_read =
@@ -308,6 +365,8 @@ static void
 finalize (
   LiveWaveformWidget * self)
 {
+  unsubscribe_from_ports (self);
+
   object_zero_and_free_if_nonnull (self->bufs[0]);
   object_zero_and_free_if_nonnull (self->bufs[1]);
 
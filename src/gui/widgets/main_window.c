@@ -139,6 +139,7 @@ on_delete_event (
     AUDIO_ENGINE, &state, F_NO_FORCE);
 
   /* get yaml for live project */
+  undo_manager_ensure_loaded (UNDO_MANAGER);
   char * live_yaml =
     yaml_serialize (PROJECT, &project_schema);
 
@@ -575,6 +576,8 @@ main_window_widget_init (MainWindowWidget * self)
     { "save-as", activate_save_as },
     { "export-as", activate_export_as },
     { "export-graph", activate_export_graph },
+    { "toggle-dsp-profiling",
+      activate_toggle_dsp_profiling },
     { "properties", activate_properties },
 
     /* edit menu */
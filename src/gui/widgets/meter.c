@@ -21,7 +21,9 @@
 #include "audio/meter.h"
 #include "gui/widgets/meter.h"
 #include "gui/widgets/fader.h"
+#include "utils/gtk.h"
 #include "utils/math.h"
+#include "utils/objects.h"
 
 G_DEFINE_TYPE (
   MeterWidget, meter_widget, GTK_TYPE_DRAWING_AREA)
@@ -235,11 +237,50 @@ meter_widget_setup (
   self->meter = meter_new_for_port (port);
   self->padding = 2;
 
+  /* only read the port while visible */
+  meter_set_subscribed (
+    self->meter,
+    gtk_widget_get_mapped (GTK_WIDGET (self)));
+
   /* set size */
   gtk_widget_set_size_request (
     GTK_WIDGET (self), width, -1);
 }
 
+static void
+on_map (
+  GtkWidget *   widget,
+  MeterWidget * self)
+{
+  if (self->meter)
+    meter_set_subscribed (self->meter, true);
+
+  if (!self->source_id)
+    {
+      self->source_id =
+        g_timeout_add (
+          20, (GSourceFunc) meter_timeout, self);
+    }
+}
+
+/**
+ * Stops reading the port while hidden or out of
+ * view.
+ */
+static void
+on_unmap (
+  GtkWidget *   widget,
+  MeterWidget * self)
+{
+  if (self->meter)
+    meter_set_subscribed (self->meter, false);
+
+  if (self->source_id)
+    {
+      g_source_remove_and_zero (self->source_id);
+    }
+}
+
 static void
 finalize (
   MeterWidget * self)
@@ -247,7 +288,10 @@ finalize (
   if (self->meter)
     meter_free (self->meter);
 
-  g_source_remove (self->source_id);
+  if (self->source_id)
+    {
+      g_source_remove_and_zero (self->source_id);
+    }
 
   G_OBJECT_CLASS (
     meter_widget_parent_class)->
@@ -273,12 +317,16 @@ meter_widget_init (MeterWidget * self)
     G_OBJECT(self), "leave-notify-event",
     G_CALLBACK (on_crossing),  self);
 
-  gtk_widget_add_tick_callback (
+  g_signal_connect (
+    G_OBJECT (self), "map",
+    G_CALLBACK (on_map), self);
+  g_signal_connect (
+    G_OBJECT (self), "unmap",
+    G_CALLBACK (on_unmap), self);
+
+  z_gtk_widget_add_tick_callback_while_mapped (
     GTK_WIDGET (self), (GtkTickCallback) tick_cb,
-    self, NULL);
-  self->source_id =
-    g_timeout_add (
-      20, (GSourceFunc) meter_timeout, self);
+    self);
 }
 
 static void
@@ -60,17 +60,19 @@ mixer_widget_soft_refresh (MixerWidget * self)
     }
 }
 
+/**
+ * Updates the strips in the mixer to match the
+ * tracklist.
+ *
+ * Only the strips that were added, removed or
+ * moved are changed in the container.
+ */
 void
 mixer_widget_hard_refresh (MixerWidget * self)
 {
-  g_object_ref (self->ddbox);
-  g_object_ref (self->channels_add);
+  GPtrArray * widgets = g_ptr_array_new ();
 
-  /* remove all things in the container */
-  z_gtk_container_remove_all_children (
-    GTK_CONTAINER (self->channels_box));
-
-  /* add all channels */
+  /* collect all channels */
   Track * track;
   Channel * ch;
   for (int i = 0; i < TRACKLIST->num_tracks; i++)
@@ -90,10 +92,8 @@ mixer_widget_hard_refresh (MixerWidget * self)
           folder_channel_widget_refresh (
             track->folder_ch_widget);
 
-          gtk_box_pack_start (
-            self->channels_box,
-            GTK_WIDGET (track->folder_ch_widget),
-            F_NO_EXPAND, F_NO_FILL, 0);
+          g_ptr_array_add (
+            widgets, track->folder_ch_widget);
         }
 
       if (!track_type_has_channel (track->type))
@@ -108,36 +108,73 @@ mixer_widget_hard_refresh (MixerWidget * self)
 
       channel_widget_refresh (ch->widget);
 
+      GtkWidget * parent =
+        gtk_widget_get_parent (
+          GTK_WIDGET (ch->widget));
       if (track->type != TRACK_TYPE_MASTER &&
-          !gtk_widget_get_parent (
-            GTK_WIDGET (ch->widget))) /* not master */
+          (!parent ||
+           parent ==
+             GTK_WIDGET (self->channels_box)))
         {
-          gtk_box_pack_start (
-            self->channels_box,
-            GTK_WIDGET (ch->widget),
-            F_NO_EXPAND, F_NO_FILL, 0);
+          g_ptr_array_add (widgets, ch->widget);
         }
     }
 
   /* add the add button */
-  gtk_box_pack_start (
-    self->channels_box,
-    GTK_WIDGET (self->channels_add),
-    F_NO_EXPAND, F_NO_FILL, 0);
+  g_ptr_array_add (widgets, self->channels_add);
 
   /* re-add dummy box for dnd */
   if (!GTK_IS_WIDGET (self->ddbox))
-    self->ddbox =
-      drag_dest_box_widget_new (
-        GTK_ORIENTATION_HORIZONTAL,
-        0,
-        DRAG_DEST_BOX_TYPE_MIXER);
-  gtk_box_pack_start (
+    {
+      self->ddbox =
+        drag_dest_box_widget_new (
+          GTK_ORIENTATION_HORIZONTAL,
+          0,
+          DRAG_DEST_BOX_TYPE_MIXER);
+      gtk_box_pack_start (
+        self->channels_box,
+        GTK_WIDGET (self->ddbox),
+        1, 1, 0);
+    }
+  g_ptr_array_add (widgets, self->ddbox);
+
+  z_gtk_box_sync_children (
+    self->channels_box,
+    (GtkWidget **) widgets->pdata,
+    (int) widgets->len,
+    F_NO_EXPAND, F_NO_FILL);
+  g_ptr_array_unref (widgets);
+}
+
+/**
+ * Maps only the strips in view.
+ */
+static void
+update_strips_in_view (
+  MixerWidget * self)
+{
+  z_gtk_box_map_only_children_in_view (
     self->channels_box,
-    GTK_WIDGET (self->ddbox),
-    1, 1, 0);
-  g_object_unref (self->ddbox);
-  g_object_unref (self->channels_add);
+    gtk_scrolled_window_get_hadjustment (
+      self->channels_scroll),
+    MIXER_WIDGET_VIEW_MARGIN);
+}
+
+static void
+on_hadj_changed (
+  GtkAdjustment * adj,
+  MixerWidget *   self)
+{
+  update_strips_in_view (self);
+}
+
+static void
+on_channels_box_size_allocate (
+  GtkWidget *    widget,
+  GdkRectangle * allocation,
+  MixerWidget *  self)
+{
+  update_strips_in_view (self);
 }
 
 void
@@ -174,6 +211,10 @@ mixer_widget_class_init (MixerWidgetClass * _klass)
   GtkWidgetClass * klass = GTK_WIDGET_CLASS (_klass);
   resources_set_class_template (klass, "mixer.ui");
 
+  gtk_widget_class_bind_template_child (
+    klass,
+    MixerWidget,
+    channels_scroll);
   gtk_widget_class_bind_template_child (
     klass,
     MixerWidget,
@@ -205,4 +246,19 @@ mixer_widget_init (MixerWidget * self)
   gtk_box_pack_start (self->channels_box,
                       GTK_WIDGET (self->ddbox),
                       1, 1, 0);
+
+  /* only map the strips in view */
+  GtkAdjustment * hadj =
+    gtk_scrolled_window_get_hadjustment (
+      self->channels_scroll);
+  g_signal_connect (
+    G_OBJECT (hadj), "value-changed",
+    G_CALLBACK (on_hadj_changed), self);
+  g_signal_connect (
+    G_OBJECT (hadj), "changed",
+    G_CALLBACK (on_hadj_changed), self);
+  g_signal_connect_after (
+    G_OBJECT (self->channels_box), "size-allocate",
+    G_CALLBACK (on_channels_box_size_allocate),
+    self);
 }
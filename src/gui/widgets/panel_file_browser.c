@@ -24,6 +24,7 @@
  */
 
 #include "actions/tracklist_selections.h"
+#include "gui/backend/file_index.h"
 #include "gui/backend/file_manager.h"
 #include "gui/widgets/arranger.h"
 #include "gui/widgets/bot_dock_edge.h"
@@ -45,6 +46,7 @@
 #include "utils/io.h"
 #include "utils/objects.h"
 #include "utils/resources.h"
+#include "utils/string.h"
 #include "zrythm.h"
 #include "zrythm_app.h"
 
@@ -427,6 +429,44 @@ update_file_info_label (
   return G_SOURCE_REMOVE;
 }
 
+/**
+ * Called when the metadata of a selected file is
+ * available.
+ */
+static void
+on_file_indexed (
+  const FileIndexEntry *   entry,
+  PanelFileBrowserWidget * self)
+{
+  /* ignore if the widget was destroyed */
+  if (!gtk_widget_get_realized (GTK_WIDGET (self)))
+    return;
+
+  /* ignore if the selection changed */
+  if (self->selected_files->len == 0)
+    return;
+  SupportedFile * descr =
+    (SupportedFile *)
+    g_ptr_array_index (self->selected_files, 0);
+  if (!string_is_equal (
+         descr->abs_path, entry->abs_path))
+    return;
+
+  char * label =
+    supported_file_get_info_text_for_label (
+      descr, entry);
+  update_file_info_label (self, label);
+  g_free (label);
+
+  if (g_settings_get_boolean (
+        S_UI_FILE_BROWSER, "autoplay") &&
+      supported_file_should_autoplay (descr, entry))
+    {
+      sample_processor_queue_file (
+        SAMPLE_PROCESSOR, descr);
+    }
+}
+
 static void
 on_selection_changed (
   GtkTreeSelection *       ts,
@@ -475,13 +515,24 @@ on_selection_changed (
 
           char * label =
             supported_file_get_info_text_for_label (
-              descr);
+              descr, NULL);
           update_file_info_label (self, label);
+          g_free (label);
 
-          if (g_settings_get_boolean (
-                S_UI_FILE_BROWSER, "autoplay") &&
-              supported_file_should_autoplay (
-                 descr))
+          if (supported_file_type_is_audio (
+                descr->type))
+            {
+              /* update the label and autoplay once
+               * the metadata is available */
+              file_index_request (
+                FILE_MANAGER->index, descr->abs_path,
+                (FileIndexCallback) on_file_indexed,
+                g_object_ref (self), g_object_unref);
+            }
+          else if (g_settings_get_boolean (
+                     S_UI_FILE_BROWSER, "autoplay") &&
+                   supported_file_should_autoplay (
+                     descr, NULL))
             {
               sample_processor_queue_file (
                 SAMPLE_PROCESSOR, descr);
@@ -624,6 +675,29 @@ create_model_for_files (
   return model;
 }
 
+/**
+ * Called when the files of a new location are
+ * loaded.
+ */
+static void
+on_files_loaded (
+  FileManager *            file_manager,
+  PanelFileBrowserWidget * self)
+{
+  /* the previous files are freed so clear the
+   * selection */
+  g_ptr_array_remove_range (
+    self->selected_files, 0,
+    self->selected_files->len);
+
+  self->files_tree_model =
+    GTK_TREE_MODEL_FILTER (
+      create_model_for_files (self));
+  gtk_tree_view_set_model (
+    self->files_tree_view,
+    GTK_TREE_MODEL (self->files_tree_model));
+}
+
 static void
 on_bookmark_row_activated (
   GtkTreeView *            tree_view,
@@ -644,13 +718,10 @@ on_bookmark_row_activated (
     g_value_get_pointer (&value);
 
   file_manager_set_selection (
-    FILE_MANAGER, loc, true, true);
-  self->files_tree_model =
-    GTK_TREE_MODEL_FILTER (
-      create_model_for_files (self));
-  gtk_tree_view_set_model (
-    self->files_tree_view,
-    GTK_TREE_MODEL (self->files_tree_model));
+    FILE_MANAGER, loc, false, true);
+  file_manager_load_files_async (
+    FILE_MANAGER,
+    (FileManagerLoadedFunc) on_files_loaded, self);
 }
 
 static void
@@ -680,13 +751,11 @@ on_file_row_activated (
       loc->path = descr->abs_path;
       loc->label = g_path_get_basename (loc->path);
       file_manager_set_selection (
-        FILE_MANAGER, loc, true, true);
-      self->files_tree_model =
-        GTK_TREE_MODEL_FILTER (
-          create_model_for_files (self));
-      gtk_tree_view_set_model (
-        self->files_tree_view,
-        GTK_TREE_MODEL (self->files_tree_model));
+        FILE_MANAGER, loc, false, true);
+      file_manager_load_files_async (
+        FILE_MANAGER,
+        (FileManagerLoadedFunc) on_files_loaded,
+        self);
     }
   else if (descr->type == FILE_TYPE_WAV ||
            descr->type == FILE_TYPE_OGG ||
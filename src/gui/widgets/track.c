@@ -3359,10 +3359,10 @@ track_widget_new (Track * track)
 
   track_widget_update_size (self);
 
-  gtk_widget_add_tick_callback (
+  z_gtk_widget_add_tick_callback_while_mapped (
     GTK_WIDGET (self),
     (GtkTickCallback) track_tick_cb,
-    self, NULL);
+    self);
 
   return self;
 }
@@ -362,51 +362,37 @@ void
 tracklist_widget_hard_refresh (
   TracklistWidget * self)
 {
-  /* remove all children */
-  z_gtk_container_remove_all_children (
-    (GtkContainer *) self->unpinned_box);
-  z_gtk_container_remove_all_children (
-    (GtkContainer *) self->pinned_box);
-
-  /** add pinned tracks */
+  GPtrArray * pinned_widgets = g_ptr_array_new ();
+  GPtrArray * unpinned_widgets =
+    g_ptr_array_new ();
   for (int i = 0; i < self->tracklist->num_tracks;
        i++)
     {
       Track * track = self->tracklist->tracks[i];
 
-      if (!track_is_pinned (track))
-        continue;
-
       refresh_track_widget (track);
 
-      gtk_container_add (
-        (GtkContainer *) self->pinned_box,
-        (GtkWidget *) track->widget);
-    }
-
-  /* readd all visible unpinned tracks to
-   * scrolled window */
-  for (int i = 0; i < self->tracklist->num_tracks;
-       i++)
-    {
-      Track * track = self->tracklist->tracks[i];
-
-      if (track_is_pinned (track))
-        continue;
-
-      refresh_track_widget (track);
-
-      gtk_container_add (
-        (GtkContainer *) self->unpinned_box,
-        (GtkWidget *) track->widget);
+      g_ptr_array_add (
+        track_is_pinned (track) ?
+          pinned_widgets : unpinned_widgets,
+        track->widget);
     }
 
   /* re-add ddbox */
-  gtk_container_add (
-    GTK_CONTAINER (self->unpinned_box),
-    GTK_WIDGET (self->ddbox));
-
-  /*g_object_unref (self->ddbox);*/
+  g_ptr_array_add (unpinned_widgets, self->ddbox);
+
+  /* only add, remove or move the widgets that
+   * changed */
+  z_gtk_box_sync_children (
+    self->unpinned_box,
+    (GtkWidget **) unpinned_widgets->pdata,
+    (int) unpinned_widgets->len, false, true);
+  z_gtk_box_sync_children (
+    self->pinned_box,
+    (GtkWidget **) pinned_widgets->pdata,
+    (int) pinned_widgets->len, false, true);
+  g_ptr_array_unref (pinned_widgets);
+  g_ptr_array_unref (unpinned_widgets);
 
   /* set handle position.
    * this is done because the position resets to -1
@@ -519,6 +505,37 @@ tracklist_widget_tear_down (
   g_message ("done");
 }
 
+/**
+ * Maps only the unpinned tracks in view.
+ */
+static void
+update_tracks_in_view (
+  TracklistWidget * self)
+{
+  z_gtk_box_map_only_children_in_view (
+    self->unpinned_box,
+    gtk_scrolled_window_get_vadjustment (
+      self->unpinned_scroll),
+    TRACKLIST_WIDGET_VIEW_MARGIN);
+}
+
+static void
+on_vadj_changed (
+  GtkAdjustment *   adj,
+  TracklistWidget * self)
+{
+  update_tracks_in_view (self);
+}
+
+static void
+on_unpinned_box_size_allocate (
+  GtkWidget *       widget,
+  GdkRectangle *    allocation,
+  TracklistWidget * self)
+{
+  update_tracks_in_view (self);
+}
+
 static void
 tracklist_widget_init (TracklistWidget * self)
 {
@@ -563,6 +580,21 @@ tracklist_widget_init (TracklistWidget * self)
     (GtkContainer *) self->unpinned_scroll,
     (GtkWidget *) self->unpinned_box);
 
+  /* only map the tracks in view */
+  GtkAdjustment * vadj =
+    gtk_scrolled_window_get_vadjustment (
+      self->unpinned_scroll);
+  g_signal_connect (
+    G_OBJECT (vadj), "value-changed",
+    G_CALLBACK (on_vadj_changed), self);
+  g_signal_connect (
+    G_OBJECT (vadj), "changed",
+    G_CALLBACK (on_vadj_changed), self);
+  g_signal_connect_after (
+    G_OBJECT (self->unpinned_box), "size-allocate",
+    G_CALLBACK (on_unpinned_box_size_allocate),
+    self);
+
   /* create the drag dest box and bump its reference
    * so it doesn't get deleted. */
   self->ddbox =
@@ -40,6 +40,7 @@
 #include "project.h"
 #include "settings/settings.h"
 #include "utils/gtk.h"
+#include "utils/hash.h"
 #include "utils/file.h"
 #include "utils/flags.h"
 #include "utils/io.h"
@@ -1653,8 +1654,27 @@ carla_native_plugin_save_state (
     self->native_plugin_descriptor->get_state (
       self->native_plugin_handle);
   GError * err = NULL;
-  g_file_set_contents (
-    state_file_abs_path, state, -1, &err);
+
+  /* only write the state if it changed */
+  char * hash =
+    hash_get_from_data (
+      state, strlen (state),
+      HASH_ALGORITHM_XXH3_64);
+  const char * filenames[] = {
+    CARLA_STATE_FILENAME, NULL };
+  if (!plugin_reuse_saved_state (
+         self->plugin, hash, dir_to_use,
+         filenames))
+    {
+      g_file_set_contents (
+        state_file_abs_path, state, -1, &err);
+      if (!err)
+        {
+          plugin_set_saved_state (
+            self->plugin, hash, dir_to_use);
+        }
+    }
+  g_free (hash);
   g_free (dir_to_use);
   g_free (state_file_abs_path);
   g_free (state);
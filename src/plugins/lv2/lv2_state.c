@@ -52,6 +52,7 @@
 #include "project.h"
 #include "utils/datetime.h"
 #include "utils/flags.h"
+#include "utils/hash.h"
 #include "utils/objects.h"
 #include "utils/string.h"
 #include "zrythm_app.h"
@@ -63,6 +64,21 @@
 
 #define STATE_FILENAME "state.ttl"
 
+/** URI used when serializing a state to memory
+ * to hash it. */
+#define STATE_URI "urn:zrythm:state"
+
+/**
+ * Serializes the creation and serialization of
+ * states.
+ *
+ * Plugin states are saved from several threads
+ * at once, but lilv_state_new_from_instance() and
+ * the serialization use the shared lilv world and
+ * are not thread-safe.
+ */
+static GMutex state_mutex;
+
 /* not used - lilv handles these */
 #if 0
 /**
@@ -234,6 +250,7 @@ lv2_state_save_to_file (
       PROJECT, PROJECT_PATH_PLUGIN_EXT_LINKS,
       false);
 
+  g_mutex_lock (&state_mutex);
   LilvState* const state =
     lilv_state_new_from_instance (
       pl->lilv_plugin, pl->instance,
@@ -243,20 +260,59 @@ lv2_state_save_to_file (
       lv2_plugin_get_port_value, pl,
       LV2_STATE_IS_PORTABLE,
       pl->state_features);
-  g_return_val_if_fail (state, NULL);
+  if (!state)
+    {
+      g_mutex_unlock (&state_mutex);
+      g_free (abs_state_dir);
+      g_free (copy_dir);
+      g_free (link_dir);
+      g_return_val_if_reached (NULL);
+    }
+
+  /* only write the state if it changed */
+  char * state_str =
+    lilv_state_to_string (
+      LILV_WORLD, &pl->map, &pl->unmap, state,
+      STATE_URI, NULL);
+  char * hash =
+    hash_get_from_data (
+      state_str, strlen (state_str),
+      HASH_ALGORITHM_XXH3_64);
+  lilv_free (state_str);
+  const char * filenames[] = {
+    STATE_FILENAME, "manifest.ttl", NULL };
+  int rc = 0;
+  if (!plugin_reuse_saved_state (
+         pl->plugin, hash, abs_state_dir,
+         filenames))
+    {
+      rc =
+        lilv_state_save (
+          LILV_WORLD, &pl->map, &pl->unmap,
+          state, NULL, abs_state_dir,
+          STATE_FILENAME);
+      if (!rc)
+        {
+          plugin_set_saved_state (
+            pl->plugin, hash, abs_state_dir);
+        }
+    }
+  g_mutex_unlock (&state_mutex);
+  g_free (hash);
+  g_free (copy_dir);
+  g_free (link_dir);
 
-  int rc =
-    lilv_state_save (
-      LILV_WORLD, &pl->map, &pl->unmap,
-      state, NULL, abs_state_dir, STATE_FILENAME);
   if (rc)
     {
       g_critical ("Lilv save state failed");
+      g_free (abs_state_dir);
+      lilv_state_free (state);
       return NULL;
     }
 
   g_message (
     "Lilv state saved to %s", pl->plugin->state_dir);
+  g_free (abs_state_dir);
 
   return state;
 }
@@ -272,6 +328,7 @@ LilvState *
 lv2_state_save_to_memory (
   Lv2Plugin * plugin)
 {
+  g_mutex_lock (&state_mutex);
   LilvState * state =
     lilv_state_new_from_instance (
       plugin->lilv_plugin, plugin->instance,
@@ -280,6 +337,7 @@ lv2_state_save_to_memory (
       lv2_plugin_get_port_value, plugin,
       LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE,
       plugin->state_features);
+  g_mutex_unlock (&state_mutex);
 
   g_message (
     "Lilv state saved to memory for plugin %s",
@@ -447,6 +505,7 @@ lv2_state_save_preset (
   const char * label,
   const char * filename)
 {
+  g_mutex_lock (&state_mutex);
   LilvState* const state =
     lilv_state_new_from_instance (
       plugin->lilv_plugin, plugin->instance,
@@ -465,6 +524,7 @@ lv2_state_save_preset (
     lilv_state_save (
       LILV_WORLD, &plugin->map, &plugin->unmap,
       state, uri, dir, filename);
+  g_mutex_unlock (&state_mutex);
 
   lilv_state_free(plugin->preset);
   plugin->preset = state;
@@ -385,6 +385,14 @@ create_port (
         {
           g_return_val_if_fail (
             IS_PORT_AND_NONNULL (port), NULL);
+
+          /* stop sharing until the graph is
+           * recalculated */
+          if (port->buf_is_shared)
+            {
+              port->buf = NULL;
+              port->buf_is_shared = false;
+            }
           port->buf =
             g_realloc (
               port->buf,
@@ -1436,6 +1444,18 @@ lv2_plugin_get_port_value (
     {
       *size = sizeof (float);
       *type = PM_URIDS.atom_Float;
+
+      /* use the values from when saving the
+       * project started, if saving */
+      if (pl->control_snapshot &&
+          port->id.flow == FLOW_INPUT)
+        {
+          return
+            (const void *)
+            &pl->control_snapshot[
+              port->id.port_index];
+        }
+
       return (const void *) &port->control;
     }
 
@@ -3628,11 +3648,14 @@ lv2_plugin_process (
                         }
                       else
                         {
-                          /* Write MIDI event to port */
+                          /* Write MIDI event to
+                           * port (the time is
+                           * relative to the
+                           * current split) */
                           midi_events_add_event_from_buf (
                             port->midi_events,
-                            frames, body,
-                            (int) size, 0);
+                            local_offset + frames,
+                            body, (int) size, 0);
                         }
                     }
 
@@ -31,6 +31,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef _WOE32
+#include <unistd.h>
+#endif
+
 #include "audio/automation_tracklist.h"
 #include "audio/channel.h"
 #include "audio/control_port.h"
@@ -57,6 +61,7 @@
 #include "utils/dsp.h"
 #include "utils/error.h"
 #include "utils/gtk.h"
+#include "utils/handle_table.h"
 #include "utils/io.h"
 #include "utils/flags.h"
 #include "utils/math.h"
@@ -164,6 +169,9 @@ plugin_init_loaded (
       ports[i]->magic = PORT_MAGIC;
       ports[i]->is_project = project;
     }
+  free (ports);
+
+  plugin_update_handle (self, project);
 
   /* set enabled/gain ports */
   for (int i = 0; i < self->num_in_ports; i++)
@@ -675,6 +683,51 @@ plugin_set_is_project (
       port_set_is_project (port, is_project);
     }
   free (ports);
+
+  plugin_update_handle (self, is_project);
+}
+
+/**
+ * Registers the plugin in the handle table if
+ * @p is_project, otherwise unregisters it, and
+ * sets the handle on the identifiers of its ports.
+ */
+void
+plugin_update_handle (
+  Plugin * self,
+  bool     is_project)
+{
+  if (!ZRYTHM || !HANDLE_TABLE)
+    return;
+
+  bool registered =
+    object_handle_is_set (&self->handle);
+  if (is_project == registered)
+    return;
+
+  if (is_project)
+    {
+      self->handle =
+        handle_table_add (HANDLE_TABLE, self);
+    }
+  else
+    {
+      handle_table_remove (
+        HANDLE_TABLE, &self->handle);
+      self->handle.generation = 0;
+    }
+
+  size_t max_size = 20;
+  Port ** ports =
+    object_new_n (max_size, Port *);
+  int num_ports = 0;
+  plugin_append_ports (
+    self, &ports, &max_size, true, &num_ports);
+  for (int i = 0; i < num_ports; i++)
+    {
+      ports[i]->id.plugin_handle = self->handle;
+    }
+  free (ports);
 }
 
 /**
@@ -1704,6 +1757,157 @@ plugin_prepare_process (
     }
 }
 
+/**
+ * Returns whether any of the plugin's inputs has
+ * audio, CV or MIDI in the given range.
+ *
+ * The silence flags of the audio and CV inputs are
+ * set when their port is processed, which happens
+ * before the plugin is processed.
+ */
+static bool
+has_input_activity (
+  Plugin *        self,
+  const nframes_t local_offset,
+  const nframes_t nframes)
+{
+  for (int i = 0; i < self->num_in_ports; i++)
+    {
+      Port * port = self->in_ports[i];
+      switch (port->id.type)
+        {
+        case TYPE_AUDIO:
+        case TYPE_CV:
+          if (!port->is_silent)
+            return true;
+          break;
+        case TYPE_EVENT:
+          {
+            MidiEvents * events = port->midi_events;
+            if (!events)
+              break;
+
+            for (int j = 0; j < events->num_events;
+                 j++)
+              {
+                nframes_t time =
+                  events->events[j].time;
+                if (time >= local_offset &&
+                    time < local_offset + nframes)
+                  return true;
+              }
+          }
+          break;
+        default:
+          break;
+        }
+    }
+
+  return false;
+}
+
+/**
+ * Returns whether the outputs of the plugin have
+ * no audio, CV or MIDI in the given range.
+ */
+static bool
+are_outputs_silent (
+  Plugin *        self,
+  const nframes_t local_offset,
+  const nframes_t nframes)
+{
+  for (int i = 0; i < self->num_out_ports; i++)
+    {
+      Port * port = self->out_ports[i];
+      switch (port->id.type)
+        {
+        case TYPE_AUDIO:
+        case TYPE_CV:
+          {
+            float peak = 0.f;
+            dsp_abs_max (
+              &port->buf[local_offset], &peak,
+              nframes);
+            if (peak >= PORT_SILENCE_THRESHOLD)
+              return false;
+          }
+          break;
+        case TYPE_EVENT:
+          {
+            MidiEvents * events = port->midi_events;
+            if (!events)
+              break;
+
+            for (int j = 0; j < events->num_events;
+                 j++)
+              {
+                nframes_t time =
+                  events->events[j].time;
+                if (time >= local_offset &&
+                    time < local_offset + nframes)
+                  return false;
+              }
+          }
+          break;
+        default:
+          break;
+        }
+    }
+
+  return true;
+}
+
+/**
+ * Returns whether the plugin may be suspended.
+ *
+ * Plugins without audio or CV inputs (such as
+ * instruments, sequencers and drum machines) may
+ * produce sound on their own while the transport
+ * is rolling, so they are only suspended while it
+ * is stopped.
+ */
+static bool
+can_be_suspended (
+  Plugin * self)
+{
+  if (AUDIO_ENGINE->plugin_suspend_tail_ms <= 0 ||
+      self->id.slot_type == PLUGIN_SLOT_MODULATOR)
+    return false;
+
+  const PluginDescriptor * descr =
+    self->setting->descr;
+  if (descr->num_audio_ins == 0 &&
+      descr->num_cv_ins == 0 &&
+      TRANSPORT_IS_ROLLING)
+    return false;
+
+  return true;
+}
+
+/**
+ * Fills the audio and CV outputs of the plugin
+ * with silence, used while the plugin is
+ * suspended.
+ */
+static void
+silence_outputs (
+  Plugin *        self,
+  const nframes_t local_offset,
+  const nframes_t nframes)
+{
+  for (int i = 0; i < self->num_out_ports; i++)
+    {
+      Port * port = self->out_ports[i];
+      if (port->id.type != TYPE_AUDIO &&
+          port->id.type != TYPE_CV)
+        continue;
+
+      dsp_fill (
+        &port->buf[local_offset],
+        DENORMAL_PREVENTION_VAL, nframes);
+    }
+}
+
 /**
  * Process plugin.
  *
@@ -1720,6 +1924,7 @@ plugin_process (
   if (!plugin_is_enabled (plugin, true) &&
       !plugin->own_enabled_port)
     {
+      plugin->suspended = false;
       plugin_process_passthrough (
         plugin, g_start_frames, local_offset,
         nframes);
@@ -1731,6 +1936,36 @@ plugin_process (
       return;
     }
 
+  /* suspend idle plugins */
+  const bool can_suspend =
+    can_be_suspended (plugin);
+  if (!can_suspend)
+    {
+      plugin->silent_frames = 0;
+      plugin->suspended = false;
+    }
+  else
+    {
+      if (has_input_activity (
+            plugin, local_offset, nframes))
+        {
+          /* resume immediately */
+          plugin->silent_frames = 0;
+          plugin->suspended = false;
+        }
+      else if (plugin->suspended)
+        {
+          silence_outputs (
+            plugin, local_offset, nframes);
+          return;
+        }
+      else if (plugin->silent_frames <
+                 UINT32_MAX - nframes)
+        {
+          plugin->silent_frames += nframes;
+        }
+    }
+
   /* if has MIDI input port */
   if (plugin->setting->descr->num_midi_ins > 0)
     {
@@ -1810,6 +2045,27 @@ plugin_process (
             }
         }
     }
+
+  /* suspend if the inputs and outputs have been
+   * silent for longer than the tail */
+  if (can_suspend)
+    {
+      if (!are_outputs_silent (
+             plugin, local_offset, nframes))
+        {
+          plugin->silent_frames = 0;
+        }
+      else if (plugin->silent_frames >=
+                 (nframes_t)
+                 (((gint64)
+                   AUDIO_ENGINE->
+                     plugin_suspend_tail_ms *
+                   AUDIO_ENGINE->sample_rate) /
+                  1000))
+        {
+          plugin->suspended = true;
+        }
+    }
 }
 
 /**
@@ -2009,6 +2265,173 @@ plugin_get_abs_state_dir (
   return full_path;
 }
 
+/**
+ * Saves the state of the plugin in its state
+ * directory.
+ *
+ * The state is captured through the plugin's state
+ * interface, which may be called while the plugin
+ * is processing, so the engine does not need to be
+ * paused. Different plugins may be saved
+ * concurrently. The control values are taken from
+ * the snapshot, if any (see
+ * plugin_snapshot_control_values()).
+ *
+ * @note plugin_ensure_state_dir() must have been
+ *   called first.
+ *
+ * @return Non-zero if error.
+ */
+int
+plugin_save_state (
+  Plugin * self,
+  bool     is_backup)
+{
+  g_return_val_if_fail (self->state_dir, -1);
+
+#ifdef HAVE_CARLA
+  if (self->setting->open_with_carla)
+    {
+      return
+        carla_native_plugin_save_state (
+          self->carla, is_backup, NULL);
+    }
+#endif
+
+  switch (self->setting->descr->protocol)
+    {
+    case PROT_LV2:
+      {
+        LilvState * state =
+          lv2_state_save_to_file (
+            self->lv2, is_backup);
+        if (!state)
+          return -1;
+        lilv_state_free (state);
+      }
+      break;
+    default:
+      g_warn_if_reached ();
+      break;
+    }
+
+  return 0;
+}
+
+/**
+ * Returns whether the files of the state with the
+ * given hash are already in the given directory.
+ *
+ * If the state did not change since it was last
+ * saved in another directory (eg, when saving a
+ * backup), the files are hard-linked from there
+ * instead of being written again.
+ *
+ * @param filenames NULL-terminated array of the
+ *   basenames of the state files.
+ */
+bool
+plugin_reuse_saved_state (
+  Plugin *      self,
+  const char *  hash,
+  const char *  abs_state_dir,
+  const char ** filenames)
+{
+  if (!self->saved_state_hash ||
+      !self->saved_state_dir ||
+      !string_is_equal (
+         self->saved_state_hash, hash))
+    return false;
+
+  bool same_dir =
+    string_is_equal (
+      self->saved_state_dir, abs_state_dir);
+  for (int i = 0; filenames[i]; i++)
+    {
+      char * dest =
+        g_build_filename (
+          abs_state_dir, filenames[i], NULL);
+      bool exists =
+        g_file_test (dest, G_FILE_TEST_EXISTS);
+      bool reused = false;
+      if (same_dir)
+        {
+          reused = exists;
+        }
+#ifndef _WOE32
+      else if (!exists)
+        {
+          char * src =
+            g_build_filename (
+              self->saved_state_dir, filenames[i],
+              NULL);
+          reused = link (src, dest) == 0;
+          g_free (src);
+        }
+#endif
+      g_free (dest);
+
+      if (!reused)
+        return false;
+    }
+
+  g_debug (
+    "state of %s unchanged, reused files from %s",
+    self->setting->descr->name,
+    self->saved_state_dir);
+
+  return true;
+}
+
+/**
+ * Remembers the given state as the last saved
+ * state.
+ */
+void
+plugin_set_saved_state (
+  Plugin *     self,
+  const char * hash,
+  const char * abs_state_dir)
+{
+  g_free_and_null (self->saved_state_hash);
+  g_free_and_null (self->saved_state_dir);
+  self->saved_state_hash = g_strdup (hash);
+  self->saved_state_dir = g_strdup (abs_state_dir);
+}
+
+/**
+ * Copies the current values of the input ports to
+ * be used when saving the state.
+ *
+ * Must be released with
+ * plugin_clear_control_snapshot().
+ */
+void
+plugin_snapshot_control_values (
+  Plugin * self)
+{
+  object_zero_and_free (self->control_snapshot);
+  self->control_snapshot =
+    object_new_n (
+      (size_t) MAX (self->num_in_ports, 1), float);
+  for (int i = 0; i < self->num_in_ports; i++)
+    {
+      self->control_snapshot[i] =
+        self->in_ports[i]->control;
+    }
+}
+
+/**
+ * Releases the values copied by
+ * plugin_snapshot_control_values().
+ */
+void
+plugin_clear_control_snapshot (
+  Plugin * self)
+{
+  object_zero_and_free (self->control_snapshot);
+}
+
 /**
  * Ensures the state dir exists or creates it.
  */
@@ -3093,6 +3516,8 @@ plugin_free (
     "freeing plugin %s",
     self->setting->descr->name);
 
+  plugin_update_handle (self, false);
+
   object_free_w_func_and_null (
     lv2_plugin_free, self->lv2);
 #ifdef HAVE_CARLA
@@ -3114,6 +3539,9 @@ plugin_free (
     }
 
   object_zero_and_free (self->lilv_ports);
+  g_free_and_null (self->saved_state_hash);
+  g_free_and_null (self->saved_state_dir);
+  object_zero_and_free (self->control_snapshot);
 
   object_zero_and_free (self);
 }
@@ -26,11 +26,15 @@
 
 #include "zrythm-config.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <sys/stat.h>
 
 #include "zrythm.h"
 #include "project.h"
+#include "project_binary.h"
 #include "audio/automation_point.h"
 #include "audio/automation_track.h"
 #include "audio/channel.h"
@@ -83,17 +87,478 @@
 #include "utils/objects.h"
 #include "utils/string.h"
 #include "utils/ui.h"
+#include "utils/yaml.h"
 #include "zrythm_app.h"
 
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 
+#include <zdict.h>
 #include <zstd.h>
 
+#ifndef ZSTD_CONTENTSIZE_UNKNOWN
+#define ZSTD_CONTENTSIZE_UNKNOWN (0ULL - 1)
+#endif
+
+/**
+ * Output of a compression stream: a growing
+ * buffer, or a file.
+ */
+typedef struct CompressionSink
+{
+  FILE * file;
+  char * data;
+  size_t size;
+  size_t capacity;
+} CompressionSink;
+
+static bool
+compression_sink_write (
+  CompressionSink * sink,
+  const void *      src,
+  size_t            size)
+{
+  if (size == 0)
+    return true;
+
+  if (sink->file)
+    {
+      sink->size += size;
+      return fwrite (src, 1, size, sink->file) == size;
+    }
+
+  if (sink->size + size > sink->capacity)
+    {
+      sink->capacity =
+        MAX (
+          MAX (sink->capacity * 2, 4096),
+          sink->size + size);
+      sink->data =
+        realloc (sink->data, sink->capacity);
+    }
+  memcpy (&sink->data[sink->size], src, size);
+  sink->size += size;
+
+  return true;
+}
+
+/**
+ * Returns the compression level and the path to
+ * the compression dictionary (or NULL) from the
+ * settings, or the defaults if the settings are
+ * not available (eg, when converting projects from
+ * the command line).
+ */
+static void
+get_compression_settings (
+  int *   level,
+  char ** dict_path)
+{
+  *level = PROJECT_DEFAULT_COMPRESSION_LEVEL;
+  *dict_path = NULL;
+  if (!ZRYTHM || ZRYTHM_TESTING || !SETTINGS)
+    return;
+
+  *level =
+    g_settings_get_int (
+      S_P_PROJECTS_GENERAL, "compression-level");
+  char * path =
+    g_settings_get_string (
+      S_P_PROJECTS_GENERAL,
+      "compression-dictionary");
+  if (path && strlen (path) > 0)
+    {
+      *dict_path = path;
+    }
+  else
+    {
+      g_free (path);
+    }
+}
+
+/**
+ * Loads the compression dictionary, if any.
+ *
+ * @param dict_path Path to the dictionary from
+ *   get_compression_settings(), or NULL.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+static char *
+load_compression_dictionary (
+  const char * dict_path,
+  char **      dict,
+  size_t *     dict_size)
+{
+  *dict = NULL;
+  *dict_size = 0;
+  if (!dict_path)
+    return NULL;
+
+  GError * err = NULL;
+  g_file_get_contents (
+    dict_path, dict, dict_size, &err);
+  if (err)
+    {
+      char * err_msg =
+        g_strdup_printf (
+          _("Failed to read compression dictionary "
+          "%s: %s"),
+          dict_path, err->message);
+      g_error_free (err);
+      return err_msg;
+    }
+
+  return NULL;
+}
+
+/**
+ * Reads the next chunk of the source.
+ *
+ * @return The number of bytes read.
+ */
+static size_t
+read_source_chunk (
+  FILE *        file,
+  const char ** mem_src,
+  size_t *      mem_remaining,
+  char *        buf,
+  size_t        buf_size,
+  const char ** chunk)
+{
+  if (file)
+    {
+      *chunk = buf;
+      return fread (buf, 1, buf_size, file);
+    }
+
+  /* memory sources are passed in one chunk */
+  size_t size = *mem_remaining;
+  *chunk = *mem_src;
+  *mem_src += size;
+  *mem_remaining = 0;
+  return size;
+}
+
+#if ZSTD_VERSION_NUMBER >= 10400
+/**
+ * Compresses the source into the sink with a
+ * streaming context, using worker threads.
+ *
+ * @param src_size Size of the source, used to
+ *   store the content size in the frame.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+static char *
+compress_stream (
+  CompressionSink * sink,
+  FILE *            src_file,
+  const char *      src,
+  size_t            src_size)
+{
+  int level;
+  char * dict_path;
+  get_compression_settings (&level, &dict_path);
+
+  char * dict;
+  size_t dict_size;
+  char * err_msg =
+    load_compression_dictionary (
+      dict_path, &dict, &dict_size);
+  g_free (dict_path);
+  if (err_msg)
+    return err_msg;
+
+  ZSTD_CCtx * cctx = ZSTD_createCCtx ();
+  ZSTD_CCtx_setParameter (
+    cctx, ZSTD_c_compressionLevel, level);
+  size_t ret =
+    ZSTD_CCtx_setParameter (
+      cctx, ZSTD_c_nbWorkers,
+      (int) g_get_num_processors ());
+  if (ZSTD_isError (ret))
+    {
+      g_debug (
+        "zstd does not support multithreading: %s",
+        ZSTD_getErrorName (ret));
+    }
+  ZSTD_CCtx_setPledgedSrcSize (cctx, src_size);
+  if (dict)
+    {
+      ret =
+        ZSTD_CCtx_loadDictionary (
+          cctx, dict, dict_size);
+      g_free (dict);
+      if (ZSTD_isError (ret))
+        {
+          ZSTD_freeCCtx (cctx);
+          return
+            g_strdup_printf (
+              _("Failed to load compression "
+              "dictionary: %s"),
+              ZSTD_getErrorName (ret));
+        }
+    }
+
+  size_t in_buf_size = ZSTD_CStreamInSize ();
+  size_t out_buf_size = ZSTD_CStreamOutSize ();
+  char * in_buf =
+    src_file ? malloc (in_buf_size) : NULL;
+  char * out_buf = malloc (out_buf_size);
+  size_t mem_remaining = src_size;
+  size_t total_read = 0;
+  bool finished = false;
+  while (!finished && !err_msg)
+    {
+      const char * chunk;
+      size_t chunk_size =
+        read_source_chunk (
+          src_file, &src, &mem_remaining, in_buf,
+          in_buf_size, &chunk);
+      total_read += chunk_size;
+      bool last =
+        src_file ?
+          chunk_size < in_buf_size :
+          true;
+      ZSTD_EndDirective mode =
+        last ? ZSTD_e_end : ZSTD_e_continue;
+      ZSTD_inBuffer input = {
+        chunk, chunk_size, 0 };
+      bool done;
+      do
+        {
+          ZSTD_outBuffer output = {
+            out_buf, out_buf_size, 0 };
+          size_t remaining =
+            ZSTD_compressStream2 (
+              cctx, &output, &input, mode);
+          if (ZSTD_isError (remaining))
+            {
+              err_msg =
+                g_strdup_printf (
+                  "Failed to compress project "
+                  "file: %s",
+                  ZSTD_getErrorName (remaining));
+              break;
+            }
+          if (!compression_sink_write (
+                 sink, out_buf, output.pos))
+            {
+              err_msg =
+                g_strdup (
+                  _("Failed to write compressed "
+                  "project"));
+              break;
+            }
+          done =
+            last ?
+              remaining == 0 :
+              input.pos == input.size;
+        } while (!done);
+      finished = last;
+    }
+
+  free (in_buf);
+  free (out_buf);
+  ZSTD_freeCCtx (cctx);
+
+  if (!err_msg && total_read != src_size)
+    {
+      err_msg =
+        g_strdup (_("Project file changed while "
+        "compressing"));
+    }
+
+  return err_msg;
+}
+#endif
+
+/**
+ * Decompresses the source into the sink with a
+ * streaming context, so that the whole compressed
+ * data is never in memory when the source is a
+ * file.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+static char *
+decompress_stream (
+  CompressionSink * sink,
+  FILE *            src_file,
+  const char *      src,
+  size_t            src_size)
+{
+  ZSTD_DStream * dstream = ZSTD_createDStream ();
+  ZSTD_initDStream (dstream);
+
+  size_t in_buf_size = ZSTD_DStreamInSize ();
+  size_t out_buf_size = ZSTD_DStreamOutSize ();
+  char * in_buf =
+    src_file ? malloc (in_buf_size) : NULL;
+  char * out_buf = malloc (out_buf_size);
+  size_t mem_remaining = src_size;
+  char * err_msg = NULL;
+  bool first_chunk = true;
+  size_t last_ret = 0;
+  while (!err_msg)
+    {
+      const char * chunk;
+      size_t chunk_size =
+        read_source_chunk (
+          src_file, &src, &mem_remaining, in_buf,
+          in_buf_size, &chunk);
+      if (chunk_size == 0)
+        break;
+
+      if (first_chunk)
+        {
+          first_chunk = false;
+#if (ZSTD_VERSION_MAJOR == 1 && \
+  ZSTD_VERSION_MINOR < 3)
+          unsigned long long const
+            frame_content_size =
+              ZSTD_getDecompressedSize (
+                chunk, chunk_size);
+          if (frame_content_size == 0)
+#else
+          unsigned long long const
+            frame_content_size =
+              ZSTD_getFrameContentSize (
+                chunk, chunk_size);
+          if (frame_content_size ==
+                ZSTD_CONTENTSIZE_ERROR)
+#endif
+            {
+              err_msg =
+                g_strdup (
+                  _("Project not compressed by "
+                  "zstd"));
+              break;
+            }
+
+          /* allocate the output once if the size
+           * is known */
+          if (!sink->file &&
+              frame_content_size !=
+                ZSTD_CONTENTSIZE_UNKNOWN &&
+              frame_content_size > 0)
+            {
+              sink->capacity =
+                (size_t) frame_content_size;
+              sink->data = malloc (sink->capacity);
+            }
+
+          unsigned dict_id =
+            ZSTD_getDictID_fromFrame (
+              chunk, chunk_size);
+          if (dict_id != 0)
+            {
+              int level;
+              char * dict_path;
+              get_compression_settings (
+                &level, &dict_path);
+              char * dict;
+              size_t dict_size;
+              err_msg =
+                load_compression_dictionary (
+                  dict_path, &dict, &dict_size);
+              g_free (dict_path);
+              if (!err_msg &&
+                  (!dict ||
+                   ZSTD_getDictID_fromDict (
+                     dict, dict_size) != dict_id))
+                {
+                  err_msg =
+                    g_strdup (
+                      _("Project was compressed "
+                      "with a different "
+                      "dictionary"));
+                }
+#if ZSTD_VERSION_NUMBER >= 10400
+              if (!err_msg)
+                {
+                  size_t ret =
+                    ZSTD_DCtx_loadDictionary (
+                      dstream, dict, dict_size);
+                  if (ZSTD_isError (ret))
+                    {
+                      err_msg =
+                        g_strdup (
+                          ZSTD_getErrorName (ret));
+                    }
+                }
+#else
+              if (!err_msg)
+                {
+                  err_msg =
+                    g_strdup (
+                      _("Compression dictionaries "
+                      "need zstd 1.4.0 or newer"));
+                }
+#endif
+              g_free (dict);
+              if (err_msg)
+                break;
+            }
+        }
+
+      ZSTD_inBuffer input = {
+        chunk, chunk_size, 0 };
+      while (input.pos < input.size)
+        {
+          ZSTD_outBuffer output = {
+            out_buf, out_buf_size, 0 };
+          last_ret =
+            ZSTD_decompressStream (
+              dstream, &output, &input);
+          if (ZSTD_isError (last_ret))
+            {
+              err_msg =
+                g_strdup_printf (
+                  _("Failed to decompress project "
+                  "file: %s"),
+                  ZSTD_getErrorName (last_ret));
+              break;
+            }
+          if (!compression_sink_write (
+                 sink, out_buf, output.pos))
+            {
+              err_msg =
+                g_strdup (
+                  _("Failed to write decompressed "
+                  "project"));
+              break;
+            }
+        }
+    }
+
+  if (!err_msg && (first_chunk || last_ret != 0))
+    {
+      err_msg =
+        g_strdup (
+          _("Project file is truncated"));
+    }
+
+  free (in_buf);
+  free (out_buf);
+  ZSTD_freeDStream (dstream);
+
+  return err_msg;
+}
+
 /**
  * Compresses/decompress a project from a file/data
  * to a file/data.
  *
+ * Data is streamed through zstd so that the whole
+ * input and output are only held in memory when
+ * they are passed or requested as data.
+ * Compression uses worker threads, the compression
+ * level and the optional dictionary from the
+ * settings.
+ *
  * @param compress True to compress, false to
  *   decompress.
  * @param[out] dest Pointer to a location to allocate
@@ -122,118 +587,144 @@ _project_compress (
     ZSTD_VERSION_MINOR,
     ZSTD_VERSION_RELEASE);
 
-  char * src = NULL;
-  size_t src_size = 0;
-  switch (src_type)
+  /* open the source */
+  FILE * src_file = NULL;
+  size_t src_size = _src_size;
+  if (src_type == PROJECT_COMPRESS_FILE)
     {
-    case PROJECT_COMPRESS_DATA:
-      src = (char *) _src;
-      src_size = _src_size;
-      break;
-    case PROJECT_COMPRESS_FILE:
-      {
-        GError *err = NULL;
-        g_file_get_contents (
-          _src, &src, &src_size, &err);
-        if (err)
-          {
-            char err_msg[800];
-            strcpy (err_msg, err->message);
-            g_error_free (err);
-            return
-              g_strdup_printf (
-                _("Failed to open file: %s"),
-                err_msg);
-          }
-      }
-      break;
+      src_file = g_fopen (_src, "rb");
+      GStatBuf st;
+      if (!src_file || g_stat (_src, &st) != 0)
+        {
+          if (src_file)
+            fclose (src_file);
+          return
+            g_strdup_printf (
+              _("Failed to open file: %s"),
+              _src);
+        }
+      src_size = (size_t) st.st_size;
     }
 
-  char * dest = NULL;
-  size_t dest_size = 0;
+  /* open the destination (files are written to a
+   * temporary file first so that existing files
+   * are not left half-written) */
+  CompressionSink sink;
+  memset (&sink, 0, sizeof (CompressionSink));
+  char * tmp_path = NULL;
+  if (dest_type == PROJECT_COMPRESS_FILE)
+    {
+      tmp_path =
+        g_strdup_printf ("%s.tmp", *_dest);
+      sink.file = g_fopen (tmp_path, "wb");
+      if (!sink.file)
+        {
+          if (src_file)
+            fclose (src_file);
+          char * err_msg =
+            g_strdup_printf (
+              _("Failed to open file: %s"),
+              tmp_path);
+          g_free (tmp_path);
+          return err_msg;
+        }
+    }
+
+  char * err_msg = NULL;
   if (compress)
     {
       g_message ("compressing project...");
+#if ZSTD_VERSION_NUMBER >= 10400
+      err_msg =
+        compress_stream (
+          &sink, src_file, _src, src_size);
+#else
+      /* streaming with worker threads needs zstd
+       * 1.4.0 */
+      char * src = (char *) _src;
+      if (src_file)
+        {
+          g_file_get_contents (
+            _src, &src, &src_size, NULL);
+        }
+      int level;
+      char * dict_path;
+      get_compression_settings (&level, &dict_path);
+      g_free (dict_path);
       size_t compress_bound =
         ZSTD_compressBound (src_size);
-      dest = malloc (compress_bound);
-      dest_size =
+      char * dest = malloc (compress_bound);
+      size_t dest_size =
         ZSTD_compress (
           dest, compress_bound,
-          src, src_size, 1);
+          src, src_size, level);
       if (ZSTD_isError (dest_size))
         {
-          free (dest);
-          return
+          err_msg =
             g_strdup_printf (
               "Failed to compress project file: %s",
               ZSTD_getErrorName (dest_size));
         }
+      else
+        {
+          compression_sink_write (
+            &sink, dest, dest_size);
+        }
+      free (dest);
+      if (src_file)
+        g_free (src);
+#endif
     }
   else /* decompress */
     {
-#if (ZSTD_VERSION_MAJOR == 1 && \
-  ZSTD_VERSION_MINOR < 3)
-      unsigned long long const frame_content_size =
-        ZSTD_getDecompressedSize (src, src_size);
-      if (frame_content_size == 0)
-#else
-      unsigned long long const frame_content_size =
-        ZSTD_getFrameContentSize (src, src_size);
-      if (frame_content_size ==
-            ZSTD_CONTENTSIZE_ERROR)
-#endif
+      err_msg =
+        decompress_stream (
+          &sink, src_file,
+          src_file ? NULL : _src, src_size);
+    }
+
+  if (src_file)
+    fclose (src_file);
+
+  if (sink.file)
+    {
+      if (fclose (sink.file) != 0 && !err_msg)
         {
-          return
-            g_strdup (
-              _("Project not compressed by zstd"));
+          err_msg =
+            g_strdup_printf (
+              _("Failed to write file: %s"),
+              tmp_path);
         }
-      dest =
-        malloc ((size_t) frame_content_size);
-      dest_size =
-        ZSTD_decompress (
-          dest, frame_content_size,
-          src, src_size);
-      if (ZSTD_isError (dest_size))
+      if (!err_msg &&
+          g_rename (tmp_path, *_dest) != 0)
         {
-          free (dest);
-          return
+          err_msg =
             g_strdup_printf (
-              _("Failed to decompress project "
-              "file: %s"),
-              ZSTD_getErrorName (dest_size));
+              _("Failed to write file: %s"),
+              *_dest);
         }
-      if (dest_size != frame_content_size)
+      if (err_msg)
         {
-          free (dest);
-          /* impossible because zstd will check
-           * this condition */
-          return
-            g_strdup (
-              "uncompressed_size != "
-              "frame_content_size");
+          g_unlink (tmp_path);
         }
+      g_free (tmp_path);
+    }
+
+  if (err_msg)
+    {
+      free (sink.data);
+      return err_msg;
     }
 
   g_message (
-    "%s : %u bytes -> %u bytes",
+    "%s : %zu bytes -> %zu bytes",
     compress ? "Compression" : "Decompression",
-    (unsigned) src_size,
-    (unsigned) dest_size);
+    src_size, sink.size);
 
-  switch (dest_type)
+  if (dest_type == PROJECT_COMPRESS_DATA)
     {
-    case PROJECT_COMPRESS_DATA:
-      *_dest = dest;
-      *_dest_size = dest_size;
-      break;
-    case PROJECT_COMPRESS_FILE:
-      {
-        char * err_msg =
-          io_write_file (*_dest, dest, dest_size);
-        return err_msg;
-      }
-      break;
+      *_dest = sink.data;
+      *_dest_size = sink.size;
     }
 
   return NULL;
@@ -893,58 +1384,126 @@ project_create_default (
 }
 
 /**
- * Returns the YAML representation of the saved
- * project file.
- *
- * To be free'd with free().
+ * Returns the path of the project file, checking
+ * that it exists.
  *
  * @param backup Whether to use the project file
  *   from the most recent backup.
  */
-char *
-project_get_existing_yaml (
+static char *
+get_existing_project_file_path (
   Project * self,
   bool      backup)
 {
-  /* get file contents */
   char * project_file_path =
     project_get_path (
       self, PROJECT_PATH_PROJECT_FILE, backup);
   g_return_val_if_fail (project_file_path, NULL);
   g_message (
-    "%s: getting YAML for project file %s",
+    "%s: reading project file %s",
     __func__, project_file_path);
 
-  char * compressed_pj;
-  gsize compressed_pj_size;
-  GError *err = NULL;
-  g_file_get_contents (
-    project_file_path, &compressed_pj,
-    &compressed_pj_size, &err);
-  if (err != NULL)
+  if (!g_file_test (
+         project_file_path, G_FILE_TEST_EXISTS))
     {
-      /* Report error to user, and free error */
       char str[1200];
       sprintf (
         str, _("Unable to read file: %s"),
-        err->message);
+        project_file_path);
       ui_show_error_message (MAIN_WINDOW, str);
-      g_error_free (err);
+      g_free (project_file_path);
       return NULL;
     }
 
-  /* decompress */
-  g_message (
-    "%s: decompressing project...", __func__);
+  return project_file_path;
+}
+
+/**
+ * Returns whether the given file is a binary
+ * project (by checking its header).
+ */
+static bool
+is_binary_project_file (
+  const char * path)
+{
+  FILE * file = g_fopen (path, "rb");
+  if (!file)
+    return false;
+
+  char header[16];
+  size_t size =
+    fread (header, 1, sizeof (header), file);
+  fclose (file);
+
+  return project_binary_is_binary (header, size);
+}
+
+/**
+ * Reads and deserializes a binary project file.
+ *
+ * @param lazy_undo_history See
+ *   project_binary_deserialize().
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+static char *
+read_binary_project_file (
+  const char * path,
+  Project **   project,
+  char **      yaml,
+  bool         lazy_undo_history)
+{
+  return
+    project ?
+      project_binary_deserialize_from_file (
+        project, path, lazy_undo_history) :
+      project_binary_file_to_yaml (yaml, path);
+}
+
+/**
+ * Returns the YAML representation of the given
+ * project file (compressed YAML or binary).
+ *
+ * The compressed YAML is decompressed while it is
+ * read from the file.
+ *
+ * To be free'd with free().
+ */
+static char *
+get_yaml_from_project_file (
+  const char * path)
+{
   char * yaml = NULL;
-  size_t yaml_size;
-  char * error_msg =
-    project_decompress (
-      &yaml, &yaml_size,
-      PROJECT_DECOMPRESS_DATA,
-      compressed_pj, compressed_pj_size,
-      PROJECT_DECOMPRESS_DATA);
-  g_free (compressed_pj);
+  char * error_msg = NULL;
+  if (is_binary_project_file (path))
+    {
+      g_message (
+        "%s: converting binary project...",
+        __func__);
+      error_msg =
+        read_binary_project_file (
+          path, NULL, &yaml, false);
+    }
+  else
+    {
+      g_message (
+        "%s: decompressing project...", __func__);
+      size_t yaml_size;
+      error_msg =
+        project_decompress (
+          &yaml, &yaml_size,
+          PROJECT_DECOMPRESS_DATA,
+          path, 0,
+          PROJECT_DECOMPRESS_FILE);
+      if (!error_msg)
+        {
+          /* make string null-terminated */
+          yaml =
+            g_realloc (
+              yaml, yaml_size + sizeof (char));
+          yaml[yaml_size] = '\0';
+        }
+    }
   if (error_msg)
     {
       g_warning (
@@ -956,15 +1515,191 @@ project_get_existing_yaml (
       return NULL;
     }
 
-  /* make string null-terminated */
-  yaml =
-    g_realloc (
-      yaml, yaml_size + sizeof (char));
-  yaml[yaml_size] = '\0';
+  return yaml;
+}
+
+/**
+ * Trains a zstd dictionary from all the (YAML)
+ * project files under the given directory and
+ * writes it to the given path.
+ *
+ * The dictionary is used for compressing project
+ * files when set in the "compression-dictionary"
+ * setting.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_train_compression_dictionary (
+  const char * dir,
+  const char * dest)
+{
+  char ** files =
+    io_get_files_in_dir_ending_in (
+      dir, true, PROJECT_FILE, false);
+  if (!files)
+    {
+      return
+        g_strdup_printf (
+          _("No project files found in %s"), dir);
+    }
+
+  /* collect the decompressed projects as
+   * samples */
+  CompressionSink samples;
+  memset (&samples, 0, sizeof (CompressionSink));
+  GArray * sample_sizes =
+    g_array_new (false, false, sizeof (size_t));
+  for (int i = 0; files[i]; i++)
+    {
+      if (is_binary_project_file (files[i]))
+        continue;
+
+      char * yaml;
+      size_t yaml_size;
+      char * err_msg =
+        project_decompress (
+          &yaml, &yaml_size,
+          PROJECT_DECOMPRESS_DATA,
+          files[i], 0,
+          PROJECT_DECOMPRESS_FILE);
+      if (err_msg)
+        {
+          g_message (
+            "skipping %s: %s", files[i], err_msg);
+          g_free (err_msg);
+          continue;
+        }
+      compression_sink_write (
+        &samples, yaml, yaml_size);
+      g_array_append_val (sample_sizes, yaml_size);
+      free (yaml);
+    }
+  g_strfreev (files);
+
+  char * err_msg = NULL;
+  char * dict =
+    malloc (PROJECT_COMPRESSION_DICT_SIZE);
+  size_t dict_size =
+    ZDICT_trainFromBuffer (
+      dict, PROJECT_COMPRESSION_DICT_SIZE,
+      samples.data,
+      (size_t *) sample_sizes->data,
+      sample_sizes->len);
+  if (ZDICT_isError (dict_size))
+    {
+      err_msg =
+        g_strdup_printf (
+          _("Failed to train dictionary from %u "
+          "projects: %s"),
+          sample_sizes->len,
+          ZDICT_getErrorName (dict_size));
+    }
+  else
+    {
+      err_msg = io_write_file (dest, dict, dict_size);
+    }
+  free (dict);
+  free (samples.data);
+  g_array_free (sample_sizes, true);
+
+  return err_msg;
+}
+
+/**
+ * Returns the YAML representation of the saved
+ * project file.
+ *
+ * To be free'd with free().
+ *
+ * @param backup Whether to use the project file
+ *   from the most recent backup.
+ */
+char *
+project_get_existing_yaml (
+  Project * self,
+  bool      backup)
+{
+  char * path =
+    get_existing_project_file_path (self, backup);
+  if (!path)
+    return NULL;
+
+  char * yaml = get_yaml_from_project_file (path);
+  g_free (path);
 
   return yaml;
 }
 
+/**
+ * Deserializes the saved project file.
+ *
+ * The undo history of binary projects is loaded
+ * lazily.
+ *
+ * @param backup Whether to use the project file
+ *   from the most recent backup.
+ */
+static Project *
+deserialize_project_file (
+  Project * self,
+  bool      backup)
+{
+  char * path =
+    get_existing_project_file_path (self, backup);
+  if (!path)
+    return NULL;
+
+  Project * prj = NULL;
+  if (is_binary_project_file (path))
+    {
+      char * error_msg =
+        read_binary_project_file (
+          path, &prj, NULL, true);
+      g_free (path);
+      if (error_msg)
+        {
+          g_warning (
+            "Failed to load binary project: %s",
+            error_msg);
+          ui_show_error_message (
+            MAIN_WINDOW, error_msg);
+          g_free (error_msg);
+          return NULL;
+        }
+      return prj;
+    }
+
+  char * yaml = get_yaml_from_project_file (path);
+  g_free (path);
+  if (!yaml)
+    return NULL;
+
+  prj =
+    (Project *)
+    yaml_deserialize (yaml, &project_schema);
+  free (yaml);
+
+  return prj;
+}
+
+/**
+ * Idle callback to finish loading a lazily loaded
+ * undo history after the project is loaded.
+ */
+static int
+finish_loading_undo_history (
+  void * data)
+{
+  if (PROJECT && UNDO_MANAGER)
+    {
+      undo_manager_ensure_loaded (UNDO_MANAGER);
+      EVENTS_PUSH (ET_UNDO_REDO_ACTION_DONE, NULL);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
 /**
  * @param filename The filename to open. This will
  *   be the template in the case of template, or
@@ -998,7 +1733,15 @@ load (
         g_free (PROJECT->backup_dir);
       PROJECT->backup_dir =
         get_newer_backup (PROJECT);
-      if (PROJECT->backup_dir)
+      if (PROJECT->backup_dir && !ZRYTHM_HAVE_UI)
+        {
+          /* there is no one to ask */
+          g_message (
+            "ignoring newer backup %s",
+            PROJECT->backup_dir);
+          g_free_and_null (PROJECT->backup_dir);
+        }
+      else if (PROJECT->backup_dir)
         {
           g_message (
             "newer backup found %s",
@@ -1052,13 +1795,8 @@ load (
   bool use_backup = PROJECT->backup_dir != NULL;
   PROJECT->loading_from_backup = use_backup;
 
-  char * yaml =
-    project_get_existing_yaml (PROJECT, use_backup);
-
   Project * self =
-    (Project *)
-    yaml_deserialize (yaml, &project_schema);
-  free (yaml);
+    deserialize_project_file (PROJECT, use_backup);
   if (!self)
     {
       g_warning ("Failed to load project");
@@ -1076,9 +1814,16 @@ load (
             "different version of %s (%s). "
             "It may not work correctly."),
           PROGRAM_NAME, self->version);
-      ui_show_message_full (
-        GTK_WINDOW (MAIN_WINDOW),
-        GTK_MESSAGE_WARNING, str);
+      if (ZRYTHM_HAVE_UI)
+        {
+          ui_show_message_full (
+            GTK_WINDOW (MAIN_WINDOW),
+            GTK_MESSAGE_WARNING, "%s", str);
+        }
+      else
+        {
+          g_warning ("%s", str);
+        }
       g_free (str);
     }
   g_free (version);
@@ -1180,6 +1925,13 @@ load (
   if (self->undo_manager)
     {
       undo_manager_init_loaded (self->undo_manager);
+      if (self->undo_manager->loader &&
+          ZRYTHM_HAVE_UI)
+        {
+          g_idle_add (
+            (GSourceFunc)
+            finish_loading_undo_history, NULL);
+        }
     }
   else
     {
@@ -1312,7 +2064,14 @@ project_load (
   if (filename)
     {
       int ret = load (filename, is_template);
-      if (ret)
+      if (ret && !ZRYTHM_HAVE_UI)
+        {
+          g_warning (
+            "%s: failed to load project %s",
+            __func__, filename);
+          return -1;
+        }
+      else if (ret)
         {
           ui_show_error_message (
             NULL,
@@ -1558,46 +2317,80 @@ project_save_data_free (
 }
 
 /**
- * Thread that does the serialization and saving.
+ * Serializes the project to YAML and streams it
+ * compressed to the given file.
+ *
+ * @return Error message if error, otherwise NULL.
  */
-static void *
-serialize_project_thread (
-  ProjectSaveData * data)
+static char *
+write_compressed_yaml (
+  Project *    project,
+  const char * file_path)
 {
-  char * compressed_yaml;
-  char * error_msg;
-  size_t compressed_size;
-
   /* generate yaml */
   g_message ("serializing project to yaml...");
-  GError *err = NULL;
   gint64 time_before = g_get_monotonic_time ();
   char * yaml =
-    yaml_serialize (
-      data->project, &project_schema);
+    yaml_serialize (project, &project_schema);
   gint64 time_after = g_get_monotonic_time ();
   g_message (
     "time to serialize: %ldms",
     (long) (time_after - time_before) / 1000);
   if (!yaml)
     {
-      g_critical ("Failed to serialize project");
-      data->has_error = true;
-      goto serialize_end;
+      return
+        g_strdup (_("Failed to serialize project"));
     }
 
   /* compress */
-  error_msg =
+  char * dest = (char *) file_path;
+  char * error_msg =
     project_compress (
-      &compressed_yaml, &compressed_size,
-      PROJECT_COMPRESS_DATA,
+      &dest, NULL, PROJECT_COMPRESS_FILE,
       yaml, strlen (yaml) * sizeof (char),
       PROJECT_COMPRESS_DATA);
   g_free (yaml);
+
+  return error_msg;
+}
+
+/**
+ * Serializes the project to the binary format,
+ * streaming the sections to the given file.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+static char *
+write_binary (
+  Project *    project,
+  const char * file_path)
+{
+  g_message ("serializing binary project...");
+  return
+    project_binary_serialize_to_file (
+      project, file_path);
+}
+
+/**
+ * Thread that does the serialization and saving.
+ */
+static void *
+serialize_project_thread (
+  ProjectSaveData * data)
+{
+  g_message (
+    "%s: saving project file at %s...",
+    __func__, data->project_file_path);
+  char * error_msg =
+    data->binary ?
+      write_binary (
+        data->project, data->project_file_path) :
+      write_compressed_yaml (
+        data->project, data->project_file_path);
   if (error_msg)
     {
       g_critical (
-        "Failed to compress project file: %s",
+        "Failed to save project file: %s",
         error_msg);
       ui_show_error_message (
         MAIN_WINDOW, error_msg);
@@ -1606,23 +2399,6 @@ serialize_project_thread (
       goto serialize_end;
     }
 
-  /* set file contents */
-  g_message (
-    "%s: saving project file at %s...",
-    __func__, data->project_file_path);
-  g_file_set_contents (
-    data->project_file_path, compressed_yaml,
-    (gssize) compressed_size, &err);
-  free (compressed_yaml);
-  if (err != NULL)
-    {
-      g_critical (
-        "%s: Unable to write project file: %s",
-        __func__, err->message);
-      g_error_free (err);
-      data->has_error = true;
-    }
-
   g_message (
     "%s: successfully saved project", __func__);
 
@@ -1671,6 +2447,132 @@ project_idle_saved_cb (
   return G_SOURCE_REMOVE;
 }
 
+/**
+ * Data shared by the jobs saving plugin states.
+ */
+typedef struct PluginStatesSaveInfo
+{
+  bool          is_backup;
+  volatile gint num_errors;
+} PluginStatesSaveInfo;
+
+static void
+save_plugin_state_job (
+  Plugin *               pl,
+  PluginStatesSaveInfo * info)
+{
+  if (plugin_save_state (pl, info->is_backup))
+    {
+      g_atomic_int_inc (&info->num_errors);
+    }
+}
+
+/**
+ * Saves the states of all plugins in parallel.
+ *
+ * @return Non-zero if error.
+ */
+static int
+save_plugin_states (
+  Project *  self,
+  const bool is_backup)
+{
+  gint64 time_before = g_get_monotonic_time ();
+
+  /* collect the plugins and create their state
+   * dirs here, since this may modify the
+   * plugins */
+  GPtrArray * plugins = g_ptr_array_new ();
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      Track * track = TRACKLIST->tracks[i];
+      if (track->type == TRACK_TYPE_CHORD)
+        continue;
+
+      Channel * ch = track->channel;
+      if (!ch)
+        continue;
+
+      for (int j = 0; j < STRIP_SIZE * 2 + 1; j++)
+        {
+          Plugin * pl;
+          if (j < STRIP_SIZE)
+            pl = ch->midi_fx[j];
+          else if (j == STRIP_SIZE)
+            pl = ch->instrument;
+          else
+            pl = ch->inserts[j - (STRIP_SIZE + 1)];
+
+          if (!pl)
+            continue;
+
+          plugin_ensure_state_dir (pl, is_backup);
+
+          /* the engine keeps running, so take the
+           * control values of all plugins at the
+           * same time */
+          plugin_snapshot_control_values (pl);
+          g_ptr_array_add (plugins, pl);
+        }
+    }
+
+  PluginStatesSaveInfo info = {
+    .is_backup = is_backup,
+    .num_errors = 0,
+  };
+  GError * err = NULL;
+  GThreadPool * pool =
+    g_thread_pool_new (
+      (GFunc) save_plugin_state_job, &info,
+      (int) g_get_num_processors (), false, &err);
+  for (guint i = 0; i < plugins->len; i++)
+    {
+      Plugin * pl = g_ptr_array_index (plugins, i);
+      if (pool)
+        {
+          g_thread_pool_push (pool, pl, NULL);
+        }
+      else
+        {
+          save_plugin_state_job (pl, &info);
+        }
+    }
+  if (pool)
+    {
+      /* wait for all jobs to finish */
+      g_thread_pool_free (pool, false, true);
+    }
+  else
+    {
+      g_warning (
+        "failed to create thread pool: %s",
+        err->message);
+      g_error_free (err);
+    }
+  for (guint i = 0; i < plugins->len; i++)
+    {
+      plugin_clear_control_snapshot (
+        g_ptr_array_index (plugins, i));
+    }
+
+  g_message (
+    "time to save %u plugin states: %ldms",
+    plugins->len,
+    (long)
+    (g_get_monotonic_time () - time_before) / 1000);
+  g_ptr_array_unref (plugins);
+
+  if (info.num_errors > 0)
+    {
+      g_warning (
+        "failed to save %d plugin states",
+        info.num_errors);
+      return -1;
+    }
+
+  return 0;
+}
+
 /**
  * Saves the project to a project file in the
  * given dir.
@@ -1692,15 +2594,17 @@ project_save (
   const bool   show_notification,
   const bool   async)
 {
-  /* pause engine */
-  EngineState state;
-  bool engine_paused = false;
-  if (AUDIO_ENGINE->activated)
-    {
-      engine_wait_for_pause (
-        AUDIO_ENGINE, &state, F_NO_FORCE);
-      engine_paused = true;
-    }
+  /* the engine is not paused - plugin states are
+   * captured through their thread-safe state
+   * interfaces with the control values from the
+   * start of the save, and project changes that
+   * come from the engine wait until serialization
+   * is done */
+  int ret = 0;
+  ProjectSaveData * data = NULL;
+
+  /* the undo history is serialized too */
+  undo_manager_ensure_loaded (self->undo_manager);
 
   if (async)
     {
@@ -1709,8 +2613,6 @@ project_save (
 
   project_validate (self);
 
-  int i, j;
-
   char * dir = g_strdup (_dir);
 
   /* set the dir and create it if it doesn't
@@ -1743,7 +2645,13 @@ project_save (
   tmp = \
     project_get_path ( \
       self, PROJECT_PATH_##_path, is_backup); \
-  g_return_val_if_fail (tmp, -1); \
+  if (!tmp) \
+    { \
+      g_critical ( \
+        "failed to get path for %s", #_path); \
+      ret = -1; \
+      goto save_failed; \
+    } \
   io_mkdir (tmp); \
   g_free_and_null (tmp)
 
@@ -1754,57 +2662,14 @@ project_save (
   MK_PROJECT_DIR (PLUGIN_EXT_COPIES);
   MK_PROJECT_DIR (PLUGIN_EXT_LINKS);
 
-  /* write plugin states, prepare channels for
-   * serialization, */
-  Track * track;
-  Channel * ch;
-  Plugin * pl;
-  for (i = 0; i < TRACKLIST->num_tracks; i++)
+  /* write plugin states */
+  if (save_plugin_states (self, is_backup) != 0)
     {
-      track = TRACKLIST->tracks[i];
-      if (track->type == TRACK_TYPE_CHORD)
-        continue;
-
-      ch = track->channel;
-      if (!ch)
-        continue;
-
-      for (j = 0; j < STRIP_SIZE * 2 + 1; j++)
-        {
-          if (j < STRIP_SIZE)
-            pl = ch->midi_fx[j];
-          else if (j == STRIP_SIZE)
-            pl = ch->instrument;
-          else
-            pl = ch->inserts[j - (STRIP_SIZE + 1)];
-
-          if (!pl)
-            continue;
-
-          /* save state */
-#ifdef HAVE_CARLA
-          if (pl->setting->open_with_carla)
-            {
-              carla_native_plugin_save_state (
-                pl->carla, is_backup, NULL);
-            }
-          else
-            {
-#endif
-              switch (pl->setting->descr->protocol)
-                {
-                case PROT_LV2:
-                  lv2_state_save_to_file (
-                    pl->lv2, is_backup);
-                  break;
-                default:
-                  g_warn_if_reached ();
-                  break;
-                }
-#ifdef HAVE_CARLA
-            }
-#endif
-        }
+      ui_show_error_message (
+        MAIN_WINDOW,
+        _("Failed to save the plugin states"));
+      ret = -1;
+      goto save_failed;
     }
 
   /* write the pool */
@@ -1906,14 +2771,22 @@ project_save (
         }
     }
 
-  ProjectSaveData * data =
-    object_new (ProjectSaveData);
+  data = object_new (ProjectSaveData);
   data->project_file_path =
     project_get_path (
       self, PROJECT_PATH_PROJECT_FILE, is_backup);
   data->show_notification = show_notification;
   data->is_backup = is_backup;
+  data->binary =
+    ZRYTHM_TESTING ?
+      false :
+      g_settings_get_boolean (
+        S_P_PROJECTS_GENERAL, "binary-format");
   data->project = PROJECT;
+
+  /* hold off changes from engine events while
+   * serializing */
+  g_atomic_int_set (&self->saving, 1);
   if (async)
     {
       g_thread_new (
@@ -1952,14 +2825,24 @@ project_save (
       serialize_project_thread (data);
       project_idle_saved_cb (data);
     }
+  g_atomic_int_set (&self->saving, 0);
+
+  if (data->has_error)
+    {
+      ret = -1;
+    }
 
   object_free_w_func_and_null (
     project_save_data_free, data);
 
-  if (engine_paused)
+  return ret;
+
+save_failed:
+  /* the serialization thread was not started */
+  if (async)
     {
-      engine_resume (AUDIO_ENGINE, &state);
+      zix_sem_post (&UNDO_MANAGER->action_sem);
     }
 
-  RETURN_OK;
+  return ret;
 }
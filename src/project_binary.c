@@ -0,0 +1,1075 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "actions/undo_manager.h"
+#include "audio/engine.h"
+#include "audio/pool.h"
+#include "audio/tracklist.h"
+#include "project.h"
+#include "project_binary.h"
+#include "utils/objects.h"
+#include "utils/yaml.h"
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#define HEADER_SIZE 12
+#define INDEX_ENTRY_SIZE 48
+
+typedef struct SectionInfo
+{
+  const char *                 name;
+  const cyaml_schema_value_t * schema;
+  int                          schema_version;
+  bool                         required;
+} SectionInfo;
+
+/* the project and engine sections use copies of
+ * the project and engine schemas without the parts
+ * that go in their own sections (see
+ * init_section_schemas()) */
+static cyaml_schema_field_t
+project_section_fields_schema[
+  G_N_ELEMENTS (project_fields_schema)];
+static cyaml_schema_value_t project_section_schema;
+static cyaml_schema_field_t
+engine_section_fields_schema[
+  G_N_ELEMENTS (engine_fields_schema)];
+static cyaml_schema_value_t engine_section_schema;
+
+static const SectionInfo section_infos[] = {
+  [PROJECT_BINARY_SECTION_PROJECT] = {
+    "project", &project_section_schema,
+    PROJECT_SCHEMA_VERSION, true },
+  [PROJECT_BINARY_SECTION_ENGINE] = {
+    "engine", &engine_section_schema,
+    AUDIO_ENGINE_SCHEMA_VERSION, true },
+  [PROJECT_BINARY_SECTION_POOL] = {
+    "pool", &audio_pool_schema,
+    AUDIO_POOL_SCHEMA_VERSION, true },
+  [PROJECT_BINARY_SECTION_TRACKLIST] = {
+    "tracklist", &tracklist_schema,
+    PROJECT_SCHEMA_VERSION, true },
+  [PROJECT_BINARY_SECTION_UNDO_HISTORY] = {
+    "undo-history", &undo_manager_schema,
+    PROJECT_SCHEMA_VERSION, false },
+};
+
+/**
+ * Work for encoding or decoding a section.
+ */
+typedef struct SectionJob
+{
+  const SectionInfo * info;
+
+  /** Object to serialize, or deserialized
+   * object. */
+  void *              obj;
+
+  /** Compressed payload. */
+  char *              data;
+  size_t              size;
+
+  /** Offset of the payload in the container. */
+  guint64             offset;
+
+  /** Schema version of the payload. */
+  int                 schema_version;
+
+  char *              error_msg;
+
+  GThread *           thread;
+} SectionJob;
+
+/**
+ * Copies the fields of the given schema, skipping
+ * the fields with the given keys.
+ *
+ * @param skip_keys NULL-terminated array of keys.
+ */
+static void
+copy_fields_schema (
+  cyaml_schema_field_t *       dest,
+  const cyaml_schema_field_t * src,
+  const char **                skip_keys)
+{
+  int count = 0;
+  for (int i = 0; src[i].key; i++)
+    {
+      if (g_strv_contains (skip_keys, src[i].key))
+        continue;
+
+      dest[count++] = src[i];
+    }
+
+  cyaml_schema_field_t end = CYAML_FIELD_END;
+  dest[count] = end;
+}
+
+static void *
+init_section_schemas_once (
+  void * data)
+{
+  const char * project_skip_keys[] = {
+    "tracklist", "audio_engine", "undo_manager",
+    NULL };
+  copy_fields_schema (
+    project_section_fields_schema,
+    project_fields_schema, project_skip_keys);
+  project_section_schema = project_schema;
+  project_section_schema.mapping.fields =
+    project_section_fields_schema;
+
+  const char * engine_skip_keys[] = {
+    "pool", NULL };
+  copy_fields_schema (
+    engine_section_fields_schema,
+    engine_fields_schema, engine_skip_keys);
+  engine_section_schema = engine_schema;
+  engine_section_schema.mapping.fields =
+    engine_section_fields_schema;
+
+  return NULL;
+}
+
+/**
+ * Sets up the schemas of the project and engine
+ * sections.
+ *
+ * This keeps the tracklist, engine and pool
+ * mandatory in YAML projects.
+ */
+static void
+init_section_schemas (void)
+{
+  static GOnce init_once = G_ONCE_INIT;
+  g_once (
+    &init_once, init_section_schemas_once, NULL);
+}
+
+/**
+ * Destination of a container being written.
+ */
+typedef struct ContainerWriter
+{
+  /** File to write to, or NULL to append to
+   * @ref ContainerWriter.arr. */
+  FILE *       file;
+  GByteArray * arr;
+
+  /** Whether a write to the file failed. */
+  bool         failed;
+} ContainerWriter;
+
+static void
+write_bytes (
+  ContainerWriter * self,
+  const void *      src,
+  size_t            size)
+{
+  if (self->failed)
+    return;
+
+  if (self->file)
+    {
+      if (fwrite (src, 1, size, self->file) != size)
+        self->failed = true;
+    }
+  else
+    {
+      g_byte_array_append (
+        self->arr, (const guint8 *) src,
+        (guint) size);
+    }
+}
+
+static void
+write_u32 (
+  ContainerWriter * self,
+  guint32           val)
+{
+  val = GUINT32_TO_LE (val);
+  write_bytes (self, &val, sizeof (val));
+}
+
+static void
+write_u64 (
+  ContainerWriter * self,
+  guint64           val)
+{
+  val = GUINT64_TO_LE (val);
+  write_bytes (self, &val, sizeof (val));
+}
+
+static guint32
+read_u32 (
+  const char * src)
+{
+  guint32 val;
+  memcpy (&val, src, sizeof (val));
+  return GUINT32_FROM_LE (val);
+}
+
+static guint64
+read_u64 (
+  const char * src)
+{
+  guint64 val;
+  memcpy (&val, src, sizeof (val));
+  return GUINT64_FROM_LE (val);
+}
+
+static void *
+encode_section_thread (
+  SectionJob * job)
+{
+  char * yaml =
+    yaml_serialize (job->obj, job->info->schema);
+  if (!yaml)
+    {
+      job->error_msg =
+        g_strdup_printf (
+          _("Failed to serialize section %s"),
+          job->info->name);
+      return NULL;
+    }
+
+  job->error_msg =
+    project_compress (
+      &job->data, &job->size,
+      PROJECT_COMPRESS_DATA,
+      yaml, strlen (yaml),
+      PROJECT_COMPRESS_DATA);
+  g_free (yaml);
+
+  return NULL;
+}
+
+static void *
+decode_section_thread (
+  SectionJob * job)
+{
+  char * yaml = NULL;
+  size_t yaml_size;
+  job->error_msg =
+    project_decompress (
+      &yaml, &yaml_size,
+      PROJECT_DECOMPRESS_DATA,
+      job->data, job->size,
+      PROJECT_DECOMPRESS_DATA);
+  if (job->error_msg)
+    return NULL;
+
+  /* make string null-terminated */
+  yaml =
+    g_realloc (yaml, yaml_size + sizeof (char));
+  yaml[yaml_size] = '\0';
+
+  job->obj =
+    yaml_deserialize (yaml, job->info->schema);
+  free (yaml);
+  if (!job->obj)
+    {
+      job->error_msg =
+        g_strdup_printf (
+          _("Failed to deserialize section %s"),
+          job->info->name);
+    }
+
+  return job->obj;
+}
+
+/**
+ * Decodes the undo history in the background.
+ *
+ * Takes ownership of the job and returns the
+ * deserialized UndoManager.
+ */
+static void *
+decode_undo_history_thread (
+  SectionJob * job)
+{
+  gint64 time_before = g_get_monotonic_time ();
+  void * obj = decode_section_thread (job);
+  if (job->error_msg)
+    {
+      g_warning (
+        "failed to load undo history: %s",
+        job->error_msg);
+      g_free (job->error_msg);
+    }
+  g_message (
+    "time to decode undo history: %ldms",
+    (long)
+    (g_get_monotonic_time () - time_before) / 1000);
+
+  g_free (job->data);
+  object_zero_and_free (job);
+
+  return obj;
+}
+
+/**
+ * Returns whether the given data is a binary
+ * project.
+ */
+bool
+project_binary_is_binary (
+  const char * data,
+  size_t       size)
+{
+  return
+    size >= HEADER_SIZE &&
+    memcmp (
+      data, PROJECT_BINARY_MAGIC,
+      strlen (PROJECT_BINARY_MAGIC)) == 0;
+}
+
+/**
+ * Serializes the project into the given writer.
+ *
+ * Each payload is freed as soon as it is
+ * written.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+static char *
+serialize (
+  Project *         project,
+  ContainerWriter * writer)
+{
+  g_return_val_if_fail (
+    project && project->tracklist &&
+    project->audio_engine &&
+    project->audio_engine->pool,
+    g_strdup ("invalid project"));
+
+  init_section_schemas ();
+
+  gint64 time_before = g_get_monotonic_time ();
+
+  /* shallow copies without the parts that go in
+   * their own sections */
+  Project * project_part = object_new (Project);
+  memcpy (project_part, project, sizeof (Project));
+  project_part->tracklist = NULL;
+  project_part->audio_engine = NULL;
+  project_part->undo_manager = NULL;
+  AudioEngine * engine_part =
+    object_new (AudioEngine);
+  memcpy (
+    engine_part, project->audio_engine,
+    sizeof (AudioEngine));
+  engine_part->pool = NULL;
+
+  SectionJob jobs[NUM_PROJECT_BINARY_SECTIONS];
+  memset (jobs, 0, sizeof (jobs));
+  jobs[PROJECT_BINARY_SECTION_PROJECT].obj =
+    project_part;
+  jobs[PROJECT_BINARY_SECTION_ENGINE].obj =
+    engine_part;
+  jobs[PROJECT_BINARY_SECTION_POOL].obj =
+    project->audio_engine->pool;
+  jobs[PROJECT_BINARY_SECTION_TRACKLIST].obj =
+    project->tracklist;
+  jobs[PROJECT_BINARY_SECTION_UNDO_HISTORY].obj =
+    project->undo_manager;
+
+  for (int i = 0; i < NUM_PROJECT_BINARY_SECTIONS;
+       i++)
+    {
+      SectionJob * job = &jobs[i];
+      if (!job->obj)
+        continue;
+
+      job->info = &section_infos[i];
+      job->thread =
+        g_thread_new (
+          "encode_section",
+          (GThreadFunc) encode_section_thread, job);
+    }
+
+  char * error_msg = NULL;
+  int num_sections = 0;
+  for (int i = 0; i < NUM_PROJECT_BINARY_SECTIONS;
+       i++)
+    {
+      SectionJob * job = &jobs[i];
+      if (!job->thread)
+        continue;
+
+      g_thread_join (job->thread);
+      if (job->error_msg && !error_msg)
+        {
+          error_msg = job->error_msg;
+        }
+      else if (job->error_msg)
+        {
+          g_free (job->error_msg);
+        }
+      num_sections++;
+    }
+  object_zero_and_free (project_part);
+  object_zero_and_free (engine_part);
+
+  /* write the header, index and payloads */
+  if (!error_msg)
+    {
+      write_bytes (
+        writer, PROJECT_BINARY_MAGIC,
+        strlen (PROJECT_BINARY_MAGIC));
+      write_u32 (
+        writer, PROJECT_BINARY_FORMAT_VERSION);
+      write_u32 (writer, (guint32) num_sections);
+
+      guint64 offset =
+        HEADER_SIZE +
+        (guint64) num_sections * INDEX_ENTRY_SIZE;
+      for (int i = 0;
+           i < NUM_PROJECT_BINARY_SECTIONS; i++)
+        {
+          SectionJob * job = &jobs[i];
+          if (!job->thread)
+            continue;
+
+          char name[PROJECT_BINARY_SECTION_NAME_LEN];
+          memset (name, 0, sizeof (name));
+          strcpy (name, job->info->name);
+          write_bytes (writer, name, sizeof (name));
+          write_u32 (
+            writer,
+            (guint32) job->info->schema_version);
+          write_u32 (writer, 0);
+          write_u64 (writer, offset);
+          write_u64 (writer, job->size);
+          offset += job->size;
+        }
+
+      for (int i = 0;
+           i < NUM_PROJECT_BINARY_SECTIONS; i++)
+        {
+          SectionJob * job = &jobs[i];
+          if (!job->thread)
+            continue;
+
+          write_bytes (writer, job->data, job->size);
+          free (job->data);
+          job->data = NULL;
+        }
+
+      if (writer->failed)
+        {
+          error_msg =
+            g_strdup (
+              _("Failed to write project"));
+        }
+    }
+
+  for (int i = 0; i < NUM_PROJECT_BINARY_SECTIONS;
+       i++)
+    {
+      free (jobs[i].data);
+    }
+
+  if (error_msg)
+    return error_msg;
+
+  g_message (
+    "time to serialize %d sections: %ldms",
+    num_sections,
+    (long)
+    (g_get_monotonic_time () - time_before) / 1000);
+
+  return NULL;
+}
+
+/**
+ * Serializes the project into a new binary
+ * container.
+ *
+ * The sections are serialized in parallel.
+ *
+ * @param[out] data Pointer to a location to
+ *   allocate memory.
+ * @param[out] size Pointer to a location to store
+ *   the size of the allocated memory.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_binary_serialize (
+  Project * project,
+  char **   data,
+  size_t *  size)
+{
+  ContainerWriter writer;
+  memset (&writer, 0, sizeof (ContainerWriter));
+  writer.arr = g_byte_array_new ();
+  char * error_msg = serialize (project, &writer);
+  if (error_msg)
+    {
+      g_byte_array_free (writer.arr, true);
+      return error_msg;
+    }
+
+  *size = writer.arr->len;
+  *data =
+    (char *) g_byte_array_free (writer.arr, false);
+
+  return NULL;
+}
+
+/**
+ * Serializes the project into a binary container
+ * written directly to the given file.
+ *
+ * Unlike project_binary_serialize(), the
+ * container is never held in memory in one piece.
+ * The file is written to a temporary file first so
+ * that an existing file is not left half-written.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_binary_serialize_to_file (
+  Project *    project,
+  const char * path)
+{
+  char * tmp_path =
+    g_strdup_printf ("%s.tmp", path);
+  ContainerWriter writer;
+  memset (&writer, 0, sizeof (ContainerWriter));
+  writer.file = g_fopen (tmp_path, "wb");
+  if (!writer.file)
+    {
+      char * error_msg =
+        g_strdup_printf (
+          _("Failed to open file: %s"), tmp_path);
+      g_free (tmp_path);
+      return error_msg;
+    }
+
+  char * error_msg = serialize (project, &writer);
+  if (fclose (writer.file) != 0 && !error_msg)
+    {
+      error_msg =
+        g_strdup_printf (
+          _("Failed to write file: %s"), tmp_path);
+    }
+  if (!error_msg && g_rename (tmp_path, path) != 0)
+    {
+      error_msg =
+        g_strdup_printf (
+          _("Failed to write file: %s"), path);
+    }
+  if (error_msg)
+    {
+      g_unlink (tmp_path);
+    }
+  g_free (tmp_path);
+
+  return error_msg;
+}
+
+/**
+ * Checks the header of a container.
+ *
+ * @param size Size of the whole container.
+ * @param[out] num_sections Number of sections in
+ *   the index.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+static char *
+check_header (
+  const char * header,
+  size_t       size,
+  guint32 *    num_sections)
+{
+  if (!project_binary_is_binary (header, size))
+    {
+      return
+        g_strdup (_("Not a binary project"));
+    }
+
+  guint32 format_version =
+    read_u32 (&header[4]);
+  if (format_version >
+        PROJECT_BINARY_FORMAT_VERSION)
+    {
+      return
+        g_strdup_printf (
+          _("The project was saved with a newer "
+          "format version (%u)"),
+          format_version);
+    }
+
+  *num_sections = read_u32 (&header[8]);
+  if ((guint64) *num_sections * INDEX_ENTRY_SIZE >
+        size - HEADER_SIZE)
+    {
+      return g_strdup (_("Invalid project index"));
+    }
+
+  return NULL;
+}
+
+/**
+ * Reads the index into the jobs of the known
+ * sections.
+ *
+ * @param size Size of the whole container.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+static char *
+read_index (
+  const char * index,
+  guint32      num_sections,
+  size_t       size,
+  SectionJob * jobs)
+{
+  for (guint32 i = 0; i < num_sections; i++)
+    {
+      const char * entry =
+        &index[i * INDEX_ENTRY_SIZE];
+      char name[PROJECT_BINARY_SECTION_NAME_LEN];
+      memcpy (name, entry, sizeof (name));
+      name[PROJECT_BINARY_SECTION_NAME_LEN - 1] =
+        '\0';
+      int schema_version =
+        (int)
+        read_u32 (
+          &entry[PROJECT_BINARY_SECTION_NAME_LEN]);
+      guint64 offset =
+        read_u64 (
+          &entry[PROJECT_BINARY_SECTION_NAME_LEN + 8]);
+      guint64 section_size =
+        read_u64 (
+          &entry[PROJECT_BINARY_SECTION_NAME_LEN + 16]);
+      if (offset > size || section_size > size - offset)
+        {
+          return
+            g_strdup_printf (
+              _("Invalid project section %s"), name);
+        }
+
+      /* skip sections from newer versions */
+      SectionJob * job = NULL;
+      for (int j = 0;
+           j < NUM_PROJECT_BINARY_SECTIONS; j++)
+        {
+          if (g_str_equal (
+                section_infos[j].name, name))
+            {
+              job = &jobs[j];
+              job->info = &section_infos[j];
+              break;
+            }
+        }
+      if (!job)
+        {
+          g_message (
+            "skipping unknown section %s", name);
+          continue;
+        }
+
+      if (schema_version >
+            job->info->schema_version)
+        {
+          return
+            g_strdup_printf (
+              _("The project section %s was saved "
+              "with a newer schema version (%d)"),
+              name, schema_version);
+        }
+
+      job->offset = offset;
+      job->size = (size_t) section_size;
+      job->schema_version = schema_version;
+    }
+
+  for (int i = 0; i < NUM_PROJECT_BINARY_SECTIONS;
+       i++)
+    {
+      if (section_infos[i].required && !jobs[i].info)
+        {
+          return
+            g_strdup_printf (
+              _("Missing project section %s"),
+              section_infos[i].name);
+        }
+    }
+
+  return NULL;
+}
+
+/**
+ * Decodes the payloads of the jobs in parallel and
+ * puts the project together.
+ *
+ * @param owns_data Whether the payloads were
+ *   allocated for the jobs and must be freed.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+static char *
+decode_sections (
+  SectionJob * jobs,
+  bool         owns_data,
+  bool         lazy_undo_history,
+  Project **   project)
+{
+  gint64 time_before = g_get_monotonic_time ();
+
+  /* decode the sections in parallel */
+  SectionJob * undo_job =
+    &jobs[PROJECT_BINARY_SECTION_UNDO_HISTORY];
+  for (int i = 0; i < NUM_PROJECT_BINARY_SECTIONS;
+       i++)
+    {
+      SectionJob * job = &jobs[i];
+      if (!job->data ||
+          (lazy_undo_history && job == undo_job))
+        continue;
+
+      job->thread =
+        g_thread_new (
+          "decode_section",
+          (GThreadFunc) decode_section_thread, job);
+    }
+
+  char * error_msg = NULL;
+  for (int i = 0; i < NUM_PROJECT_BINARY_SECTIONS;
+       i++)
+    {
+      SectionJob * job = &jobs[i];
+      if (!job->thread)
+        continue;
+
+      g_thread_join (job->thread);
+      if (job->error_msg && !error_msg)
+        {
+          error_msg = job->error_msg;
+        }
+      else if (job->error_msg)
+        {
+          g_free (job->error_msg);
+        }
+    }
+
+  if (error_msg)
+    {
+      for (int i = 0;
+           i < NUM_PROJECT_BINARY_SECTIONS; i++)
+        {
+          SectionJob * job = &jobs[i];
+          if (job->obj)
+            {
+              yaml_free (job->obj, job->info->schema);
+            }
+          if (owns_data)
+            {
+              g_free (job->data);
+            }
+        }
+      return error_msg;
+    }
+
+  g_message (
+    "time to decode sections: %ldms",
+    (long)
+    (g_get_monotonic_time () - time_before) / 1000);
+
+  /* put the sections together */
+  Project * self =
+    jobs[PROJECT_BINARY_SECTION_PROJECT].obj;
+  self->tracklist =
+    jobs[PROJECT_BINARY_SECTION_TRACKLIST].obj;
+  self->audio_engine =
+    jobs[PROJECT_BINARY_SECTION_ENGINE].obj;
+  self->audio_engine->pool =
+    jobs[PROJECT_BINARY_SECTION_POOL].obj;
+  if (undo_job->obj)
+    {
+      self->undo_manager = undo_job->obj;
+    }
+  else if (undo_job->data && lazy_undo_history)
+    {
+      /* decode the undo history in the
+       * background */
+      SectionJob * job = object_new (SectionJob);
+      *job = *undo_job;
+      if (owns_data)
+        {
+          undo_job->data = NULL;
+        }
+      else
+        {
+          job->data = g_malloc (job->size);
+          memcpy (
+            job->data, undo_job->data, job->size);
+        }
+
+      self->undo_manager = object_new (UndoManager);
+      self->undo_manager->loader =
+        g_thread_new (
+          "decode_undo_history",
+          (GThreadFunc) decode_undo_history_thread,
+          job);
+    }
+
+  if (owns_data)
+    {
+      for (int i = 0;
+           i < NUM_PROJECT_BINARY_SECTIONS; i++)
+        {
+          g_free (jobs[i].data);
+        }
+    }
+
+  *project = self;
+
+  return NULL;
+}
+
+/**
+ * Deserializes a project from a binary container.
+ *
+ * The sections are decoded in parallel.
+ *
+ * @param[out] project Pointer to a location to
+ *   store the new project.
+ * @param lazy_undo_history Whether to keep decoding
+ *   the undo history in the background and only
+ *   wait for it when it is first needed (see
+ *   undo_manager_ensure_loaded()). Otherwise,
+ *   the undo history is decoded before returning.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_binary_deserialize (
+  Project **   project,
+  const char * data,
+  size_t       size,
+  bool         lazy_undo_history)
+{
+  init_section_schemas ();
+
+  guint32 num_sections;
+  char * error_msg =
+    check_header (data, size, &num_sections);
+  if (error_msg)
+    return error_msg;
+
+  SectionJob jobs[NUM_PROJECT_BINARY_SECTIONS];
+  memset (jobs, 0, sizeof (jobs));
+  error_msg =
+    read_index (
+      &data[HEADER_SIZE], num_sections, size, jobs);
+  if (error_msg)
+    return error_msg;
+
+  for (int i = 0; i < NUM_PROJECT_BINARY_SECTIONS;
+       i++)
+    {
+      SectionJob * job = &jobs[i];
+      if (job->info)
+        job->data = (char *) &data[job->offset];
+    }
+
+  return
+    decode_sections (
+      jobs, false, lazy_undo_history, project);
+}
+
+/**
+ * Deserializes a project from a binary container
+ * file.
+ *
+ * Only the index and the payloads of the known
+ * sections are read, each into its own buffer, so
+ * the file is never held in memory in one piece.
+ *
+ * @see project_binary_deserialize().
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_binary_deserialize_from_file (
+  Project **   project,
+  const char * path,
+  bool         lazy_undo_history)
+{
+  init_section_schemas ();
+
+  FILE * file = g_fopen (path, "rb");
+  GStatBuf st;
+  if (!file || g_stat (path, &st) != 0)
+    {
+      if (file)
+        fclose (file);
+      return
+        g_strdup_printf (
+          _("Failed to open file: %s"), path);
+    }
+  size_t size = (size_t) st.st_size;
+
+  char header[HEADER_SIZE];
+  size_t header_size =
+    fread (header, 1, HEADER_SIZE, file);
+  guint32 num_sections;
+  char * error_msg =
+    check_header (
+      header,
+      header_size == HEADER_SIZE ?
+        size : header_size,
+      &num_sections);
+  if (error_msg)
+    {
+      fclose (file);
+      return error_msg;
+    }
+
+  SectionJob jobs[NUM_PROJECT_BINARY_SECTIONS];
+  memset (jobs, 0, sizeof (jobs));
+  size_t index_size =
+    (size_t) num_sections * INDEX_ENTRY_SIZE;
+  char * index = g_malloc (MAX (index_size, 1));
+  if (fread (index, 1, index_size, file) !=
+        index_size)
+    {
+      error_msg =
+        g_strdup (_("Project file is truncated"));
+    }
+  else
+    {
+      error_msg =
+        read_index (index, num_sections, size, jobs);
+    }
+  g_free (index);
+
+  for (int i = 0;
+       i < NUM_PROJECT_BINARY_SECTIONS && !error_msg;
+       i++)
+    {
+      SectionJob * job = &jobs[i];
+      if (!job->info)
+        continue;
+
+      job->data = g_malloc (MAX (job->size, 1));
+      if (fseek (file, (long) job->offset, SEEK_SET)
+            != 0 ||
+          fread (job->data, 1, job->size, file) !=
+            job->size)
+        {
+          error_msg =
+            g_strdup (
+              _("Project file is truncated"));
+        }
+    }
+  fclose (file);
+
+  if (error_msg)
+    {
+      for (int i = 0;
+           i < NUM_PROJECT_BINARY_SECTIONS; i++)
+        {
+          g_free (jobs[i].data);
+        }
+      return error_msg;
+    }
+
+  return
+    decode_sections (
+      jobs, true, lazy_undo_history, project);
+}
+
+/**
+ * Serializes the deserialized project to YAML and
+ * frees it.
+ */
+static char *
+project_to_yaml (
+  Project * project,
+  char **   yaml)
+{
+  *yaml = yaml_serialize (project, &project_schema);
+  yaml_free (project, &project_schema);
+  if (!*yaml)
+    {
+      return
+        g_strdup (_("Failed to serialize project"));
+    }
+
+  return NULL;
+}
+
+/**
+ * Converts a binary container into the YAML
+ * representation of the project.
+ *
+ * @param[out] yaml Pointer to a location to store
+ *   the new null-terminated YAML string.
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_binary_to_yaml (
+  char **      yaml,
+  const char * data,
+  size_t       size)
+{
+  Project * project = NULL;
+  char * error_msg =
+    project_binary_deserialize (
+      &project, data, size, false);
+  if (error_msg)
+    return error_msg;
+
+  return project_to_yaml (project, yaml);
+}
+
+/**
+ * Converts a binary container file into the YAML
+ * representation of the project.
+ *
+ * @see project_binary_to_yaml().
+ *
+ * @return Error message if error, otherwise NULL.
+ */
+char *
+project_binary_file_to_yaml (
+  char **      yaml,
+  const char * path)
+{
+  Project * project = NULL;
+  char * error_msg =
+    project_binary_deserialize_from_file (
+      &project, path, false);
+  if (error_msg)
+    return error_msg;
+
+  return project_to_yaml (project, yaml);
+}
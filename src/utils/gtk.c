@@ -17,9 +17,12 @@
  * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <stdlib.h>
+
 #include "gui/accel.h"
 #include "utils/gtk.h"
 #include "utils/io.h"
+#include "utils/objects.h"
 #include "utils/resources.h"
 #include "utils/string.h"
 #include "utils/strv_builder.h"
@@ -257,6 +260,255 @@ z_gtk_overlay_add_if_not_exists (
   gtk_overlay_add_overlay (overlay, widget);
 }
 
+/**
+ * Makes the children of the box match the given
+ * widgets, in the given order.
+ *
+ * Only the children that differ are removed,
+ * added or moved, so the widgets that stay in the
+ * box are not unrealized and realized again.
+ *
+ * @param widgets Widgets to show. Widgets inside
+ *   another container are moved to this box.
+ * @param expand Expand value to use when packing
+ *   new widgets.
+ * @param fill Fill value to use when packing new
+ *   widgets.
+ */
+void
+z_gtk_box_sync_children (
+  GtkBox *     box,
+  GtkWidget ** widgets,
+  int          num_widgets,
+  bool         expand,
+  bool         fill)
+{
+  GHashTable * wanted =
+    g_hash_table_new (NULL, NULL);
+  for (int i = 0; i < num_widgets; i++)
+    {
+      g_hash_table_add (wanted, widgets[i]);
+    }
+
+  /* remove children that are no longer wanted */
+  GList * children =
+    gtk_container_get_children (
+      GTK_CONTAINER (box));
+  for (GList * iter = children; iter;
+       iter = g_list_next (iter))
+    {
+      if (!g_hash_table_contains (
+             wanted, iter->data))
+        {
+          gtk_container_remove (
+            GTK_CONTAINER (box),
+            GTK_WIDGET (iter->data));
+        }
+    }
+  g_list_free (children);
+  g_hash_table_unref (wanted);
+
+  /* add new children */
+  for (int i = 0; i < num_widgets; i++)
+    {
+      GtkWidget * widget = widgets[i];
+      GtkWidget * parent =
+        gtk_widget_get_parent (widget);
+      if (parent == GTK_WIDGET (box))
+        continue;
+
+      g_object_ref (widget);
+      if (parent)
+        {
+          gtk_container_remove (
+            GTK_CONTAINER (parent), widget);
+        }
+      gtk_box_pack_start (
+        box, widget, expand, fill, 0);
+      g_object_unref (widget);
+    }
+
+  /* move the children that are not in the
+   * right position */
+  children =
+    gtk_container_get_children (
+      GTK_CONTAINER (box));
+  GList * iter = children;
+  for (int i = 0; i < num_widgets; i++)
+    {
+      GtkWidget * widget = widgets[i];
+      if (iter && iter->data == widget)
+        {
+          iter = g_list_next (iter);
+          continue;
+        }
+
+      gtk_box_reorder_child (box, widget, i);
+
+      /* mirror the move in the list */
+      children = g_list_remove (children, widget);
+      if (iter)
+        {
+          children =
+            g_list_insert_before (
+              children, iter, widget);
+        }
+      else
+        {
+          children =
+            g_list_append (children, widget);
+        }
+    }
+  g_list_free (children);
+}
+
+/**
+ * Unmaps the children of the box (which must be
+ * inside a scrolled window) that are outside of
+ * the visible area, and maps the ones inside it,
+ * using gtk_widget_set_child_visible().
+ *
+ * The children keep their size so the scrolled
+ * area does not change.
+ *
+ * @param adj The adjustment of the scrolled window
+ *   in the orientation of the box.
+ * @param margin Extra area in pixels before and
+ *   after the visible area whose children should
+ *   also be mapped.
+ */
+void
+z_gtk_box_map_only_children_in_view (
+  GtkBox *        box,
+  GtkAdjustment * adj,
+  int             margin)
+{
+  bool horizontal =
+    gtk_orientable_get_orientation (
+      GTK_ORIENTABLE (box)) ==
+        GTK_ORIENTATION_HORIZONTAL;
+  double view_start =
+    gtk_adjustment_get_value (adj) - margin;
+  double view_end =
+    gtk_adjustment_get_value (adj) +
+    gtk_adjustment_get_page_size (adj) + margin;
+
+  GtkAllocation box_alloc;
+  gtk_widget_get_allocation (
+    GTK_WIDGET (box), &box_alloc);
+
+  GList * children =
+    gtk_container_get_children (
+      GTK_CONTAINER (box));
+  for (GList * iter = children; iter;
+       iter = g_list_next (iter))
+    {
+      GtkWidget * widget = GTK_WIDGET (iter->data);
+      GtkAllocation alloc;
+      gtk_widget_get_allocation (widget, &alloc);
+      double start, end;
+      if (horizontal)
+        {
+          start = alloc.x - box_alloc.x;
+          end = start + alloc.width;
+        }
+      else
+        {
+          start = alloc.y - box_alloc.y;
+          end = start + alloc.height;
+        }
+
+      bool in_view =
+        end >= view_start && start <= view_end;
+      if ((bool) gtk_widget_get_child_visible (
+             widget) != in_view)
+        {
+          gtk_widget_set_child_visible (
+            widget, in_view);
+        }
+    }
+  g_list_free (children);
+}
+
+typedef struct MappedTickCallback
+{
+  GtkTickCallback callback;
+  gpointer        user_data;
+
+  /** ID of the tick callback while mapped, or
+   * 0. */
+  guint           id;
+} MappedTickCallback;
+
+static void
+on_mapped_tick_callback_map (
+  GtkWidget *          widget,
+  MappedTickCallback * data)
+{
+  if (data->id)
+    return;
+
+  data->id =
+    gtk_widget_add_tick_callback (
+      widget, data->callback, data->user_data,
+      NULL);
+}
+
+static void
+on_mapped_tick_callback_unmap (
+  GtkWidget *          widget,
+  MappedTickCallback * data)
+{
+  if (!data->id)
+    return;
+
+  gtk_widget_remove_tick_callback (
+    widget, data->id);
+  data->id = 0;
+}
+
+static void
+mapped_tick_callback_free (
+  gpointer  data,
+  GClosure * closure)
+{
+  free (data);
+}
+
+/**
+ * Adds a tick callback that is only added to the
+ * frame clock while the widget is mapped.
+ *
+ * This avoids running the callbacks of widgets that
+ * are hidden or scrolled out of view (see
+ * z_gtk_box_map_only_children_in_view()).
+ */
+void
+z_gtk_widget_add_tick_callback_while_mapped (
+  GtkWidget *     widget,
+  GtkTickCallback callback,
+  gpointer        user_data)
+{
+  MappedTickCallback * data =
+    object_new (MappedTickCallback);
+  data->callback = callback;
+  data->user_data = user_data;
+
+  g_signal_connect_data (
+    widget, "map",
+    G_CALLBACK (on_mapped_tick_callback_map),
+    data, mapped_tick_callback_free, 0);
+  g_signal_connect (
+    widget, "unmap",
+    G_CALLBACK (on_mapped_tick_callback_unmap),
+    data);
+
+  if (gtk_widget_get_mapped (widget))
+    {
+      on_mapped_tick_callback_map (widget, data);
+    }
+}
+
 void
 z_gtk_container_destroy_all_children (
   GtkContainer * container)
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "utils/arrays.h"
+#include "utils/handle_table.h"
+#include "utils/objects.h"
+
+#include <glib.h>
+
+#define INITIAL_SLOTS 64
+
+/**
+ * Creates a new handle table.
+ */
+HandleTable *
+handle_table_new (void)
+{
+  HandleTable * self = object_new (HandleTable);
+
+  self->slots_size = INITIAL_SLOTS;
+  self->slots =
+    object_new_n (
+      self->slots_size, HandleTableSlot);
+  self->free_slots_size = INITIAL_SLOTS;
+  self->free_slots =
+    object_new_n (
+      self->free_slots_size, unsigned int);
+
+  return self;
+}
+
+/**
+ * Registers @p obj and returns its handle.
+ */
+ObjectHandle
+handle_table_add (
+  HandleTable * self,
+  void *        obj)
+{
+  ObjectHandle handle = { 0, 0 };
+  g_return_val_if_fail (obj, handle);
+
+  unsigned int slot_idx;
+  if (self->num_free_slots > 0)
+    {
+      slot_idx =
+        self->free_slots[--self->num_free_slots];
+    }
+  else
+    {
+      array_double_size_if_full (
+        self->slots, self->num_slots,
+        self->slots_size, HandleTableSlot);
+      slot_idx = (unsigned int) self->num_slots++;
+      self->slots[slot_idx].generation = 1;
+    }
+
+  HandleTableSlot * slot = &self->slots[slot_idx];
+  slot->obj = obj;
+
+  handle.slot = slot_idx;
+  handle.generation = slot->generation;
+
+  return handle;
+}
+
+/**
+ * Unregisters the object @p handle refers to.
+ *
+ * Existing copies of @p handle will no longer
+ * resolve.
+ */
+void
+handle_table_remove (
+  HandleTable *        self,
+  const ObjectHandle * handle)
+{
+  g_return_if_fail (
+    handle_table_get (self, handle));
+
+  HandleTableSlot * slot =
+    &self->slots[handle->slot];
+  slot->obj = NULL;
+  slot->generation++;
+
+  /* skip the "not set" generation when wrapping
+   * around */
+  if (slot->generation == 0)
+    slot->generation = 1;
+
+  array_double_size_if_full (
+    self->free_slots, self->num_free_slots,
+    self->free_slots_size, unsigned int);
+  array_append (
+    self->free_slots, self->num_free_slots,
+    handle->slot);
+}
+
+/**
+ * Returns the object @p handle refers to, or NULL
+ * if the handle is not set or the object was
+ * removed.
+ */
+void *
+handle_table_get (
+  const HandleTable *  self,
+  const ObjectHandle * handle)
+{
+  if (!object_handle_is_set (handle) ||
+      handle->slot >= (unsigned int) self->num_slots)
+    return NULL;
+
+  const HandleTableSlot * slot =
+    &self->slots[handle->slot];
+  if (slot->generation != handle->generation)
+    return NULL;
+
+  return slot->obj;
+}
+
+/**
+ * Frees the table.
+ *
+ * The registered objects are not freed.
+ */
+void
+handle_table_free (
+  HandleTable * self)
+{
+  free (self->slots);
+  free (self->free_slots);
+
+  object_zero_and_free (self);
+}
@@ -29,6 +29,21 @@
 #define SEED_32 0xbaad5eed
 #define SEED_64 0xbaad5eedbaad5eed
 
+static char *
+get_xxh32_canonical_str (
+  XXH32_hash_t hash)
+{
+  XXH32_canonical_t canonical;
+  XXH32_canonicalFromHash (&canonical, hash);
+  return
+    g_strdup_printf (
+      "%x%x%x%x",
+      canonical.digest[0],
+      canonical.digest[1],
+      canonical.digest[2],
+      canonical.digest[3]);
+}
+
 static char *
 get_xxh32_hash (
   FILE * stream)
@@ -54,20 +69,29 @@ get_xxh32_hash (
   XXH32_freeState (state);
 
   /* get as canonical string */
-  XXH32_canonical_t canonical;
-  XXH32_canonicalFromHash (&canonical, hash);
-  char * ret =
+  return get_xxh32_canonical_str (hash);
+}
+
+#if XXH_VERSION_NUMBER >= 800
+static char *
+get_xxh64_canonical_str (
+  XXH64_hash_t hash)
+{
+  XXH64_canonical_t canonical;
+  XXH64_canonicalFromHash (&canonical, hash);
+  return
     g_strdup_printf (
-      "%x%x%x%x",
+      "%x%x%x%x%x%x%x%x",
       canonical.digest[0],
       canonical.digest[1],
       canonical.digest[2],
-      canonical.digest[3]);
-
-  return ret;
+      canonical.digest[3],
+      canonical.digest[4],
+      canonical.digest[5],
+      canonical.digest[6],
+      canonical.digest[7]);
 }
 
-#if XXH_VERSION_NUMBER >= 800
 static char *
 get_xxh3_64_hash (
   FILE * stream)
@@ -93,22 +117,7 @@ get_xxh3_64_hash (
   XXH3_freeState (state);
 
   /* get as canonical string */
-  XXH64_canonical_t canonical;
-  XXH64_canonicalFromHash (&canonical, hash);
-  char * ret =
-    g_strdup_printf (
-      "%x%x%x%x%x%x%x%x",
-      canonical.digest[0],
-      canonical.digest[1],
-      canonical.digest[2],
-      canonical.digest[3],
-      canonical.digest[4],
-      canonical.digest[5],
-      canonical.digest[6],
-      canonical.digest[7]
-      );
-
-  return ret;
+  return get_xxh64_canonical_str (hash);
 }
 #endif
 
@@ -140,3 +149,30 @@ hash_get_from_file (
 
   return ret;
 }
+
+/**
+ * Returns the hash of the given data as a newly
+ * allocated string.
+ */
+char *
+hash_get_from_data (
+  const void *  data,
+  size_t        size,
+  HashAlgorithm algo)
+{
+  switch (algo)
+    {
+    case HASH_ALGORITHM_XXH3_64:
+#if XXH_VERSION_NUMBER >= 800
+      return
+        get_xxh64_canonical_str (
+          XXH3_64bits (data, size));
+#endif
+    case HASH_ALGORITHM_XXH32:
+      return
+        get_xxh32_canonical_str (
+          XXH32 (data, size, 0));
+    }
+
+  g_return_val_if_reached (NULL);
+}
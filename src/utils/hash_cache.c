@@ -0,0 +1,417 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "utils/arrays.h"
+#include "utils/file.h"
+#include "utils/hash_cache.h"
+#include "utils/objects.h"
+#include "utils/string.h"
+#include "zrythm.h"
+
+#include <glib/gstdio.h>
+
+/**
+ * Identity of a file on disk.
+ */
+typedef struct FileIdentity
+{
+  guint64  device;
+  guint64  inode;
+  guint64  size;
+  gint64   mtime_ns;
+} FileIdentity;
+
+static char *
+get_hash_cache_file_path (void)
+{
+  char * zrythm_dir =
+    zrythm_get_dir (ZRYTHM_DIR_USER_TOP);
+  g_return_val_if_fail (zrythm_dir, NULL);
+
+  char * path =
+    g_build_filename (
+      zrythm_dir, "file_hash_cache.yaml", NULL);
+  g_free (zrythm_dir);
+
+  return path;
+}
+
+/**
+ * Stats the file.
+ *
+ * @return Whether successful.
+ */
+static bool
+get_file_identity (
+  const char *   filepath,
+  FileIdentity * id)
+{
+  GStatBuf st;
+  if (g_stat (filepath, &st) != 0)
+    return false;
+
+  id->device = (guint64) st.st_dev;
+  id->inode = (guint64) st.st_ino;
+  id->size = (guint64) st.st_size;
+#if defined (__APPLE__)
+  id->mtime_ns =
+    (gint64) st.st_mtimespec.tv_sec * 1000000000 +
+    (gint64) st.st_mtimespec.tv_nsec;
+#elif defined (_WOE32)
+  id->mtime_ns =
+    (gint64) st.st_mtime * 1000000000;
+#else
+  id->mtime_ns =
+    (gint64) st.st_mtim.tv_sec * 1000000000 +
+    (gint64) st.st_mtim.tv_nsec;
+#endif
+
+  return true;
+}
+
+static bool
+file_identities_equal (
+  const FileIdentity * a,
+  const FileIdentity * b)
+{
+  return
+    a->device == b->device &&
+    a->inode == b->inode &&
+    a->size == b->size &&
+    a->mtime_ns == b->mtime_ns;
+}
+
+/**
+ * Returns the key to look up the entry with.
+ */
+static char *
+get_key (
+  const FileIdentity * id,
+  const char *         filepath,
+  HashAlgorithm        algo)
+{
+#ifdef _WOE32
+  /* inode numbers are not available */
+  return
+    g_strdup_printf (
+      "%s:%" G_GUINT64_FORMAT ":%" G_GINT64_FORMAT
+      ":%d",
+      filepath, id->size, id->mtime_ns, algo);
+#else
+  return
+    g_strdup_printf (
+      "%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT
+      ":%" G_GUINT64_FORMAT ":%" G_GINT64_FORMAT
+      ":%d",
+      id->device, id->inode, id->size,
+      id->mtime_ns, algo);
+#endif
+}
+
+static void
+hash_cache_entry_free (
+  HashCacheEntry * self)
+{
+  g_free_and_null (self->path);
+  g_free_and_null (self->hash);
+
+  object_zero_and_free (self);
+}
+
+static void
+add_entry (
+  HashCache *      self,
+  HashCacheEntry * entry)
+{
+  FileIdentity id = {
+    .device = entry->device,
+    .inode = entry->inode,
+    .size = entry->size,
+    .mtime_ns = entry->mtime_ns,
+  };
+  char * key = get_key (&id, entry->path, entry->algo);
+
+  /* replace any entry with the same key */
+  HashCacheEntry * prev_entry =
+    g_hash_table_lookup (self->ht, key);
+  if (prev_entry)
+    {
+      array_delete (
+        self->entries, self->num_entries,
+        prev_entry);
+      hash_cache_entry_free (prev_entry);
+    }
+
+  array_double_size_if_full (
+    self->entries, self->num_entries,
+    self->entries_size, HashCacheEntry *);
+  array_append (
+    self->entries, self->num_entries, entry);
+  g_hash_table_replace (self->ht, key, entry);
+}
+
+/**
+ * Reads the cache file, if not read yet.
+ */
+static void
+load (
+  HashCache * self)
+{
+  if (self->loaded)
+    return;
+
+  self->loaded = true;
+
+  char * path = get_hash_cache_file_path ();
+  if (!path || !file_exists (path))
+    {
+      g_free (path);
+      return;
+    }
+
+  char * yaml = NULL;
+  GError * err = NULL;
+  g_file_get_contents (path, &yaml, NULL, &err);
+  if (err)
+    {
+      g_warning (
+        "Failed to read hash cache from %s: %s",
+        path, err->message);
+      g_error_free (err);
+      g_free (path);
+      return;
+    }
+
+  HashCache * loaded = NULL;
+  char version_str[120];
+  sprintf (
+    version_str, "schema_version: %d\n",
+    HASH_CACHE_SCHEMA_VERSION);
+  if (strstr (yaml, version_str))
+    {
+      loaded =
+        (HashCache *)
+        yaml_deserialize (yaml, &hash_cache_schema);
+    }
+  if (!loaded)
+    {
+      g_message (
+        "Ignoring invalid or old hash cache at %s",
+        path);
+      g_free (yaml);
+      g_free (path);
+      return;
+    }
+
+  for (int i = 0; i < loaded->num_entries; i++)
+    {
+      add_entry (self, loaded->entries[i]);
+    }
+  free (loaded->entries);
+  free (loaded);
+  g_free (yaml);
+
+  g_message (
+    "Loaded %d cached file hashes from %s",
+    self->num_entries, path);
+  g_free (path);
+}
+
+/**
+ * Creates a new hash cache.
+ *
+ * The cache file is read on first use.
+ */
+HashCache *
+hash_cache_new (void)
+{
+  HashCache * self = object_new (HashCache);
+
+  self->schema_version = HASH_CACHE_SCHEMA_VERSION;
+  self->entries_size = 1;
+  self->entries =
+    object_new_n (
+      self->entries_size, HashCacheEntry *);
+  self->ht =
+    g_hash_table_new_full (
+      g_str_hash, g_str_equal, g_free, NULL);
+  g_mutex_init (&self->mutex);
+
+  return self;
+}
+
+/**
+ * Returns the hash of the given file as a newly
+ * allocated string, calculating it only if the
+ * file changed since it was last cached.
+ *
+ * This can be called from any thread.
+ */
+char *
+hash_cache_get_from_file (
+  HashCache *   self,
+  const char *  filepath,
+  HashAlgorithm algo)
+{
+  FileIdentity id;
+  if (!get_file_identity (filepath, &id))
+    {
+      return hash_get_from_file (filepath, algo);
+    }
+
+  char * key = get_key (&id, filepath, algo);
+
+  g_mutex_lock (&self->mutex);
+  load (self);
+  HashCacheEntry * entry =
+    g_hash_table_lookup (self->ht, key);
+  char * hash = NULL;
+  if (entry)
+    {
+      entry->last_used =
+        g_get_real_time () / 1000000;
+      hash = g_strdup (entry->hash);
+    }
+  g_mutex_unlock (&self->mutex);
+  g_free (key);
+
+  if (hash)
+    {
+      g_debug (
+        "%s: using cached hash for %s: %s",
+        __func__, filepath, hash);
+      return hash;
+    }
+
+  hash = hash_get_from_file (filepath, algo);
+  if (!hash)
+    return NULL;
+
+  /* skip caching if the file changed while
+   * hashing or may still change within the same
+   * timestamp */
+  FileIdentity id_after;
+  gint64 now_ns = g_get_real_time () * 1000;
+  if (!get_file_identity (filepath, &id_after) ||
+      !file_identities_equal (&id, &id_after) ||
+      id.mtime_ns > now_ns - HASH_CACHE_RACY_NS)
+    {
+      return hash;
+    }
+
+  entry = object_new (HashCacheEntry);
+  entry->path = g_strdup (filepath);
+  entry->device = id.device;
+  entry->inode = id.inode;
+  entry->size = id.size;
+  entry->mtime_ns = id.mtime_ns;
+  entry->algo = algo;
+  entry->hash = g_strdup (hash);
+  entry->last_used = now_ns / 1000000000;
+
+  g_mutex_lock (&self->mutex);
+  add_entry (self, entry);
+  self->dirty = true;
+  g_mutex_unlock (&self->mutex);
+
+  return hash;
+}
+
+/**
+ * Writes the cache to its file if it changed.
+ */
+void
+hash_cache_serialize_to_file (
+  HashCache * self)
+{
+  g_mutex_lock (&self->mutex);
+
+  if (!self->dirty)
+    {
+      g_mutex_unlock (&self->mutex);
+      return;
+    }
+
+  /* drop old entries */
+  gint64 now = g_get_real_time () / 1000000;
+  for (int i = self->num_entries - 1; i >= 0; i--)
+    {
+      HashCacheEntry * entry = self->entries[i];
+      if (now - entry->last_used <=
+            HASH_CACHE_MAX_AGE)
+        continue;
+
+      FileIdentity id = {
+        .device = entry->device,
+        .inode = entry->inode,
+        .size = entry->size,
+        .mtime_ns = entry->mtime_ns,
+      };
+      char * key =
+        get_key (&id, entry->path, entry->algo);
+      g_hash_table_remove (self->ht, key);
+      g_free (key);
+      array_delete (
+        self->entries, self->num_entries, entry);
+      hash_cache_entry_free (entry);
+    }
+
+  char * yaml =
+    yaml_serialize (self, &hash_cache_schema);
+  self->dirty = false;
+  g_mutex_unlock (&self->mutex);
+  g_return_if_fail (yaml);
+
+  char * path = get_hash_cache_file_path ();
+  g_return_if_fail (path);
+  GError * err = NULL;
+  if (!g_file_set_contents (path, yaml, -1, &err))
+    {
+      g_warning (
+        "Unable to write hash cache file: %s",
+        err->message);
+      g_error_free (err);
+    }
+  g_free (path);
+  g_free (yaml);
+}
+
+void
+hash_cache_free (
+  HashCache * self)
+{
+  for (int i = 0; i < self->num_entries; i++)
+    {
+      object_free_w_func_and_null (
+        hash_cache_entry_free, self->entries[i]);
+    }
+  object_zero_and_free (self->entries);
+  object_free_w_func_and_null (
+    g_hash_table_destroy, self->ht);
+  g_mutex_clear (&self->mutex);
+
+  object_zero_and_free (self);
+}
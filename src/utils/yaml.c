@@ -135,6 +135,20 @@ yaml_deserialize (
   return obj;
 }
 
+/**
+ * Frees an object returned by yaml_deserialize()
+ * that was not modified since.
+ */
+void
+yaml_free (
+  void *                       data,
+  const cyaml_schema_value_t * schema)
+{
+  cyaml_config_t cyaml_config;
+  yaml_get_cyaml_config (&cyaml_config);
+  cyaml_free (&cyaml_config, schema, data, 0);
+}
+
 void
 yaml_print (
   void *                       data,
@@ -46,6 +46,8 @@
 #include "utils/curl.h"
 #include "utils/env.h"
 #include "utils/gtk.h"
+#include "utils/handle_table.h"
+#include "utils/hash_cache.h"
 #include "utils/localization.h"
 #include "utils/log.h"
 #include "utils/object_pool.h"
@@ -642,6 +644,10 @@ zrythm_free (
     event_manager_free, self->event_manager);
   object_free_w_func_and_null (
     file_manager_free, self->file_manager);
+  object_free_w_func_and_null (
+    hash_cache_free, self->hash_cache);
+  object_free_w_func_and_null (
+    handle_table_free, self->handle_table);
 
   /* free object utils around last */
   object_free_w_func_and_null (
@@ -695,6 +701,8 @@ zrythm_new (
   self->symap = symap_new ();
   self->error_domain_symap = symap_new ();
   self->file_manager = file_manager_new ();
+  self->hash_cache = hash_cache_new ();
+  self->handle_table = handle_table_new ();
   self->cairo_caches = z_cairo_caches_new ();
 
   if (have_ui)
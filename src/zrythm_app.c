@@ -55,7 +55,10 @@
 
 #include "actions/actions.h"
 #include "actions/undo_manager.h"
+#include "audio/dsp_profiler.h"
 #include "audio/engine.h"
+#include "audio/exporter.h"
+#include "audio/position.h"
 #include "audio/router.h"
 #include "audio/quantize_options.h"
 #include "audio/track.h"
@@ -74,6 +77,7 @@
 #include "gui/widgets/splash.h"
 #include "plugins/plugin_manager.h"
 #include "project.h"
+#include "project_binary.h"
 #include "settings/settings.h"
 #include "utils/arrays.h"
 #include "utils/backtrace.h"
@@ -99,6 +103,7 @@
 
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 #include <gtk/gtk.h>
 
 #ifdef HAVE_GTK_SOURCE_VIEW_4
@@ -301,6 +306,11 @@ static void on_load_project (
       exit (0);
     }
 
+  if (zrythm_app->dsp_trace_file)
+    {
+      engine_set_dsp_profiling (AUDIO_ENGINE, true);
+    }
+
   g_action_group_activate_action (
     G_ACTION_GROUP (zrythm_app),
     "setup_main_window",
@@ -1384,6 +1394,9 @@ zrythm_app_startup (
   INSTALL_ACCEL (
     gdk_keyval_name (GDK_KEY_Home),
     "win.go-to-start");
+  INSTALL_ACCEL (
+    "<Control><Shift>F12",
+    "win.toggle-dsp-profiling");
 
 #undef INSTALL_ACCEL
 
@@ -1405,6 +1418,28 @@ zrythm_app_on_shutdown (
 
   if (ZRYTHM)
     {
+      if (self->dsp_trace_file && PROJECT &&
+          AUDIO_ENGINE && AUDIO_ENGINE->profiler)
+        {
+          dsp_profiler_collect (
+            AUDIO_ENGINE->profiler);
+          char * err =
+            dsp_profiler_write_trace (
+              AUDIO_ENGINE->profiler,
+              self->dsp_trace_file);
+          if (err)
+            {
+              g_warning ("%s", err);
+              g_free (err);
+            }
+          else
+            {
+              g_message (
+                "DSP trace written to %s",
+                self->dsp_trace_file);
+            }
+        }
+
       zrythm_free (ZRYTHM);
     }
 
@@ -1456,6 +1491,29 @@ verify_output_exists (
     }
 }
 
+static void
+train_project_dictionary (
+  ZrythmApp *  self,
+  const char * dir)
+{
+  verify_output_exists (self);
+
+  char * err_msg =
+    project_train_compression_dictionary (
+      dir, self->output_file);
+  if (err_msg)
+    {
+      fprintf (
+        stderr,
+        _("Failed to train dictionary: %s\n"),
+        err_msg);
+      g_free (err_msg);
+      exit (EXIT_FAILURE);
+    }
+
+  exit (EXIT_SUCCESS);
+}
+
 static bool
 print_settings (
   ZrythmApp * self)
@@ -1477,7 +1535,34 @@ convert_project (
   char * output;
   size_t output_size;
   char * err_msg = NULL;
-  if (compress)
+
+  /* binary projects are converted to YAML */
+  char * contents = NULL;
+  size_t contents_size = 0;
+  if (!compress &&
+      g_file_get_contents (
+        file_to_convert, &contents, &contents_size,
+        NULL) &&
+      project_binary_is_binary (
+        contents, contents_size))
+    {
+      err_msg =
+        project_binary_to_yaml (
+          &output, contents, contents_size);
+      g_free (contents);
+      if (!err_msg)
+        {
+          output_size = strlen (output);
+          if (self->output_file)
+            {
+              err_msg =
+                io_write_file (
+                  self->output_file, output,
+                  output_size);
+            }
+        }
+    }
+  else if (compress)
     {
       verify_output_exists (self);
 
@@ -1508,6 +1593,7 @@ convert_project (
               file_to_convert, 0,
               PROJECT_DECOMPRESS_FILE);
         }
+      g_free (contents);
     }
 
   if (err_msg)
@@ -1558,6 +1644,281 @@ gen_project (
 #endif
 }
 
+/** Peak reported for silence, since JSON has no
+ * -inf. */
+#define RENDER_MIN_DBFS -200.0
+
+/**
+ * Formats accepted by --render-format.
+ */
+static const struct
+{
+  const char * name;
+  AudioFormat  format;
+} render_formats[] =
+{
+  { "wav", AUDIO_FORMAT_WAV },
+  { "flac", AUDIO_FORMAT_FLAC },
+  { "ogg", AUDIO_FORMAT_OGG_VORBIS },
+  { "opus", AUDIO_FORMAT_OGG_OPUS },
+  { "mp3", AUDIO_FORMAT_MP3 },
+  { "mid", AUDIO_FORMAT_MIDI },
+  { "raw", AUDIO_FORMAT_RAW },
+};
+
+/**
+ * Fills in the export settings from the --render-*
+ * options, exiting if any of them is invalid.
+ *
+ * Must be called after loading the project.
+ */
+static void
+fill_render_settings (
+  ZrythmApp *      self,
+  ExportSettings * info)
+{
+  /* format */
+  const char * format =
+    self->render_format ? self->render_format : "wav";
+  bool found = false;
+  for (size_t i = 0;
+       i < G_N_ELEMENTS (render_formats); i++)
+    {
+      if (string_is_equal_ignore_case (
+            format, render_formats[i].name))
+        {
+          info->format = render_formats[i].format;
+          found = true;
+          break;
+        }
+    }
+  if (!found)
+    {
+      fprintf (
+        stderr, _("Unknown format: %s\n"), format);
+      exit (EXIT_FAILURE);
+    }
+
+  /* bit depth */
+  switch (self->render_bit_depth)
+    {
+    case 0:
+    case 16:
+      info->depth = BIT_DEPTH_16;
+      break;
+    case 24:
+      info->depth = BIT_DEPTH_24;
+      break;
+    case 32:
+      info->depth = BIT_DEPTH_32;
+      break;
+    default:
+      fprintf (
+        stderr, _("Unsupported bit depth: %d\n"),
+        self->render_bit_depth);
+      exit (EXIT_FAILURE);
+    }
+
+  /* range */
+  const char * range =
+    self->render_range ? self->render_range : "song";
+  int start_bar, end_bar;
+  if (string_is_equal_ignore_case (range, "song"))
+    {
+      info->time_range = TIME_RANGE_SONG;
+    }
+  else if (string_is_equal_ignore_case (
+             range, "loop"))
+    {
+      info->time_range = TIME_RANGE_LOOP;
+    }
+  else if (sscanf (
+             range, "%d:%d", &start_bar,
+             &end_bar) == 2 &&
+           start_bar >= 1 && end_bar > start_bar)
+    {
+      info->time_range = TIME_RANGE_CUSTOM;
+      position_set_to_bar (
+        &info->custom_start, start_bar);
+      position_set_to_bar (
+        &info->custom_end, end_bar);
+    }
+  else
+    {
+      fprintf (
+        stderr, _("Invalid range: %s\n"), range);
+      exit (EXIT_FAILURE);
+    }
+
+  /* tracks */
+  if (!self->render_tracks)
+    {
+      info->mode = EXPORT_MODE_FULL;
+      return;
+    }
+
+  info->mode = EXPORT_MODE_TRACKS;
+  info->bounce_with_parents = true;
+  tracklist_mark_all_tracks_for_bounce (
+    TRACKLIST, false);
+  char ** track_names =
+    g_strsplit (self->render_tracks, ",", -1);
+  for (int i = 0; track_names[i]; i++)
+    {
+      Track * track =
+        tracklist_find_track_by_name (
+          TRACKLIST, track_names[i]);
+      if (!track)
+        {
+          fprintf (
+            stderr, _("Track %s not found.\n"),
+            track_names[i]);
+          exit (EXIT_FAILURE);
+        }
+      track_mark_for_bounce (
+        track, F_BOUNCE, F_MARK_REGIONS,
+        F_NO_MARK_CHILDREN, F_MARK_PARENTS);
+    }
+  g_strfreev (track_names);
+}
+
+/**
+ * Loads the given project without a UI, renders
+ * it to the output file using the offline export
+ * path and prints a JSON report with the timings
+ * and peaks to stdout.
+ *
+ * Each invocation uses its own log file so that
+ * multiple projects can be rendered in parallel
+ * processes.
+ */
+static void
+render_project (
+  ZrythmApp *  self,
+  const char * filepath)
+{
+  verify_file_exists (filepath);
+  verify_output_exists (self);
+
+  localization_init (false, false);
+
+  /* render offline with the dummy backends */
+  g_free (self->audio_backend);
+  g_free (self->midi_backend);
+  self->audio_backend = g_strdup ("none");
+  self->midi_backend = g_strdup ("none");
+  self->gtk_thread = g_thread_self ();
+
+  char * exe_path = NULL;
+  int dirname_length;
+  int length =
+    wai_getExecutablePath (
+      NULL, 0, &dirname_length);
+  if (length > 0)
+    {
+      exe_path =
+        (char *) malloc ((size_t) length + 1);
+      wai_getExecutablePath (
+        exe_path, length, &dirname_length);
+      exe_path[length] = '\0';
+    }
+
+  ZRYTHM = zrythm_new (exe_path, false, false, true);
+  free (exe_path);
+  zrythm_init_user_dirs_and_files (ZRYTHM);
+
+  char * log_filepath = NULL;
+  int log_fd =
+    g_file_open_tmp (
+      "zrythm-render-XXXXXX.log", &log_filepath,
+      NULL);
+  if (log_fd >= 0)
+    g_close (log_fd, NULL);
+  log_init_with_file (LOG, log_filepath);
+  g_free (log_filepath);
+
+  plugin_manager_scan_plugins (
+    ZRYTHM->plugin_manager, 1.0, NULL);
+
+  gint64 load_start = g_get_monotonic_time ();
+  char * project_file = g_strdup (filepath);
+  int ret = project_load (project_file, false);
+  g_free (project_file);
+  if (ret != 0)
+    {
+      fprintf (
+        stderr, _("Failed to load project %s\n"),
+        filepath);
+      exit (EXIT_FAILURE);
+    }
+  gint64 load_time =
+    g_get_monotonic_time () - load_start;
+
+  ExportSettings info;
+  memset (&info, 0, sizeof (ExportSettings));
+  fill_render_settings (self, &info);
+  info.artist = g_strdup ("");
+  info.title = g_strdup (PROJECT->title);
+  info.genre = g_strdup ("");
+  info.file_uri = self->output_file;
+
+  gint64 render_start = g_get_monotonic_time ();
+  ret = exporter_export (&info);
+  gint64 render_time =
+    g_get_monotonic_time () - render_start;
+  if (ret != 0 || info.progress_info.has_error)
+    {
+      fprintf (
+        stderr, _("Failed to render %s: %s\n"),
+        filepath,
+        info.progress_info.has_error ?
+          info.progress_info.error_str : "");
+      exit (EXIT_FAILURE);
+    }
+
+  double rendered_secs =
+    (double) info.num_frames /
+      (double) AUDIO_ENGINE->sample_rate;
+  char * project_json =
+    g_strescape (filepath, NULL);
+  char * output_json =
+    g_strescape (self->output_file, NULL);
+  fprintf (
+    stdout,
+    "{\"project\": \"%s\", \"output\": \"%s\", "
+    "\"format\": \"%s\", \"frames\": %ld, "
+    "\"sample_rate\": %u, "
+    "\"load_ms\": %.3f, \"render_ms\": %.3f, "
+    "\"realtime_multiple\": %.3f, "
+    "\"peaks\": [%f, %f], "
+    "\"peaks_dbfs\": [%.2f, %.2f]}\n",
+    project_json, output_json,
+    exporter_stringize_audio_format (
+      info.format, false),
+    info.num_frames,
+    AUDIO_ENGINE->sample_rate,
+    (double) load_time / 1000.0,
+    (double) render_time / 1000.0,
+    render_time > 0 ?
+      rendered_secs /
+        ((double) render_time / 1000000.0) : 0.0,
+    (double) info.peaks[0], (double) info.peaks[1],
+    MAX (
+      (double) math_amp_to_dbfs (info.peaks[0]),
+      RENDER_MIN_DBFS),
+    MAX (
+      (double) math_amp_to_dbfs (info.peaks[1]),
+      RENDER_MIN_DBFS));
+  fflush (stdout);
+  g_free (project_json);
+  g_free (output_json);
+
+  object_free_w_func_and_null (
+    zrythm_free, ZRYTHM);
+
+  exit (EXIT_SUCCESS);
+}
+
 static bool
 reset_to_factory (void)
 {
@@ -1605,6 +1966,15 @@ on_handle_local_options (
         opts, "zpj-to-yaml", "^ay", &filepath);
       convert_project (self, false, filepath);
     }
+  else if (g_variant_dict_contains (
+             opts, "train-zpj-dictionary"))
+    {
+      char * dirpath = NULL;
+      g_variant_dict_lookup (
+        opts, "train-zpj-dictionary", "^ay",
+        &dirpath);
+      train_project_dictionary (self, dirpath);
+    }
   else if (g_variant_dict_contains (
              opts, "gen-project"))
     {
@@ -1613,6 +1983,14 @@ on_handle_local_options (
         opts, "gen-project", "^ay", &filepath);
       gen_project (self, filepath);
     }
+  else if (g_variant_dict_contains (
+             opts, "render"))
+    {
+      char * filepath = NULL;
+      g_variant_dict_lookup (
+        opts, "render", "^ay", &filepath);
+      render_project (self, filepath);
+    }
   else if (g_variant_dict_contains (
              opts, "reset-to-factory"))
     {
@@ -1730,11 +2108,44 @@ add_option_entries (
         G_OPTION_ARG_FILENAME, NULL,
         _("Convert YAML-PROJECT-FILE to the .zpj format"),
         "YAML-PROJECT-FILE" },
+      { "train-zpj-dictionary", 0,
+        G_OPTION_FLAG_NONE,
+        G_OPTION_ARG_FILENAME, NULL,
+        _("Train a compression dictionary from the "
+        "projects in DIR"),
+        "DIR" },
       { "gen-project", 0,
         G_OPTION_FLAG_NONE,
         G_OPTION_ARG_FILENAME, NULL,
         _("Generate a project from SCRIPT-FILE"),
         "SCRIPT-FILE" },
+      { "render", 0,
+        G_OPTION_FLAG_NONE,
+        G_OPTION_ARG_FILENAME, NULL,
+        _("Render PROJECT-FILE without a UI to the "
+        "file passed with --output and print a "
+        "report"),
+        "PROJECT-FILE" },
+      { "render-range", 0, G_OPTION_FLAG_NONE,
+        G_OPTION_ARG_STRING, &self->render_range,
+        _("Range to render: song (default), loop or "
+        "START-BAR:END-BAR"),
+        "RANGE" },
+      { "render-tracks", 0, G_OPTION_FLAG_NONE,
+        G_OPTION_ARG_STRING, &self->render_tracks,
+        _("Comma-separated names of the tracks to "
+        "render (default: the full mix)"),
+        "TRACKS" },
+      { "render-format", 0, G_OPTION_FLAG_NONE,
+        G_OPTION_ARG_STRING, &self->render_format,
+        _("Format to render to: wav (default), flac, "
+        "ogg, opus, mp3, mid or raw"),
+        "FORMAT" },
+      { "render-bit-depth", 0, G_OPTION_FLAG_NONE,
+        G_OPTION_ARG_INT, &self->render_bit_depth,
+        _("Bit depth to render with: 16 (default), "
+        "24 or 32"),
+        "BIT-DEPTH" },
       { "pretty", 0, G_OPTION_FLAG_NONE,
         G_OPTION_ARG_NONE, &self->pretty_print,
         _("Print output in user-friendly way"),
@@ -1772,6 +2183,11 @@ add_option_entries (
       { "output", 'o', G_OPTION_FLAG_NONE,
         G_OPTION_ARG_STRING, &self->output_file,
         "File or directory to output to", "FILE" },
+      { "dsp-trace", 0, G_OPTION_FLAG_NONE,
+        G_OPTION_ARG_FILENAME, &self->dsp_trace_file,
+        _("Profile the DSP of each processor and "
+        "write a trace to FILE on exit"),
+        "FILE" },
       { "cyaml-log-level", 0, G_OPTION_FLAG_NONE,
         G_OPTION_ARG_STRING, NULL,
         "Cyaml log level", "LOG-LEVEL" },
@@ -1796,6 +2212,8 @@ add_option_entries (
     _("Examples:\n"
     "  --zpj-to-yaml a.zpj > b.yaml        Convert a a.zpj to YAML and save to b.yaml\n"
     "  --gen-project a.scm -o myproject    Generate myproject from a.scm\n"
+    "  --render a.zpj -o a.flac --render-format=flac  Render a.zpj to a.flac\n"
+    "  --train-zpj-dictionary dir -o d.zdict  Train a compression dictionary from the projects in dir\n"
     "  -p --pretty                         Pretty-print current settings\n\n"
     "Please report issues to %s\n"),
     ISSUE_TRACKER_URL);
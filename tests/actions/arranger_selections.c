@@ -1768,6 +1768,10 @@ test_audio_functions ()
   verify_audio_function (
     inverted_frames, frames_per_channel);
 
+  /* the edited clip is only written when saving */
+  g_assert_true (
+    audio_region_get_clip (region)->dirty);
+
   test_project_save_and_reload ();
 
   undo_manager_undo (UNDO_MANAGER);
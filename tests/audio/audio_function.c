@@ -0,0 +1,371 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "actions/arranger_selections.h"
+#include "actions/undo_manager.h"
+#include "audio/audio_function.h"
+#include "audio/audio_region.h"
+#include "audio/clip.h"
+#include "audio/clip_chunk.h"
+#include "audio/offline_processor.h"
+#include "audio/pool.h"
+#include "audio/region.h"
+#include "audio/track.h"
+#include "audio/tracklist.h"
+#include "gui/backend/audio_selections.h"
+#include "project.h"
+#include "utils/dsp.h"
+#include "utils/flags.h"
+#include "utils/io.h"
+#include "utils/objects.h"
+#include "zrythm.h"
+
+#include "tests/helpers/project.h"
+
+#include <glib.h>
+
+#define CHANNELS 2
+
+/* several chunks, not a multiple of the chunk
+ * size */
+#define NUM_FRAMES \
+  (5 * OFFLINE_PROCESSOR_CHUNK_FRAMES + 123)
+
+/**
+ * Creates a region with a clip of NUM_FRAMES
+ * frames and selects all of it.
+ */
+static ZRegion *
+create_region (
+  Track * track)
+{
+  float * frames =
+    object_new_n (NUM_FRAMES * CHANNELS, float);
+  for (size_t i = 0; i < NUM_FRAMES * CHANNELS; i++)
+    {
+      frames[i] = 0.5f * sinf ((float) i * 0.001f);
+    }
+
+  /* put the peak in the last chunk */
+  frames[NUM_FRAMES * CHANNELS - 3] = -0.8f;
+
+  Position pos;
+  position_set_to_bar (&pos, 2);
+  ZRegion * r =
+    audio_region_new (
+      -1, NULL, true, frames, NUM_FRAMES,
+      "Test clip", CHANNELS, BIT_DEPTH_32, &pos,
+      track->pos, 0, track->lanes[0]->num_regions);
+  g_assert_nonnull (r);
+  track_add_region (
+    track, r, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  free (frames);
+
+  ArrangerObject * r_obj = (ArrangerObject *) r;
+  AUDIO_SELECTIONS->region_id = r->id;
+  AUDIO_SELECTIONS->has_selection = true;
+  AUDIO_SELECTIONS->sel_start = r_obj->pos;
+  AUDIO_SELECTIONS->sel_end = r_obj->end_pos;
+
+  return r;
+}
+
+/**
+ * Applies the given function serially to @p src.
+ */
+static void
+apply_serial_reference (
+  AudioFunctionType type,
+  const float *     src,
+  float *           dest,
+  size_t            num_frames)
+{
+  size_t total = num_frames * CHANNELS;
+  float peak = 0.f;
+  switch (type)
+    {
+    case AUDIO_FUNCTION_INVERT:
+      for (size_t i = 0; i < total; i++)
+        {
+          dest[i] = - src[i];
+        }
+      break;
+    case AUDIO_FUNCTION_NORMALIZE:
+      for (size_t i = 0; i < total; i++)
+        {
+          peak = MAX (peak, fabsf (src[i]));
+        }
+      for (size_t i = 0; i < total; i++)
+        {
+          dest[i] = src[i] / peak;
+        }
+      break;
+    case AUDIO_FUNCTION_REVERSE:
+      for (size_t i = 0; i < num_frames; i++)
+        {
+          for (size_t j = 0; j < CHANNELS; j++)
+            {
+              dest[i * CHANNELS + j] =
+                src[
+                  (num_frames - i - 1) * CHANNELS +
+                    j];
+            }
+        }
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+test_apply_in_chunks (void)
+{
+  test_helper_zrythm_init ();
+
+  Track * track =
+    track_new (
+      TRACK_TYPE_AUDIO, TRACKLIST->num_tracks,
+      "Test Audio Track", F_WITH_LANE,
+      F_NOT_AUDITIONER);
+  tracklist_append_track (
+    TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+    F_NO_RECALC_GRAPH);
+
+  AudioFunctionType types[] = {
+    AUDIO_FUNCTION_INVERT,
+    AUDIO_FUNCTION_NORMALIZE,
+    AUDIO_FUNCTION_REVERSE,
+  };
+  for (size_t i = 0; i < G_N_ELEMENTS (types); i++)
+    {
+      ZRegion * r = create_region (track);
+      AudioClip * clip = audio_region_get_clip (r);
+      g_assert_cmpint (
+        clip->num_frames, ==, NUM_FRAMES);
+
+      /* calculate the expected frames */
+      size_t total = NUM_FRAMES * CHANNELS;
+      float * expected = object_new_n (total, float);
+      apply_serial_reference (
+        types[i], clip->frames, expected,
+        NUM_FRAMES);
+
+      int ret =
+        audio_function_apply (
+          (ArrangerSelections *) AUDIO_SELECTIONS,
+          types[i]);
+      g_assert_cmpint (ret, ==, 0);
+
+      clip = audio_region_get_clip (r);
+      for (size_t j = 0; j < total; j++)
+        {
+          g_assert_cmpfloat_with_epsilon (
+            clip->frames[j], expected[j], 0.00001f);
+        }
+
+      free (expected);
+    }
+
+  test_helper_zrythm_cleanup ();
+}
+
+/**
+ * Returns the frame (per channel) in the region's
+ * clip that the given selection position is at.
+ */
+static size_t
+get_clip_frame (
+  ZRegion *  r,
+  Position * pos)
+{
+  return
+    (size_t)
+    (pos->frames - ((ArrangerObject *) r)->pos.frames);
+}
+
+static void
+test_edit_shares_untouched_chunks (void)
+{
+  test_helper_zrythm_init ();
+
+  Track * track =
+    track_new (
+      TRACK_TYPE_AUDIO, TRACKLIST->num_tracks,
+      "Test Audio Track", F_WITH_LANE,
+      F_NOT_AUDITIONER);
+  tracklist_append_track (
+    TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+    F_NO_RECALC_GRAPH);
+
+  ZRegion * r = create_region (track);
+  AudioClip * clip = audio_region_get_clip (r);
+  size_t total = NUM_FRAMES * CHANNELS;
+  float * orig_frames = object_new_n (total, float);
+  dsp_copy (orig_frames, clip->frames, total);
+
+  /* select a small range inside the second
+   * chunk */
+  position_add_frames (
+    &AUDIO_SELECTIONS->sel_start,
+    CLIP_CHUNK_FRAMES + 100);
+  AUDIO_SELECTIONS->sel_end =
+    AUDIO_SELECTIONS->sel_start;
+  position_add_frames (
+    &AUDIO_SELECTIONS->sel_end, 1000);
+  size_t sel_start =
+    get_clip_frame (r, &AUDIO_SELECTIONS->sel_start);
+  size_t sel_end =
+    get_clip_frame (r, &AUDIO_SELECTIONS->sel_end);
+
+  UndoableAction * ua =
+    arranger_selections_action_new_edit_audio_function (
+      (ArrangerSelections *) AUDIO_SELECTIONS,
+      AUDIO_FUNCTION_INVERT);
+  undo_manager_perform (UNDO_MANAGER, ua);
+
+  ArrangerSelectionsAction * action =
+    (ArrangerSelectionsAction *) ua;
+  AudioClip * before =
+    audio_pool_get_clip (
+      AUDIO_POOL,
+      ((AudioSelections *) action->sel)->pool_id);
+  AudioClip * after =
+    audio_pool_get_clip (
+      AUDIO_POOL,
+      ((AudioSelections *) action->sel_after)->
+        pool_id);
+  int num_chunks =
+    (NUM_FRAMES + CLIP_CHUNK_FRAMES - 1) /
+    CLIP_CHUNK_FRAMES;
+  g_assert_cmpint (
+    before->num_chunks, ==, num_chunks);
+  g_assert_cmpint (
+    after->num_chunks, ==, num_chunks);
+
+  /* only the touched chunk is replaced */
+  for (int i = 0; i < num_chunks; i++)
+    {
+      if (i == 1)
+        {
+          g_assert_true (
+            before->chunks[i] != after->chunks[i]);
+        }
+      else
+        {
+          g_assert_true (
+            before->chunks[i] == after->chunks[i]);
+        }
+    }
+
+  /* versions don't copy the frames */
+  g_assert_null (before->frames);
+  g_assert_null (after->frames);
+
+  /* only the selected range is edited */
+  clip = audio_region_get_clip (r);
+  for (size_t i = 0; i < NUM_FRAMES; i++)
+    {
+      bool in_range = i >= sel_start && i < sel_end;
+      for (size_t j = 0; j < CHANNELS; j++)
+        {
+          size_t idx = i * CHANNELS + j;
+          g_assert_cmpfloat_with_epsilon (
+            clip->frames[idx],
+            in_range ?
+              - orig_frames[idx] : orig_frames[idx],
+            0.00001f);
+        }
+    }
+
+  /* the unique chunks are stored once */
+  test_project_save_and_reload ();
+  char * chunks_dir =
+    project_get_path (
+      PROJECT, PROJECT_PATH_POOL, F_NOT_BACKUP);
+  char * tmp = chunks_dir;
+  chunks_dir =
+    g_build_filename (tmp, CLIP_CHUNK_DIR, NULL);
+  g_free (tmp);
+  char ** files =
+    io_get_files_in_dir_ending_in (
+      chunks_dir, 0, ".raw", false);
+  g_assert_nonnull (files);
+  g_assert_cmpuint (
+    g_strv_length (files), ==,
+    (unsigned int) num_chunks + 1);
+  g_strfreev (files);
+  g_free (chunks_dir);
+
+  /* the loaded versions share their chunks
+   * again */
+  ClipChunk * first_chunk = NULL;
+  for (int i = 0; i < AUDIO_POOL->num_clips; i++)
+    {
+      AudioClip * pool_clip = AUDIO_POOL->clips[i];
+      if (!pool_clip || pool_clip->num_chunks == 0)
+        continue;
+
+      if (!first_chunk)
+        first_chunk = pool_clip->chunks[0];
+      g_assert_true (
+        pool_clip->chunks[0] == first_chunk);
+    }
+  g_assert_nonnull (first_chunk);
+
+  /* undo restores the original frames */
+  undo_manager_undo (UNDO_MANAGER);
+  track =
+    tracklist_find_track_by_name (
+      TRACKLIST, "Test Audio Track");
+  g_assert_nonnull (track);
+  r = track->lanes[0]->regions[0];
+  clip = audio_region_get_clip (r);
+  for (size_t i = 0; i < total; i++)
+    {
+      g_assert_cmpfloat_with_epsilon (
+        clip->frames[i], orig_frames[i], 0.00001f);
+    }
+
+  free (orig_frames);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/audio_function/"
+
+  g_test_add_func (
+    TEST_PREFIX "test apply in chunks",
+    (GTestFunc) test_apply_in_chunks);
+  g_test_add_func (
+    TEST_PREFIX "test edit shares untouched chunks",
+    (GTestFunc) test_edit_shares_untouched_chunks);
+
+  return g_test_run ();
+}
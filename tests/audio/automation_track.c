@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019-2020 Alexandros Theodotou <alex at zrythm dot org>
+ * Copyright (C) 2019-2021 Alexandros Theodotou <alex at zrythm dot org>
  *
  * This file is part of Zrythm
  *
@@ -19,15 +19,31 @@
 
 #include "zrythm-test-config.h"
 
+#include <math.h>
+
 #include "actions/arranger_selections.h"
+#include "actions/mixer_selections_action.h"
+#include "actions/tracklist_selections.h"
+#include "actions/undo_manager.h"
 #include "audio/channel.h"
+#include "audio/graph.h"
+#include "audio/automation_point.h"
 #include "audio/automation_region.h"
 #include "audio/automation_track.h"
+#include "audio/control_port.h"
+#include "audio/engine.h"
 #include "audio/master_track.h"
+#include "audio/router.h"
+#include "audio/supported_file.h"
+#include "audio/transport.h"
+#include "plugins/plugin.h"
 #include "project.h"
 #include "utils/arrays.h"
+#include "utils/string.h"
 #include "zrythm.h"
 
+#include "tests/helpers/plugin_manager.h"
+#include "tests/helpers/project.h"
 #include "tests/helpers/zrythm.h"
 
 #include <glib.h>
@@ -86,6 +102,433 @@ test_set_at_index ()
   test_helper_zrythm_cleanup ();
 }
 
+/**
+ * Checks that the compiled envelope gives the
+ * same values as walking the regions.
+ */
+static void
+check_envelope_matches_regions (
+  AutomationTrack * at,
+  long              end_frames)
+{
+  for (int i = 0; i < 2; i++)
+    {
+      bool ends_after = i == 0;
+      for (long frames = 0; frames < end_frames;
+           frames += 331)
+        {
+          automation_track_invalidate_envelope (at);
+          float expected = -1.f;
+          bool has_expected =
+            automation_track_get_normalized_val_at_frames (
+              at, frames, ends_after, &expected);
+
+          automation_track_update_envelope (
+            at, false);
+          float actual = -1.f;
+          bool has_actual =
+            automation_track_get_normalized_val_at_frames (
+              at, frames, ends_after, &actual);
+
+          g_assert_true (has_expected == has_actual);
+          if (has_expected)
+            {
+              g_assert_cmpfloat_with_epsilon (
+                expected, actual, 0.0001f);
+            }
+        }
+    }
+}
+
+static void
+test_envelope ()
+{
+  test_helper_zrythm_init ();
+
+  Track * master = P_MASTER_TRACK;
+  AutomationTracklist * atl =
+    track_get_automation_tracklist (master);
+  AutomationTrack * at = atl->ats[0];
+
+  /* looped region from bar 2 to 6 with a loop
+   * of 1 bar */
+  Position start, end, pos;
+  position_set_to_bar (&start, 2);
+  position_set_to_bar (&end, 6);
+  ZRegion * region =
+    automation_region_new (
+      &start, &end, master->pos, at->index, 0);
+  track_add_region  (
+    master, region, at, -1, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  position_set_to_bar (&pos, 2);
+  arranger_object_set_position (
+    (ArrangerObject *) region, &pos,
+    ARRANGER_OBJECT_POSITION_TYPE_LOOP_END,
+    F_NO_VALIDATE);
+
+  float vals[] = { 0.2f, 0.9f, 0.4f };
+  for (int i = 0; i < 3; i++)
+    {
+      position_set_to_bar (&pos, 1);
+      position_add_beats (&pos, i);
+      AutomationPoint * ap =
+        automation_point_new_float (
+          vals[i], vals[i], &pos);
+      automation_region_add_ap (
+        region, ap, F_NO_PUBLISH_EVENTS);
+    }
+  automation_point_set_curviness (
+    region->aps[0], 0.6);
+
+  /* unlooped region after a gap */
+  position_set_to_bar (&start, 8);
+  position_set_to_bar (&end, 9);
+  ZRegion * region2 =
+    automation_region_new (
+      &start, &end, master->pos, at->index, 1);
+  track_add_region  (
+    master, region2, at, -1, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  for (int i = 0; i < 2; i++)
+    {
+      position_set_to_bar (&pos, 1);
+      position_add_beats (&pos, i + 1);
+      AutomationPoint * ap =
+        automation_point_new_float (
+          vals[i + 1], vals[i + 1], &pos);
+      automation_region_add_ap (
+        region2, ap, F_NO_PUBLISH_EVENTS);
+    }
+
+  position_set_to_bar (&pos, 11);
+  check_envelope_matches_regions (at, pos.frames);
+
+  /* each region is stored once, however many
+   * times it loops */
+  g_assert_cmpint (at->envelope->num_points, ==, 5);
+  position_set_to_bar (&pos, 80);
+  arranger_object_set_position (
+    (ArrangerObject *) region2, &pos,
+    ARRANGER_OBJECT_POSITION_TYPE_END,
+    F_NO_VALIDATE);
+  automation_track_update_envelope (at, true);
+  g_assert_cmpint (at->envelope->num_points, ==, 5);
+  check_envelope_matches_regions (at, pos.frames);
+  position_set_to_bar (&end, 9);
+  arranger_object_set_position (
+    (ArrangerObject *) region2, &end,
+    ARRANGER_OBJECT_POSITION_TYPE_END,
+    F_NO_VALIDATE);
+  position_set_to_bar (&pos, 11);
+  check_envelope_matches_regions (at, pos.frames);
+
+  /* check the next change inside a ramp and in
+   * the gap between the regions */
+  long change_frames;
+  position_set_to_bar (&pos, 2);
+  g_assert_true (
+    automation_track_get_next_change_frames (
+      at, pos.frames + 10, true, &change_frames));
+  g_assert_cmpint (
+    change_frames, ==, pos.frames + 11);
+  position_set_to_bar (&pos, 7);
+  g_assert_true (
+    automation_track_get_next_change_frames (
+      at, pos.frames, true, &change_frames));
+  /* the first point of the second region is at
+   * its 2nd beat */
+  position_set_to_bar (&pos, 8);
+  position_add_beats (&pos, 1);
+  g_assert_cmpint (change_frames, ==, pos.frames);
+  position_set_to_bar (&pos, 11);
+
+  /* editing a point invalidates the envelope */
+  automation_track_update_envelope (at, false);
+  automation_point_set_fvalue (
+    region->aps[1], 0.5f, F_NORMALIZED,
+    F_NO_PUBLISH_EVENTS);
+  g_assert_true (
+    g_atomic_int_get (&at->envelope_dirty));
+
+  /* and recompiles it when idle, without an
+   * action */
+  while (g_main_context_iteration (NULL, false));
+  g_assert_false (
+    g_atomic_int_get (&at->envelope_dirty));
+  check_envelope_matches_regions (at, pos.frames);
+
+  /* invalidations from other threads are picked
+   * up by the engine events timeout */
+  GThread * thread =
+    g_thread_new (
+      "invalidate",
+      (GThreadFunc) automation_track_invalidate_envelope,
+      at);
+  g_thread_join (thread);
+  g_assert_true (
+    g_atomic_int_get (&at->envelope_dirty));
+  engine_process_events (AUDIO_ENGINE);
+  g_assert_false (
+    g_atomic_int_get (&at->envelope_dirty));
+
+  /* muted regions give no value */
+  arranger_object_set_muted (
+    (ArrangerObject *) region2, true,
+    F_NO_PUBLISH_EVENTS);
+  check_envelope_matches_regions (at, pos.frames);
+
+  /* actions that do not touch the automation do
+   * not recompile the envelope */
+  automation_track_update_envelope (at, false);
+  AutomationEnvelope * envelope = at->envelope;
+  UndoableAction * ua =
+    tracklist_selections_action_new_create_midi (
+      TRACKLIST->num_tracks, 1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+  g_assert_true (at->envelope == envelope);
+  undo_manager_undo (UNDO_MANAGER);
+  g_assert_true (at->envelope == envelope);
+
+  test_helper_zrythm_cleanup ();
+}
+
+/**
+ * Returns whether the port gets a node when the
+ * graph is set up (the router's graph only keeps
+ * the nodes used during setup until it is
+ * rechained).
+ */
+static bool
+port_has_graph_node (
+  Port * port)
+{
+  Graph * graph = graph_new (ROUTER);
+  graph_setup (graph, true, false);
+  bool ret =
+    graph_find_node_from_port (graph, port) != NULL;
+  graph_free (graph);
+
+  return ret;
+}
+
+static void
+test_graph_prunes_static_ports ()
+{
+  test_helper_zrythm_init ();
+
+  Track * master = P_MASTER_TRACK;
+  AutomationTracklist * atl =
+    track_get_automation_tracklist (master);
+  AutomationTrack * at = atl->ats[0];
+  Port * port = automation_track_get_port (at);
+  g_assert_nonnull (port);
+
+  /* the port has no automation so it should not
+   * be in the graph */
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+  g_assert_false (port_has_graph_node (port));
+  g_assert_cmpint (
+    ROUTER->graph->num_pruned_ports, >, 0);
+  int num_pruned = ROUTER->graph->num_pruned_ports;
+
+  /* add an automation region and check that the
+   * port is added back */
+  Position start, end;
+  position_set_to_bar (&start, 2);
+  position_set_to_bar (&end, 4);
+  ZRegion * region =
+    automation_region_new (
+      &start, &end, master->pos, at->index, 0);
+  track_add_region  (
+    master, region, at, -1, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  arranger_object_select (
+    (ArrangerObject *) region, F_SELECT,
+    F_NO_APPEND, F_NO_PUBLISH_EVENTS);
+  UndoableAction * ua =
+    arranger_selections_action_new_create (
+      (ArrangerSelections *) TL_SELECTIONS);
+  undo_manager_perform (UNDO_MANAGER, ua);
+
+  g_assert_true (port_has_graph_node (port));
+  g_assert_cmpint (
+    ROUTER->graph->num_pruned_ports, ==,
+    num_pruned - 1);
+
+  test_helper_zrythm_cleanup ();
+}
+
+/** Gain coefficient of eg-amp for the given gain
+ * in dB. */
+#define EG_AMP_DB_CO(g) \
+  ((g) > -90.0f ? powf (10.0f, (g) * 0.05f) : 0.0f)
+
+static ZRegion *
+add_automation_region_with_value (
+  Track *           track,
+  AutomationTrack * at,
+  long              start_frames,
+  long              end_frames,
+  int               idx,
+  float             normalized_val)
+{
+  Position start, end, pos;
+  position_from_frames (&start, start_frames);
+  position_from_frames (&end, end_frames);
+  ZRegion * region =
+    automation_region_new (
+      &start, &end, track->pos, at->index, idx);
+  track_add_region  (
+    track, region, at, -1, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+  position_set_to_bar (&pos, 1);
+  Port * port = automation_track_get_port (at);
+  AutomationPoint * ap =
+    automation_point_new_float (
+      control_port_normalized_val_to_real (
+        port, normalized_val),
+      normalized_val, &pos);
+  automation_region_add_ap (
+    region, ap, F_NO_PUBLISH_EVENTS);
+
+  return region;
+}
+
+/**
+ * Checks that an automation change in the middle
+ * of a cycle is applied to the plugin at the frame
+ * of the change.
+ */
+static void
+test_sub_block_automation ()
+{
+  test_helper_zrythm_init ();
+
+  /* create an audio track with eg-amp */
+  char * filepath =
+    g_build_filename (
+      TESTS_SRCDIR, "test.wav", NULL);
+  SupportedFile * file =
+    supported_file_new_from_path (filepath);
+  g_free (filepath);
+  Position pos;
+  position_set_to_bar (&pos, 1);
+  int track_pos = TRACKLIST->num_tracks;
+  UndoableAction * ua =
+    tracklist_selections_action_new_create (
+      TRACK_TYPE_AUDIO, NULL, file, track_pos,
+      &pos, 1, -1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+  supported_file_free (file);
+  Track * track = TRACKLIST->tracks[track_pos];
+  PluginSetting * setting =
+    test_plugin_manager_get_plugin_setting (
+      EG_AMP_BUNDLE_URI, EG_AMP_URI, false);
+  ua =
+    mixer_selections_action_new_create (
+      PLUGIN_SLOT_INSERT, track_pos, 0, setting,
+      1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+  Plugin * pl = track->channel->inserts[0];
+  g_assert_nonnull (pl);
+
+  Port * in = NULL;
+  Port * out = NULL;
+  Port * gain = NULL;
+  for (int i = 0; i < pl->num_in_ports; i++)
+    {
+      Port * port = pl->in_ports[i];
+      if (port->id.type == TYPE_AUDIO && !in)
+        in = port;
+      else if (port->id.type == TYPE_CONTROL &&
+               string_is_equal (port->id.sym, "gain"))
+        gain = port;
+    }
+  for (int i = 0; i < pl->num_out_ports; i++)
+    {
+      Port * port = pl->out_ports[i];
+      if (port->id.type == TYPE_AUDIO && !out)
+        out = port;
+    }
+  g_assert_nonnull (in);
+  g_assert_nonnull (out);
+  g_assert_nonnull (gain);
+  AutomationTrack * at =
+    automation_tracklist_get_at_from_port (
+      track_get_automation_tracklist (track), gain);
+  g_assert_nonnull (at);
+
+  /* change the gain in the middle of the first
+   * cycle (the file has signal there) */
+  const long start_frames = 4800;
+  const nframes_t nframes =
+    AUDIO_ENGINE->block_length;
+  long change_frames =
+    start_frames + (long) (nframes / 2 + 7);
+  add_automation_region_with_value (
+    track, at, 0, change_frames, 0, 0.5f);
+  ZRegion * region =
+    add_automation_region_with_value (
+      track, at, change_frames,
+      change_frames + (long) nframes * 4, 1, 0.9f);
+  change_frames =
+    ((ArrangerObject *) region)->pos.frames;
+  g_assert_cmpint (
+    change_frames - start_frames, >, 16);
+  g_assert_cmpint (
+    change_frames, <, start_frames + (long) nframes);
+  automation_track_update_envelope (at, false);
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+
+  const float coef_before =
+    EG_AMP_DB_CO (
+      control_port_normalized_val_to_real (
+        gain, 0.5f));
+  const float coef_after =
+    EG_AMP_DB_CO (
+      control_port_normalized_val_to_real (
+        gain, 0.9f));
+  g_assert_cmpfloat (
+    fabsf (coef_before - coef_after), >, 0.1f);
+
+  /* enable sample-accurate automation and process
+   * a cycle manually */
+  test_project_stop_dummy_engine ();
+  AUDIO_ENGINE->automation_sub_block_size = 16;
+  position_from_frames (&pos, start_frames);
+  transport_move_playhead (
+    TRANSPORT, &pos, F_NO_PANIC, false,
+    F_NO_PUBLISH_EVENTS);
+  transport_request_roll (TRANSPORT);
+  engine_process (AUDIO_ENGINE, nframes);
+
+  int num_checked_before = 0;
+  int num_checked_after = 0;
+  for (nframes_t i = 0; i < nframes; i++)
+    {
+      float in_val = in->buf[i];
+      if (fabsf (in_val) < 0.001f)
+        continue;
+
+      bool before =
+        start_frames + (long) i < change_frames;
+      float expected =
+        in_val * (before ? coef_before : coef_after);
+      g_assert_cmpfloat_with_epsilon (
+        out->buf[i], expected,
+        fabsf (expected) * 0.0001f + 0.000001f);
+      if (before)
+        num_checked_before++;
+      else
+        num_checked_after++;
+    }
+  g_assert_cmpint (num_checked_before, >, 0);
+  g_assert_cmpint (num_checked_after, >, 0);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -96,6 +539,15 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test set at index",
     (GTestFunc) test_set_at_index);
+  g_test_add_func (
+    TEST_PREFIX "test envelope",
+    (GTestFunc) test_envelope);
+  g_test_add_func (
+    TEST_PREFIX "test graph prunes static ports",
+    (GTestFunc) test_graph_prunes_static_ports);
+  g_test_add_func (
+    TEST_PREFIX "test sub block automation",
+    (GTestFunc) test_sub_block_automation);
 
   return g_test_run ();
 }
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <string.h>
+
+#include "audio/dsp_profiler.h"
+#include "audio/engine.h"
+#include "project.h"
+#include "utils/io.h"
+#include "zrythm.h"
+
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+static void
+test_profile_nodes (void)
+{
+  test_helper_zrythm_init ();
+
+  g_assert_null (AUDIO_ENGINE->profiler);
+  engine_set_dsp_profiling (AUDIO_ENGINE, true);
+  DspProfiler * profiler = AUDIO_ENGINE->profiler;
+  g_assert_nonnull (profiler);
+
+  /* let the engine run */
+  g_usleep (200000);
+  dsp_profiler_collect (profiler);
+  g_assert_cmpuint (
+    g_hash_table_size (profiler->stats), >, 1);
+  g_assert_cmpuint (
+    profiler->num_trace_events, >, 0);
+
+  /* check that cycles and nodes were recorded
+   * with sane timings */
+  bool have_cycle = false;
+  bool have_node = false;
+  GHashTableIter iter;
+  gpointer value;
+  g_hash_table_iter_init (&iter, profiler->stats);
+  while (g_hash_table_iter_next (
+           &iter, NULL, &value))
+    {
+      DspProfilerStats * stats =
+        (DspProfilerStats *) value;
+      g_assert_cmpint (stats->num_durations, >, 0);
+      gint64 p50 =
+        dsp_profiler_stats_get_percentile (
+          stats, 50.0);
+      gint64 p99 =
+        dsp_profiler_stats_get_percentile (
+          stats, 99.0);
+      g_assert_cmpint (p50, >=, 0);
+      g_assert_cmpint (p50, <=, p99);
+
+      if (stats->ev.node_type == DSP_PROFILER_CYCLE)
+        have_cycle = true;
+      else
+        have_node = true;
+
+      char * name =
+        dsp_profiler_event_get_name (&stats->ev);
+      g_assert_nonnull (name);
+      g_free (name);
+    }
+  g_assert_true (have_cycle);
+  g_assert_true (have_node);
+
+  char * summary =
+    dsp_profiler_get_summary (profiler, 5);
+  g_assert_nonnull (summary);
+  g_assert_cmpuint (strlen (summary), >, 0);
+  g_free (summary);
+
+  /* write the trace */
+  char * tmp_dir =
+    g_dir_make_tmp ("zrythm_dsp_trace_XXXXXX", NULL);
+  char * filepath =
+    g_build_filename (tmp_dir, "trace.json", NULL);
+  char * err =
+    dsp_profiler_write_trace (profiler, filepath);
+  g_assert_null (err);
+  char * contents = NULL;
+  g_assert_true (
+    g_file_get_contents (
+      filepath, &contents, NULL, NULL));
+  g_assert_nonnull (
+    strstr (contents, "\"traceEvents\""));
+  g_assert_nonnull (
+    strstr (contents, "\"name\":\"Cycle\""));
+  g_assert_nonnull (
+    strstr (contents, "\"ph\":\"X\""));
+
+  /* timestamps are relative to the earliest
+   * event */
+  g_assert_null (strstr (contents, "\"ts\":-"));
+  g_free (contents);
+  g_unlink (filepath);
+  g_rmdir (tmp_dir);
+  g_free (filepath);
+  g_free (tmp_dir);
+
+  engine_set_dsp_profiling (AUDIO_ENGINE, false);
+  g_assert_null (AUDIO_ENGINE->profiler);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/dsp_profiler/"
+
+  g_test_add_func (
+    TEST_PREFIX "test profile nodes",
+    (GTestFunc) test_profile_nodes);
+
+  return g_test_run ();
+}
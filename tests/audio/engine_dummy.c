@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "audio/engine.h"
+#include "audio/engine_dummy.h"
+#include "audio/transport.h"
+#include "project.h"
+#include "zrythm.h"
+
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+
+/** Time to let the engine run for, in ms. */
+#define RUN_TIME_MS 200
+
+/**
+ * Rolls for RUN_TIME_MS and returns the number of
+ * frames the playhead moved.
+ */
+static long
+get_frames_rolled (void)
+{
+  long start_frames = PLAYHEAD->frames;
+  g_usleep (RUN_TIME_MS * 1000);
+  return PLAYHEAD->frames - start_frames;
+}
+
+static void
+test_freewheel (void)
+{
+  test_helper_zrythm_init ();
+
+  g_assert_true (
+    AUDIO_ENGINE->audio_backend ==
+      AUDIO_BACKEND_DUMMY);
+
+  TRANSPORT->loop = false;
+  TRANSPORT->play_state = PLAYSTATE_ROLLING;
+
+  long realtime_frames =
+    ((long) AUDIO_ENGINE->sample_rate *
+       RUN_TIME_MS) / 1000;
+
+  /* paced mode never runs ahead of realtime */
+  long frames = get_frames_rolled ();
+  g_assert_cmpint (frames, >, 0);
+  g_assert_cmpint (
+    frames, <,
+    realtime_frames +
+      4 * (long) AUDIO_ENGINE->block_length);
+
+  /* freewheel runs as fast as possible */
+  engine_dummy_set_freewheel (AUDIO_ENGINE, true);
+  frames = get_frames_rolled ();
+  g_assert_cmpint (frames, >, realtime_frames * 2);
+
+  /* and going back to paced mode does not try to
+   * catch up */
+  engine_dummy_set_freewheel (AUDIO_ENGINE, false);
+  g_usleep (20000);
+  frames = get_frames_rolled ();
+  g_assert_cmpint (
+    frames, <,
+    realtime_frames +
+      4 * (long) AUDIO_ENGINE->block_length);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/engine_dummy/"
+
+  g_test_add_func (
+    TEST_PREFIX "test freewheel",
+    (GTestFunc) test_freewheel);
+
+  return g_test_run ();
+}
@@ -118,6 +118,9 @@ test_export_wav ()
           ret = exporter_export (&settings);
           g_assert_false (AUDIO_ENGINE->exporting);
           g_assert_cmpint (ret, ==, 0);
+          g_assert_cmpint (settings.num_frames, >, 0);
+          g_assert_true (settings.peaks[0] > 0.f);
+          g_assert_true (settings.peaks[1] > 0.f);
 
           z_chromaprint_check_fingerprint_similarity (
             filepath, settings.file_uri, 83, 6);
@@ -0,0 +1,490 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "actions/mixer_selections_action.h"
+#include "actions/port_connection_action.h"
+#include "actions/tracklist_selections.h"
+#include "actions/undo_manager.h"
+#include "audio/engine.h"
+#include "audio/graph.h"
+#include "audio/graph_buffer_planner.h"
+#include "audio/router.h"
+#include "audio/supported_file.h"
+#include "audio/transport.h"
+#include "plugins/plugin.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "utils/objects.h"
+#include "utils/string.h"
+#include "zrythm.h"
+
+#include "tests/helpers/plugin_manager.h"
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#define NUM_INSERTS 4
+
+/** Number of cycles to render when comparing. */
+#define NUM_RENDER_CYCLES 64
+
+static Port *
+get_audio_port (
+  Plugin * pl,
+  bool     input)
+{
+  int num_ports =
+    input ? pl->num_in_ports : pl->num_out_ports;
+  for (int i = 0; i < num_ports; i++)
+    {
+      Port * port =
+        input ? pl->in_ports[i] : pl->out_ports[i];
+      if (port->id.type == TYPE_AUDIO)
+        return port;
+    }
+  g_assert_not_reached ();
+}
+
+static Port *
+get_gain_port (
+  Plugin * pl)
+{
+  for (int i = 0; i < pl->num_in_ports; i++)
+    {
+      Port * port = pl->in_ports[i];
+      if (port->id.type == TYPE_CONTROL &&
+          string_is_equal (port->id.sym, "gain"))
+        return port;
+    }
+  g_assert_not_reached ();
+}
+
+/**
+ * Adds an eg-amp insert at the given slot.
+ */
+static Plugin *
+add_amp (
+  Track * track,
+  int     slot,
+  float   gain_db)
+{
+  PluginSetting * setting =
+    test_plugin_manager_get_plugin_setting (
+      EG_AMP_BUNDLE_URI, EG_AMP_URI, false);
+  UndoableAction * ua =
+    mixer_selections_action_new_create (
+      PLUGIN_SLOT_INSERT, track->pos, slot, setting,
+      1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+  plugin_setting_free (setting);
+
+  Plugin * pl = track->channel->inserts[slot];
+  g_assert_nonnull (pl);
+
+  /* use a different gain on each plugin so that
+   * reading the wrong buffer changes the output */
+  port_set_control_value (
+    get_gain_port (pl), gain_db, F_NOT_NORMALIZED,
+    F_NO_PUBLISH_EVENTS);
+
+  return pl;
+}
+
+static void
+connect_ports (
+  Port * src,
+  Port * dest)
+{
+  UndoableAction * ua =
+    port_connection_action_new_connect (
+      &src->id, &dest->id);
+  undo_manager_perform (UNDO_MANAGER, ua);
+}
+
+/**
+ * Creates an audio track with a region and a
+ * chain of NUM_INSERTS plugins.
+ */
+static Track *
+create_chain_track (void)
+{
+  char * filepath =
+    g_build_filename (
+      TESTS_SRCDIR, "test.wav", NULL);
+  SupportedFile * file =
+    supported_file_new_from_path (filepath);
+  g_free (filepath);
+  Position pos;
+  position_set_to_bar (&pos, 1);
+  int track_pos = TRACKLIST->num_tracks;
+  UndoableAction * ua =
+    tracklist_selections_action_new_create (
+      TRACK_TYPE_AUDIO, NULL, file, track_pos,
+      &pos, 1, -1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+  supported_file_free (file);
+
+  Track * track = TRACKLIST->tracks[track_pos];
+  for (int i = 0; i < NUM_INSERTS; i++)
+    {
+      add_amp (track, i, -3.f + (float) i * 1.5f);
+    }
+
+  return track;
+}
+
+/**
+ * Plugins with internal state (eg, the envelope
+ * of a compressor) must start each render from
+ * the same state.
+ */
+static void
+reset_plugins (
+  Plugin ** plugins,
+  int       num_plugins)
+{
+  for (int i = 0; i < num_plugins; i++)
+    {
+      plugin_activate (plugins[i], false);
+      plugin_activate (plugins[i], true);
+    }
+}
+
+/**
+ * Renders NUM_RENDER_CYCLES cycles from the start
+ * of the song and returns the interleaved master
+ * output.
+ *
+ * @param[out] time_us Time spent processing.
+ */
+static float *
+render (
+  Plugin ** stateful_plugins,
+  int       num_stateful_plugins,
+  gint64 *  time_us)
+{
+  reset_plugins (
+    stateful_plugins, num_stateful_plugins);
+
+  Position pos;
+  position_set_to_bar (&pos, 1);
+  transport_move_playhead (
+    TRANSPORT, &pos, F_NO_PANIC, false,
+    F_NO_PUBLISH_EVENTS);
+  transport_request_roll (TRANSPORT);
+
+  const nframes_t nframes =
+    AUDIO_ENGINE->block_length;
+  float * frames =
+    object_new_n (
+      (size_t) nframes * NUM_RENDER_CYCLES * 2,
+      float);
+  Port * l = P_MASTER_TRACK->channel->stereo_out->l;
+  Port * r = P_MASTER_TRACK->channel->stereo_out->r;
+  *time_us = 0;
+  for (int i = 0; i < NUM_RENDER_CYCLES; i++)
+    {
+      gint64 start = g_get_monotonic_time ();
+      engine_process (AUDIO_ENGINE, nframes);
+      *time_us += g_get_monotonic_time () - start;
+
+      float * dest =
+        &frames[(size_t) i * nframes * 2];
+      memcpy (
+        dest, l->buf, nframes * sizeof (float));
+      memcpy (
+        &dest[nframes], r->buf,
+        nframes * sizeof (float));
+    }
+
+  transport_request_pause (TRANSPORT);
+
+  return frames;
+}
+
+/**
+ * Renders the project with and without buffer
+ * sharing and checks that the output is identical.
+ */
+static void
+check_render_matches_unshared (
+  Plugin ** stateful_plugins,
+  int       num_stateful_plugins)
+{
+  Graph * graph = ROUTER->graph;
+  const size_t num_samples =
+    (size_t) AUDIO_ENGINE->block_length *
+    NUM_RENDER_CYCLES * 2;
+
+  AUDIO_ENGINE->share_port_buffers = false;
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+  g_assert_cmpint (graph->num_shared_ports, ==, 0);
+  gint64 unshared_us;
+  float * unshared =
+    render (
+      stateful_plugins, num_stateful_plugins,
+      &unshared_us);
+
+  AUDIO_ENGINE->share_port_buffers = true;
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+  g_assert_cmpint (graph->num_shared_ports, >, 0);
+  g_assert_cmpint (
+    graph->num_shared_bufs, <,
+    graph->num_shared_ports);
+  gint64 shared_us;
+  float * shared =
+    render (
+      stateful_plugins, num_stateful_plugins,
+      &shared_us);
+
+  /* make sure something was rendered */
+  bool has_signal = false;
+  for (size_t i = 0; i < num_samples; i++)
+    {
+      if (fabsf (unshared[i]) > 0.001f)
+        {
+          has_signal = true;
+          break;
+        }
+    }
+  g_assert_true (has_signal);
+
+  for (size_t i = 0; i < num_samples; i++)
+    {
+      g_assert_cmpfloat (shared[i], ==, unshared[i]);
+    }
+
+  size_t block_size =
+    AUDIO_ENGINE->block_length * sizeof (float);
+  g_message (
+    "%d port buffers: %zu KiB unshared, "
+    "%zu KiB shared; %d cycles: "
+    "%" G_GINT64_FORMAT " us unshared, "
+    "%" G_GINT64_FORMAT " us shared",
+    graph->num_shared_ports,
+    ((size_t) graph->num_shared_ports *
+       block_size) / 1024,
+    ((size_t) graph->num_shared_bufs * block_size) /
+      1024,
+    NUM_RENDER_CYCLES, unshared_us, shared_us);
+
+  free (unshared);
+  free (shared);
+}
+
+/**
+ * Checks that sharing does not change the output
+ * of a plain chain, of a plugin output feeding
+ * several inputs and of a sidechain.
+ */
+static void
+test_render_matches_unshared (void)
+{
+  test_helper_zrythm_init ();
+  test_project_stop_dummy_engine ();
+
+  /* plain chain */
+  Track * track = create_chain_track ();
+  check_render_matches_unshared (NULL, 0);
+
+  /* fan-out: the output of the second plugin
+   * also feeds a plugin on a bus */
+  UndoableAction * ua =
+    tracklist_selections_action_new_create (
+      TRACK_TYPE_AUDIO_BUS, NULL, NULL,
+      TRACKLIST->num_tracks, NULL, 1, -1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+  Track * bus =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  Plugin * bus_amp = add_amp (bus, 0, -6.f);
+  connect_ports (
+    get_audio_port (
+      track->channel->inserts[1], false),
+    get_audio_port (bus_amp, true));
+  check_render_matches_unshared (NULL, 0);
+
+#ifdef HAVE_LSP_SIDECHAIN_COMPRESSOR
+  /* sidechain: a compressor on another track is
+   * fed by the first plugin and keyed by the
+   * third one */
+  int lsp_track_pos =
+    test_plugin_manager_create_tracks_from_plugin (
+      LSP_SIDECHAIN_COMPRESSOR_BUNDLE,
+      LSP_SIDECHAIN_COMPRESSOR_URI, false, false,
+      1);
+  Plugin * lsp =
+    TRACKLIST->tracks[lsp_track_pos]->channel->
+      inserts[0];
+  Port * lsp_in = NULL;
+  Port * sidechain_port = NULL;
+  for (int i = 0; i < lsp->num_in_ports; i++)
+    {
+      Port * port = lsp->in_ports[i];
+      if (port->id.type != TYPE_AUDIO)
+        continue;
+
+      if (port->id.flags & PORT_FLAG_SIDECHAIN)
+        {
+          if (!sidechain_port)
+            sidechain_port = port;
+        }
+      else if (!lsp_in)
+        {
+          lsp_in = port;
+        }
+    }
+  g_assert_nonnull (lsp_in);
+  g_assert_nonnull (sidechain_port);
+  connect_ports (
+    get_audio_port (
+      track->channel->inserts[0], false),
+    lsp_in);
+  connect_ports (
+    get_audio_port (
+      track->channel->inserts[2], false),
+    sidechain_port);
+  check_render_matches_unshared (&lsp, 1);
+#endif
+
+  AUDIO_ENGINE->share_port_buffers = false;
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_share_plugin_buffers (void)
+{
+  test_helper_zrythm_init ();
+
+  /* create a chain of plugins */
+  int track_pos =
+    test_plugin_manager_create_tracks_from_plugin (
+      EG_AMP_BUNDLE_URI, EG_AMP_URI, false, false,
+      1);
+  Track * track = TRACKLIST->tracks[track_pos];
+  for (int i = 1; i < NUM_INSERTS; i++)
+    {
+      PluginSetting * setting =
+        test_plugin_manager_get_plugin_setting (
+          EG_AMP_BUNDLE_URI, EG_AMP_URI, false);
+      UndoableAction * ua =
+        mixer_selections_action_new_create (
+          PLUGIN_SLOT_INSERT, track_pos, i, setting,
+          1);
+      undo_manager_perform (UNDO_MANAGER, ua);
+    }
+
+  /* no sharing by default */
+  Graph * graph = ROUTER->graph;
+  g_assert_cmpint (graph->num_shared_ports, ==, 0);
+  g_assert_null (graph->shared_bufs);
+
+  AUDIO_ENGINE->share_port_buffers = true;
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+  g_assert_cmpint (
+    graph->num_shared_ports, ==, NUM_INSERTS * 2);
+  g_assert_cmpint (
+    graph->num_shared_bufs, <,
+    graph->num_shared_ports);
+  g_assert_cmpint (
+    (intptr_t) graph->shared_bufs %
+      GRAPH_SHARED_BUF_ALIGNMENT, ==, 0);
+
+  /* the input and output of a plugin and the
+   * output of a plugin and the input of the next
+   * plugin are in use at the same time */
+  for (int i = 0; i < NUM_INSERTS; i++)
+    {
+      Plugin * pl = track->channel->inserts[i];
+      Port * in = get_audio_port (pl, true);
+      Port * out = get_audio_port (pl, false);
+      g_assert_true (in->buf_is_shared);
+      g_assert_true (out->buf_is_shared);
+      g_assert_true (in->buf != out->buf);
+      if (i < NUM_INSERTS - 1)
+        {
+          Plugin * next_pl =
+            track->channel->inserts[i + 1];
+          g_assert_true (
+            out->buf !=
+              get_audio_port (next_pl, true)->buf);
+        }
+    }
+
+  /* let the engine run */
+  g_usleep (100000);
+
+  /* metered ports keep sharing and get a private
+   * copy for the UI without recalculating the
+   * graph */
+  Port * metered_port =
+    get_audio_port (
+      track->channel->inserts[1], false);
+  float * shared_buf = metered_port->buf;
+  port_subscribe_to_rings (metered_port);
+  g_assert_true (metered_port->buf_is_shared);
+  g_assert_true (metered_port->buf == shared_buf);
+  g_assert_nonnull (metered_port->pinned_buf);
+  g_assert_cmpint (
+    graph->num_shared_ports, ==, NUM_INSERTS * 2);
+  g_usleep (100000);
+  port_unsubscribe_from_rings (metered_port);
+  g_assert_null (metered_port->pinned_buf);
+
+  /* disabling gives the ports their own buffers
+   * back */
+  AUDIO_ENGINE->share_port_buffers = false;
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+  g_assert_cmpint (graph->num_shared_ports, ==, 0);
+  for (int i = 0; i < NUM_INSERTS; i++)
+    {
+      Plugin * pl = track->channel->inserts[i];
+      g_assert_false (
+        get_audio_port (pl, true)->buf_is_shared);
+      g_assert_false (
+        get_audio_port (pl, false)->buf_is_shared);
+    }
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/graph_buffer_planner/"
+
+  g_test_add_func (
+    TEST_PREFIX "test share plugin buffers",
+    (GTestFunc) test_share_plugin_buffers);
+  g_test_add_func (
+    TEST_PREFIX "test render matches unshared",
+    (GTestFunc) test_render_matches_unshared);
+
+  return g_test_run ();
+}
@@ -20,6 +20,10 @@
 #include "zrythm-test-config.h"
 
 #include "actions/tracklist_selections.h"
+#include "actions/undo_manager.h"
+#include "audio/midi_event.h"
+#include "audio/midi_note.h"
+#include "audio/midi_note_store.h"
 #include "audio/midi_region.h"
 #include "audio/region.h"
 #include "audio/transport.h"
@@ -105,6 +109,274 @@ test_export (void)
   io_rmdir (export_dir, true);
 }
 
+/**
+ * Asserts that the events are the same, ignoring
+ * their order.
+ */
+static void
+assert_events_equal (
+  MidiEvents * a,
+  MidiEvents * b)
+{
+  midi_events_sort (a, F_QUEUED);
+  midi_events_sort (b, F_QUEUED);
+  g_assert_cmpint (
+    a->num_queued_events, ==, b->num_queued_events);
+  for (int i = 0; i < a->num_queued_events; i++)
+    {
+      MidiEvent * ev_a = &a->queued_events[i];
+      MidiEvent * ev_b = &b->queued_events[i];
+      g_assert_cmpint (ev_a->type, ==, ev_b->type);
+      g_assert_cmpuint (
+        ev_a->note_pitch, ==, ev_b->note_pitch);
+      g_assert_cmpuint (
+        ev_a->velocity, ==, ev_b->velocity);
+      g_assert_cmpuint (
+        ev_a->channel, ==, ev_b->channel);
+      g_assert_cmpuint (ev_a->time, ==, ev_b->time);
+    }
+}
+
+static void
+test_note_store (void)
+{
+  test_helper_zrythm_init ();
+
+  Track * track =
+    track_new (
+      TRACK_TYPE_MIDI, TRACKLIST->num_tracks,
+      "Test MIDI Track", F_WITH_LANE,
+      F_NOT_AUDITIONER);
+  tracklist_append_track (
+    TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+    F_NO_RECALC_GRAPH);
+
+  Position start_pos, end_pos;
+  position_set_to_bar (&start_pos, 1);
+  position_set_to_bar (&end_pos, 5);
+  ZRegion * r =
+    midi_region_new (
+      &start_pos, &end_pos, track->pos, 0, 0);
+  track_add_region (
+    track, r, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+
+  /* add a few notes, one of them muted */
+  for (int i = 0; i < 4; i++)
+    {
+      Position mn_start_pos, mn_end_pos;
+      position_set_to_bar (&mn_start_pos, 1);
+      position_add_beats (&mn_start_pos, i);
+      position_set_to_pos (
+        &mn_end_pos, &mn_start_pos);
+      position_add_ticks (&mn_end_pos, 120);
+      MidiNote * mn =
+        midi_note_new (
+          &r->id, &mn_start_pos, &mn_end_pos,
+          (midi_byte_t) (60 + i),
+          (midi_byte_t) (70 + i));
+      midi_region_add_midi_note (
+        r, mn, F_NO_PUBLISH_EVENTS);
+    }
+  arranger_object_set_muted (
+    (ArrangerObject *) r->midi_notes[2], true,
+    F_NO_PUBLISH_EVENTS);
+
+  midi_region_update_note_store (r, false);
+  MidiNoteStore * store = r->note_store;
+  g_assert_nonnull (store);
+  g_assert_false (r->note_store_dirty);
+  g_assert_cmpint (
+    store->num_notes, ==, r->num_midi_notes);
+  for (int i = 0; i < r->num_midi_notes; i++)
+    {
+      MidiNote * mn = r->midi_notes[i];
+      ArrangerObject * mn_obj =
+        (ArrangerObject *) mn;
+      g_assert_cmpint (
+        store->start_frames[i], ==,
+        mn_obj->pos.frames);
+      g_assert_cmpint (
+        store->end_frames[i], ==,
+        mn_obj->end_pos.frames);
+      g_assert_cmpuint (
+        store->pitches[i], ==, mn->val);
+      g_assert_cmpuint (
+        store->velocities[i], ==, mn->vel->vel);
+      g_assert_cmpuint (
+        store->flags[i] & MIDI_NOTE_STORE_FLAG_MUTED,
+        ==,
+        mn_obj->muted ?
+          MIDI_NOTE_STORE_FLAG_MUTED : 0);
+    }
+
+  /* the store produces the same events as the
+   * notes */
+  MidiEvents * store_events = midi_events_new ();
+  MidiEvents * note_events = midi_events_new ();
+  const nframes_t nframes = 256;
+  long end_frames =
+    ((ArrangerObject *) r)->end_pos.frames;
+  for (long frames = start_pos.frames;
+       frames < end_frames;
+       frames += nframes)
+    {
+      midi_region_fill_midi_events (
+        r, frames, 0, nframes, false,
+        store_events);
+      midi_region_invalidate_note_store (r);
+      midi_region_fill_midi_events (
+        r, frames, 0, nframes, false,
+        note_events);
+      g_atomic_int_set (&r->note_store_dirty, 0);
+
+      assert_events_equal (
+        store_events, note_events);
+      midi_events_clear (store_events, F_QUEUED);
+      midi_events_clear (note_events, F_QUEUED);
+    }
+  midi_events_free (store_events);
+  midi_events_free (note_events);
+
+  /* edits mark the store as out of date */
+  midi_note_set_val (r->midi_notes[0], 40);
+  g_assert_true (r->note_store_dirty);
+  midi_region_update_note_store (r, false);
+  g_assert_true (r->note_store != store);
+  g_assert_cmpuint (
+    r->note_store->pitches[0], ==, 40);
+
+  midi_region_remove_midi_note (
+    r, r->midi_notes[3], F_FREE,
+    F_NO_PUBLISH_EVENTS);
+  g_assert_true (r->note_store_dirty);
+  midi_region_update_note_store (r, false);
+  g_assert_cmpint (
+    r->note_store->num_notes, ==, 3);
+
+  /* unrelated actions don't recreate the store */
+  store = r->note_store;
+  UndoableAction * ua =
+    tracklist_selections_action_new_create_midi (
+      TRACKLIST->num_tracks, 1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+  g_assert_true (r->note_store == store);
+  undo_manager_undo (UNDO_MANAGER);
+  g_assert_true (r->note_store == store);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_note_store_events (void)
+{
+  test_helper_zrythm_init ();
+
+  Track * track =
+    track_new (
+      TRACK_TYPE_MIDI, TRACKLIST->num_tracks,
+      "Test MIDI Track", F_WITH_LANE,
+      F_NOT_AUDITIONER);
+  tracklist_append_track (
+    TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+    F_NO_RECALC_GRAPH);
+
+  Position start_pos, end_pos;
+  position_set_to_bar (&start_pos, 1);
+  position_set_to_bar (&end_pos, 3);
+  ZRegion * r =
+    midi_region_new (
+      &start_pos, &end_pos, track->pos, 0, 0);
+  track_add_region (
+    track, r, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+
+  /* add short overlapping notes in reverse order,
+   * each starting where the next one ends */
+  const int num_notes = 64;
+  for (int i = num_notes - 1; i >= 0; i--)
+    {
+      Position mn_start_pos, mn_end_pos;
+      position_from_frames (&mn_start_pos, i * 10);
+      position_from_frames (
+        &mn_end_pos, (i + 1) * 10);
+      MidiNote * mn =
+        midi_note_new (
+          &r->id, &mn_start_pos, &mn_end_pos,
+          (midi_byte_t) (i % 2 ? 60 : 61),
+          (midi_byte_t) (i + 1));
+      midi_region_add_midi_note (
+        r, mn, F_NO_PUBLISH_EVENTS);
+    }
+  midi_region_update_note_store (r, true);
+
+  MidiNoteStore * store = r->note_store;
+  g_assert_cmpint (
+    store->num_events, ==, num_notes * 2);
+  for (int i = 1; i < store->num_events; i++)
+    {
+      MidiNoteStoreEvent * prev_ev =
+        &store->events[i - 1];
+      MidiNoteStoreEvent * ev = &store->events[i];
+      g_assert_cmpint (
+        prev_ev->frames, <=, ev->frames);
+      if (prev_ev->frames == ev->frames)
+        {
+          g_assert_false (prev_ev->note_on);
+        }
+    }
+  g_assert_cmpint (
+    midi_note_store_find_first_event (store, -100),
+    ==, 0);
+  g_assert_cmpint (
+    midi_note_store_find_first_event (store, 0),
+    ==, 0);
+  g_assert_cmpint (
+    midi_note_store_find_first_event (store, 1),
+    ==, 1);
+  g_assert_cmpint (
+    midi_note_store_find_first_event (
+      store, num_notes * 10),
+    ==, store->num_events);
+
+  /* the filled events are already sorted and are
+   * the same as the ones from the notes */
+  MidiEvents * store_events = midi_events_new ();
+  MidiEvents * note_events = midi_events_new ();
+  const nframes_t nframes = 32;
+  for (long frames = start_pos.frames;
+       frames < start_pos.frames + num_notes * 10;
+       frames += nframes)
+    {
+      midi_region_fill_midi_events (
+        r, frames, 0, nframes, true, store_events);
+      for (int i = 1;
+           i < store_events->num_queued_events; i++)
+        {
+          MidiEvent * prev_ev =
+            &store_events->queued_events[i - 1];
+          MidiEvent * ev =
+            &store_events->queued_events[i];
+          g_assert_cmpuint (
+            prev_ev->time, <=, ev->time);
+        }
+
+      midi_region_invalidate_note_store (r);
+      midi_region_fill_midi_events (
+        r, frames, 0, nframes, true, note_events);
+      g_atomic_int_set (&r->note_store_dirty, 0);
+
+      assert_events_equal (
+        store_events, note_events);
+      midi_events_clear (store_events, F_QUEUED);
+      midi_events_clear (note_events, F_QUEUED);
+    }
+  midi_events_free (store_events);
+  midi_events_free (note_events);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -115,6 +387,12 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test export",
     (GTestFunc) test_export);
+  g_test_add_func (
+    TEST_PREFIX "test note store",
+    (GTestFunc) test_note_store);
+  g_test_add_func (
+    TEST_PREFIX "test note store events",
+    (GTestFunc) test_note_store_events);
 
   return g_test_run ();
 }
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "audio/offline_processor.h"
+#include "utils/objects.h"
+
+#include <glib.h>
+
+#define CHANNELS 2
+
+/* not a multiple of the chunk size */
+#define NUM_FRAMES \
+  (5 * OFFLINE_PROCESSOR_CHUNK_FRAMES + 123)
+
+static void
+reverse_chunk (
+  OfflineProcessor *      self,
+  OfflineProcessorChunk * chunk)
+{
+  for (size_t i = chunk->start_frame;
+       i < chunk->start_frame + chunk->num_frames;
+       i++)
+    {
+      for (size_t j = 0; j < self->channels; j++)
+        {
+          self->dest[i * self->channels + j] =
+            self->src[
+              ((self->num_frames - i) - 1) *
+                self->channels + j];
+        }
+    }
+}
+
+static void
+get_abs_peak_of_chunk (
+  OfflineProcessor *      self,
+  OfflineProcessorChunk * chunk)
+{
+  const float * src =
+    offline_processor_get_chunk_src (self, chunk);
+  for (size_t i = 0;
+       i < chunk->num_frames * self->channels; i++)
+    {
+      chunk->result =
+        MAX (chunk->result, fabsf (src[i]));
+    }
+}
+
+static void
+cancel_chunk (
+  OfflineProcessor *      self,
+  OfflineProcessorChunk * chunk)
+{
+  self->progress_info->cancelled = true;
+}
+
+static float *
+create_src (void)
+{
+  float * src =
+    object_new_n (NUM_FRAMES * CHANNELS, float);
+  for (size_t i = 0; i < NUM_FRAMES * CHANNELS; i++)
+    {
+      src[i] = sinf ((float) i * 0.001f);
+    }
+
+  /* put the peak in the last chunk */
+  src[NUM_FRAMES * CHANNELS - 3] = -1.5f;
+
+  return src;
+}
+
+static void
+test_process_in_chunks (void)
+{
+  float * src = create_src ();
+  float * dest =
+    object_new_n (NUM_FRAMES * CHANNELS, float);
+
+  GenericProgressInfo progress_info;
+  memset (
+    &progress_info, 0, sizeof (progress_info));
+  OfflineProcessor * processor =
+    offline_processor_new (
+      src, dest, NUM_FRAMES, CHANNELS, 2,
+      &progress_info, NULL);
+  g_assert_cmpint (processor->num_chunks, ==, 6);
+  g_assert_cmpuint (
+    processor->chunks[5].num_frames, ==, 123);
+
+  /* reduction */
+  int ret =
+    offline_processor_run_pass (
+      processor, get_abs_peak_of_chunk);
+  g_assert_cmpint (ret, ==, 0);
+  g_assert_cmpfloat_with_epsilon (
+    offline_processor_get_max_result (processor),
+    1.5f, 0.00001f);
+  g_assert_cmpfloat_with_epsilon (
+    progress_info.progress, 0.5, 0.00001);
+
+  /* output matches the serial reference */
+  ret =
+    offline_processor_run_pass (
+      processor, reverse_chunk);
+  g_assert_cmpint (ret, ==, 0);
+  for (size_t i = 0; i < NUM_FRAMES; i++)
+    {
+      for (size_t j = 0; j < CHANNELS; j++)
+        {
+          g_assert_cmpfloat (
+            dest[i * CHANNELS + j], ==,
+            src[(NUM_FRAMES - i - 1) * CHANNELS + j]);
+        }
+    }
+  g_assert_cmpfloat_with_epsilon (
+    progress_info.progress, 1.0, 0.00001);
+
+  offline_processor_free (processor);
+  free (src);
+  free (dest);
+}
+
+static void
+test_cancel (void)
+{
+  float * src = create_src ();
+  float * dest =
+    object_new_n (NUM_FRAMES * CHANNELS, float);
+
+  GenericProgressInfo progress_info;
+  memset (
+    &progress_info, 0, sizeof (progress_info));
+  OfflineProcessor * processor =
+    offline_processor_new (
+      src, dest, NUM_FRAMES, CHANNELS, 1,
+      &progress_info, NULL);
+
+  int ret =
+    offline_processor_run_pass (
+      processor, cancel_chunk);
+  g_assert_cmpint (ret, !=, 0);
+
+  /* nothing is processed once cancelled */
+  ret =
+    offline_processor_run_pass (
+      processor, reverse_chunk);
+  g_assert_cmpint (ret, !=, 0);
+  for (size_t i = 0; i < NUM_FRAMES * CHANNELS; i++)
+    {
+      g_assert_cmpfloat (dest[i], ==, 0.f);
+    }
+
+  offline_processor_free (processor);
+  free (src);
+  free (dest);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/offline_processor/"
+
+  g_test_add_func (
+    TEST_PREFIX "test process in chunks",
+    (GTestFunc) test_process_in_chunks);
+  g_test_add_func (
+    TEST_PREFIX "test cancel",
+    (GTestFunc) test_cancel);
+
+  return g_test_run ();
+}
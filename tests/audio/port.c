@@ -20,6 +20,8 @@
 #include "zrythm-test-config.h"
 
 #include "actions/tracklist_selections.h"
+#include "audio/engine.h"
+#include "audio/meter.h"
 #include "audio/midi_region.h"
 #include "audio/region.h"
 #include "audio/transport.h"
@@ -28,6 +30,8 @@
 #include "utils/io.h"
 #include "zrythm.h"
 
+#include "zix/ring.h"
+
 #include "tests/helpers/project.h"
 #include "tests/helpers/zrythm.h"
 
@@ -151,6 +155,158 @@ test_serialization (void)
   test_helper_zrythm_cleanup ();
 }
 
+/**
+ * Counts the ports in the project that have ring
+ * buffers and returns the memory used by them.
+ */
+static size_t
+get_ring_memory (
+  int * num_rings)
+{
+  size_t max_size = 20;
+  Port ** ports =
+    object_new_n (max_size, Port *);
+  int num_ports = 0;
+  port_get_all (
+    &ports, &max_size, true, &num_ports);
+  size_t mem = 0;
+  *num_rings = 0;
+  for (int i = 0; i < num_ports; i++)
+    {
+      Port * port = ports[i];
+      if (port->audio_ring)
+        {
+          (*num_rings)++;
+          mem += zix_ring_capacity (port->audio_ring);
+        }
+      if (port->midi_ring)
+        {
+          (*num_rings)++;
+          mem += zix_ring_capacity (port->midi_ring);
+        }
+    }
+  free (ports);
+
+  return mem;
+}
+
+static void
+test_rings_on_demand (void)
+{
+  test_helper_zrythm_init ();
+
+  /* generate a project with many tracks */
+  UndoableAction * ua =
+    tracklist_selections_action_new_create (
+      TRACK_TYPE_AUDIO_BUS, NULL, NULL,
+      TRACKLIST->num_tracks, NULL, 64, -1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+
+  /* no rings without subscribers */
+  int num_rings;
+  size_t mem = get_ring_memory (&num_rings);
+  g_assert_cmpint (num_rings, ==, 0);
+  g_assert_cmpuint (mem, ==, 0);
+
+  /* process a few cycles and check that nothing
+   * is written */
+  Port * l = P_MASTER_TRACK->channel->stereo_out->l;
+  for (int i = 0; i < 4; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+  g_assert_null (l->audio_ring);
+
+  /* subscribe twice and check that the ring is
+   * allocated once and filled */
+  port_subscribe_to_rings (l);
+  port_subscribe_to_rings (l);
+  g_assert_true (port_has_ring_subscribers (l));
+  ZixRing * ring = l->audio_ring;
+  g_assert_nonnull (ring);
+  mem = get_ring_memory (&num_rings);
+  g_assert_cmpint (num_rings, ==, 1);
+  g_assert_cmpuint (mem, >=, zix_ring_capacity (ring));
+  for (int i = 0; i < 4; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+  g_assert_cmpuint (
+    zix_ring_read_space (ring), >=,
+    AUDIO_ENGINE->block_length * sizeof (float));
+
+  /* the ring is released with the last
+   * subscriber */
+  port_unsubscribe_from_rings (l);
+  g_assert_true (l->audio_ring == ring);
+  port_unsubscribe_from_rings (l);
+  g_assert_false (port_has_ring_subscribers (l));
+  g_assert_null (l->audio_ring);
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_meter_outlives_port (void)
+{
+  test_helper_zrythm_init ();
+
+  UndoableAction * ua =
+    tracklist_selections_action_new_create (
+      TRACK_TYPE_AUDIO_BUS, NULL, NULL,
+      TRACKLIST->num_tracks, NULL, 1, -1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+  Track * track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  Port * port = track->channel->stereo_out->l;
+  Meter * meter = meter_new_for_port (port);
+  g_assert_true (meter->subscribed);
+  g_assert_true (port_has_ring_subscribers (port));
+
+  /* freeing the meter after its port is freed
+   * must not touch the port */
+  undo_manager_undo (UNDO_MANAGER);
+  meter_set_subscribed (meter, false);
+  g_assert_false (meter->subscribed);
+  meter_free (meter);
+
+  /* a meter of a port that was replaced by one
+   * with the same identifier does not release the
+   * subscription of another meter on the new
+   * port */
+  undo_manager_redo (UNDO_MANAGER);
+  track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  meter =
+    meter_new_for_port (track->channel->stereo_out->l);
+  g_assert_cmpuint (meter->ring_token, !=, 0);
+  undo_manager_undo (UNDO_MANAGER);
+  undo_manager_redo (UNDO_MANAGER);
+  track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  port = track->channel->stereo_out->l;
+  Meter * new_meter = meter_new_for_port (port);
+  g_assert_cmpuint (
+    new_meter->ring_token, !=, meter->ring_token);
+  meter_free (meter);
+  g_assert_true (port_has_ring_subscribers (port));
+  meter_free (new_meter);
+  g_assert_false (port_has_ring_subscribers (port));
+
+  /* a live port is unsubscribed */
+  port = P_MASTER_TRACK->channel->stereo_out->l;
+  meter = meter_new_for_port (port);
+  g_assert_true (port_has_ring_subscribers (port));
+  meter_free (meter);
+  g_assert_false (port_has_ring_subscribers (port));
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -158,6 +314,12 @@ main (int argc, char *argv[])
 
 #define TEST_PREFIX "/audio/port/"
 
+  g_test_add_func (
+    TEST_PREFIX "test rings on demand",
+    (GTestFunc) test_rings_on_demand);
+  g_test_add_func (
+    TEST_PREFIX "test meter outlives port",
+    (GTestFunc) test_meter_outlives_port);
   g_test_add_func (
     TEST_PREFIX "test port disconnect",
     (GTestFunc) test_port_disconnect);
@@ -20,8 +20,10 @@
 #include "zrythm-test-config.h"
 
 #include "actions/tracklist_selections.h"
+#include "audio/midi_note.h"
 #include "audio/midi_region.h"
 #include "audio/region.h"
+#include "audio/track.h"
 #include "audio/transport.h"
 #include "project.h"
 #include "utils/flags.h"
@@ -236,6 +238,116 @@ test_timeline_frames_to_local (void)
   g_assert_cmpint (localp, ==, 13000);
 }
 
+static void
+add_notes (
+  ZRegion * region,
+  int       num_notes,
+  uint8_t   first_val)
+{
+  for (int i = 0; i < num_notes; i++)
+    {
+      Position start_pos, end_pos;
+      position_set_to_bar (&start_pos, 1 + i);
+      position_set_to_bar (&end_pos, 2 + i);
+      MidiNote * mn =
+        midi_note_new (
+          &region->id, &start_pos, &end_pos,
+          (uint8_t) (first_val + i), 80);
+      midi_region_add_midi_note (
+        region, mn, F_NO_PUBLISH_EVENTS);
+    }
+}
+
+static ZRegion *
+create_linked_test_region (
+  Track * track)
+{
+  Position pos, end_pos;
+  position_init (&pos);
+  position_set_to_bar (&end_pos, 8);
+  ZRegion * region =
+    midi_region_new (
+      &pos, &end_pos, track->pos, 0,
+      track->lanes[0]->num_regions);
+  track_add_region (
+    track, region, NULL, 0, F_GEN_NAME,
+    F_NO_PUBLISH_EVENTS);
+
+  return region;
+}
+
+static void
+test_linked_regions_share_children (void)
+{
+  UndoableAction * ua =
+    tracklist_selections_action_new_create (
+      TRACK_TYPE_MIDI, NULL, NULL,
+      TRACKLIST->num_tracks, NULL, 1, -1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+
+  Track * track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+
+  ZRegion * r1 = create_linked_test_region (track);
+  ZRegion * r2 = create_linked_test_region (track);
+  add_notes (r1, 3, 60);
+  add_notes (r2, 5, 40);
+
+  /* linking shares the notes of the first
+   * region */
+  region_create_link_group_if_none (r1);
+  region_set_link_group (
+    r2, r1->id.link_group, true);
+  g_assert_nonnull (r1->content);
+  g_assert_true (r1->content == r2->content);
+  g_assert_cmpint (r2->num_midi_notes, ==, 3);
+  for (int i = 0; i < 3; i++)
+    {
+      g_assert_true (
+        r2->midi_notes[i] == r1->midi_notes[i]);
+    }
+
+  /* the notes are serialized once */
+  g_assert_cmpint (
+    r1->num_serialized_midi_notes, ==, 3);
+  g_assert_cmpint (
+    r2->num_serialized_midi_notes, ==, 0);
+
+  /* edits in one region are seen in the other */
+  add_notes (r2, 1, 70);
+  g_assert_cmpint (r1->num_midi_notes, ==, 4);
+  g_assert_true (
+    r1->midi_notes[3] == r2->midi_notes[3]);
+  g_assert_true (
+    region_identifier_is_equal (
+      &r2->midi_notes[3]->base.region_id,
+      &r1->id));
+  g_assert_cmpint (
+    r1->num_serialized_midi_notes, ==, 4);
+  midi_region_remove_midi_note (
+    r1, r1->midi_notes[0], F_FREE,
+    F_NO_PUBLISH_EVENTS);
+  g_assert_cmpint (r2->num_midi_notes, ==, 3);
+
+  /* unlinking copies the notes */
+  region_unlink (r2);
+  g_assert_null (r1->content);
+  g_assert_null (r2->content);
+  g_assert_cmpint (r2->num_midi_notes, ==, 3);
+  g_assert_cmpint (
+    r2->num_serialized_midi_notes, ==, 3);
+  for (int i = 0; i < 3; i++)
+    {
+      MidiNote * mn1 = r1->midi_notes[i];
+      MidiNote * mn2 = r2->midi_notes[i];
+      g_assert_true (mn1 != mn2);
+      g_assert_cmpuint (mn1->val, ==, mn2->val);
+      g_assert_true (
+        region_identifier_is_equal (
+          &mn2->base.region_id, &r2->id));
+    }
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -257,6 +369,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test_timeline_frames_to_local",
     (GTestFunc) test_timeline_frames_to_local);
+  g_test_add_func (
+    TEST_PREFIX "test linked regions share children",
+    (GTestFunc) test_linked_regions_share_children);
 
   return g_test_run ();
 }
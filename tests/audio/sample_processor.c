@@ -19,6 +19,7 @@
 
 #include "zrythm-test-config.h"
 
+#include "audio/sample_stream.h"
 #include "audio/track.h"
 #include "project.h"
 #include "utils/flags.h"
@@ -26,6 +27,11 @@
 
 #include "tests/helpers/project.h"
 
+#include "zix/ring.h"
+
+#include <math.h>
+#include <string.h>
+
 #include <glib.h>
 #include <locale.h>
 
@@ -48,6 +54,136 @@ test_queue_file ()
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_stream_file ()
+{
+  test_helper_zrythm_init ();
+
+  char * filepath =
+    g_build_filename (
+      TESTS_SRCDIR, "test.wav", NULL);
+  SampleStream * stream =
+    sample_stream_new (
+      filepath, (int) AUDIO_ENGINE->sample_rate);
+  g_assert_nonnull (stream);
+
+  /* nothing is played before the ring is
+   * prefilled */
+  for (int i = 0;
+       i < 100 && !g_atomic_int_get (&stream->ready);
+       i++)
+    {
+      g_usleep (10000);
+    }
+  g_assert_true (g_atomic_int_get (&stream->ready));
+  g_assert_cmpuint (
+    zix_ring_read_space (stream->ring), >=,
+    stream->prefill_frames * 2 * sizeof (float));
+
+  /* wait for the decoder to fill the ring */
+  for (int i = 0;
+       i < 100 &&
+       zix_ring_read_space (stream->ring) <
+         zix_ring_capacity (stream->ring) / 2;
+       i++)
+    {
+      g_usleep (10000);
+    }
+  g_assert_cmpuint (
+    zix_ring_read_space (stream->ring), >=,
+    zix_ring_capacity (stream->ring) / 2);
+
+  /* the stream must fade in and play */
+  float l[256], r[256];
+  memset (l, 0, sizeof (l));
+  memset (r, 0, sizeof (r));
+  nframes_t played =
+    sample_stream_process (stream, l, r, 256, 1.f);
+  g_assert_cmpuint (played, ==, 256);
+  float peak = 0.f;
+  for (int i = 0; i < 256; i++)
+    {
+      peak = MAX (peak, fabsf (l[i]));
+    }
+  g_assert_cmpfloat (peak, >, 0.f);
+  g_assert_false (
+    sample_stream_is_finished (stream));
+
+  /* fade out */
+  sample_stream_fade_out (stream);
+  for (int i = 0;
+       i < 100 && !sample_stream_is_finished (stream);
+       i++)
+    {
+      sample_stream_process (
+        stream, l, r, 256, 1.f);
+    }
+  g_assert_true (
+    sample_stream_is_finished (stream));
+  g_assert_cmpfloat (stream->gain, <=, 0.f);
+  g_assert_cmpuint (
+    sample_stream_process (stream, l, r, 256, 1.f),
+    ==, 0);
+
+  sample_stream_free (stream);
+
+  /* freeing a stream while it is decoding does not
+   * wait for the decoder */
+  stream =
+    sample_stream_new (
+      filepath, (int) AUDIO_ENGINE->sample_rate);
+  g_assert_nonnull (stream);
+  sample_stream_free (stream);
+
+  g_free (filepath);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_reap_finished_streams ()
+{
+  test_helper_zrythm_init ();
+
+  char * filepath =
+    g_build_filename (
+      TESTS_SRCDIR, "test.wav", NULL);
+  SupportedFile * file =
+    supported_file_new_from_path (filepath);
+  sample_processor_queue_file (
+    SAMPLE_PROCESSOR, file);
+  SampleStream * stream =
+    SAMPLE_PROCESSOR->streams[0];
+  g_assert_nonnull (stream);
+
+  /* play until the fade out is done */
+  sample_stream_fade_out (stream);
+  float l[256], r[256];
+  for (int i = 0;
+       i < 1000 && !sample_stream_is_finished (stream);
+       i++)
+    {
+      sample_stream_process (
+        stream, l, r, 256, 1.f);
+      g_usleep (1000);
+    }
+  g_assert_true (
+    sample_stream_is_finished (stream));
+
+  /* the periodic reap releases it */
+  sample_processor_reap_streams (SAMPLE_PROCESSOR);
+  for (int i = 0; i < SAMPLE_PROCESSOR_MAX_STREAMS;
+       i++)
+    {
+      g_assert_null (SAMPLE_PROCESSOR->streams[i]);
+    }
+
+  supported_file_free (file);
+  g_free (filepath);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -58,6 +194,12 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test queue file",
     (GTestFunc) test_queue_file);
+  g_test_add_func (
+    TEST_PREFIX "test stream file",
+    (GTestFunc) test_stream_file);
+  g_test_add_func (
+    TEST_PREFIX "test reap finished streams",
+    (GTestFunc) test_reap_finished_streams);
 
   return g_test_run ();
 }
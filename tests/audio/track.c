@@ -19,13 +19,22 @@
 
 #include "zrythm-test-config.h"
 
+#include "actions/tracklist_selections.h"
+#include "actions/undo_manager.h"
+#include "audio/channel.h"
+#include "audio/engine.h"
+#include "audio/graph.h"
+#include "audio/router.h"
 #include "audio/track.h"
+#include "audio/tracklist.h"
 #include "project.h"
 #include "utils/flags.h"
 #include "zrythm.h"
 
 #include "tests/helpers/project.h"
 
+#include <math.h>
+
 #include <glib.h>
 #include <locale.h>
 
@@ -43,6 +52,90 @@ test_new_track ()
   g_assert_nonnull (track->name);
 }
 
+/**
+ * Sets up a new graph without rechaining it, so
+ * that its nodes can be looked up (the router's
+ * graph only keeps them until it is rechained).
+ */
+static Graph *
+setup_graph (void)
+{
+  Graph * graph = graph_new (ROUTER);
+  graph_setup (graph, true, false);
+  return graph;
+}
+
+static void
+test_prune_disabled_track ()
+{
+  UndoableAction * ua =
+    tracklist_selections_action_new_create (
+      TRACK_TYPE_AUDIO_BUS, NULL, NULL,
+      TRACKLIST->num_tracks, NULL, 1, -1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+  Track * track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  Port * out_l = track->channel->stereo_out->l;
+  Graph * graph = setup_graph ();
+  g_assert_nonnull (
+    graph_find_node_from_track (
+      graph, track, true));
+  int num_pruned = graph->num_pruned_processors;
+  graph_free (graph);
+
+  /* disabling the track leaves out its whole
+   * subgraph */
+  track_select (
+    track, F_SELECT, F_EXCLUSIVE,
+    F_NO_PUBLISH_EVENTS);
+  ua =
+    tracklist_selections_action_new_edit_enable (
+      TRACKLIST_SELECTIONS, false);
+  undo_manager_perform (UNDO_MANAGER, ua);
+  g_assert_false (track_is_enabled (track));
+  g_assert_null (
+    graph_find_node_from_track (
+      ROUTER->graph, track, false));
+  g_assert_cmpint (
+    ROUTER->graph->num_pruned_processors, >=,
+    num_pruned + 3);
+  g_assert_cmpint (
+    ROUTER->graph->num_pruned_idle_ports, >, 0);
+  graph = setup_graph ();
+  g_assert_null (
+    graph_find_node_from_fader (
+      graph, track->channel->fader));
+  g_assert_null (
+    graph_find_node_from_port (graph, out_l));
+  graph_free (graph);
+
+  /* the master still gets silence from it */
+  test_project_stop_dummy_engine ();
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  for (nframes_t i = 0;
+       i < AUDIO_ENGINE->block_length; i++)
+    {
+      g_assert_cmpfloat (
+        fabsf (out_l->buf[i]), <, 0.0001f);
+    }
+
+  /* enabling it adds it back */
+  undo_manager_undo (UNDO_MANAGER);
+  g_assert_true (track_is_enabled (track));
+  g_assert_nonnull (
+    graph_find_node_from_track (
+      ROUTER->graph, track, false));
+  graph = setup_graph ();
+  g_assert_nonnull (
+    graph_find_node_from_port (graph, out_l));
+  graph_free (graph);
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+
+  undo_manager_undo (UNDO_MANAGER);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -55,6 +148,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test new track",
     (GTestFunc) test_new_track);
+  g_test_add_func (
+    TEST_PREFIX "test prune disabled track",
+    (GTestFunc) test_prune_disabled_track);
 
   return g_test_run ();
 }
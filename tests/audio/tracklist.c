@@ -127,6 +127,160 @@ test_swap_with_automation_regions ()
   test_helper_zrythm_cleanup ();
 }
 
+/**
+ * Asserts that the positions of the tracks and
+ * their ports match their index in the tracklist.
+ */
+static void
+assert_track_positions (void)
+{
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      Track * track = TRACKLIST->tracks[i];
+      g_assert_cmpint (track->pos, ==, i);
+      g_assert_true (track_validate (track));
+
+      AutomationTracklist * atl =
+        track_get_automation_tracklist (track);
+      if (!atl)
+        continue;
+      for (int j = 0; j < atl->num_ats; j++)
+        {
+          AutomationTrack * at = atl->ats[j];
+          g_assert_cmpint (
+            at->port_id.track_pos, ==, i);
+          Port * port =
+            automation_track_get_port (at);
+          g_assert_nonnull (port);
+          g_assert_true (port->at == at);
+        }
+    }
+}
+
+static void
+test_move_track_across_tracks (void)
+{
+  test_helper_zrythm_init ();
+
+  int start_pos = TRACKLIST->num_tracks;
+  const int num_tracks = 6;
+  for (int i = 0; i < num_tracks; i++)
+    {
+      UndoableAction * ua =
+        tracklist_selections_action_new_create (
+          i % 2 ? TRACK_TYPE_MIDI : TRACK_TYPE_AUDIO,
+          NULL, NULL, TRACKLIST->num_tracks,
+          PLAYHEAD, 1, -1);
+      undo_manager_perform (UNDO_MANAGER, ua);
+    }
+  create_automation_region (start_pos);
+
+  /* move the last track to the first new
+   * position */
+  Track * track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  Track * first_track =
+    TRACKLIST->tracks[start_pos];
+  tracklist_move_track (
+    TRACKLIST, track, start_pos, false,
+    F_NO_PUBLISH_EVENTS, F_NO_RECALC_GRAPH);
+  g_assert_true (
+    TRACKLIST->tracks[start_pos] == track);
+  g_assert_true (
+    TRACKLIST->tracks[start_pos + 1] ==
+      first_track);
+  assert_track_positions ();
+
+  /* move it back before the last track */
+  tracklist_move_track (
+    TRACKLIST, track, TRACKLIST->num_tracks - 1,
+    true, F_NO_PUBLISH_EVENTS, F_NO_RECALC_GRAPH);
+  g_assert_true (
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 2] ==
+      track);
+  g_assert_true (
+    TRACKLIST->tracks[start_pos] == first_track);
+  assert_track_positions ();
+
+  /* insert a new track before the others */
+  UndoableAction * ua =
+    tracklist_selections_action_new_create (
+      TRACK_TYPE_MIDI, NULL, NULL, start_pos,
+      PLAYHEAD, 1, -1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+  g_assert_true (
+    TRACKLIST->tracks[start_pos + 1] ==
+      first_track);
+  assert_track_positions ();
+
+  undo_manager_undo (UNDO_MANAGER);
+  assert_track_positions ();
+
+  test_helper_zrythm_cleanup ();
+}
+
+/**
+ * Tests that a reference to a port of a removed
+ * track does not resolve to the port of the track
+ * that took its place.
+ */
+static void
+test_removed_track_handle (void)
+{
+  test_helper_zrythm_init ();
+
+  int pos = TRACKLIST->num_tracks;
+  UndoableAction * ua =
+    tracklist_selections_action_new_create (
+      TRACK_TYPE_MIDI, NULL, NULL, pos,
+      PLAYHEAD, 1, -1);
+  undo_manager_perform (UNDO_MANAGER, ua);
+
+  Track * track = TRACKLIST->tracks[pos];
+  Port * amp = track->channel->fader->amp;
+  g_assert_true (
+    object_handle_is_set (&amp->id.track_handle));
+  g_assert_true (
+    port_get_track (amp, true) == track);
+  g_assert_true (
+    automation_track_find_from_port (
+      amp, NULL, false) == amp->at);
+
+  /* keep a reference with the handle and a
+   * positional one */
+  PortIdentifier handle_id, pos_id;
+  port_identifier_init (&handle_id);
+  port_identifier_init (&pos_id);
+  port_identifier_copy (&handle_id, &amp->id);
+  handle_id.track_handle = amp->id.track_handle;
+  port_identifier_copy (&pos_id, &amp->id);
+  g_assert_true (
+    port_find_from_identifier (&handle_id) == amp);
+  g_assert_true (
+    port_find_from_identifier (&pos_id) == amp);
+
+  /* remove the track and create it again at the
+   * same position */
+  undo_manager_undo (UNDO_MANAGER);
+  undo_manager_redo (UNDO_MANAGER);
+  track = TRACKLIST->tracks[pos];
+  amp = track->channel->fader->amp;
+
+  /* the handle no longer resolves */
+  g_assert_null (
+    port_find_from_identifier (&handle_id));
+
+  /* the positional reference resolves to the new
+   * track */
+  g_assert_true (
+    port_find_from_identifier (&pos_id) == amp);
+
+  port_identifier_free_members (&handle_id);
+  port_identifier_free_members (&pos_id);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -139,6 +293,12 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test swap with automation regions",
     (GTestFunc) test_swap_with_automation_regions);
+  g_test_add_func (
+    TEST_PREFIX "test move track across tracks",
+    (GTestFunc) test_move_track_across_tracks);
+  g_test_add_func (
+    TEST_PREFIX "test removed track handle",
+    (GTestFunc) test_removed_track_handle);
 
   return g_test_run ();
 }
@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * Benchmarks drawing the timeline through
+ * arranger_draw_cb() in a running app, with and
+ * without reusing the cached tiles.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/midi_region.h"
+#include "audio/midi_track.h"
+#include "audio/region.h"
+#include "audio/tracklist.h"
+#include "gui/widgets/arranger.h"
+#include "gui/widgets/arranger_draw.h"
+#include "gui/widgets/arranger_object.h"
+#include "gui/widgets/arranger_tile_cache.h"
+#include "gui/widgets/center_dock.h"
+#include "gui/widgets/main_notebook.h"
+#include "gui/widgets/main_window.h"
+#include "gui/widgets/timeline_arranger.h"
+#include "gui/widgets/timeline_panel.h"
+#include "project.h"
+#include "settings/settings.h"
+#include "utils/flags.h"
+#include "zrythm.h"
+#include "zrythm_app.h"
+
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+
+#define NUM_TRACKS 20
+#define NUM_REGIONS_PER_TRACK 50
+#define VIEW_WIDTH 1600
+#define VIEW_HEIGHT 800
+#define SCROLL_STEP 16
+#define NUM_FRAMES 600
+
+/** Queue a redraw of a region every this many
+ * frames. */
+#define EDIT_INTERVAL 10
+
+static void
+create_regions (void)
+{
+  for (int i = 0; i < NUM_TRACKS; i++)
+    {
+      Track * track =
+        track_new (
+          TRACK_TYPE_MIDI, TRACKLIST->num_tracks,
+          "Test MIDI Track", F_WITH_LANE,
+          F_NOT_AUDITIONER);
+      tracklist_append_track (
+        TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+        F_NO_RECALC_GRAPH);
+
+      for (int j = 0; j < NUM_REGIONS_PER_TRACK;
+           j++)
+        {
+          Position start, end;
+          position_set_to_bar (&start, j * 2 + 1);
+          position_set_to_bar (&end, j * 2 + 2);
+          ZRegion * r =
+            midi_region_new (
+              &start, &end, track->pos, 0, j);
+          track_add_region (
+            track, r, NULL, 0, F_GEN_NAME,
+            F_NO_PUBLISH_EVENTS);
+        }
+    }
+}
+
+/**
+ * Returns the region to edit at the given frame.
+ */
+static ZRegion *
+get_region_to_edit (
+  int frame)
+{
+  int r_idx =
+    (frame / EDIT_INTERVAL) %
+    (NUM_TRACKS * NUM_REGIONS_PER_TRACK);
+  Track * track =
+    TRACKLIST->tracks[
+      (TRACKLIST->num_tracks - NUM_TRACKS) +
+      r_idx / NUM_REGIONS_PER_TRACK];
+  return
+    track->lanes[0]->regions[
+      r_idx % NUM_REGIONS_PER_TRACK];
+}
+
+static int
+cmp_gint64 (
+  const void * a,
+  const void * b)
+{
+  gint64 val_a = *(const gint64 *) a;
+  gint64 val_b = *(const gint64 *) b;
+  return (val_a > val_b) - (val_a < val_b);
+}
+
+/**
+ * Scrolls through the timeline, drawing it with
+ * arranger_draw_cb() like GTK does, and returns
+ * the 50th/99th percentile frame times.
+ *
+ * @param full_redraw Whether to drop the cached
+ *   tiles before each frame.
+ */
+static void
+run_scroll (
+  ArrangerWidget *  arranger,
+  cairo_surface_t * surface,
+  bool              full_redraw,
+  gint64 *          p50,
+  gint64 *          p99)
+{
+  gint64 frame_times[NUM_FRAMES];
+  for (int i = 0; i < NUM_FRAMES; i++)
+    {
+      /* scroll right, then back left */
+      int step =
+        i < NUM_FRAMES / 2 ?
+          i : NUM_FRAMES - i;
+      GdkRectangle rect = {
+        .x = step * SCROLL_STEP, .y = 0,
+        .width = VIEW_WIDTH, .height = VIEW_HEIGHT,
+      };
+
+      /* simulate an edit on a region */
+      if (i % EDIT_INTERVAL == 0)
+        {
+          arranger_object_queue_redraw (
+            (ArrangerObject *)
+            get_region_to_edit (i));
+        }
+      if (full_redraw)
+        {
+          arranger->redraw = 1;
+        }
+
+      gint64 start = g_get_monotonic_time ();
+      cairo_t * cr = cairo_create (surface);
+      cairo_translate (cr, - rect.x, - rect.y);
+      gdk_cairo_rectangle (cr, &rect);
+      cairo_clip (cr);
+      arranger_draw_cb (
+        GTK_WIDGET (arranger), cr, arranger);
+      cairo_destroy (cr);
+      cairo_surface_flush (surface);
+      frame_times[i] =
+        g_get_monotonic_time () - start;
+    }
+
+  qsort (
+    frame_times, NUM_FRAMES, sizeof (gint64),
+    cmp_gint64);
+  *p50 = frame_times[NUM_FRAMES / 2];
+  *p99 = frame_times[(NUM_FRAMES * 99) / 100];
+}
+
+static int
+run_benchmark_when_ready (
+  void * data)
+{
+  if (!zrythm_app->main_window ||
+      !MAIN_WINDOW->setup || !PROJECT ||
+      !PROJECT->loaded ||
+      !gtk_widget_get_realized (
+         GTK_WIDGET (MW_TIMELINE)))
+    return G_SOURCE_CONTINUE;
+
+  ArrangerWidget * arranger = MW_TIMELINE;
+  cairo_surface_t * surface =
+    cairo_image_surface_create (
+      CAIRO_FORMAT_ARGB32, VIEW_WIDTH, VIEW_HEIGHT);
+
+  gint64 full_p50, full_p99;
+  run_scroll (
+    arranger, surface, true, &full_p50,
+    &full_p99);
+  gint64 tiled_p50, tiled_p99;
+  run_scroll (
+    arranger, surface, false, &tiled_p50,
+    &tiled_p99);
+
+  g_message (
+    "scrolling %d regions (%d frames): "
+    "full redraw p50 %" G_GINT64_FORMAT " us, "
+    "p99 %" G_GINT64_FORMAT " us | "
+    "tiled p50 %" G_GINT64_FORMAT " us, "
+    "p99 %" G_GINT64_FORMAT " us",
+    NUM_TRACKS * NUM_REGIONS_PER_TRACK, NUM_FRAMES,
+    full_p50, full_p99, tiled_p50, tiled_p99);
+
+  /* the last frame must have reused tiles */
+  g_assert_cmpint (
+    arranger->tile_cache->num_tiles_reused, >, 0);
+
+  cairo_surface_destroy (surface);
+
+  g_application_quit (G_APPLICATION (zrythm_app));
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+test_scroll_1000_regions (void)
+{
+  if (g_test_subprocess ())
+    {
+      /* open the project in the app */
+      char exe_path[] = "zrythm";
+      char arg1[] = "--dummy";
+      char arg2[900];
+      strcpy (
+        arg2,
+        g_getenv ("ZRYTHM_TEST_BENCHMARK_PROJECT"));
+      int argc = 3;
+      char * argv[] = {
+        exe_path, arg1, arg2 };
+
+      /* skip the first run assistant */
+      GSettings * general =
+        g_settings_new (
+          GSETTINGS_ZRYTHM_PREFIX ".general");
+      g_settings_set_boolean (
+        general, "first-run", false);
+      g_object_unref (general);
+
+      ZrythmApp * app =
+        zrythm_app_new (argc, (const char **) argv);
+      g_timeout_add (
+        100, run_benchmark_when_ready, NULL);
+      int ret =
+        g_application_run (
+          G_APPLICATION (app), argc, argv);
+      g_assert_cmpint (ret, ==, 0);
+      g_object_unref (app);
+      return;
+    }
+
+  test_helper_zrythm_init ();
+
+  if (!gtk_init_check (NULL, NULL))
+    {
+      test_helper_zrythm_cleanup ();
+      g_test_skip ("No display found");
+      return;
+    }
+
+  create_regions ();
+  int ret =
+    project_save (
+      PROJECT, PROJECT->dir, F_NOT_BACKUP, 0,
+      F_NO_ASYNC);
+  g_assert_cmpint (ret, ==, 0);
+  char * prj_file =
+    g_build_filename (
+      PROJECT->dir, PROJECT_FILE, NULL);
+
+  g_setenv (
+    "ZRYTHM_TEST_BENCHMARK_PROJECT", prj_file, true);
+  g_test_trap_subprocess (
+    NULL, 0, G_TEST_SUBPROCESS_INHERIT_STDERR);
+  g_test_trap_assert_passed ();
+  g_unsetenv ("ZRYTHM_TEST_BENCHMARK_PROJECT");
+  g_free (prj_file);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/arranger_tiles/"
+
+  g_test_add_func (
+    TEST_PREFIX "test scroll 1000 regions",
+    (GTestFunc) test_scroll_1000_regions);
+
+  return g_test_run ();
+}
@@ -0,0 +1,624 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ *
+ * End-to-end engine benchmarks on synthetic
+ * projects.
+ *
+ * Each scenario builds a project with the given
+ * number of tracks, lanes, regions, automation
+ * lanes, sends and plugins, then measures the
+ * graph setup time, the time taken by each engine
+ * cycle while rolling (with the dummy backend
+ * stopped, so cycles run back to back) with and
+ * without the channel meters reading the port
+ * rings, and the project save/load times.
+ *
+ * The results are printed as one JSON object per
+ * scenario and are also appended to the file in
+ * the ZRYTHM_BENCHMARK_RESULTS environment
+ * variable, if set, so they can be compared
+ * between commits.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef _WOE32
+#include <sys/resource.h>
+#endif
+
+#include "actions/mixer_selections_action.h"
+#include "actions/undo_manager.h"
+#include "audio/audio_region.h"
+#include "audio/automation_point.h"
+#include "audio/automation_region.h"
+#include "audio/automation_track.h"
+#include "audio/channel.h"
+#include "audio/channel_send.h"
+#include "audio/engine.h"
+#include "audio/midi_note.h"
+#include "audio/midi_region.h"
+#include "audio/port.h"
+#include "audio/router.h"
+#include "audio/track.h"
+#include "audio/track_processor.h"
+#include "audio/tracklist.h"
+#include "audio/transport.h"
+#include "plugins/plugin.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "utils/objects.h"
+#include "zrythm.h"
+
+#include "tests/helpers/plugin_manager.h"
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+
+/** Number of cycles to process per scenario. */
+#define NUM_CYCLES 2000
+
+/** Number of graph rebuilds to average. */
+#define NUM_GRAPH_SETUPS 5
+
+#define NOTES_PER_REGION 16
+
+/**
+ * Parameters of a synthetic project.
+ */
+typedef struct EngineScenario
+{
+  const char * name;
+
+  /** Audio tracks with a chain of eg-amp
+   * inserts. */
+  int          num_audio_tracks;
+
+  /** MIDI tracks with eg-fifths as MIDI FX. */
+  int          num_midi_tracks;
+
+  /** Lanes per track. */
+  int          num_lanes;
+
+  /** Regions per lane. */
+  int          num_regions_per_lane;
+
+  /** Automation lanes (with one region each) per
+   * audio track. */
+  int          num_automation_lanes;
+
+  /** Sends per audio track, each to a separate
+   * audio bus. */
+  int          num_sends;
+
+  /** Inserts per audio track. */
+  int          num_plugins;
+} EngineScenario;
+
+static const EngineScenario scenarios[] = {
+  {
+    .name = "small",
+    .num_audio_tracks = 4,
+    .num_midi_tracks = 4,
+    .num_lanes = 1,
+    .num_regions_per_lane = 4,
+    .num_automation_lanes = 1,
+    .num_sends = 0,
+    .num_plugins = 1,
+  },
+  {
+    .name = "medium",
+    .num_audio_tracks = 16,
+    .num_midi_tracks = 16,
+    .num_lanes = 2,
+    .num_regions_per_lane = 8,
+    .num_automation_lanes = 2,
+    .num_sends = 1,
+    .num_plugins = 2,
+  },
+  {
+    .name = "large",
+    .num_audio_tracks = 48,
+    .num_midi_tracks = 32,
+    .num_lanes = 4,
+    .num_regions_per_lane = 16,
+    .num_automation_lanes = 4,
+    .num_sends = 2,
+    .num_plugins = 4,
+  },
+};
+
+static int
+cmp_gint64 (
+  const void * a,
+  const void * b)
+{
+  gint64 val_a = *(const gint64 *) a;
+  gint64 val_b = *(const gint64 *) b;
+  return (val_a > val_b) - (val_a < val_b);
+}
+
+/**
+ * Returns the peak resident set size in KiB, or
+ * -1 if unknown.
+ */
+static long
+get_peak_rss_kib (void)
+{
+#ifdef _WOE32
+  return -1;
+#else
+  struct rusage usage;
+  if (getrusage (RUSAGE_SELF, &usage) != 0)
+    return -1;
+#  ifdef __APPLE__
+  /* bytes on mac */
+  return usage.ru_maxrss / 1024;
+#  else
+  return usage.ru_maxrss;
+#  endif
+#endif
+}
+
+static void
+add_audio_regions (
+  const EngineScenario * scenario,
+  Track *                track,
+  int *                  pool_id)
+{
+  char audio_file_path[2000];
+  sprintf (
+    audio_file_path, "%s%s%s",
+    TESTS_SRCDIR, G_DIR_SEPARATOR_S, "test.wav");
+
+  for (int i = 0; i < scenario->num_lanes; i++)
+    {
+      for (int j = 0;
+           j < scenario->num_regions_per_lane; j++)
+        {
+          /* offset the lanes so that regions
+           * overlap */
+          Position pos;
+          position_set_to_bar (&pos, j * 4 + 1);
+          position_add_beats (&pos, i);
+
+          /* all regions share the same clip */
+          ZRegion * r =
+            audio_region_new (
+              *pool_id,
+              *pool_id == -1 ?
+                audio_file_path : NULL,
+              true, NULL, 0, NULL, 0, 0, &pos,
+              track->pos, i, j);
+          g_assert_nonnull (r);
+          track_add_region (
+            track, r, NULL, i, F_GEN_NAME,
+            F_NO_PUBLISH_EVENTS);
+          *pool_id = r->pool_id;
+        }
+    }
+}
+
+static void
+add_midi_regions (
+  const EngineScenario * scenario,
+  Track *                track)
+{
+  for (int i = 0; i < scenario->num_lanes; i++)
+    {
+      for (int j = 0;
+           j < scenario->num_regions_per_lane; j++)
+        {
+          Position start, end;
+          position_set_to_bar (&start, j * 4 + 1);
+          position_set_to_bar (&end, j * 4 + 5);
+          ZRegion * r =
+            midi_region_new (
+              &start, &end, track->pos, i, j);
+          track_add_region (
+            track, r, NULL, i, F_GEN_NAME,
+            F_NO_PUBLISH_EVENTS);
+
+          for (int k = 0; k < NOTES_PER_REGION; k++)
+            {
+              Position note_start, note_end;
+              position_init (&note_start);
+              position_add_sixteenths (
+                &note_start, k * 4);
+              position_set_to_pos (
+                &note_end, &note_start);
+              position_add_sixteenths (&note_end, 3);
+              MidiNote * mn =
+                midi_note_new (
+                  &r->id, &note_start, &note_end,
+                  (uint8_t) (48 + (k + i) % 24),
+                  100);
+              midi_region_add_midi_note (
+                r, mn, F_NO_PUBLISH_EVENTS);
+            }
+        }
+    }
+}
+
+static void
+add_automation (
+  const EngineScenario * scenario,
+  Track *                track)
+{
+  AutomationTracklist * atl =
+    track_get_automation_tracklist (track);
+  int num_lanes =
+    MIN (scenario->num_automation_lanes, atl->num_ats);
+  for (int i = 0; i < num_lanes; i++)
+    {
+      AutomationTrack * at = atl->ats[i];
+      Position start, end;
+      position_set_to_bar (&start, 1);
+      position_set_to_bar (
+        &end, scenario->num_regions_per_lane * 4 + 1);
+      ZRegion * r =
+        automation_region_new (
+          &start, &end, track->pos, at->index, 0);
+      track_add_region (
+        track, r, at, 0, F_GEN_NAME,
+        F_NO_PUBLISH_EVENTS);
+
+      /* a ramp every bar */
+      for (int j = 0;
+           j < scenario->num_regions_per_lane * 4;
+           j++)
+        {
+          Position pos;
+          position_set_to_bar (&pos, j + 1);
+          float val = j % 2 == 0 ? 0.2f : 0.8f;
+          AutomationPoint * ap =
+            automation_point_new_float (
+              val, val, &pos);
+          automation_region_add_ap (
+            r, ap, F_NO_PUBLISH_EVENTS);
+        }
+    }
+}
+
+static void
+create_project (
+  const EngineScenario * scenario)
+{
+  /* buses to send to */
+  Track * buses[STRIP_SIZE];
+  for (int i = 0; i < scenario->num_sends; i++)
+    {
+      char name[60];
+      sprintf (name, "Bus %d", i + 1);
+      buses[i] =
+        track_new (
+          TRACK_TYPE_AUDIO_BUS,
+          TRACKLIST->num_tracks, name,
+          F_WITHOUT_LANE, F_NOT_AUDITIONER);
+      tracklist_append_track (
+        TRACKLIST, buses[i], F_NO_PUBLISH_EVENTS,
+        F_NO_RECALC_GRAPH);
+    }
+
+  int pool_id = -1;
+  for (int i = 0; i < scenario->num_audio_tracks;
+       i++)
+    {
+      char name[60];
+      sprintf (name, "Audio %d", i + 1);
+      Track * track =
+        track_new (
+          TRACK_TYPE_AUDIO, TRACKLIST->num_tracks,
+          name, F_WITH_LANE, F_NOT_AUDITIONER);
+      tracklist_append_track (
+        TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+        F_NO_RECALC_GRAPH);
+
+      add_audio_regions (scenario, track, &pool_id);
+      add_automation (scenario, track);
+
+      for (int j = 0; j < scenario->num_sends; j++)
+        {
+          StereoPorts * stereo_in =
+            buses[j]->processor->stereo_in;
+          channel_send_connect_stereo (
+            track->channel->sends[j], NULL,
+            stereo_in->l, stereo_in->r, false);
+        }
+
+      /* plugin chain */
+      if (scenario->num_plugins > 0)
+        {
+          PluginSetting * setting =
+            test_plugin_manager_get_plugin_setting (
+              EG_AMP_BUNDLE_URI, EG_AMP_URI, false);
+          UndoableAction * ua =
+            mixer_selections_action_new_create (
+              PLUGIN_SLOT_INSERT, track->pos, 0,
+              setting, scenario->num_plugins);
+          undo_manager_perform (UNDO_MANAGER, ua);
+        }
+    }
+
+  for (int i = 0; i < scenario->num_midi_tracks;
+       i++)
+    {
+      char name[60];
+      sprintf (name, "MIDI %d", i + 1);
+      Track * track =
+        track_new (
+          TRACK_TYPE_MIDI, TRACKLIST->num_tracks,
+          name, F_WITH_LANE, F_NOT_AUDITIONER);
+      tracklist_append_track (
+        TRACKLIST, track, F_NO_PUBLISH_EVENTS,
+        F_NO_RECALC_GRAPH);
+
+      add_midi_regions (scenario, track);
+
+      PluginSetting * setting =
+        test_plugin_manager_get_plugin_setting (
+          EG_FIFTHS_BUNDLE_URI, EG_FIFTHS_URI, false);
+      UndoableAction * ua =
+        mixer_selections_action_new_create (
+          PLUGIN_SLOT_MIDI_FX, track->pos, 0,
+          setting, 1);
+      undo_manager_perform (UNDO_MANAGER, ua);
+    }
+
+  /* loop over the whole project */
+  position_set_to_bar (
+    &TRANSPORT->loop_start_pos, 1);
+  position_set_to_bar (
+    &TRANSPORT->loop_end_pos,
+    scenario->num_regions_per_lane * 4 + 1);
+  TRANSPORT->loop = true;
+}
+
+static void
+write_results (
+  const char * json)
+{
+  fprintf (stdout, "%s\n", json);
+
+  const char * results_file =
+    g_getenv ("ZRYTHM_BENCHMARK_RESULTS");
+  if (results_file)
+    {
+      FILE * f = fopen (results_file, "a");
+      g_assert_nonnull (f);
+      fprintf (f, "%s\n", json);
+      fclose (f);
+    }
+}
+
+/**
+ * Processes NUM_CYCLES cycles back to back.
+ *
+ * @param[out] cycle_times Sorted cycle times.
+ *
+ * @return The total time.
+ */
+static gint64
+process_cycles (
+  gint64 * cycle_times)
+{
+  gint64 total_start = g_get_monotonic_time ();
+  for (int i = 0; i < NUM_CYCLES; i++)
+    {
+      gint64 start = g_get_monotonic_time ();
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+      cycle_times[i] =
+        g_get_monotonic_time () - start;
+    }
+  gint64 total_time =
+    g_get_monotonic_time () - total_start;
+  qsort (
+    cycle_times, NUM_CYCLES, sizeof (gint64),
+    cmp_gint64);
+
+  return total_time;
+}
+
+/**
+ * Subscribes to or unsubscribes from the rings
+ * of the channel outputs, like the mixer does
+ * when all the meters are visible.
+ */
+static void
+set_channel_meters_subscribed (
+  bool subscribed)
+{
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      Channel * ch = TRACKLIST->tracks[i]->channel;
+      if (!ch)
+        continue;
+
+      Port * ports[] = {
+        ch->stereo_out->l, ch->stereo_out->r };
+      for (size_t j = 0; j < G_N_ELEMENTS (ports);
+           j++)
+        {
+          if (subscribed)
+            port_subscribe_to_rings (ports[j]);
+          else
+            port_unsubscribe_from_rings (ports[j]);
+        }
+    }
+}
+
+static void
+run_scenario (
+  const EngineScenario * scenario)
+{
+  test_helper_zrythm_init ();
+
+  create_project (scenario);
+
+  /* graph setup */
+  gint64 graph_setup_time = 0;
+  for (int i = 0; i < NUM_GRAPH_SETUPS; i++)
+    {
+      gint64 start = g_get_monotonic_time ();
+      router_recalc_graph (ROUTER, F_NOT_SOFT);
+      graph_setup_time +=
+        g_get_monotonic_time () - start;
+    }
+  graph_setup_time /= NUM_GRAPH_SETUPS;
+
+  /* process cycles back to back */
+  test_project_stop_dummy_engine ();
+  TRANSPORT->play_state = PLAYSTATE_ROLLING;
+  gint64 * cycle_times =
+    object_new_n (NUM_CYCLES, gint64);
+  gint64 total_time = process_cycles (cycle_times);
+
+  /* again with all the channel meters reading,
+   * to measure the cost of filling the rings */
+  gint64 * metered_cycle_times =
+    object_new_n (NUM_CYCLES, gint64);
+  set_channel_meters_subscribed (true);
+  process_cycles (metered_cycle_times);
+  set_channel_meters_subscribed (false);
+
+  double processed_sec =
+    ((double) NUM_CYCLES *
+       (double) AUDIO_ENGINE->block_length) /
+    (double) AUDIO_ENGINE->sample_rate;
+  double realtime_multiple =
+    processed_sec /
+      ((double) MAX (total_time, 1) / 1000000.0);
+  nframes_t block_length =
+    AUDIO_ENGINE->block_length;
+  sample_rate_t sample_rate =
+    AUDIO_ENGINE->sample_rate;
+  int num_tracks = TRACKLIST->num_tracks;
+
+  /* save and load */
+  gint64 start = g_get_monotonic_time ();
+  int ret =
+    project_save (
+      PROJECT, PROJECT->dir, 0, 0, F_NO_ASYNC);
+  g_assert_cmpint (ret, ==, 0);
+  gint64 save_time = g_get_monotonic_time () - start;
+
+  char * prj_file =
+    g_build_filename (
+      PROJECT->dir, PROJECT_FILE, NULL);
+  object_free_w_func_and_null (
+    project_free, PROJECT);
+  start = g_get_monotonic_time ();
+  ret = project_load (prj_file, 0);
+  g_assert_cmpint (ret, ==, 0);
+  gint64 load_time = g_get_monotonic_time () - start;
+  g_free (prj_file);
+  g_assert_cmpint (
+    TRACKLIST->num_tracks, ==, num_tracks);
+
+  char * json =
+    g_strdup_printf (
+      "{\"benchmark\":\"engine\","
+      "\"scenario\":\"%s\","
+      "\"tracks\":%d,\"audio_tracks\":%d,"
+      "\"midi_tracks\":%d,\"lanes\":%d,"
+      "\"regions_per_lane\":%d,"
+      "\"automation_lanes\":%d,\"sends\":%d,"
+      "\"plugins\":%d,"
+      "\"block_length\":%u,\"sample_rate\":%u,"
+      "\"cycles\":%d,"
+      "\"cycle_us\":{\"p50\":%" G_GINT64_FORMAT
+      ",\"p95\":%" G_GINT64_FORMAT
+      ",\"p99\":%" G_GINT64_FORMAT
+      ",\"max\":%" G_GINT64_FORMAT "},"
+      "\"metered_cycle_us\":{\"p50\":%"
+      G_GINT64_FORMAT
+      ",\"p95\":%" G_GINT64_FORMAT "},"
+      "\"realtime_multiple\":%.2f,"
+      "\"graph_setup_us\":%" G_GINT64_FORMAT ","
+      "\"save_us\":%" G_GINT64_FORMAT ","
+      "\"load_us\":%" G_GINT64_FORMAT ","
+      "\"peak_rss_kib\":%ld}",
+      scenario->name, num_tracks,
+      scenario->num_audio_tracks,
+      scenario->num_midi_tracks,
+      scenario->num_lanes,
+      scenario->num_regions_per_lane,
+      scenario->num_automation_lanes,
+      scenario->num_sends, scenario->num_plugins,
+      block_length, sample_rate, NUM_CYCLES,
+      cycle_times[NUM_CYCLES / 2],
+      cycle_times[(NUM_CYCLES * 95) / 100],
+      cycle_times[(NUM_CYCLES * 99) / 100],
+      cycle_times[NUM_CYCLES - 1],
+      metered_cycle_times[NUM_CYCLES / 2],
+      metered_cycle_times[(NUM_CYCLES * 95) / 100],
+      realtime_multiple, graph_setup_time,
+      save_time, load_time, get_peak_rss_kib ());
+  write_results (json);
+  g_free (json);
+  free (cycle_times);
+  free (metered_cycle_times);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_small_project (void)
+{
+  run_scenario (&scenarios[0]);
+}
+
+static void
+test_medium_project (void)
+{
+  run_scenario (&scenarios[1]);
+}
+
+static void
+test_large_project (void)
+{
+  run_scenario (&scenarios[2]);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/engine/"
+
+  g_test_add_func (
+    TEST_PREFIX "test small project",
+    (GTestFunc) test_small_project);
+  g_test_add_func (
+    TEST_PREFIX "test medium project",
+    (GTestFunc) test_medium_project);
+  g_test_add_func (
+    TEST_PREFIX "test large project",
+    (GTestFunc) test_large_project);
+
+  return g_test_run ();
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "gui/backend/file_index.h"
+#include "utils/file.h"
+#include "utils/flags.h"
+#include "utils/io.h"
+#include "zrythm.h"
+
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+#include <locale.h>
+
+static void
+on_indexed (
+  const FileIndexEntry * entry,
+  int *                  num_calls)
+{
+  g_assert_true (
+    g_str_has_suffix (entry->abs_path, "test.wav"));
+  g_assert_cmpint (entry->sample_rate, ==, 48000);
+  (*num_calls)++;
+}
+
+static void
+on_user_data_freed (
+  int * num_frees)
+{
+  (*num_frees)++;
+}
+
+static void
+test_index_and_search (void)
+{
+  test_helper_zrythm_init ();
+
+  char * tmp_dir =
+    g_dir_make_tmp ("zrythm_file_index_XXXXXX", NULL);
+  char * cache_path =
+    g_build_filename (
+      tmp_dir, FILE_INDEX_FILENAME, NULL);
+
+  FileIndex * index = file_index_new (cache_path);
+  g_assert_cmpint (
+    file_index_get_num_entries (index), ==, 0);
+
+  /* index the files in the test dir */
+  file_index_queue_dir (index, TESTS_SRCDIR);
+  char * filepath =
+    g_build_filename (
+      TESTS_SRCDIR, "test.wav", NULL);
+  int num_calls = 0;
+  int num_frees = 0;
+  file_index_request (
+    index, filepath,
+    (FileIndexCallback) on_indexed, &num_calls,
+    (GDestroyNotify) on_user_data_freed);
+  file_index_wait (index);
+  g_assert_cmpint (
+    file_index_get_num_entries (index), >, 2);
+
+  /* the callback is called on the main thread */
+  g_assert_cmpint (num_calls, ==, 0);
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, false);
+  g_assert_cmpint (num_calls, ==, 1);
+
+  /* the user data is released on the main thread
+   * (also when the file cannot be indexed) */
+  g_assert_cmpint (num_frees, ==, 1);
+  char * nonexistent_path =
+    g_build_filename (
+      tmp_dir, "nonexistent.wav", NULL);
+  file_index_request (
+    index, nonexistent_path,
+    (FileIndexCallback) on_indexed, &num_calls,
+    (GDestroyNotify) on_user_data_freed);
+  g_free (nonexistent_path);
+  file_index_wait (index);
+  g_assert_cmpint (num_frees, ==, 1);
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, false);
+  g_assert_cmpint (num_calls, ==, 1);
+  g_assert_cmpint (num_frees, ==, 2);
+
+  /* search ignoring case */
+  GPtrArray * results =
+    file_index_search (index, "TEST.WAV", -1);
+  g_assert_cmpuint (results->len, ==, 1);
+  g_assert_cmpstr (
+    g_ptr_array_index (results, 0), ==, filepath);
+  g_ptr_array_unref (results);
+  results = file_index_search (index, "test", 1);
+  g_assert_cmpuint (results->len, ==, 1);
+  g_ptr_array_unref (results);
+  results =
+    file_index_search (
+      index, "nonexistent-file", -1);
+  g_assert_cmpuint (results->len, ==, 0);
+  g_ptr_array_unref (results);
+
+  /* save and reload from the cache */
+  int num_entries =
+    file_index_get_num_entries (index);
+  file_index_save (index);
+  file_index_free (index);
+  g_assert_true (file_exists (cache_path));
+
+  index = file_index_new (cache_path);
+  g_assert_cmpint (
+    file_index_get_num_entries (index), ==,
+    num_entries);
+  results =
+    file_index_search (index, "test.wav", -1);
+  g_assert_cmpuint (results->len, ==, 1);
+  g_ptr_array_unref (results);
+
+  /* cached entries are returned without
+   * rescanning */
+  num_calls = 0;
+  file_index_request (
+    index, filepath,
+    (FileIndexCallback) on_indexed, &num_calls,
+    NULL);
+  file_index_wait (index);
+  g_assert_false (index->dirty);
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, false);
+  g_assert_cmpint (num_calls, ==, 1);
+
+  /* the peak thumbnail is available */
+  FileIndexEntry * entry =
+    g_hash_table_lookup (index->entries, filepath);
+  g_assert_nonnull (entry);
+  g_assert_nonnull (entry->peaks);
+  float max_peak = 0.f;
+  for (int i = 0; i < FILE_INDEX_NUM_PEAKS; i++)
+    {
+      max_peak =
+        MAX (
+          max_peak,
+          file_index_entry_get_peak (entry, i));
+    }
+  g_assert_cmpfloat (max_peak, >, 0.f);
+  g_assert_cmpfloat (max_peak, <=, 1.f);
+
+  file_index_free (index);
+
+  io_rmdir (tmp_dir, F_FORCE);
+  g_free (filepath);
+  g_free (cache_path);
+  g_free (tmp_dir);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/gui/backend/file_index/"
+
+  g_test_add_func (
+    TEST_PREFIX "test index and search",
+    (GTestFunc) test_index_and_search);
+
+  return g_test_run ();
+}
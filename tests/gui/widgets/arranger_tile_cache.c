@@ -0,0 +1,384 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <string.h>
+
+#include "gui/widgets/arranger_tile_cache.h"
+
+#include <glib.h>
+
+#define ORIGIN_X 10
+#define ZOOM 0.03
+#define VIEW_WIDTH 1600
+#define VIEW_HEIGHT 800
+
+/**
+ * Fake contents: a background and a box whose
+ * position scales with the zoom level, like an
+ * arranger object.
+ */
+typedef struct Contents
+{
+  double zoom;
+
+  /** Box start/end in ticks. */
+  double box_start;
+  double box_end;
+} Contents;
+
+static void
+get_box_rect (
+  Contents *     contents,
+  GdkRectangle * rect)
+{
+  rect->x =
+    (int) (contents->box_start * contents->zoom) +
+    ORIGIN_X;
+  rect->width =
+    (int)
+    ((contents->box_end - contents->box_start) *
+       contents->zoom);
+  rect->y = 100;
+  rect->height = 40;
+}
+
+static void
+draw_contents (
+  Contents *     contents,
+  cairo_t *      cr,
+  GdkRectangle * rect)
+{
+  cairo_set_source_rgb (cr, 0.1, 0.1, 0.1);
+  cairo_rectangle (
+    cr, 0, 0, rect->width, rect->height);
+  cairo_fill (cr);
+
+  GdkRectangle box_rect, draw_rect;
+  get_box_rect (contents, &box_rect);
+  if (!gdk_rectangle_intersect (
+         &box_rect, rect, &draw_rect))
+    return;
+
+  cairo_set_source_rgb (cr, 0.2, 0.6, 0.9);
+  cairo_rectangle (
+    cr, draw_rect.x - rect->x,
+    draw_rect.y - rect->y, draw_rect.width,
+    draw_rect.height);
+  cairo_fill (cr);
+}
+
+/**
+ * Draws the view through the cache on @ref
+ * tiled_surface and directly on @ref full_surface
+ * and checks that they match.
+ */
+static void
+draw_and_compare (
+  ArrangerTileCache * cache,
+  Contents *          contents,
+  cairo_surface_t *   tiled_surface,
+  cairo_surface_t *   full_surface)
+{
+  GdkRectangle rect = {
+    .x = 0, .y = 0,
+    .width = VIEW_WIDTH, .height = VIEW_HEIGHT,
+  };
+
+  cairo_t * cr = cairo_create (tiled_surface);
+  arranger_tile_cache_draw (
+    cache, cr, &rect,
+    (ArrangerTileDrawFunc) draw_contents,
+    contents);
+  cairo_destroy (cr);
+
+  cr = cairo_create (full_surface);
+  draw_contents (contents, cr, &rect);
+  cairo_destroy (cr);
+
+  cairo_surface_flush (tiled_surface);
+  cairo_surface_flush (full_surface);
+  int stride =
+    cairo_image_surface_get_stride (full_surface);
+  g_assert_cmpint (
+    memcmp (
+      cairo_image_surface_get_data (full_surface),
+      cairo_image_surface_get_data (tiled_surface),
+      (size_t) (stride * VIEW_HEIGHT)), ==, 0);
+}
+
+static void
+set_zoom (
+  ArrangerTileCache * cache,
+  Contents *          contents,
+  double              zoom)
+{
+  contents->zoom = zoom;
+  arranger_tile_cache_set_zoom (cache, zoom);
+}
+
+/**
+ * Moves the box, invalidating the area it was at
+ * and the area it is at now, like
+ * arranger_object_queue_redraw() does.
+ */
+static void
+move_box (
+  ArrangerTileCache * cache,
+  Contents *          contents,
+  double              ticks)
+{
+  GdkRectangle rect;
+  get_box_rect (contents, &rect);
+  arranger_tile_cache_invalidate_rect (cache, &rect);
+  contents->box_start += ticks;
+  contents->box_end += ticks;
+  get_box_rect (contents, &rect);
+  arranger_tile_cache_invalidate_rect (cache, &rect);
+}
+
+static void
+test_reuse_tiles (void)
+{
+  cairo_surface_t * tiled_surface =
+    cairo_image_surface_create (
+      CAIRO_FORMAT_ARGB32, VIEW_WIDTH, VIEW_HEIGHT);
+  cairo_surface_t * full_surface =
+    cairo_image_surface_create (
+      CAIRO_FORMAT_ARGB32, VIEW_WIDTH, VIEW_HEIGHT);
+  const int num_visible_tiles =
+    ((VIEW_WIDTH + ARRANGER_TILE_SIZE - 1) /
+       ARRANGER_TILE_SIZE) *
+    ((VIEW_HEIGHT + ARRANGER_TILE_SIZE - 1) /
+       ARRANGER_TILE_SIZE);
+
+  Contents contents = {
+    .box_start = 3840.0, .box_end = 7680.0,
+  };
+  ArrangerTileCache * cache =
+    arranger_tile_cache_new (ORIGIN_X);
+  set_zoom (cache, &contents, ZOOM);
+  draw_and_compare (
+    cache, &contents, tiled_surface, full_surface);
+  g_assert_cmpint (
+    cache->num_tiles_rendered, ==,
+    num_visible_tiles);
+
+  /* nothing changed */
+  draw_and_compare (
+    cache, &contents, tiled_surface, full_surface);
+  g_assert_cmpint (
+    cache->num_tiles_rendered, ==, 0);
+  g_assert_cmpint (
+    cache->num_tiles_reused, ==, num_visible_tiles);
+
+  /* only the tiles around the box are
+   * re-rendered */
+  move_box (cache, &contents, 960.0);
+  draw_and_compare (
+    cache, &contents, tiled_surface, full_surface);
+  g_assert_cmpint (
+    cache->num_tiles_rendered, >, 0);
+  g_assert_cmpint (
+    cache->num_tiles_rendered, <,
+    num_visible_tiles);
+
+  /* invalidating everything re-renders all
+   * visible tiles */
+  arranger_tile_cache_invalidate_all (cache);
+  draw_and_compare (
+    cache, &contents, tiled_surface, full_surface);
+  g_assert_cmpint (
+    cache->num_tiles_rendered, ==,
+    num_visible_tiles);
+
+  arranger_tile_cache_free (cache);
+  cairo_surface_destroy (tiled_surface);
+  cairo_surface_destroy (full_surface);
+}
+
+static void
+test_zoom_levels (void)
+{
+  cairo_surface_t * tiled_surface =
+    cairo_image_surface_create (
+      CAIRO_FORMAT_ARGB32, VIEW_WIDTH, VIEW_HEIGHT);
+  cairo_surface_t * full_surface =
+    cairo_image_surface_create (
+      CAIRO_FORMAT_ARGB32, VIEW_WIDTH, VIEW_HEIGHT);
+
+  Contents contents = {
+    .box_start = 3840.0, .box_end = 7680.0,
+  };
+  ArrangerTileCache * cache =
+    arranger_tile_cache_new (ORIGIN_X);
+  set_zoom (cache, &contents, ZOOM * 2);
+  draw_and_compare (
+    cache, &contents, tiled_surface, full_surface);
+  set_zoom (cache, &contents, ZOOM);
+  draw_and_compare (
+    cache, &contents, tiled_surface, full_surface);
+
+  /* switching zoom levels and back keeps the
+   * tiles */
+  set_zoom (cache, &contents, ZOOM * 2);
+  draw_and_compare (
+    cache, &contents, tiled_surface, full_surface);
+  g_assert_cmpint (
+    cache->num_tiles_rendered, ==, 0);
+  set_zoom (cache, &contents, ZOOM);
+  draw_and_compare (
+    cache, &contents, tiled_surface, full_surface);
+  g_assert_cmpint (
+    cache->num_tiles_rendered, ==, 0);
+
+  /* an edit keeps the other zoom level and
+   * invalidates the area of the edit there too */
+  move_box (cache, &contents, 1920.0);
+  g_assert_cmpint (cache->num_layers, ==, 2);
+  draw_and_compare (
+    cache, &contents, tiled_surface, full_surface);
+  g_assert_cmpint (
+    cache->num_tiles_rendered, >, 0);
+  set_zoom (cache, &contents, ZOOM * 2);
+  draw_and_compare (
+    cache, &contents, tiled_surface, full_surface);
+  g_assert_cmpint (
+    cache->num_tiles_rendered, >, 0);
+  g_assert_cmpint (
+    cache->num_tiles_reused, >, 0);
+
+  arranger_tile_cache_free (cache);
+  cairo_surface_destroy (tiled_surface);
+  cairo_surface_destroy (full_surface);
+}
+
+/**
+ * Draws the given rectangle through the cache.
+ */
+static void
+draw_rect (
+  ArrangerTileCache * cache,
+  Contents *          contents,
+  cairo_surface_t *   surface,
+  GdkRectangle *      rect)
+{
+  cairo_t * cr = cairo_create (surface);
+  arranger_tile_cache_draw (
+    cache, cr, rect,
+    (ArrangerTileDrawFunc) draw_contents,
+    contents);
+  cairo_destroy (cr);
+}
+
+static void
+test_shared_budget (void)
+{
+  cairo_surface_t * surface =
+    cairo_image_surface_create (
+      CAIRO_FORMAT_ARGB32, VIEW_WIDTH, VIEW_HEIGHT);
+
+  Contents contents = {
+    .box_start = 3840.0, .box_end = 7680.0,
+  };
+  ArrangerTileCache * cache =
+    arranger_tile_cache_new (ORIGIN_X);
+  ArrangerTileCache * small_cache =
+    arranger_tile_cache_new (ORIGIN_X);
+
+  /* a small arranger showing 2x2 tiles */
+  GdkRectangle small_rect = {
+    .x = 0, .y = 0,
+    .width = 2 * ARRANGER_TILE_SIZE,
+    .height = 2 * ARRANGER_TILE_SIZE,
+  };
+  set_zoom (small_cache, &contents, ZOOM);
+  draw_rect (
+    small_cache, &contents, surface, &small_rect);
+
+  /* a large one with tiles at another zoom
+   * level */
+  GdkRectangle rect = {
+    .x = 0, .y = 0,
+    .width = VIEW_WIDTH, .height = VIEW_HEIGHT,
+  };
+  set_zoom (cache, &contents, ZOOM * 2);
+  draw_rect (cache, &contents, surface, &rect);
+  set_zoom (cache, &contents, ZOOM);
+  g_assert_cmpint (cache->num_layers, ==, 2);
+
+  /* the budget scales with what is visible */
+  g_assert_cmpuint (
+    arranger_tile_cache_get_budget (), ==,
+    (size_t)
+    (cache->num_visible_tiles +
+       small_cache->num_visible_tiles) *
+    ARRANGER_TILE_CACHE_SCREENS *
+    ARRANGER_TILE_BYTES);
+
+  /* scroll far to the right and check that the
+   * tiles of both caches never exceed the
+   * budget */
+  for (int i = 0; i < 20; i++)
+    {
+      draw_rect (cache, &contents, surface, &rect);
+      g_assert_cmpuint (
+        arranger_tile_cache_get_total_bytes (), <=,
+        arranger_tile_cache_get_budget ());
+      rect.x += VIEW_WIDTH;
+    }
+
+  /* the tiles of the other zoom level were used
+   * least recently, so the layer is gone */
+  g_assert_cmpint (cache->num_layers, ==, 1);
+
+  /* the visible tiles of the small arranger are
+   * kept */
+  draw_rect (
+    small_cache, &contents, surface, &small_rect);
+  g_assert_cmpint (
+    small_cache->num_tiles_rendered, ==, 0);
+
+  arranger_tile_cache_free (cache);
+  arranger_tile_cache_free (small_cache);
+  g_assert_cmpuint (
+    arranger_tile_cache_get_total_bytes (), ==, 0);
+  cairo_surface_destroy (surface);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/gui/widgets/arranger_tile_cache/"
+
+  g_test_add_func (
+    TEST_PREFIX "test reuse tiles",
+    (GTestFunc) test_reuse_tiles);
+  g_test_add_func (
+    TEST_PREFIX "test zoom levels",
+    (GTestFunc) test_zoom_levels);
+  g_test_add_func (
+    TEST_PREFIX "test shared budget",
+    (GTestFunc) test_shared_budget);
+
+  return g_test_run ();
+}
@@ -235,10 +235,23 @@ do_takes_no_loop_no_punch (
     latch_port, AUTOMATION_VAL, F_NOT_NORMALIZED,
     F_NO_PUBLISH_EVENTS);
 
-  /* run the engine */
+  /* run the engine while the project is being
+   * serialized: the events are taken out of the
+   * queue but only handled after saving */
+  g_atomic_int_set (&PROJECT->saving, 1);
   engine_process (AUDIO_ENGINE, CYCLE_SIZE);
   recording_manager_process_events (
     RECORDING_MANAGER);
+  g_assert_cmpuint (
+    g_queue_get_length (
+      RECORDING_MANAGER->deferred_events), >, 0);
+  g_assert_cmpint (mr->num_midi_notes, ==, 0);
+  g_atomic_int_set (&PROJECT->saving, 0);
+  recording_manager_process_events (
+    RECORDING_MANAGER);
+  g_assert_cmpuint (
+    g_queue_get_length (
+      RECORDING_MANAGER->deferred_events), ==, 0);
 
   /* verify MIDI region positions */
   long r_length_frames =
@@ -24,6 +24,10 @@
 #include "audio/fader.h"
 #include "audio/midi_event.h"
 #include "audio/router.h"
+#include "audio/tracklist.h"
+#include "audio/transport.h"
+#include "plugins/lv2_plugin.h"
+#include "plugins/plugin.h"
 #include "utils/math.h"
 
 #include "tests/helpers/plugin_manager.h"
@@ -203,6 +207,176 @@ test_bypass_state_after_project_load (void)
 #endif
 }
 
+static void
+test_suspend_after_silent_tail (void)
+{
+#ifdef HAVE_LSP_COMPRESSOR
+  test_helper_zrythm_init ();
+
+  /* create fx track */
+  test_plugin_manager_create_tracks_from_plugin (
+    LSP_COMPRESSOR_BUNDLE, LSP_COMPRESSOR_URI,
+    false, false, 1);
+  Track * track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  Plugin * pl = track->channel->inserts[0];
+  g_assert_true (IS_PLUGIN_AND_NONNULL (pl));
+
+  /* stop dummy audio engine processing so we can
+   * process manually */
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (1000000);
+
+  /* use a tail shorter than a cycle */
+  AUDIO_ENGINE->plugin_suspend_tail_ms = 1;
+  g_assert_false (pl->suspended);
+
+  /* process silence until the tail passes */
+  for (int i = 0; i < 4; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+  g_assert_true (pl->suspended);
+  g_assert_cmpint (
+    tracklist_get_num_suspended_plugins (TRACKLIST),
+    ==, 1);
+
+  /* bypassing resumes the plugin */
+  plugin_set_enabled (
+    pl, F_NOT_ENABLED, F_NO_PUBLISH_EVENTS);
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  g_assert_false (pl->suspended);
+
+  test_helper_zrythm_cleanup ();
+#endif
+}
+
+static void
+test_no_suspend_while_producing_output (void)
+{
+#ifdef HAVE_HELM
+  test_helper_zrythm_init ();
+
+  /* create instrument track */
+  test_plugin_manager_create_tracks_from_plugin (
+    HELM_BUNDLE, HELM_URI, true, false, 1);
+  Track * track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  Plugin * pl = track->channel->instrument;
+  g_assert_true (IS_PLUGIN_AND_NONNULL (pl));
+
+  /* stop dummy audio engine processing so we can
+   * process manually */
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (1000000);
+
+  /* use a tail shorter than a cycle */
+  AUDIO_ENGINE->plugin_suspend_tail_ms = 1;
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+
+  /* hold a note */
+  midi_events_add_note_on (
+    track->processor->midi_in->midi_events,
+    1, 62, 74, 2, true);
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+
+  /* the plugin keeps sounding without further
+   * input, so it is not suspended and the silent
+   * tail starts over on every cycle */
+  for (int i = 0; i < 4; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+      g_assert_false (pl->suspended);
+      g_assert_cmpuint (pl->silent_frames, ==, 0);
+    }
+
+  /* release the note and let the tail pass */
+  midi_events_add_note_off (
+    track->processor->midi_in->midi_events,
+    1, 62, 0, true);
+  bool suspended = false;
+  for (int i = 0; i < 400 && !suspended; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+      suspended = pl->suspended;
+    }
+  g_assert_true (suspended);
+
+  /* a new note resumes it */
+  midi_events_add_note_on (
+    track->processor->midi_in->midi_events,
+    1, 62, 74, 2, true);
+  engine_process (
+    AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  g_assert_false (pl->suspended);
+
+  /* instruments are not suspended while the
+   * transport is rolling */
+  midi_events_add_note_off (
+    track->processor->midi_in->midi_events,
+    1, 62, 0, true);
+  transport_request_roll (TRANSPORT);
+  for (int i = 0; i < 400; i++)
+    {
+      engine_process (
+        AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+  g_assert_false (pl->suspended);
+
+  test_helper_zrythm_cleanup ();
+#endif
+}
+
+/**
+ * Checks that the state is saved with the control
+ * values from when saving started.
+ */
+static void
+test_save_state_with_control_snapshot (void)
+{
+  test_helper_zrythm_init ();
+
+  test_plugin_manager_create_tracks_from_plugin (
+    EG_AMP_BUNDLE_URI, EG_AMP_URI, false, false,
+    1);
+  Track * track =
+    TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  Plugin * pl = track->channel->inserts[0];
+  g_assert_true (IS_PLUGIN_AND_NONNULL (pl));
+  Port * gain =
+    plugin_get_port_by_symbol (pl, "gain");
+  g_assert_nonnull (gain);
+
+  gain->control = -6.f;
+  plugin_snapshot_control_values (pl);
+  gain->control = 3.f;
+
+  uint32_t size, type;
+  const float * val =
+    lv2_plugin_get_port_value (
+      "gain", pl->lv2, &size, &type);
+  g_assert_nonnull (val);
+  g_assert_cmpfloat_with_epsilon (
+    *val, -6.f, 0.0001f);
+
+  /* the live values are used otherwise */
+  plugin_clear_control_snapshot (pl);
+  g_assert_null (pl->control_snapshot);
+  val =
+    lv2_plugin_get_port_value (
+      "gain", pl->lv2, &size, &type);
+  g_assert_cmpfloat_with_epsilon (
+    *val, 3.f, 0.0001f);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -212,9 +386,19 @@ main (int argc, char *argv[])
 
 #define TEST_PREFIX "/plugins/plugin/"
 
+  g_test_add_func (
+    TEST_PREFIX
+    "test save state with control snapshot",
+    (GTestFunc) test_save_state_with_control_snapshot);
   g_test_add_func (
     TEST_PREFIX "test bypass state after project load",
     (GTestFunc) test_bypass_state_after_project_load);
+  g_test_add_func (
+    TEST_PREFIX "test suspend after silent tail",
+    (GTestFunc) test_suspend_after_silent_tail);
+  g_test_add_func (
+    TEST_PREFIX "test no suspend while producing output",
+    (GTestFunc) test_no_suspend_while_producing_output);
   g_test_add_func (
     TEST_PREFIX "test loading non-existing plugin",
     (GTestFunc) test_loading_non_existing_plugin);
@@ -19,10 +19,15 @@
 
 #include "zrythm-test-config.h"
 
+#include <string.h>
+
 #include "audio/track.h"
 #include "audio/tempo_track.h"
 #include "project.h"
+#include "project_binary.h"
 #include "utils/flags.h"
+#include "utils/io.h"
+#include "utils/yaml.h"
 #include "zrythm.h"
 
 #include "helpers/plugin_manager.h"
@@ -107,6 +112,146 @@ test_save_load_with_data ()
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_save_load_binary ()
+{
+  test_helper_zrythm_init ();
+
+  /* add some data */
+  Position p1, p2;
+  test_project_rebootstrap_timeline (&p1, &p2);
+
+  /* serialize to the binary format */
+  char * live_yaml =
+    yaml_serialize (PROJECT, &project_schema);
+  char * data;
+  size_t size;
+  char * err_msg =
+    project_binary_serialize (
+      PROJECT, &data, &size);
+  g_assert_null (err_msg);
+  g_assert_true (
+    project_binary_is_binary (data, size));
+
+  /* check that exporting to YAML gives the same
+   * project */
+  char * yaml;
+  err_msg =
+    project_binary_to_yaml (&yaml, data, size);
+  g_assert_null (err_msg);
+  g_assert_cmpstr (yaml, ==, live_yaml);
+  g_free (yaml);
+  g_free (live_yaml);
+
+  /* check that corrupt data is rejected */
+  Project * prj = NULL;
+  err_msg =
+    project_binary_deserialize (
+      &prj, data, 20, false);
+  g_assert_nonnull (err_msg);
+  g_assert_null (prj);
+  g_free (err_msg);
+
+  /* stream it to the project file and check
+   * that it matches the in-memory container */
+  char * prj_file =
+    g_build_filename (
+      PROJECT->dir, PROJECT_FILE, NULL);
+  err_msg =
+    project_binary_serialize_to_file (
+      PROJECT, prj_file);
+  g_assert_null (err_msg);
+  char * file_data;
+  size_t file_size;
+  g_assert_true (
+    g_file_get_contents (
+      prj_file, &file_data, &file_size, NULL));
+  g_assert_cmpuint (file_size, ==, size);
+  g_assert_true (
+    memcmp (file_data, data, size) == 0);
+  g_free (file_data);
+  g_free (data);
+
+  /* and reload it from the file */
+  object_free_w_func_and_null (
+    project_free, PROJECT);
+  int ret = project_load (prj_file, 0);
+  g_assert_cmpint (ret, ==, 0);
+  g_free (prj_file);
+
+  /* the undo history is loaded lazily */
+  g_assert_nonnull (UNDO_MANAGER->loader);
+  undo_manager_ensure_loaded (UNDO_MANAGER);
+  g_assert_null (UNDO_MANAGER->loader);
+  g_assert_nonnull (UNDO_MANAGER->undo_stack);
+  g_assert_nonnull (UNDO_MANAGER->redo_stack);
+
+  test_project_check_vs_original_state (
+    &p1, &p2, 0);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_compress_file_roundtrip ()
+{
+  test_helper_zrythm_init ();
+
+  char * yaml =
+    yaml_serialize (PROJECT, &project_schema);
+  size_t yaml_size = strlen (yaml);
+
+  /* stream the compressed project to a file */
+  char * tmp_dir =
+    g_dir_make_tmp ("zrythm_compress_XXXXXX", NULL);
+  char * file =
+    g_build_filename (tmp_dir, PROJECT_FILE, NULL);
+  char * err_msg =
+    project_compress (
+      &file, NULL, PROJECT_COMPRESS_FILE,
+      yaml, yaml_size, PROJECT_COMPRESS_DATA);
+  g_assert_null (err_msg);
+  g_assert_true (
+    g_file_test (file, G_FILE_TEST_EXISTS));
+
+  /* stream it back from the file */
+  char * dest;
+  size_t dest_size;
+  err_msg =
+    project_decompress (
+      &dest, &dest_size, PROJECT_DECOMPRESS_DATA,
+      file, 0, PROJECT_DECOMPRESS_FILE);
+  g_assert_null (err_msg);
+  g_assert_cmpuint (dest_size, ==, yaml_size);
+  g_assert_true (
+    memcmp (dest, yaml, yaml_size) == 0);
+  free (dest);
+
+  /* check that truncated files are rejected */
+  char * data;
+  size_t size;
+  g_assert_true (
+    g_file_get_contents (file, &data, &size, NULL));
+  g_assert_true (
+    g_file_set_contents (
+      file, data, (gssize) size / 2, NULL));
+  g_free (data);
+  err_msg =
+    project_decompress (
+      &dest, &dest_size, PROJECT_DECOMPRESS_DATA,
+      file, 0, PROJECT_DECOMPRESS_FILE);
+  g_assert_nonnull (err_msg);
+  g_free (err_msg);
+
+  io_remove (file);
+  io_rmdir (tmp_dir, false);
+  g_free (file);
+  g_free (tmp_dir);
+  g_free (yaml);
+
+  test_helper_zrythm_cleanup ();
+}
+
 static void
 test_new_from_template ()
 {
@@ -227,6 +372,12 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test empty save load",
     (GTestFunc) test_empty_save_load);
+  g_test_add_func (
+    TEST_PREFIX "test compress file roundtrip",
+    (GTestFunc) test_compress_file_roundtrip);
+  g_test_add_func (
+    TEST_PREFIX "test save load binary",
+    (GTestFunc) test_save_load_binary);
   g_test_add_func (
     TEST_PREFIX "test save load with data",
     (GTestFunc) test_save_load_with_data);
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include "utils/handle_table.h"
+
+#include <glib.h>
+
+static void
+test_generation_mismatch (void)
+{
+  HandleTable * table = handle_table_new ();
+
+  int a = 1, b = 2;
+
+  /* unset handles resolve to NULL */
+  ObjectHandle unset = { 0, 0 };
+  g_assert_false (object_handle_is_set (&unset));
+  g_assert_null (handle_table_get (table, &unset));
+
+  ObjectHandle handle_a =
+    handle_table_add (table, &a);
+  g_assert_true (object_handle_is_set (&handle_a));
+  g_assert_true (
+    handle_table_get (table, &handle_a) == &a);
+
+  /* removed objects no longer resolve */
+  handle_table_remove (table, &handle_a);
+  g_assert_null (
+    handle_table_get (table, &handle_a));
+
+  /* the slot is reused with a new generation, so
+   * the old handle does not resolve to the new
+   * object */
+  ObjectHandle handle_b =
+    handle_table_add (table, &b);
+  g_assert_cmpuint (
+    handle_b.slot, ==, handle_a.slot);
+  g_assert_cmpuint (
+    handle_b.generation, !=, handle_a.generation);
+  g_assert_null (
+    handle_table_get (table, &handle_a));
+  g_assert_true (
+    handle_table_get (table, &handle_b) == &b);
+
+  /* handles to slots that don't exist resolve to
+   * NULL */
+  ObjectHandle invalid = { 1000, 1 };
+  g_assert_null (
+    handle_table_get (table, &invalid));
+
+  handle_table_free (table);
+}
+
+static void
+test_many_objects (void)
+{
+  HandleTable * table = handle_table_new ();
+
+#define NUM_OBJS 300
+
+  int objs[NUM_OBJS];
+  ObjectHandle handles[NUM_OBJS];
+  for (int i = 0; i < NUM_OBJS; i++)
+    {
+      objs[i] = i;
+      handles[i] = handle_table_add (table, &objs[i]);
+    }
+
+  /* remove every other object */
+  for (int i = 0; i < NUM_OBJS; i += 2)
+    {
+      handle_table_remove (table, &handles[i]);
+    }
+
+  for (int i = 0; i < NUM_OBJS; i++)
+    {
+      int * obj =
+        handle_table_get (table, &handles[i]);
+      if (i % 2 == 0)
+        {
+          g_assert_null (obj);
+        }
+      else
+        {
+          g_assert_nonnull (obj);
+          g_assert_cmpint (*obj, ==, i);
+        }
+    }
+
+#undef NUM_OBJS
+
+  handle_table_free (table);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/utils/handle_table/"
+
+  g_test_add_func (
+    TEST_PREFIX "test generation mismatch",
+    (GTestFunc) test_generation_mismatch);
+  g_test_add_func (
+    TEST_PREFIX "test many objects",
+    (GTestFunc) test_many_objects);
+
+  return g_test_run ();
+}
@@ -19,6 +19,7 @@
 
 #include "zrythm-test-config.h"
 
+#include <stdbool.h>
 #include <stdlib.h>
 
 #include "utils/hash.h"
@@ -53,6 +54,39 @@ test_get_from_file (void)
 #endif
 }
 
+static void
+test_get_from_data (void)
+{
+  char * filepath =
+    g_build_filename (
+      TESTS_SRCDIR,
+      "test_start_with_signal.mp3", NULL);
+  char * contents;
+  gsize size;
+  bool ret =
+    g_file_get_contents (
+      filepath, &contents, &size, NULL);
+  g_assert_true (ret);
+
+  /* should match the hash of the file */
+  char * hash =
+    hash_get_from_data (
+      contents, size, HASH_ALGORITHM_XXH32);
+  g_assert_cmpstr (hash, ==, "ca5b86cb");
+  g_free (hash);
+
+#if XXH_VERSION_NUMBER >= 800
+  hash =
+    hash_get_from_data (
+      contents, size, HASH_ALGORITHM_XXH3_64);
+  g_assert_cmpstr (hash, ==, "e9cd4b9c1e12785e");
+  g_free (hash);
+#endif
+
+  g_free (contents);
+  g_free (filepath);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -63,6 +97,9 @@ main (int argc, char *argv[])
   g_test_add_func (
     TEST_PREFIX "test get from file",
     (GTestFunc) test_get_from_file);
+  g_test_add_func (
+    TEST_PREFIX "test get from data",
+    (GTestFunc) test_get_from_data);
 
   return g_test_run ();
 }
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2021 Alexandros Theodotou <alex at zrythm dot org>
+ *
+ * This file is part of Zrythm
+ *
+ * Zrythm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zrythm is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with Zrythm.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "zrythm-test-config.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <utime.h>
+
+#include "utils/hash.h"
+#include "utils/hash_cache.h"
+#include "utils/io.h"
+#include "zrythm.h"
+
+#include "tests/helpers/zrythm.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+/**
+ * Writes the contents to the file and sets its
+ * modification time to a fixed time in the past.
+ */
+static void
+write_old_file (
+  const char * filepath,
+  const char * contents)
+{
+  /* overwrite in place to keep the inode */
+  FILE * f = fopen (filepath, "wb");
+  g_assert_nonnull (f);
+  fputs (contents, f);
+  fclose (f);
+
+  struct utimbuf times;
+  times.actime = 1600000000;
+  times.modtime = times.actime;
+  g_assert_cmpint (
+    g_utime (filepath, &times), ==, 0);
+}
+
+static void
+test_get_from_file (void)
+{
+  test_helper_zrythm_init ();
+
+  char * tmp_dir =
+    g_dir_make_tmp ("zrythm_hash_cache_XXXXXX", NULL);
+  char * filepath =
+    g_build_filename (tmp_dir, "file", NULL);
+
+  write_old_file (filepath, "aaaa");
+  char * hash =
+    hash_cache_get_from_file (
+      HASH_CACHE, filepath, HASH_ALGORITHM_XXH32);
+  char * expected_hash =
+    hash_get_from_file (
+      filepath, HASH_ALGORITHM_XXH32);
+  g_assert_cmpstr (hash, ==, expected_hash);
+  g_free (hash);
+  g_assert_cmpint (HASH_CACHE->num_entries, ==, 1);
+
+  /* change the contents without changing the size
+   * or the modification time: the cached hash is
+   * used without reading the file */
+  write_old_file (filepath, "bbbb");
+  hash =
+    hash_cache_get_from_file (
+      HASH_CACHE, filepath, HASH_ALGORITHM_XXH32);
+  g_assert_cmpstr (hash, ==, expected_hash);
+  g_free (hash);
+
+  /* changing the size invalidates it */
+  write_old_file (filepath, "bbbbb");
+  hash =
+    hash_cache_get_from_file (
+      HASH_CACHE, filepath, HASH_ALGORITHM_XXH32);
+  g_free (expected_hash);
+  expected_hash =
+    hash_get_from_file (
+      filepath, HASH_ALGORITHM_XXH32);
+  g_assert_cmpstr (hash, ==, expected_hash);
+  g_free (hash);
+
+  /* recently modified files are not cached */
+  char * new_filepath =
+    g_build_filename (tmp_dir, "new_file", NULL);
+  g_assert_true (
+    g_file_set_contents (
+      new_filepath, "cccc", -1, NULL));
+  hash =
+    hash_cache_get_from_file (
+      HASH_CACHE, new_filepath,
+      HASH_ALGORITHM_XXH32);
+  g_assert_nonnull (hash);
+  g_free (hash);
+  g_assert_cmpint (HASH_CACHE->num_entries, ==, 2);
+
+  /* the cache is persistent */
+  hash_cache_serialize_to_file (HASH_CACHE);
+  hash_cache_free (HASH_CACHE);
+  HASH_CACHE = hash_cache_new ();
+  write_old_file (filepath, "ccccc");
+  hash =
+    hash_cache_get_from_file (
+      HASH_CACHE, filepath, HASH_ALGORITHM_XXH32);
+  g_assert_cmpstr (hash, ==, expected_hash);
+  g_free (hash);
+  g_assert_cmpint (HASH_CACHE->num_entries, ==, 2);
+
+  io_remove (filepath);
+  io_remove (new_filepath);
+  io_rmdir (tmp_dir, false);
+  g_free (filepath);
+  g_free (new_filepath);
+  g_free (expected_hash);
+  g_free (tmp_dir);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/utils/hash_cache/"
+
+  g_test_add_func (
+    TEST_PREFIX "test get from file",
+    (GTestFunc) test_get_from_file);
+
+  return g_test_run ();
+}
@@ -19,11 +19,15 @@
 
 #include "zrythm-test-config.h"
 
+#include <utime.h>
+
 #include <lilv/lilv.h>
 
 #include "audio/fader.h"
 #include "audio/midi_event.h"
 #include "audio/router.h"
+#include "project.h"
+#include "utils/flags.h"
 #include "utils/math.h"
 #include "ext/whereami/whereami.h"
 
@@ -31,6 +35,7 @@
 #include "tests/helpers/zrythm.h"
 
 #include <glib.h>
+#include <glib/gstdio.h>
 
 static void
 on_finished_conversion_from_zpj_to_yaml (void)
@@ -148,6 +153,79 @@ test_project_conversion (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_render (void)
+{
+  if (g_test_subprocess ())
+    {
+      /* render from a fresh process like the
+       * command line would */
+      char arg1[900];
+      sprintf (
+        arg1, "--render=%s",
+        g_getenv ("ZRYTHM_TEST_RENDER_PROJECT"));
+      char arg2[900];
+      sprintf (
+        arg2, "--output=%s",
+        g_getenv ("ZRYTHM_TEST_RENDER_OUTPUT"));
+      char exe_path[] = "zrythm";
+      int argc = 3;
+      char * argv[] = {
+        exe_path, arg1, arg2 };
+
+      ZrythmApp * app =
+        zrythm_app_new (argc, (const char **) argv);
+      g_application_run (
+        G_APPLICATION (app), argc, argv);
+
+      /* rendering exits the process */
+      g_assert_not_reached ();
+    }
+
+  test_helper_zrythm_init ();
+
+  /* save the project and a newer backup, which
+   * must be ignored without a UI */
+  int ret =
+    project_save (
+      PROJECT, PROJECT->dir, F_NOT_BACKUP, 0,
+      F_NO_ASYNC);
+  g_assert_cmpint (ret, ==, 0);
+  char * prj_file =
+    g_build_filename (
+      PROJECT->dir, PROJECT_FILE, NULL);
+  struct utimbuf times;
+  times.actime = 1600000000;
+  times.modtime = times.actime;
+  g_assert_cmpint (
+    g_utime (prj_file, &times), ==, 0);
+  ret =
+    project_save (
+      PROJECT, PROJECT->dir, F_BACKUP, 0,
+      F_NO_ASYNC);
+  g_assert_cmpint (ret, ==, 0);
+
+  char * output_file =
+    g_build_filename (
+      PROJECT->dir, "render.wav", NULL);
+  g_setenv (
+    "ZRYTHM_TEST_RENDER_PROJECT", prj_file, true);
+  g_setenv (
+    "ZRYTHM_TEST_RENDER_OUTPUT", output_file, true);
+
+  g_test_trap_subprocess (NULL, 0, 0);
+  g_test_trap_assert_passed ();
+  g_test_trap_assert_stdout (
+    "*\"realtime_multiple\"*");
+  g_assert_true (
+    g_file_test (output_file, G_FILE_TEST_EXISTS));
+
+  g_free (prj_file);
+  g_free (output_file);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -155,6 +233,11 @@ main (int argc, char *argv[])
 
 #define TEST_PREFIX "/zrythm_app/"
 
+  /* the conversion test exits the process so it
+   * must be last */
+  g_test_add_func (
+    TEST_PREFIX "test render",
+    (GTestFunc) test_render);
   g_test_add_func (
     TEST_PREFIX "test project conversion",
     (GTestFunc) test_project_conversion);